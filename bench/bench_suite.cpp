@@ -0,0 +1,330 @@
+// BENCHMARK SUITE
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "checker.h"
+#include "configuration.h"
+#include "file_walker.h"
+#include "list.h"
+
+#include <benchmark/benchmark.h>
+
+#ifndef SQLCHECK_EXAMPLES_DIR
+#define SQLCHECK_EXAMPLES_DIR "examples"
+#endif
+
+namespace sqlcheck {
+
+// Representative statements that a rule flags (hit) and passes (miss)
+struct RuleSample {
+
+  // rule id
+  const char* id;
+
+  // flagged statement (nullptr -- the rule cannot fire today)
+  const char* hit;
+
+  const char* miss;
+
+};
+
+const RuleSample rule_samples[] = {
+
+  // LOGICAL DATABASE DESIGN
+
+  {"1001",
+   "CREATE TABLE products (product_id INT PRIMARY KEY, account_id VARCHAR(100));",
+   "CREATE TABLE products (product_id INT PRIMARY KEY, account_id INT);"},
+  {"1002",
+   "CREATE TABLE employees (emp_id INT PRIMARY KEY, manager INT REFERENCES employees(emp_id));",
+   "CREATE TABLE employees (emp_id INT PRIMARY KEY, dept INT REFERENCES depts(dept_id));"},
+  // Absence check: CheckPattern only reports a pattern that matches
+  {"1003",
+   nullptr,
+   "CREATE TABLE bugs (bug_id INT PRIMARY KEY, summary VARCHAR(80));"},
+  {"1004",
+   "CREATE TABLE bugs (id SERIAL PRIMARY KEY, summary VARCHAR(80));",
+   "CREATE TABLE bugs (bug_id SERIAL PRIMARY KEY, summary VARCHAR(80));"},
+  // Absence check: CheckPattern only reports a pattern that matches
+  {"1005",
+   nullptr,
+   "CREATE TABLE comments (comment_id INT PRIMARY KEY, bug_id INT, "
+   "FOREIGN KEY (bug_id) REFERENCES bugs(bug_id));"},
+  {"1006",
+   "CREATE TABLE issue_attributes (issue_id INT, attribute VARCHAR(20), value VARCHAR(80));",
+   "CREATE TABLE issues (issue_id INT PRIMARY KEY, severity VARCHAR(20));"},
+  {"1007",
+   "CREATE TABLE bugs (bug_id INT PRIMARY KEY, tag1 VARCHAR(20), tag2 VARCHAR(20), tag3 VARCHAR(20));",
+   "CREATE TABLE bugs (bug_id INT PRIMARY KEY, tag VARCHAR(20));"},
+
+  // PHYSICAL DATABASE DESIGN
+
+  {"2001",
+   "CREATE TABLE accounts (account_id INT PRIMARY KEY, hourly_rate FLOAT);",
+   "CREATE TABLE accounts (account_id INT PRIMARY KEY, hourly_rate NUMERIC(9,2));"},
+  {"2002",
+   "CREATE TABLE bugs (bug_id INT PRIMARY KEY, status ENUM('NEW', 'FIXED'));",
+   "CREATE TABLE bugs (bug_id INT PRIMARY KEY, status VARCHAR(20));"},
+  {"2003",
+   "CREATE TABLE screenshots (bug_id INT PRIMARY KEY, path VARCHAR(100));",
+   "CREATE TABLE screenshots (bug_id INT PRIMARY KEY, image BLOB);"},
+  {"2004",
+   "CREATE TABLE bugs (bug_id INT PRIMARY KEY, a INT, b INT, c INT, d INT, "
+   "INDEX (a), INDEX (b), INDEX (c), INDEX (d));",
+   "CREATE TABLE bugs (bug_id INT PRIMARY KEY, a INT, INDEX (a));"},
+  {"2005",
+   "CREATE INDEX telephone_idx ON accounts (first_name, last_name);",
+   "SELECT first_name FROM accounts WHERE account_id = 1;"},
+
+  // QUERY
+
+  {"3001",
+   "SELECT * FROM bugs WHERE bug_id = 1;",
+   "SELECT bug_id, summary FROM bugs WHERE bug_id = 1;"},
+  {"3017",
+   "SELECT b.bug_id FROM bugs b JOIN comments c ON b.bug_id > c.bug_id WHERE c.author = 1;",
+   "SELECT b.bug_id FROM bugs b JOIN comments c ON b.bug_id = c.bug_id WHERE c.author = 1;"},
+  {"3002",
+   "SELECT first_name FROM accounts WHERE middle_initial = NULL;",
+   "SELECT first_name FROM accounts WHERE account_id = 1;"},
+  {"3003",
+   "CREATE TABLE accounts (account_id INT PRIMARY KEY, middle_initial CHAR(2) NOT NULL);",
+   "CREATE TABLE accounts (account_id INT PRIMARY KEY, middle_initial CHAR(2));"},
+  {"3004",
+   "SELECT first_name || ' ' || last_name AS full_name FROM accounts;",
+   "SELECT first_name, last_name FROM accounts;"},
+  {"3005",
+   "SELECT product_id, MAX(date_reported), bug_id FROM bugs GROUP BY product_id;",
+   "SELECT product_id, date_reported, bug_id FROM bugs;"},
+  {"3006",
+   "SELECT bug_id FROM bugs ORDER BY RAND() LIMIT 1;",
+   "SELECT bug_id FROM bugs ORDER BY bug_id LIMIT 1;"},
+  // Pattern is written with "\b" (backspace) and never matches
+  {"3007",
+   nullptr,
+   "SELECT bug_id FROM bugs WHERE status = 'NEW';"},
+  {"3008",
+   "SELECT p.product_id, f.bug_id, o.bug_id, COUNT(*) FROM products p "
+   "LEFT OUTER JOIN bugs_products bp ON p.product_id = bp.product_id "
+   "LEFT OUTER JOIN bugs f ON bp.bug_id = f.bug_id AND f.status = 'FIXED' "
+   "LEFT OUTER JOIN bugs o ON bp.bug_id = o.bug_id AND o.status = 'OPEN' "
+   "LEFT OUTER JOIN accounts a ON f.assigned_to = a.account_id "
+   "LEFT OUTER JOIN accounts r ON f.reported_by = r.account_id "
+   "WHERE p.product_id = 1 AND f.date_reported > o.date_reported "
+   "AND a.account_name <> r.account_name "
+   "GROUP BY p.product_id, f.bug_id, o.bug_id ORDER BY p.product_id, f.bug_id;",
+   "SELECT bug_id FROM bugs WHERE status = 'NEW';"},
+  // Pattern is written with "\b" (backspace) and never matches
+  {"3009",
+   nullptr,
+   "SELECT a.x FROM a JOIN b ON a.id = b.id;"},
+  // Pattern is written with "\b" (backspace) and never matches
+  {"3010",
+   nullptr,
+   "SELECT DISTINCT a FROM t;"},
+  {"3011",
+   "INSERT INTO accounts VALUES (1, 'bill', 'karwin');",
+   "INSERT INTO accounts (account_id, first_name, last_name) VALUES (1, 'bill', 'karwin');"},
+  // Pattern is written with "\b" (backspace) and never matches
+  {"3012",
+   nullptr,
+   "SELECT product_id FROM bugs WHERE bug_id = 1;"},
+  // Pattern is written with "\b" (backspace) and never matches
+  {"3013",
+   nullptr,
+   "SELECT bug_id FROM bugs WHERE bug_id = 1;"},
+  // Pattern is written with "\b" (backspace) and never matches
+  {"3014",
+   nullptr,
+   "SELECT bug_id FROM bugs WHERE status IN ('NEW', 'OPEN');"},
+  {"3015",
+   "SELECT bug_id FROM bugs UNION SELECT bug_id FROM comments;",
+   "SELECT bug_id FROM bugs;"},
+  {"3016",
+   "SELECT DISTINCT b.bug_id FROM bugs b JOIN comments c ON b.bug_id = c.bug_id;",
+   "SELECT b.bug_id FROM bugs b WHERE b.bug_id = 1;"},
+
+  // APPLICATION
+
+  {"4001",
+   "CREATE TABLE accounts (account_id INT PRIMARY KEY, password VARCHAR(30));",
+   "CREATE TABLE accounts (account_id INT PRIMARY KEY, password_hash CHAR(64));"}
+
+};
+
+// UTILITY
+
+// Discard std::cout while the checker prints its report
+class SilenceOutput {
+
+ public:
+  SilenceOutput()
+   : buffer_(std::cout.rdbuf(nullptr)) {
+  }
+
+  ~SilenceOutput(){
+    std::cout.rdbuf(buffer_);
+  }
+
+ private:
+  std::streambuf* buffer_;
+
+};
+
+const Rule* FindRule(const char* id){
+  for(auto& rule : GetRules()){
+    if(std::string(rule.id) == id){
+      return &rule;
+    }
+  }
+  return nullptr;
+}
+
+// RULES
+
+// Run one rule on a normalized statement (as CheckStatement does)
+void BM_Rule(benchmark::State& bench_state,
+             const Rule* rule,
+             const std::string sql_statement,
+             const bool expect_finding){
+
+  Configuration state;
+  state.collect_findings = true;
+  state.rule_id = rule->id;
+  state.catalog.AddStatement(sql_statement);
+
+  std::string statement;
+  NormalizeStatement(sql_statement, statement, state.statement_offsets);
+
+  std::size_t findings = 0;
+  for(auto _ : bench_state){
+    bool print_statement = true;
+    rule->function(state, statement, print_statement);
+    findings = state.findings.size();
+    state.findings.clear();
+  }
+
+  // A hit that is not flagged would time the no-match path
+  if(expect_finding == true && findings == 0){
+    bench_state.SkipWithError("hit sample produced no finding");
+    return;
+  }
+
+  bench_state.counters["findings"] = findings;
+  bench_state.SetBytesProcessed(bench_state.iterations() * statement.size());
+}
+
+// CHECKER
+
+void BM_WrapText(benchmark::State& bench_state){
+
+  std::string text;
+  while(text.size() < static_cast<std::size_t>(bench_state.range(0))){
+    text += "Avoid using the same column for several purposes: ";
+  }
+
+  for(auto _ : bench_state){
+    benchmark::DoNotOptimize(WrapText(text));
+  }
+
+  bench_state.SetBytesProcessed(bench_state.iterations() * text.size());
+}
+BENCHMARK(BM_WrapText)->Range(64, 16 << 10);
+
+// Map many matches of a multi-line statement to line numbers
+void BM_CheckPatternLineMapping(benchmark::State& bench_state){
+
+  std::string statement;
+  for(int64_t line = 0; line < bench_state.range(0); line++){
+    statement += "select * from bugs\nunion\n";
+  }
+  statement += "select 1 ";
+
+  Configuration state;
+  state.collect_findings = true;
+  state.rule_id = "3001";
+  std::string normalized;
+  NormalizeStatement(statement, normalized, state.statement_offsets);
+
+  static const std::regex pattern("(select\\s+\\*)");
+  for(auto _ : bench_state){
+    bool print_statement = true;
+    CheckPattern(state, normalized, print_statement, pattern,
+                 RISK_LEVEL_HIGH, PATTERN_TYPE_QUERY, "SELECT *", "", true);
+    state.findings.clear();
+  }
+
+  bench_state.SetBytesProcessed(bench_state.iterations() * normalized.size());
+}
+BENCHMARK(BM_CheckPatternLineMapping)->Range(1, 1 << 10);
+
+// End-to-end Check() over an input file
+void BM_Check(benchmark::State& bench_state,
+              const std::string path){
+
+  std::ifstream input(path.c_str());
+  std::stringstream contents;
+  contents << input.rdbuf();
+  auto text = contents.str();
+
+  SilenceOutput silence;
+  for(auto _ : bench_state){
+    Configuration state;
+    state.testing_mode = true;
+    state.color_mode = false;
+    state.file_name = path;
+    state.test_stream.reset(new std::istringstream(text));
+    benchmark::DoNotOptimize(Check(state));
+  }
+
+  bench_state.SetBytesProcessed(bench_state.iterations() * text.size());
+}
+
+void RegisterBenchmarks(){
+
+  for(auto& sample : rule_samples){
+    auto rule = FindRule(sample.id);
+    if(rule == nullptr){
+      continue;
+    }
+
+    std::string name = std::string("BM_Rule/") + sample.id;
+    if(sample.hit != nullptr){
+      benchmark::RegisterBenchmark((name + "/hit").c_str(), BM_Rule,
+                                   rule, std::string(sample.hit), true);
+    }
+    benchmark::RegisterBenchmark((name + "/miss").c_str(), BM_Rule,
+                                 rule, std::string(sample.miss), false);
+  }
+
+  // One benchmark per example file
+  WalkDirectory(SQLCHECK_EXAMPLES_DIR, [](const std::string& path){
+    if(HasExtension(path, ".sql") == false){
+      return;
+    }
+    auto name = path.substr(path.rfind('/') + 1);
+    benchmark::RegisterBenchmark(("BM_Check/" + name).c_str(), BM_Check, path)
+        ->Unit(benchmark::kMillisecond);
+  });
+
+}
+
+}  // namespace sqlcheck
+
+int main(int argc, char** argv){
+
+  sqlcheck::RegisterBenchmarks();
+
+  benchmark::Initialize(&argc, argv);
+  if(benchmark::ReportUnrecognizedArguments(argc, argv)){
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
@@ -0,0 +1 @@
+SELECT DISTINCT distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct distinct JOIN u ON a < b;
@@ -0,0 +1,22 @@
+// FUZZ CHECK SOURCE
+
+#include <iostream>
+#include <sstream>
+
+#include "checker.h"
+#include "fuzz_target.h"
+
+// Split, normalize and check arbitrary bytes
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size){
+
+  // The report is not checked, so skip writing it
+  std::cout.setstate(std::ios::badbit);
+
+  // Default options of the command line, including its statement size cap
+  sqlcheck::Configuration state;
+  state.testing_mode = true;
+  state.test_stream.reset(new std::istringstream(sqlcheck::GetFuzzInput(data, size)));
+
+  sqlcheck::Check(state);
+  return 0;
+}
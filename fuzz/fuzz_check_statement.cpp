@@ -0,0 +1,18 @@
+// FUZZ CHECK STATEMENT SOURCE
+
+#include <iostream>
+
+#include "checker.h"
+#include "fuzz_target.h"
+
+// Run every rule on a single statement
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size){
+
+  std::cout.setstate(std::ios::badbit);
+
+  sqlcheck::Configuration state;
+  state.collect_findings = true;
+
+  sqlcheck::CheckStatement(state, sqlcheck::GetFuzzInput(data, size));
+  return 0;
+}
@@ -0,0 +1,25 @@
+// FUZZ DIFFERENTIAL SOURCE
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+#include "differential.h"
+#include "fuzz_target.h"
+
+// Check arbitrary bytes with the regex and the prefilter engines
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size){
+
+  // Rules that are not collected print their findings
+  std::cout.setstate(std::ios::badbit);
+
+  sqlcheck::Configuration options;
+  options.pattern_engine = sqlcheck::PATTERN_ENGINE_PREFILTER;
+
+  auto difference = sqlcheck::CompareEngines(options, sqlcheck::GetFuzzInput(data, size));
+  if(difference.empty() == false){
+    fprintf(stderr, "ENGINES DISAGREE :: %s\n", difference.c_str());
+    abort();
+  }
+  return 0;
+}
@@ -0,0 +1,81 @@
+// FUZZ DRIVER SOURCE
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include "file_walker.h"
+#include "fuzz_target.h"
+#include "run_stats.h"
+
+// Replays inputs through a harness when libFuzzer is not available (e.g.
+// with gcc), so the corpus still runs as a regression test. Takes files and
+// directories, and the libFuzzer flags that matter for a replay: -timeout
+// (seconds per input) and -rss_limit_mb. Other flags are ignored.
+int main(int argc, char **argv) {
+
+  double timeout_seconds = 10;
+  std::uint64_t rss_limit_mb = 2048;
+  std::vector<std::string> files;
+
+  for(int i = 1; i < argc; i++){
+    std::string argument = argv[i];
+    if(argument.empty() == false && argument[0] == '-'){
+      auto separator = argument.find('=');
+      auto name = argument.substr(1, separator - 1);
+      auto value = (separator == std::string::npos) ? "" : argument.substr(separator + 1);
+      if(name == "timeout"){
+        timeout_seconds = std::strtod(value.c_str(), nullptr);
+      }
+      else if(name == "rss_limit_mb"){
+        rss_limit_mb = std::strtoull(value.c_str(), nullptr, 10);
+      }
+      continue;
+    }
+
+    struct stat info;
+    if(stat(argument.c_str(), &info) == 0 && S_ISDIR(info.st_mode)){
+      sqlcheck::WalkDirectory(argument, [&files](const std::string& path){
+        files.push_back(path);
+      });
+    }
+    else {
+      files.push_back(argument);
+    }
+  }
+
+  std::size_t failures = 0;
+  for(auto& file : files){
+    std::string contents;
+    if(sqlcheck::ReadFile(file, contents) == false){
+      printf("CANNOT READ :: %s\n", file.c_str());
+      failures++;
+      continue;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    LLVMFuzzerTestOneInput(reinterpret_cast<const std::uint8_t*>(contents.data()),
+                           contents.size());
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    if(timeout_seconds > 0 && elapsed.count() > timeout_seconds){
+      printf("TIMEOUT :: %s (%.2f s)\n", file.c_str(), elapsed.count());
+      failures++;
+    }
+
+    // Memory is not given back reliably, so stop at the first blowup
+    auto rss_mb = sqlcheck::GetPeakRss() / (1024 * 1024);
+    if(rss_limit_mb > 0 && rss_mb > rss_limit_mb){
+      printf("OUT OF MEMORY :: %s (%llu MB)\n", file.c_str(),
+             static_cast<unsigned long long>(rss_mb));
+      return (EXIT_FAILURE);
+    }
+  }
+
+  printf("Replayed %zu inputs, %zu failed\n", files.size(), failures);
+  return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
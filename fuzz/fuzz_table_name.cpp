@@ -0,0 +1,16 @@
+// FUZZ TABLE NAME SOURCE
+
+#include "fuzz_target.h"
+#include "list.h"
+
+// Add a statement to the schema catalog and look up the created table
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size){
+
+  auto statement = sqlcheck::GetFuzzInput(data, size);
+
+  sqlcheck::Configuration state;
+  state.catalog.AddStatement(statement);
+  sqlcheck::GetTableName(state, statement);
+
+  return 0;
+}
@@ -0,0 +1,18 @@
+// FUZZ TARGET HEADER
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// libFuzzer entry point (implemented by every harness)
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size);
+
+namespace sqlcheck {
+
+inline std::string GetFuzzInput(const std::uint8_t* data, const std::size_t size){
+  return std::string(reinterpret_cast<const char*>(data), size);
+}
+
+}  // namespace sqlcheck
@@ -0,0 +1,24 @@
+// FUZZ WRAP TEXT SOURCE
+
+#include <cstdlib>
+#include <sstream>
+
+#include "checker.h"
+#include "fuzz_target.h"
+
+// Wrap arbitrary text and check the line lengths
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size){
+
+  auto wrapped = sqlcheck::WrapText(sqlcheck::GetFuzzInput(data, size));
+
+  // Only a single word longer than a line may overflow it
+  std::istringstream lines(wrapped);
+  std::string line;
+  while(std::getline(lines, line)){
+    if(line.length() > 80 && line.find(' ') != std::string::npos){
+      abort();
+    }
+  }
+
+  return 0;
+}
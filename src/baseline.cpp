@@ -0,0 +1,157 @@
+// BASELINE SOURCE
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "include/baseline.h"
+
+namespace sqlcheck {
+
+static_assert(sizeof(BaselineEntry) == 16, "baseline entries are mapped in place");
+
+const char baseline_magic[] = "SQLCHKB1";
+
+// Magic and entry count
+const std::size_t kBaselineHeaderSize = 16;
+
+Baseline::Baseline(const bool record)
+ : record_(record),
+   mapping_(nullptr),
+   mapping_size_(0),
+   entries_(nullptr),
+   entry_count_(0),
+   known_count_(0) {
+}
+
+Baseline::~Baseline(){
+  Unmap();
+}
+
+void Baseline::Unmap(){
+  if(mapping_ != nullptr){
+    munmap(mapping_, mapping_size_);
+  }
+  mapping_ = nullptr;
+  mapping_size_ = 0;
+  entries_ = nullptr;
+  entry_count_ = 0;
+  matched_.clear();
+}
+
+bool Baseline::Load(const std::string& file_name){
+
+  auto fd = open(file_name.c_str(), O_RDONLY | O_CLOEXEC);
+  if(fd < 0){
+    return false;
+  }
+  struct stat file_stat;
+  if(fstat(fd, &file_stat) != 0 ||
+     static_cast<std::size_t>(file_stat.st_size) < kBaselineHeaderSize){
+    close(fd);
+    return false;
+  }
+
+  std::size_t size = file_stat.st_size;
+  auto mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if(mapping == MAP_FAILED){
+    return false;
+  }
+
+  // Reject other files and truncated baselines
+  auto data = static_cast<const char*>(mapping);
+  std::uint64_t entry_count;
+  std::memcpy(&entry_count, data + 8, sizeof(entry_count));
+  if(std::memcmp(data, baseline_magic, 8) != 0 ||
+     (size - kBaselineHeaderSize) / sizeof(BaselineEntry) != entry_count ||
+     (size - kBaselineHeaderSize) % sizeof(BaselineEntry) != 0){
+    munmap(mapping, size);
+    return false;
+  }
+
+  // Binary search touches a few pages per lookup
+  madvise(mapping, size, MADV_RANDOM);
+
+  Unmap();
+  mapping_ = mapping;
+  mapping_size_ = size;
+  entries_ = reinterpret_cast<const BaselineEntry*>(data + kBaselineHeaderSize);
+  entry_count_ = entry_count;
+  known_count_ = 0;
+  return true;
+}
+
+bool Baseline::Match(const std::string& rule_id, const std::uint64_t statement_hash){
+
+  BaselineEntry entry;
+  entry.rule = std::strtoul(rule_id.c_str(), nullptr, 10);
+  entry.reserved = 0;
+  entry.statement_hash = statement_hash;
+
+  if(record_ == true){
+    recorded_.push_back(entry);
+  }
+
+  auto end = entries_ + entry_count_;
+  auto found = std::lower_bound(entries_, end, entry);
+  if(found == end || (*found == entry) == false){
+    return false;
+  }
+
+  if(matched_.empty()){
+    matched_.resize(entry_count_, false);
+  }
+  matched_[found - entries_] = true;
+  known_count_++;
+  return true;
+}
+
+bool Baseline::Save(const std::string& file_name){
+
+  std::sort(recorded_.begin(), recorded_.end());
+  recorded_.erase(std::unique(recorded_.begin(), recorded_.end()), recorded_.end());
+
+  std::ofstream file(file_name.c_str(), std::ios::binary | std::ios::trunc);
+  std::uint64_t entry_count = recorded_.size();
+  file.write(baseline_magic, 8);
+  file.write(reinterpret_cast<const char*>(&entry_count), sizeof(entry_count));
+  file.write(reinterpret_cast<const char*>(recorded_.data()),
+             recorded_.size() * sizeof(BaselineEntry));
+  return file.good();
+}
+
+std::map<std::uint32_t, std::size_t> Baseline::GetFixedCounts() const {
+
+  std::map<std::uint32_t, std::size_t> fixed_counts;
+  for(std::size_t pos = 0; pos < entry_count_; pos++){
+    if(matched_.empty() || matched_[pos] == false){
+      fixed_counts[entries_[pos].rule]++;
+    }
+  }
+  return fixed_counts;
+}
+
+void PrintBaseline(const Baseline& baseline, std::ostream& output){
+
+  auto fixed_counts = baseline.GetFixedCounts();
+  std::size_t fixed_count = 0;
+  for(auto& entry : fixed_counts){
+    fixed_count += entry.second;
+  }
+
+  output << "\n==================== Baseline ==================\n";
+  output << "Known (suppressed)           :: " << baseline.GetKnownCount() << "\n";
+  output << "Fixed                        :: " << fixed_count << "\n";
+  for(auto& entry : fixed_counts){
+    output << ">  " << entry.first << "        :: " << entry.second << "\n";
+  }
+}
+
+}  // namespace sqlcheck
@@ -0,0 +1,992 @@
+// CATALOG SOURCE
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include "include/catalog.h"
+
+namespace sqlcheck {
+
+// STRING POOL
+
+Symbol StringPool::Intern(const std::string& text){
+
+  auto entry = symbols_.find(text);
+  if(entry != symbols_.end()){
+    return entry->second;
+  }
+
+  Symbol symbol = strings_.size();
+  strings_.push_back(text);
+  symbols_.emplace(text, symbol);
+  return symbol;
+}
+
+bool StringPool::Find(const std::string& text, Symbol& symbol) const {
+
+  auto entry = symbols_.find(text);
+  if(entry == symbols_.end()){
+    return false;
+  }
+
+  symbol = entry->second;
+  return true;
+}
+
+void StringPool::Clear(){
+  strings_.clear();
+  symbols_.clear();
+}
+
+// UTILITY
+
+std::string ToLower(std::string text){
+  for(auto& c : text){
+    c = std::tolower(static_cast<unsigned char>(c));
+  }
+  return text;
+}
+
+// Get the first keyword of a statement without tokenizing it
+std::string GetFirstKeyword(const std::string& sql_statement){
+
+  std::size_t pos = 0;
+  std::size_t length = sql_statement.length();
+  while(pos < length){
+    char c = sql_statement[pos];
+    if(std::isspace(static_cast<unsigned char>(c))){
+      pos++;
+    }
+    else if(c == '-' && pos + 1 < length && sql_statement[pos + 1] == '-'){
+      pos = sql_statement.find('\n', pos);
+      pos = (pos == std::string::npos) ? length : pos;
+    }
+    else if(c == '/' && pos + 1 < length && sql_statement[pos + 1] == '*'){
+      pos = sql_statement.find("*/", pos + 2);
+      pos = (pos == std::string::npos) ? length : pos + 2;
+    }
+    else {
+      break;
+    }
+  }
+
+  std::string keyword;
+  while(pos < length && keyword.length() < 8 &&
+      std::isalpha(static_cast<unsigned char>(sql_statement[pos]))){
+    keyword += std::tolower(static_cast<unsigned char>(sql_statement[pos]));
+    pos++;
+  }
+
+  return keyword;
+}
+
+// Check if the token at pos is one of the words
+bool IsOneOf(const std::vector<Token>& tokens,
+             const std::size_t pos,
+             std::initializer_list<const char*> words){
+
+  if(pos >= tokens.size()){
+    return false;
+  }
+  for(auto word : words){
+    if(tokens[pos].Is(word)){
+      return true;
+    }
+  }
+  return false;
+}
+
+// Skip an optional "if [not] exists" clause
+void SkipIfExists(const std::vector<Token>& tokens, std::size_t& pos){
+  if(IsOneOf(tokens, pos, {"if"})){
+    pos++;
+    if(IsOneOf(tokens, pos, {"not"})){
+      pos++;
+    }
+    if(IsOneOf(tokens, pos, {"exists"})){
+      pos++;
+    }
+  }
+}
+
+// Split the tokens between begin and end on top-level commas
+std::vector<std::pair<std::size_t, std::size_t>>
+SplitOnCommas(const std::vector<Token>& tokens,
+              std::size_t begin,
+              std::size_t end){
+
+  std::vector<std::pair<std::size_t, std::size_t>> items;
+  std::size_t depth = 0;
+  std::size_t item_begin = begin;
+  for(auto pos = begin; pos < end; pos++){
+    if(tokens[pos].Is("(")){
+      depth++;
+    }
+    else if(tokens[pos].Is(")") && depth > 0){
+      depth--;
+    }
+    else if(tokens[pos].Is(",") && depth == 0){
+      items.emplace_back(item_begin, pos);
+      item_begin = pos + 1;
+    }
+  }
+  if(item_begin < end){
+    items.emplace_back(item_begin, end);
+  }
+
+  return items;
+}
+
+// CATALOG
+
+Catalog::Catalog()
+ : current_table_(-1) {
+  empty_ = strings_.Intern("");
+}
+
+void Catalog::Clear(){
+  strings_.Clear();
+  tables_.clear();
+  table_ids_.clear();
+  index_tables_.clear();
+  current_table_ = -1;
+  empty_ = strings_.Intern("");
+}
+
+const Table* Catalog::FindTable(const Symbol name) const {
+
+  auto entry = table_ids_.find(name);
+  if(entry == table_ids_.end()){
+    return nullptr;
+  }
+
+  return &tables_[entry->second];
+}
+
+const Table* Catalog::FindTable(const std::string& name) const {
+
+  Symbol symbol;
+  if(strings_.Find(ToLower(name), symbol) == false){
+    return nullptr;
+  }
+
+  return FindTable(symbol);
+}
+
+const Column* Catalog::FindColumn(const Table& table,
+                                  const std::string& name) const {
+
+  Symbol symbol;
+  if(strings_.Find(ToLower(name), symbol) == false){
+    return nullptr;
+  }
+
+  auto entry = table.column_ids.find(symbol);
+  if(entry == table.column_ids.end()){
+    return nullptr;
+  }
+
+  return &table.columns[entry->second];
+}
+
+const Table* Catalog::GetCurrentTable() const {
+  if(current_table_ < 0){
+    return nullptr;
+  }
+  return &tables_[current_table_];
+}
+
+Table& Catalog::GetTable(const Symbol name){
+
+  auto entry = table_ids_.find(name);
+  if(entry != table_ids_.end()){
+    current_table_ = entry->second;
+    return tables_[entry->second];
+  }
+
+  current_table_ = tables_.size();
+  table_ids_.emplace(name, tables_.size());
+  tables_.push_back(Table());
+  tables_.back().name = name;
+  return tables_.back();
+}
+
+void Catalog::DropTable(const Symbol name){
+
+  auto entry = table_ids_.find(name);
+  if(entry == table_ids_.end()){
+    return;
+  }
+
+  auto id = entry->second;
+  for(auto& index : tables_[id].indexes){
+    index_tables_.erase(index.name);
+  }
+
+  tables_.erase(tables_.begin() + id);
+  table_ids_.erase(entry);
+  for(auto pos = id; pos < tables_.size(); pos++){
+    table_ids_[tables_[pos].name] = pos;
+  }
+  current_table_ = -1;
+}
+
+void Catalog::UpdateColumnIds(Table& table){
+  table.column_ids.clear();
+  for(std::uint32_t pos = 0; pos < table.columns.size(); pos++){
+    table.column_ids[table.columns[pos].name] = pos;
+  }
+}
+
+bool Catalog::AddStatement(const std::string& sql_statement){
+
+  current_table_ = -1;
+
+  // Most statements are not DDL
+  auto keyword = GetFirstKeyword(sql_statement);
+  if(keyword != "create" && keyword != "alter" && keyword != "drop"){
+    return false;
+  }
+
+  std::vector<Token> tokens;
+  Tokenize(sql_statement, tokens);
+
+  std::size_t pos = 1;
+  if(keyword == "create"){
+    bool unique = false;
+    while(IsOneOf(tokens, pos, {"or", "replace", "temporary", "temp", "global",
+                                "local", "unlogged", "virtual", "external",
+                                "unique", "clustered", "nonclustered",
+                                "fulltext", "spatial", "bitmap"})){
+      unique = unique || tokens[pos].Is("unique");
+      pos++;
+    }
+    if(IsOneOf(tokens, pos, {"table"})){
+      ParseCreateTable(tokens, pos + 1);
+      return true;
+    }
+    if(IsOneOf(tokens, pos, {"index"})){
+      ParseCreateIndex(tokens, pos + 1, unique);
+      return true;
+    }
+    return false;
+  }
+
+  if(keyword == "alter"){
+    if(IsOneOf(tokens, pos, {"table"})){
+      ParseAlterTable(tokens, pos + 1);
+      return true;
+    }
+    return false;
+  }
+
+  ParseDrop(tokens, pos);
+  return true;
+}
+
+bool Catalog::ParseName(const std::vector<Token>& tokens,
+                        std::size_t& pos,
+                        Symbol& name){
+
+  if(pos >= tokens.size() || tokens[pos].IsName() == false){
+    return false;
+  }
+
+  // Drop schema qualifiers
+  std::size_t last = pos;
+  pos++;
+  while(pos + 1 < tokens.size() && tokens[pos].Is(".") &&
+      tokens[pos + 1].IsName()){
+    last = pos + 1;
+    pos += 2;
+  }
+
+  name = strings_.Intern(ToLower(tokens[last].text));
+  return true;
+}
+
+bool Catalog::ParseColumnList(const std::vector<Token>& tokens,
+                              std::size_t& pos,
+                              std::vector<Symbol>& columns){
+
+  if(IsOneOf(tokens, pos, {"("}) == false){
+    return false;
+  }
+
+  auto close = FindClosingParenthesis(tokens, pos);
+  for(auto& item : SplitOnCommas(tokens, pos + 1, close)){
+    // Column, column with a prefix length, or an expression over a column
+    for(auto item_pos = item.first; item_pos < item.second; item_pos++){
+      auto& token = tokens[item_pos];
+      bool call = (item_pos + 1 < item.second) && tokens[item_pos + 1].Is("(");
+      bool prefix = call && item_pos + 2 < item.second &&
+          tokens[item_pos + 2].type == TOKEN_TYPE_NUMBER;
+      if(token.IsName() && (call == false || prefix == true)){
+        columns.push_back(strings_.Intern(ToLower(token.text)));
+        break;
+      }
+    }
+  }
+
+  pos = (close < tokens.size()) ? close + 1 : close;
+  return true;
+}
+
+void Catalog::ParseColumn(const std::vector<Token>& tokens,
+                          std::size_t pos,
+                          std::size_t end,
+                          Table& table){
+
+  if(pos >= end || tokens[pos].IsName() == false){
+    return;
+  }
+
+  Column column;
+  column.name = strings_.Intern(ToLower(tokens[pos].text));
+  column.not_null = false;
+  column.primary_key = false;
+  pos++;
+
+  // Type
+  std::string type;
+  while(pos < end && tokens[pos].type == TOKEN_TYPE_WORD &&
+      IsOneOf(tokens, pos, {"constraint", "primary", "not", "null", "unique",
+                            "references", "default", "check", "collate",
+                            "auto_increment", "autoincrement", "identity",
+                            "generated", "comment", "key", "on", "as"}) == false){
+    if(type.empty() == false){
+      type += " ";
+    }
+    type += tokens[pos].text;
+    pos++;
+
+    // Type arguments
+    if(IsOneOf(tokens, pos, {"("})){
+      auto close = std::min(FindClosingParenthesis(tokens, pos), end);
+      for(; pos < close; pos++){
+        type += (tokens[pos].type == TOKEN_TYPE_STRING) ?
+            "'" + tokens[pos].text + "'" : tokens[pos].text;
+      }
+      type += ")";
+      pos = close + 1;
+    }
+  }
+  column.type = strings_.Intern(type);
+
+  // Constraints
+  while(pos < end){
+    if(IsOneOf(tokens, pos, {"primary"}) && IsOneOf(tokens, pos + 1, {"key"})){
+      column.primary_key = true;
+      column.not_null = true;
+      table.primary_key.assign(1, column.name);
+      table.indexes.push_back({empty_, {column.name}, true, true});
+      pos += 2;
+    }
+    else if(IsOneOf(tokens, pos, {"not"}) && IsOneOf(tokens, pos + 1, {"null"})){
+      column.not_null = true;
+      pos += 2;
+    }
+    else if(IsOneOf(tokens, pos, {"unique"})){
+      table.indexes.push_back({empty_, {column.name}, true, false});
+      pos++;
+    }
+    else if(IsOneOf(tokens, pos, {"references"})){
+      pos++;
+      ForeignKey foreign_key;
+      foreign_key.columns.push_back(column.name);
+      if(ParseName(tokens, pos, foreign_key.referenced_table)){
+        ParseColumnList(tokens, pos, foreign_key.referenced_columns);
+        table.foreign_keys.push_back(foreign_key);
+      }
+    }
+    else if(IsOneOf(tokens, pos, {"("})){
+      pos = FindClosingParenthesis(tokens, pos) + 1;
+    }
+    else {
+      pos++;
+    }
+  }
+
+  // Replace a column with the same name
+  auto entry = table.column_ids.find(column.name);
+  if(entry != table.column_ids.end()){
+    table.columns[entry->second] = column;
+    return;
+  }
+
+  table.column_ids.emplace(column.name, table.columns.size());
+  table.columns.push_back(column);
+}
+
+void Catalog::ParseTableElement(const std::vector<Token>& tokens,
+                                std::size_t pos,
+                                std::size_t end,
+                                Table& table){
+
+  if(IsOneOf(tokens, pos, {"constraint"})){
+    pos += 2;
+  }
+  if(pos >= end){
+    return;
+  }
+
+  // PRIMARY KEY (a, b)
+  if(tokens[pos].Is("primary") && IsOneOf(tokens, pos + 1, {"key"})){
+    pos += 2;
+    while(pos < end && IsOneOf(tokens, pos, {"("}) == false){
+      pos++;
+    }
+    std::vector<Symbol> columns;
+    if(ParseColumnList(tokens, pos, columns)){
+      table.primary_key = columns;
+      table.indexes.push_back({empty_, columns, true, true});
+    }
+    return;
+  }
+
+  // FOREIGN KEY (a) REFERENCES t (b)
+  if(tokens[pos].Is("foreign") && IsOneOf(tokens, pos + 1, {"key"})){
+    pos += 2;
+    while(pos < end && IsOneOf(tokens, pos, {"("}) == false){
+      pos++;
+    }
+    ForeignKey foreign_key;
+    ParseColumnList(tokens, pos, foreign_key.columns);
+    if(IsOneOf(tokens, pos, {"references"})){
+      pos++;
+      if(ParseName(tokens, pos, foreign_key.referenced_table)){
+        ParseColumnList(tokens, pos, foreign_key.referenced_columns);
+        table.foreign_keys.push_back(foreign_key);
+      }
+    }
+    return;
+  }
+
+  // UNIQUE [KEY] [name] (a, b) and KEY|INDEX [name] (a, b)
+  bool unique = tokens[pos].Is("unique");
+  bool index = IsOneOf(tokens, pos, {"key", "index", "fulltext", "spatial"});
+  if(unique == true || index == true){
+    auto lookahead = pos + 1;
+    if(IsOneOf(tokens, lookahead, {"key", "index"})){
+      lookahead++;
+    }
+    Symbol name = empty_;
+    if(lookahead < end && tokens[lookahead].IsName() &&
+        IsOneOf(tokens, lookahead + 1, {"("})){
+      ParseName(tokens, lookahead, name);
+    }
+    std::vector<Symbol> columns;
+    if(ParseColumnList(tokens, lookahead, columns) && columns.empty() == false){
+      table.indexes.push_back({name, columns, unique, false});
+      if(name != empty_){
+        index_tables_[name] = table.name;
+      }
+      return;
+    }
+    // a column named "key" or "index"
+  }
+
+  if(IsOneOf(tokens, pos, {"check", "exclude", "like", "period"})){
+    return;
+  }
+
+  ParseColumn(tokens, pos, end, table);
+}
+
+void Catalog::ParseCreateTable(const std::vector<Token>& tokens,
+                               std::size_t pos){
+
+  SkipIfExists(tokens, pos);
+
+  Symbol name;
+  if(ParseName(tokens, pos, name) == false){
+    return;
+  }
+
+  // Replace an existing definition
+  Table& table = GetTable(name);
+  for(auto& index : table.indexes){
+    index_tables_.erase(index.name);
+  }
+  table = Table();
+  table.name = name;
+
+  if(IsOneOf(tokens, pos, {"("}) == false){
+    return;
+  }
+
+  auto close = FindClosingParenthesis(tokens, pos);
+  for(auto& element : SplitOnCommas(tokens, pos + 1, close)){
+    ParseTableElement(tokens, element.first, element.second, table);
+  }
+}
+
+void Catalog::ParseCreateIndex(const std::vector<Token>& tokens,
+                               std::size_t pos,
+                               bool unique){
+
+  if(IsOneOf(tokens, pos, {"concurrently"})){
+    pos++;
+  }
+  SkipIfExists(tokens, pos);
+
+  Symbol name = empty_;
+  if(IsOneOf(tokens, pos, {"on"}) == false){
+    ParseName(tokens, pos, name);
+  }
+  if(IsOneOf(tokens, pos, {"on"}) == false){
+    return;
+  }
+  pos++;
+  if(IsOneOf(tokens, pos, {"only"})){
+    pos++;
+  }
+
+  Symbol table_name;
+  if(ParseName(tokens, pos, table_name) == false){
+    return;
+  }
+  if(IsOneOf(tokens, pos, {"using"})){
+    pos += 2;
+  }
+
+  std::vector<Symbol> columns;
+  if(ParseColumnList(tokens, pos, columns) == false){
+    return;
+  }
+
+  Table& table = GetTable(table_name);
+  table.indexes.push_back({name, columns, unique, false});
+  if(name != empty_){
+    index_tables_[name] = table_name;
+  }
+}
+
+void Catalog::ParseAlterTable(const std::vector<Token>& tokens,
+                              std::size_t pos){
+
+  SkipIfExists(tokens, pos);
+  if(IsOneOf(tokens, pos, {"only"})){
+    pos++;
+  }
+
+  Symbol name;
+  if(ParseName(tokens, pos, name) == false){
+    return;
+  }
+  auto table_id = GetTable(name).name;
+
+  for(auto& action : SplitOnCommas(tokens, pos, tokens.size())){
+    auto action_pos = action.first;
+    auto end = action.second;
+    Table& table = tables_[table_ids_[table_id]];
+
+    // ADD [COLUMN] column or constraint
+    if(IsOneOf(tokens, action_pos, {"add"})){
+      action_pos++;
+      if(IsOneOf(tokens, action_pos, {"column"})){
+        action_pos++;
+      }
+      SkipIfExists(tokens, action_pos);
+      ParseTableElement(tokens, action_pos, end, table);
+    }
+    // MODIFY [COLUMN] column
+    else if(IsOneOf(tokens, action_pos, {"modify"})){
+      action_pos++;
+      if(IsOneOf(tokens, action_pos, {"column"})){
+        action_pos++;
+      }
+      ParseColumn(tokens, action_pos, end, table);
+    }
+    // DROP [COLUMN] column, DROP INDEX name and DROP PRIMARY KEY
+    else if(IsOneOf(tokens, action_pos, {"drop"})){
+      action_pos++;
+      if(IsOneOf(tokens, action_pos, {"primary"})){
+        table.primary_key.clear();
+        table.indexes.erase(
+            std::remove_if(table.indexes.begin(), table.indexes.end(),
+                           [](const Index& index){ return index.primary; }),
+            table.indexes.end());
+        continue;
+      }
+      bool index = IsOneOf(tokens, action_pos, {"index", "key"});
+      if(index == true ||
+          IsOneOf(tokens, action_pos, {"constraint", "foreign"})){
+        action_pos++;
+        SkipIfExists(tokens, action_pos);
+        Symbol index_name;
+        if(ParseName(tokens, action_pos, index_name) && index_name != empty_){
+          table.indexes.erase(
+              std::remove_if(table.indexes.begin(), table.indexes.end(),
+                             [index_name](const Index& entry){
+                               return entry.name == index_name;
+                             }),
+              table.indexes.end());
+          index_tables_.erase(index_name);
+        }
+        continue;
+      }
+      if(IsOneOf(tokens, action_pos, {"column"})){
+        action_pos++;
+      }
+      SkipIfExists(tokens, action_pos);
+      Symbol column_name;
+      if(ParseName(tokens, action_pos, column_name)){
+        table.columns.erase(
+            std::remove_if(table.columns.begin(), table.columns.end(),
+                           [column_name](const Column& column){
+                             return column.name == column_name;
+                           }),
+            table.columns.end());
+        UpdateColumnIds(table);
+      }
+    }
+    // RENAME TO table and RENAME [COLUMN] a TO b
+    else if(IsOneOf(tokens, action_pos, {"rename"})){
+      action_pos++;
+      if(IsOneOf(tokens, action_pos, {"to", "as"})){
+        action_pos++;
+        Symbol new_name;
+        if(ParseName(tokens, action_pos, new_name) &&
+            table_ids_.count(new_name) == 0){
+          auto id = table_ids_[table_id];
+          table_ids_.erase(table_id);
+          table_ids_[new_name] = id;
+          for(auto& entry : index_tables_){
+            if(entry.second == table_id){
+              entry.second = new_name;
+            }
+          }
+          table.name = new_name;
+          table_id = new_name;
+        }
+        continue;
+      }
+      if(IsOneOf(tokens, action_pos, {"column"})){
+        action_pos++;
+      }
+      Symbol old_name, new_name;
+      if(ParseName(tokens, action_pos, old_name) &&
+          IsOneOf(tokens, action_pos, {"to"})){
+        action_pos++;
+        auto entry = table.column_ids.find(old_name);
+        if(entry != table.column_ids.end() &&
+            ParseName(tokens, action_pos, new_name)){
+          table.columns[entry->second].name = new_name;
+          UpdateColumnIds(table);
+        }
+      }
+    }
+  }
+}
+
+void Catalog::ParseDrop(const std::vector<Token>& tokens,
+                        std::size_t pos){
+
+  // DROP TABLE a, b
+  if(IsOneOf(tokens, pos, {"table"})){
+    pos++;
+    SkipIfExists(tokens, pos);
+    Symbol name;
+    while(ParseName(tokens, pos, name)){
+      DropTable(name);
+      if(IsOneOf(tokens, pos, {","}) == false){
+        break;
+      }
+      pos++;
+    }
+    return;
+  }
+
+  // DROP INDEX name
+  if(IsOneOf(tokens, pos, {"index"})){
+    pos++;
+    if(IsOneOf(tokens, pos, {"concurrently"})){
+      pos++;
+    }
+    SkipIfExists(tokens, pos);
+    Symbol name;
+    if(ParseName(tokens, pos, name) == false){
+      return;
+    }
+    auto entry = index_tables_.find(name);
+    if(entry == index_tables_.end()){
+      return;
+    }
+    auto table = table_ids_.find(entry->second);
+    if(table != table_ids_.end()){
+      auto& indexes = tables_[table->second].indexes;
+      indexes.erase(std::remove_if(indexes.begin(), indexes.end(),
+                                   [name](const Index& index){
+                                     return index.name == name;
+                                   }),
+                    indexes.end());
+    }
+    index_tables_.erase(entry);
+  }
+}
+
+// SNAPSHOT
+//
+// Little-endian binary format:
+//   magic "SQLCHKC1"
+//   u32 string count, then (u32 length, bytes) per string
+//   u32 table count, then per table:
+//     u32 name
+//     u32 column count, then (u32 name, u32 type, u8 flags) per column
+//     symbol list of the primary key
+//     u32 foreign key count, then (symbols, u32 table, symbols) per key
+//     u32 index count, then (u32 name, u8 flags, symbols) per index
+//   where a symbol list is a u32 count followed by u32 symbols.
+
+const char snapshot_magic[] = "SQLCHKC1";
+
+class SnapshotWriter {
+
+ public:
+
+  void Write8(const std::uint8_t value){
+    data_ += static_cast<char>(value);
+  }
+
+  void Write32(const std::uint32_t value){
+    for(int shift = 0; shift < 32; shift += 8){
+      data_ += static_cast<char>((value >> shift) & 0xff);
+    }
+  }
+
+  void WriteSymbols(const std::vector<Symbol>& symbols){
+    Write32(symbols.size());
+    for(auto symbol : symbols){
+      Write32(symbol);
+    }
+  }
+
+  void WriteBytes(const std::string& bytes){
+    data_ += bytes;
+  }
+
+  const std::string& GetData() const {
+    return data_;
+  }
+
+ private:
+
+  std::string data_;
+
+};
+
+class SnapshotReader {
+
+ public:
+
+  SnapshotReader(const std::string& data, const std::uint32_t string_count = 0)
+   : data_(data),
+     pos_(0),
+     string_count_(string_count),
+     valid_(true) {
+  }
+
+  std::uint8_t Read8(){
+    if(pos_ + 1 > data_.size()){
+      valid_ = false;
+      return 0;
+    }
+    return static_cast<std::uint8_t>(data_[pos_++]);
+  }
+
+  std::uint32_t Read32(){
+    if(pos_ + 4 > data_.size()){
+      valid_ = false;
+      return 0;
+    }
+    std::uint32_t value = 0;
+    for(int shift = 0; shift < 32; shift += 8){
+      value |= static_cast<std::uint32_t>(
+          static_cast<unsigned char>(data_[pos_++])) << shift;
+    }
+    return value;
+  }
+
+  // Read a count of entries that are at least min_size bytes each
+  std::uint32_t ReadCount(const std::size_t min_size){
+    auto count = Read32();
+    if(count > (data_.size() - pos_) / min_size){
+      valid_ = false;
+      return 0;
+    }
+    return count;
+  }
+
+  Symbol ReadSymbol(){
+    auto symbol = Read32();
+    if(symbol >= string_count_){
+      valid_ = false;
+      return 0;
+    }
+    return symbol;
+  }
+
+  void ReadSymbols(std::vector<Symbol>& symbols){
+    auto count = ReadCount(4);
+    symbols.resize(count);
+    for(auto& symbol : symbols){
+      symbol = ReadSymbol();
+    }
+  }
+
+  std::string ReadBytes(const std::size_t length){
+    if(pos_ + length > data_.size()){
+      valid_ = false;
+      return "";
+    }
+    auto bytes = data_.substr(pos_, length);
+    pos_ += length;
+    return bytes;
+  }
+
+  void SetStringCount(const std::uint32_t string_count){
+    string_count_ = string_count;
+  }
+
+  bool IsValid() const {
+    return valid_;
+  }
+
+  bool IsDone() const {
+    return pos_ == data_.size();
+  }
+
+ private:
+
+  const std::string& data_;
+
+  std::size_t pos_;
+
+  std::uint32_t string_count_;
+
+  bool valid_;
+
+};
+
+bool Catalog::Save(const std::string& file_name) const {
+
+  SnapshotWriter writer;
+  writer.WriteBytes(std::string(snapshot_magic, 8));
+
+  writer.Write32(strings_.GetSize());
+  for(Symbol symbol = 0; symbol < strings_.GetSize(); symbol++){
+    auto& text = strings_.Get(symbol);
+    writer.Write32(text.length());
+    writer.WriteBytes(text);
+  }
+
+  writer.Write32(tables_.size());
+  for(auto& table : tables_){
+    writer.Write32(table.name);
+    writer.Write32(table.columns.size());
+    for(auto& column : table.columns){
+      writer.Write32(column.name);
+      writer.Write32(column.type);
+      writer.Write8((column.not_null ? 1 : 0) | (column.primary_key ? 2 : 0));
+    }
+    writer.WriteSymbols(table.primary_key);
+    writer.Write32(table.foreign_keys.size());
+    for(auto& foreign_key : table.foreign_keys){
+      writer.WriteSymbols(foreign_key.columns);
+      writer.Write32(foreign_key.referenced_table);
+      writer.WriteSymbols(foreign_key.referenced_columns);
+    }
+    writer.Write32(table.indexes.size());
+    for(auto& index : table.indexes){
+      writer.Write32(index.name);
+      writer.Write8((index.unique ? 1 : 0) | (index.primary ? 2 : 0));
+      writer.WriteSymbols(index.columns);
+    }
+  }
+
+  std::ofstream file(file_name.c_str(), std::ios::binary | std::ios::trunc);
+  file.write(writer.GetData().data(), writer.GetData().size());
+  file.close();
+  return file.good();
+}
+
+bool Catalog::Load(const std::string& file_name){
+
+  std::ifstream file(file_name.c_str(), std::ios::binary);
+  if(file.good() == false){
+    return false;
+  }
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  auto data = buffer.str();
+
+  if(data.compare(0, 8, snapshot_magic, 8) != 0){
+    return false;
+  }
+  data.erase(0, 8);
+
+  // Build a new catalog so that a bad snapshot leaves this one unchanged
+  Catalog catalog;
+  catalog.strings_.Clear();
+  SnapshotReader reader(data);
+
+  auto string_count = reader.ReadCount(4);
+  for(std::uint32_t pos = 0; pos < string_count && reader.IsValid(); pos++){
+    auto length = reader.Read32();
+    catalog.strings_.Intern(reader.ReadBytes(length));
+  }
+  if(catalog.strings_.GetSize() != string_count ||
+      catalog.strings_.Find("", catalog.empty_) == false){
+    return false;
+  }
+  reader.SetStringCount(string_count);
+
+  auto table_count = reader.ReadCount(4);
+  catalog.tables_.resize(table_count);
+  for(std::uint32_t id = 0; id < table_count && reader.IsValid(); id++){
+    auto& table = catalog.tables_[id];
+    table.name = reader.ReadSymbol();
+    table.columns.resize(reader.ReadCount(9));
+    for(auto& column : table.columns){
+      column.name = reader.ReadSymbol();
+      column.type = reader.ReadSymbol();
+      auto flags = reader.Read8();
+      column.not_null = (flags & 1) != 0;
+      column.primary_key = (flags & 2) != 0;
+    }
+    catalog.UpdateColumnIds(table);
+    reader.ReadSymbols(table.primary_key);
+    table.foreign_keys.resize(reader.ReadCount(12));
+    for(auto& foreign_key : table.foreign_keys){
+      reader.ReadSymbols(foreign_key.columns);
+      foreign_key.referenced_table = reader.ReadSymbol();
+      reader.ReadSymbols(foreign_key.referenced_columns);
+    }
+    table.indexes.resize(reader.ReadCount(9));
+    for(auto& index : table.indexes){
+      index.name = reader.ReadSymbol();
+      auto flags = reader.Read8();
+      index.unique = (flags & 1) != 0;
+      index.primary = (flags & 2) != 0;
+      reader.ReadSymbols(index.columns);
+      if(index.name != catalog.empty_){
+        catalog.index_tables_[index.name] = table.name;
+      }
+    }
+    catalog.table_ids_[table.name] = id;
+  }
+
+  if(reader.IsValid() == false || reader.IsDone() == false ||
+      catalog.table_ids_.size() != table_count){
+    return false;
+  }
+
+  *this = std::move(catalog);
+  return true;
+}
+
+}  // namespace sqlcheck
@@ -11,12 +11,20 @@
 #include <functional>
 #include <regex>
 #include <map>
+#include <algorithm>
+#include <chrono>
 
 #include "include/checker.h"
 
+#include "include/baseline.h"
 #include "include/configuration.h"
+#include "include/fingerprint.h"
+#include "include/index_advisor.h"
 #include "include/list.h"
 #include "include/color.h"
+#include "include/report_writer.h"
+#include "include/sampler.h"
+#include "include/tracer.h"
 
 namespace sqlcheck {
 
@@ -39,28 +47,65 @@ bool Check(Configuration& state) {
 
   std::stringstream sql_statement;
   state.line_number = 1;
+  state.statement_offset = 0;
+  state.statement_id = 0;
+  state.statement_column = 1;
+
+  state.run_stats.Start();
+
+  // Set up sampling front-end
+  Sampler sampler(state);
+
+  // Set up index analysis
+  IndexAdvisor index_advisor;
 
   std::cout << "==================== Results ===================\n";
 
   // Go over the input stream
-  while(!input->eof()){
+  while(input->good()){
 
     // Get a statement from the input stream
     std::string statement_fragment;
-    std::getline(*input, statement_fragment, state.delimiter[0]);
+    {
+      auto counter = state.profile ?
+          &state.profile_stats.stages[PROFILE_STAGE_SPLITTER] : nullptr;
+      ProfileTimer timer(counter);
+      TraceSpan span("read", "io");
+      std::getline(*input, statement_fragment, state.delimiter[0]);
+
+      // Append fragment to statement
+      if(statement_fragment.empty() == false){
+        sql_statement << statement_fragment << " ";
+      }
+      if(counter != nullptr){
+        counter->bytes_scanned += statement_fragment.length() + 1;
+      }
+    }
 
-    // Append fragment to statement
-    if(statement_fragment.empty() == false){
-      sql_statement << statement_fragment << " ";
+    // Record the query for index analysis
+    if(state.index_advice == true){
+      index_advisor.AddQuery(sql_statement.str());
     }
 
     // Check the statement
-    CheckStatement(state, sql_statement.str());
+    {
+      TraceSpan span("statement", "checker");
+      sampler.CheckStatement(state, sql_statement.str());
+    }
+    state.statement_offset += statement_fragment.length() + 1;
+
+    // Column of the next statement (after the delimiter)
+    auto newline = statement_fragment.rfind('\n');
+    state.statement_column = (newline == std::string::npos) ?
+        state.statement_column + statement_fragment.length() + 1 :
+        statement_fragment.length() - newline + 1;
 
     // Reset statement
     sql_statement.str(std::string());
   }
 
+  state.run_stats.Stop();
+
   // Print summary
   if(state.checker_stats[RISK_LEVEL_ALL] == 0){
     std::cout << "No issues found.\n";
@@ -75,8 +120,36 @@ bool Check(Configuration& state) {
     has_issues = true;
   }
 
+  // Print the known and fixed findings
+  if(state.baseline != nullptr && state.baseline_file.empty() == false){
+    PrintBaseline(*state.baseline, std::cout);
+  }
+
+  // Print sampling estimates
+  sampler.PrintSummary(state, std::cout);
+
+  // Print index analysis
+  if(state.index_advice == true){
+    IndexAdvice index_advice;
+    index_advisor.Analyze(state.catalog, index_advice);
+    PrintIndexAdvice(index_advice, std::cout);
+  }
+
+  PrintSkippedChecks(state.run_stats, std::cout);
+
+  // Print the throughput and resource usage
+  if(state.stats == true){
+    PrintRunStats(state.run_stats, std::cout);
+  }
+  PrintSlowestStatements(state.run_stats, std::cout);
+
+  // Print the cost of every rule and stage
+  if(state.profile == true){
+    PrintProfile(state.profile_stats, std::cout);
+  }
+
   // Skip destroying std::cin
-  if (state.file_name.empty()) {
+  if (state.testing_mode == false && state.file_name.empty()) {
     input.release();
   }
 
@@ -84,6 +157,50 @@ bool Check(Configuration& state) {
 
 }
 
+void CheckText(Configuration& state,
+               const std::string& sql_text){
+
+  state.line_number = 1;
+  state.statement_id = 0;
+  state.statement_column = 1;
+  state.findings.clear();
+  state.skipped_checks.clear();
+
+  // Texts are checked independently, so a long-lived state does not keep
+  // the schema of every text it saw
+  if(NeedsCatalog(state) == false){
+    state.catalog.Clear();
+  }
+
+  // Go over the statements in the text
+  std::size_t begin = 0;
+  while(begin <= sql_text.length()){
+
+    auto end = sql_text.find(state.delimiter[0], begin);
+    if(end == std::string::npos){
+      end = sql_text.length();
+    }
+
+    // Check the statement
+    if(end > begin){
+      state.statement_offset = begin;
+      CheckStatement(state, sql_text.substr(begin, end - begin) + " ");
+    }
+
+    // Column of the next statement (after the delimiter)
+    auto line_start = end;
+    while(line_start > begin && sql_text[line_start - 1] != '\n'){
+      line_start--;
+    }
+    state.statement_column = (line_start == begin) ?
+        state.statement_column + (end - begin) + 1 :
+        end - line_start + 2;
+
+    begin = end + 1;
+  }
+
+}
+
 // Wrap the text
 std::string WrapText(const std::string& text){
 
@@ -99,7 +216,8 @@ std::string WrapText(const std::string& text){
 
     wrapped << word;
 
-    size_t space_left = line_length - word.length();
+    // Words longer than a line get a line of their own
+    size_t space_left = (word.length() < line_length) ? line_length - word.length() : 0;
     while (words >> word) {
       if(word == "●"){
         wrapped << "\n\n";
@@ -111,7 +229,7 @@ std::string WrapText(const std::string& text){
 
       if (space_left < word.length() + 1 || newline) {
         wrapped << '\n' << word;
-        space_left = line_length - word.length();
+        space_left = (word.length() < line_length) ? line_length - word.length() : 0;
       }
       else {
         if(newpara == false){
@@ -190,10 +308,112 @@ void PrintMessage(Configuration& state,
 
 }
 
+std::uint32_t GetLineNumber(const Configuration& state,
+                            const std::size_t position){
+
+  auto& newlines = state.statement_newlines;
+  auto newline = std::lower_bound(newlines.begin(), newlines.end(), position);
+  return state.line_number + static_cast<std::uint32_t>(newline - newlines.begin());
+}
+
+void RecordFinding(Configuration& state,
+                   const RiskLevel pattern_risk_level,
+                   const PatternType pattern_type,
+                   const std::string& title,
+                   const std::size_t position,
+                   const std::size_t length,
+                   const std::string& match){
+
+  Finding finding;
+  finding.rule_id = state.rule_id;
+  finding.statement_id = state.statement_id;
+  finding.title = title;
+  finding.risk_level = pattern_risk_level;
+  finding.pattern_type = pattern_type;
+  finding.line_number = state.line_number;
+  finding.column = state.statement_column;
+  finding.match = match;
+
+  // Map the match back to the original text
+  auto& offsets = state.statement_offsets;
+  finding.begin = state.statement_offset;
+  finding.end = state.statement_offset;
+  if (offsets.empty() == false && position < offsets.size()) {
+    auto last = std::min(position + std::max<std::size_t>(length, 1), offsets.size()) - 1;
+    finding.begin += offsets[position];
+    finding.end += offsets[last] + ((length > 0) ? 1 : 0);
+
+    // The line starts after the last newline before the match
+    auto& newlines = state.statement_newlines;
+    auto newline = std::lower_bound(newlines.begin(), newlines.end(), position);
+    auto line_start = (newline == newlines.begin()) ?
+        state.statement_line_start : static_cast<std::int64_t>(offsets[*(newline - 1)]) + 1;
+    finding.line_number = state.line_number + static_cast<std::uint32_t>(newline - newlines.begin());
+    finding.column = static_cast<std::uint32_t>(offsets[position] - line_start + 1);
+  }
+
+  // Stream the finding instead of keeping it
+  if (state.report_writer != nullptr) {
+    state.report_writer->WriteFinding(state.file_name, finding);
+    return;
+  }
+
+  state.findings.push_back(finding);
+
+}
+
+// Report rule checks that ran out of budget
+void ReportSkippedCheck(Configuration& state,
+                        const std::string& rule_ids,
+                        const std::string& reason){
+
+  if (state.collect_findings == true) {
+    SkippedCheck skipped_check;
+    skipped_check.rule_ids = rule_ids;
+    skipped_check.reason = reason;
+    skipped_check.line_number = state.line_number;
+    skipped_check.offset = state.statement_offset;
+    state.skipped_checks.push_back(skipped_check);
+    return;
+  }
+
+  if(state.file_name.empty() == false){
+    std::cout << "[" << state.file_name << "]: ";
+  }
+  std::cout << "Skipped (budget) :: " << rule_ids << " at line "
+            << state.line_number << " -- " << reason << "\n";
+
+}
+
+// Check if the rule being checked may run another regex search
+// (sets state.skip_reason when it may not)
+bool HasBudget(Configuration& state){
+
+  if (state.skip_reason.empty() == false) {
+    return false;
+  }
+
+  if (state.rule_step_budget > 0 && ++state.budget_steps > state.rule_step_budget) {
+    state.skip_reason = "rule step budget";
+    return false;
+  }
+
+  if (state.has_deadline == true &&
+      std::chrono::steady_clock::now() > state.budget_deadline) {
+    state.skip_reason = "time budget";
+    return false;
+  }
+
+  return true;
+}
+
+// Check a pattern, skipping the regex search when the statement has none of
+// the literals a match needs (nullptr -- always search)
 void CheckPattern(Configuration& state,
                   const std::string& sql_statement,
                   bool& print_statement,
                   const std::regex& anti_pattern,
+                  const std::vector<std::string>* literals,
                   const RiskLevel pattern_risk_level,
                   const PatternType pattern_type,
                   const std::string title,
@@ -209,53 +429,82 @@ void CheckPattern(Configuration& state,
     return;
   }
 
-  bool found = false;
-  std::smatch match;
-  std::size_t count = 0;
+  // Skip the pattern once the rule is out of budget
+  if(HasBudget(state) == false){
+    return;
+  }
+
+  // Position and length of every match
+  std::vector<std::pair<std::size_t, std::size_t>> matches;
+
+  // The reference engine runs every search
+  bool search = (literals == nullptr ||
+                 state.pattern_engine != PATTERN_ENGINE_PREFILTER ||
+                 MayMatch(*literals, sql_statement) == true);
 
-  // create an vector for the match positions
-  std::vector<size_t> positions;
   try {
-    std::sregex_iterator sqlsearch = std::sregex_iterator(sql_statement.begin(), sql_statement.end(), anti_pattern);
+    std::sregex_iterator sqlsearch = search ?
+        std::sregex_iterator(sql_statement.begin(), sql_statement.end(), anti_pattern) :
+        std::sregex_iterator();
     std::sregex_iterator sqlend = std::sregex_iterator();
-    count = std::distance(sqlsearch, sqlend);
-    if (count > 0) {
-      found = true;
+    // std::regex cannot be interrupted, so the budget is checked between
+    // matches
+    for (auto next = sqlsearch; next != sqlend; ++next) {
+      matches.push_back(std::make_pair(next->position(0), next->length(0)));
+      if (HasBudget(state) == false) {
+        return;
+      }
     }
+    bool found = (matches.empty() == false);
+
+    if (state.profile == true && search == true) {
+      auto& counter = state.profile_stats.GetRule(state.profile_stats.current_rule);
+      counter.regex_evaluations++;
+      counter.matches += matches.size();
+    }
+
+    if(found == exists && matches.size() > min_count){
 
-    if(found == exists && count > min_count){
-      for (std::sregex_iterator next = sqlsearch; next != sqlend; ++next)
-      {
-          match = *next;
-          // add match position to the vector
-          positions.push_back(match.position(0));
+      // Suppress the findings accepted in the baseline
+      if (state.baseline != nullptr &&
+          state.baseline->Match(state.rule_id, state.statement_hash) == true) {
+        return;
       }
 
-      // update positions from character number to line number
-      uint32_t position_checker = 0;
-      uint32_t num_lines = state.line_number;
-      if (positions.size() > 0) {
-        for (size_t statement_char = 0; statement_char < sql_statement.length(); statement_char++) {
-          if (positions[position_checker] == statement_char) {
-            positions[position_checker] = num_lines;
-            position_checker++;
-          }
-          if (sql_statement[statement_char] == '\n') {
-            num_lines++;
-          }
+      // Collect or write a finding for every match, and print them only for
+      // a text sink
+      if (state.collect_findings == true || state.report_writer != nullptr) {
+        if (matches.empty()) {
+          RecordFinding(state, pattern_risk_level, pattern_type, title,
+                        0, sql_statement.length(), "");
+        }
+        for (auto& match : matches) {
+          RecordFinding(state, pattern_risk_level, pattern_type, title,
+                        match.first, match.second,
+                        sql_statement.substr(match.first, match.second));
+        }
+        if (state.collect_findings == true ||
+            FindOutputSink(state.output_sinks, OUTPUT_FORMAT_TEXT) == nullptr) {
+          state.checker_stats[pattern_risk_level]++;
+          state.checker_stats[RISK_LEVEL_ALL]++;
+          return;
         }
       }
 
+      ProfileTimer output_timer(state.profile ?
+          &state.profile_stats.stages[PROFILE_STAGE_OUTPUT] : nullptr);
+      TraceSpan span("output", "output");
+
       std::stringstream linelocations;
-      // convert line numbers to output string
-      if (positions.size() > 1) {
+      // convert match positions to line numbers
+      if (matches.size() > 1) {
         linelocations << " at lines ";
       } else {
         linelocations << " at line ";
       }
-      for (size_t i = 0; i < positions.size(); i++) {
-          linelocations << positions[i];
-          if (i < positions.size() - 1) {
+      for (size_t i = 0; i < matches.size(); i++) {
+          linelocations << GetLineNumber(state, matches[i].first);
+          if (i < matches.size() - 1) {
               linelocations << ", ";
           }
       }
@@ -270,11 +519,12 @@ void CheckPattern(Configuration& state,
       if(exists == true){
         ColorModifier blue(ColorCode::FG_BLUE, state.color_mode, true);
         ColorModifier regular(ColorCode::FG_DEFAULT, state.color_mode, false);
+        auto first_match = sql_statement.substr(matches.front().first, matches.front().second);
         if(state.color_mode == true){
-          std::cout << "[Matching Expression: " << blue << WrapText(match.str(0)) << regular << linelocations.str()  << "]";
+          std::cout << "[Matching Expression: " << blue << WrapText(first_match) << regular << linelocations.str()  << "]";
         }
         else{
-          std::cout << "[Matching Expression: " << WrapText(match.str(0)) << linelocations.str() << "]";
+          std::cout << "[Matching Expression: " << WrapText(first_match) << linelocations.str() << "]";
         }
         std::cout << "\n\n";
       }
@@ -283,112 +533,276 @@ void CheckPattern(Configuration& state,
       print_statement = false;
     }
   } catch (std::regex_error& e) {
-    // Syntax error in the regular expression
+    // The engine gives up on patterns that backtrack too much
+    if (e.code() == std::regex_constants::error_complexity ||
+        e.code() == std::regex_constants::error_stack) {
+      state.skip_reason = "regex complexity limit";
+    }
+    else {
+      state.skip_reason = "regex error";
+    }
   }
 }
 
-void CheckStatement(Configuration& state,
-                    const std::string& sql_statement){
+void CheckPattern(Configuration& state,
+                  const std::string& sql_statement,
+                  bool& print_statement,
+                  const std::regex& anti_pattern,
+                  const RiskLevel pattern_risk_level,
+                  const PatternType pattern_type,
+                  const std::string title,
+                  const std::string message,
+                  const bool exists,
+                  const size_t min_count){
+  CheckPattern(state, sql_statement, print_statement, anti_pattern, nullptr,
+               pattern_risk_level, pattern_type, title, message, exists, min_count);
+}
 
-  // TRANSFORM TO LOWER CASE
-  auto statement = sql_statement;
+void CheckPattern(Configuration& state,
+                  const std::string& sql_statement,
+                  bool& print_statement,
+                  const RulePattern& anti_pattern,
+                  const RiskLevel pattern_risk_level,
+                  const PatternType pattern_type,
+                  const std::string title,
+                  const std::string message,
+                  const bool exists,
+                  const size_t min_count){
+  CheckPattern(state, sql_statement, print_statement, anti_pattern.regex,
+               &anti_pattern.literals, pattern_risk_level, pattern_type, title,
+               message, exists, min_count);
+}
 
-  std::transform(statement.begin(),
-                 statement.end(),
-                 statement.begin(),
-                 ::tolower);
+void NormalizeStatement(const std::string& sql_statement,
+                        std::string& statement,
+                        std::vector<std::uint32_t>& offsets){
 
-  // REMOVE SPACE
-  statement = std::regex_replace(statement, std::regex("^ +| +$|( ) +"), "$1");
+  statement.clear();
+  offsets.clear();
+  statement.reserve(sql_statement.length());
+  offsets.reserve(sql_statement.length());
 
-  // CHECK FOR LEADING NEWLINE
-  if (statement[0] == '\n') {
-    statement = statement.erase(0,1);
-    state.line_number++;
+  // Drop leading and trailing spaces, collapse runs of spaces
+  auto length = sql_statement.length();
+  std::size_t pos = 0;
+  while (pos < length && sql_statement[pos] == ' ') {
+    pos++;
   }
 
-  // RESET
-  bool print_statement = true;
-
-  // LOGICAL DATABASE DESIGN
-
-  CheckMultiValuedAttribute(state, statement, print_statement);
-
-  CheckRecursiveDependency(state, statement, print_statement);
-
-  CheckPrimaryKeyExists(state, statement, print_statement);
-
-  CheckGenericPrimaryKey(state, statement, print_statement);
-
-  CheckForeignKeyExists(state, statement, print_statement);
-
-  CheckVariableAttribute(state, statement, print_statement);
-
-  CheckMetadataTribbles(state, statement, print_statement);
-
-  // PHYSICAL DATABASE DESIGN
-
-  CheckFloat(state, statement, print_statement);
-
-  CheckValuesInDefinition(state, statement, print_statement);
-
-  CheckExternalFiles(state, statement, print_statement);
-
-  CheckIndexCount(state, statement, print_statement);
-
-  CheckIndexAttributeOrder(state, statement, print_statement);
-
-  // QUERY
-
-  CheckSelectStar(state, statement, print_statement);
-
-  CheckJoinWithoutEquality(state, statement, print_statement);
-
-  CheckNullUsage(state, statement, print_statement);
+  while (pos < length) {
+    if (sql_statement[pos] == ' ') {
+      auto run_end = pos;
+      while (run_end < length && sql_statement[run_end] == ' ') {
+        run_end++;
+      }
+      if (run_end == length) {
+        break;
+      }
+      statement += ' ';
+      offsets.push_back(pos);
+      pos = run_end;
+      continue;
+    }
 
-  CheckNotNullUsage(state, statement, print_statement);
+    statement += static_cast<char>(::tolower(static_cast<unsigned char>(sql_statement[pos])));
+    offsets.push_back(pos);
+    pos++;
+  }
 
-  CheckConcatenation(state, statement, print_statement);
+}
 
-  CheckGroupByUsage(state, statement, print_statement);
+void SkipStatement(Configuration& state,
+                   const std::string& sql_statement){
 
-  CheckOrderByRand(state, statement, print_statement);
+  // Keep the schema up to date
+  state.catalog.AddStatement(sql_statement);
 
-  CheckPatternMatching(state, statement, print_statement);
+  // Keep line numbers and statement ids in sync with the input
+  state.line_number += std::count(sql_statement.begin(),
+                                  sql_statement.end(),
+                                  '\n');
+  state.statement_id++;
 
-  CheckSpaghettiQuery(state, statement, print_statement);
+}
 
-  CheckJoinCount(state, statement, print_statement);
+void CheckStatement(Configuration& state,
+                    const std::string& sql_statement){
 
-  CheckDistinctCount(state, statement, print_statement);
+  auto start_time = std::chrono::steady_clock::now();
+
+  // SKIP OVERSIZED STATEMENTS
+  if (state.max_statement_bytes > 0 &&
+      sql_statement.length() > state.max_statement_bytes) {
+    ReportSkippedCheck(state, "all", "statement exceeds " +
+                       std::to_string(state.max_statement_bytes) + " bytes");
+    state.run_stats.skipped_statements++;
+    state.line_number += std::count(sql_statement.begin(),
+                                    sql_statement.end(),
+                                    '\n');
+    state.statement_id++;
+    return;
+  }
 
-  CheckImplicitColumns(state, statement, print_statement);
+  // TRANSFORM TO LOWER CASE AND REMOVE SPACE
+  std::string statement;
+  {
+    auto counter = state.profile ?
+        &state.profile_stats.stages[PROFILE_STAGE_NORMALIZER] : nullptr;
+    ProfileTimer timer(counter);
+    TraceSpan span("normalize", "checker");
+    NormalizeStatement(sql_statement, statement, state.statement_offsets);
+    if (counter != nullptr) {
+      counter->bytes_scanned += sql_statement.length();
+    }
+  }
 
-  CheckHaving(state, statement, print_statement);
+  // CHECK FOR LEADING NEWLINES
+  // (blank lines between statements, so that the statement and its
+  // findings start at its first character)
+  state.statement_line_start = 1 - static_cast<std::int64_t>(state.statement_column);
+  std::size_t leading = 0;
+  while (leading < statement.length() && ::isspace(static_cast<unsigned char>(statement[leading]))) {
+    if (statement[leading] == '\n') {
+      state.statement_line_start = state.statement_offsets[leading] + 1;
+      state.line_number++;
+    }
+    leading++;
+  }
+  if (leading > 0) {
+    statement.erase(0, leading);
+    state.statement_offsets.erase(state.statement_offsets.begin(),
+                                  state.statement_offsets.begin() + leading);
+  }
 
-  CheckNesting(state, statement, print_statement);
+  // INDEX NEWLINES
+  state.statement_newlines.clear();
+  for (std::size_t i = 0; i < statement.length(); i++) {
+    if (statement[i] == '\n') {
+      state.statement_newlines.push_back(i);
+    }
+  }
 
-  CheckOr(state, statement, print_statement);
+  // UPDATE SCHEMA CATALOG
+  state.catalog.AddStatement(sql_statement);
 
-  CheckUnion(state, statement, print_statement);
+  // FINGERPRINT FOR THE BASELINE
+  if (state.baseline != nullptr) {
+    state.statement_hash = HashString(GetFingerprint(sql_statement));
+  }
 
-  CheckDistinctJoin(state, statement, print_statement);
+  // RESET
+  bool print_statement = true;
 
-  // APPLICATION
+  // RUN RULES
+  auto& rules = GetRules();
+  auto first_line = state.line_number;
+  bool time_rules = (state.profile == true || state.top_slowest > 0);
+  std::size_t dominant_rule = 0;
+  std::uint64_t dominant_nanoseconds = 0;
+
+  bool use_budget = (state.statement_budget_ms > 0 || state.rule_budget_ms > 0 ||
+                     state.rule_step_budget > 0);
+  auto statement_deadline = start_time +
+      std::chrono::milliseconds(state.statement_budget_ms);
+  std::string out_of_time_rules;
+
+  for(std::size_t rule_index = 0; rule_index < rules.size(); rule_index++){
+    auto& rule = rules[rule_index];
+    state.rule_id = rule.id;
+    state.skip_reason.clear();
+
+    // Give the rule what is left of the budgets
+    if(use_budget == true){
+      auto now = std::chrono::steady_clock::now();
+      if(state.statement_budget_ms > 0 && now >= statement_deadline){
+        out_of_time_rules += (out_of_time_rules.empty() ? "" : ",");
+        out_of_time_rules += rule.id;
+        state.run_stats.skipped_rules++;
+        continue;
+      }
 
-  CheckReadablePasswords(state, statement, print_statement);
+      state.budget_steps = 0;
+      state.has_deadline = (state.statement_budget_ms > 0 || state.rule_budget_ms > 0);
+      state.budget_deadline = (state.statement_budget_ms > 0) ?
+          statement_deadline : std::chrono::steady_clock::time_point::max();
+      if(state.rule_budget_ms > 0){
+        state.budget_deadline = std::min(state.budget_deadline,
+            now + std::chrono::milliseconds(state.rule_budget_ms));
+      }
+    }
 
+    TraceSpan span(rule.name, "rule");
+    if(time_rules == false){
+      rule.function(state, statement, print_statement);
+    }
+    else {
+      // Time the rule without the time spent printing its findings
+      auto& output = state.profile_stats.stages[PROFILE_STAGE_OUTPUT];
+      auto output_nanoseconds = output.nanoseconds;
+      state.profile_stats.current_rule = rule_index;
+      auto rule_start = std::chrono::steady_clock::now();
+      rule.function(state, statement, print_statement);
+      auto rule_nanoseconds = static_cast<std::uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+              std::chrono::steady_clock::now() - rule_start).count()) -
+          (output.nanoseconds - output_nanoseconds);
+
+      if(state.profile == true){
+        auto& counter = state.profile_stats.GetRule(rule_index);
+        counter.invocations++;
+        counter.nanoseconds += rule_nanoseconds;
+        counter.bytes_scanned += statement.length();
+      }
+      if(rule_nanoseconds > dominant_nanoseconds){
+        dominant_rule = rule_index;
+        dominant_nanoseconds = rule_nanoseconds;
+      }
+    }
 
+    // Report a rule that was aborted
+    if(state.skip_reason.empty() == false){
+      ReportSkippedCheck(state, rule.id, state.skip_reason);
+      state.run_stats.skipped_rules++;
+    }
+  }
 
+  state.has_deadline = false;
+  state.skip_reason.clear();
+  if(out_of_time_rules.empty() == false){
+    ReportSkippedCheck(state, out_of_time_rules, "statement time budget");
+  }
 
   // update state.line_number with number of line breaks in the statement that was just checked
-  for (size_t i = 0; i < statement.length(); i++)
-  {
-      if (statement[i] == '\n')
-      {
-          state.line_number++;
-      }
+  state.line_number += state.statement_newlines.size();
+  state.statement_id++;
+
+  // Record the check latency
+  auto elapsed = std::chrono::steady_clock::now() - start_time;
+  auto nanoseconds = static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+  auto& stats = state.run_stats;
+  stats.latency.Record(nanoseconds);
+
+  // Keep the slowest statements (without the space the splitter appends)
+  if(stats.slowest.IsSlowEnough(nanoseconds, state.top_slowest) == true){
+    SlowStatement slow_statement;
+    slow_statement.nanoseconds = nanoseconds;
+    slow_statement.sequence = stats.statements;
+    slow_statement.file_name = state.file_name;
+    slow_statement.offset = state.statement_offset;
+    slow_statement.length = sql_statement.length();
+    if(sql_statement.empty() == false && sql_statement.back() == ' '){
+      slow_statement.length--;
+    }
+    slow_statement.line_number = first_line;
+    slow_statement.rule_id = rules[dominant_rule].id;
+    slow_statement.rule_name = rules[dominant_rule].name;
+    slow_statement.rule_nanoseconds = dominant_nanoseconds;
+    stats.slowest.Add(slow_statement, state.top_slowest);
   }
+
+  stats.statements++;
+  stats.bytes += sql_statement.length();
 }
 
 }  // namespace machine
@@ -2,10 +2,60 @@
 
 #include "include/configuration.h"
 
+#include "include/baseline.h"
+
 #include "gflags/gflags.h"
 
 namespace sqlcheck {
 
+void CopyOptions(const Configuration& source, Configuration& target){
+
+  target.color_mode = source.color_mode;
+  target.file_name = source.file_name;
+  target.delimiter = source.delimiter;
+  target.risk_level = source.risk_level;
+  target.verbose = source.verbose;
+  target.sample_mode = source.sample_mode;
+  target.sample_rate = source.sample_rate;
+  target.sample_reservoir_size = source.sample_reservoir_size;
+  target.sample_budget = source.sample_budget;
+  target.sample_seed = source.sample_seed;
+  target.collect_findings = source.collect_findings;
+  target.serve_path = source.serve_path;
+  target.num_workers = source.num_workers;
+  target.watch_path = source.watch_path;
+  target.catalog = source.catalog;
+  target.catalog_file = source.catalog_file;
+  target.write_catalog_file = source.write_catalog_file;
+  target.index_advice = source.index_advice;
+  target.nplus1 = source.nplus1;
+  target.nplus1_window = source.nplus1_window;
+  target.nplus1_threshold = source.nplus1_threshold;
+  target.source_path = source.source_path;
+  target.diff_file = source.diff_file;
+  target.profile = source.profile;
+  target.profile_file = source.profile_file;
+  target.stats = source.stats;
+  target.stats_file = source.stats_file;
+  target.top_slowest = source.top_slowest;
+  target.max_statement_bytes = source.max_statement_bytes;
+  target.statement_budget_ms = source.statement_budget_ms;
+  target.rule_budget_ms = source.rule_budget_ms;
+  target.rule_step_budget = source.rule_step_budget;
+  target.pattern_engine = source.pattern_engine;
+  target.output_sinks = source.output_sinks;
+  target.baseline_file = source.baseline_file;
+  target.write_baseline_file = source.write_baseline_file;
+
+}
+
+void LimitStatementBytes(Configuration& state){
+  if(state.max_statement_bytes == 0 ||
+     state.max_statement_bytes > kMaxStatementBytes){
+    state.max_statement_bytes = kMaxStatementBytes;
+  }
+}
+
 std::string RiskLevelToString(const RiskLevel& risk_level){
 
   switch (risk_level) {
@@ -68,6 +118,121 @@ std::string PatternTypeToString(const PatternType& pattern_type){
 
 }
 
+std::string SampleModeToString(const SampleMode& sample_mode){
+
+  switch (sample_mode) {
+    case SAMPLE_MODE_RATE:
+      return "FIXED RATE";
+    case SAMPLE_MODE_RESERVOIR:
+      return "PER-FINGERPRINT RESERVOIR";
+    case SAMPLE_MODE_BUDGET:
+      return "TIME BUDGET";
+
+    case SAMPLE_MODE_NONE:
+    default:
+      return "DISABLED";
+  }
+
+}
+
+std::string PatternEngineToString(const PatternEngine& pattern_engine){
+
+  switch (pattern_engine) {
+    case PATTERN_ENGINE_REGEX:
+      return "regex";
+    case PATTERN_ENGINE_PREFILTER:
+      return "prefilter";
+
+    case PATTERN_ENGINE_INVALID:
+    default:
+      return "invalid";
+  }
+
+}
+
+PatternEngine StringToPatternEngine(const std::string& text){
+  if(text == "regex"){
+    return PATTERN_ENGINE_REGEX;
+  }
+  if(text == "prefilter"){
+    return PATTERN_ENGINE_PREFILTER;
+  }
+  return PATTERN_ENGINE_INVALID;
+}
+
+std::string OutputFormatToString(const OutputFormat& output_format){
+
+  switch (output_format) {
+    case OUTPUT_FORMAT_TEXT:
+      return "text";
+    case OUTPUT_FORMAT_JSON:
+      return "json";
+    case OUTPUT_FORMAT_JSONL:
+      return "jsonl";
+    case OUTPUT_FORMAT_SARIF:
+      return "sarif";
+
+    case OUTPUT_FORMAT_INVALID:
+    default:
+      return "invalid";
+  }
+
+}
+
+OutputFormat StringToOutputFormat(const std::string& text){
+  if(text == "text"){
+    return OUTPUT_FORMAT_TEXT;
+  }
+  if(text == "json"){
+    return OUTPUT_FORMAT_JSON;
+  }
+  if(text == "jsonl"){
+    return OUTPUT_FORMAT_JSONL;
+  }
+  if(text == "sarif"){
+    return OUTPUT_FORMAT_SARIF;
+  }
+  return OUTPUT_FORMAT_INVALID;
+}
+
+std::string OutputSinksToString(const std::vector<OutputSink>& output_sinks){
+  std::string text;
+  for(auto& output_sink : output_sinks){
+    text += (text.empty() ? "" : ",") + OutputFormatToString(output_sink.format) +
+        ":" + output_sink.path;
+  }
+  return text;
+}
+
+std::vector<OutputSink> StringToOutputSinks(const std::string& text){
+
+  std::vector<OutputSink> output_sinks;
+  std::stringstream entries(text);
+  std::string entry;
+  while(std::getline(entries, entry, ',')){
+    auto separator = entry.find(':');
+    if(separator == std::string::npos){
+      output_sinks.emplace_back(StringToOutputFormat(entry), "-");
+    }
+    else {
+      output_sinks.emplace_back(StringToOutputFormat(entry.substr(0, separator)),
+                                entry.substr(separator + 1));
+    }
+  }
+  return output_sinks;
+
+}
+
+const OutputSink* FindOutputSink(const std::vector<OutputSink>& output_sinks,
+                                 const OutputFormat& output_format){
+  for(auto& output_sink : output_sinks){
+    if(output_sink.format == output_format){
+      return &output_sink;
+    }
+  }
+  return nullptr;
+}
+
 std::string GetBooleanString(const bool& status){
   if(status == true){
     return "ENABLED";
@@ -111,4 +276,220 @@ void ValidateDelimiter(const Configuration &state) {
          state.delimiter.c_str());
 }
 
+void ValidateSampling(const Configuration &state) {
+  switch (state.sample_mode) {
+    case SAMPLE_MODE_RATE:
+      if (state.sample_rate <= 0 || state.sample_rate > 1) {
+        printf("INVALID SAMPLE RATE :: %f\n", state.sample_rate);
+        exit(EXIT_FAILURE);
+      }
+      printf("> %s :: %s (%g)\n", "SAMPLING     ",
+             SampleModeToString(state.sample_mode).c_str(),
+             state.sample_rate);
+      break;
+    case SAMPLE_MODE_RESERVOIR:
+      printf("> %s :: %s (%llu)\n", "SAMPLING     ",
+             SampleModeToString(state.sample_mode).c_str(),
+             (unsigned long long) state.sample_reservoir_size);
+      break;
+    case SAMPLE_MODE_BUDGET:
+      if (state.sample_budget <= 0 || state.sample_budget > 1) {
+        printf("INVALID SAMPLE BUDGET :: %f\n", state.sample_budget);
+        exit(EXIT_FAILURE);
+      }
+      printf("> %s :: %s (%g%% OF A CORE)\n", "SAMPLING     ",
+             SampleModeToString(state.sample_mode).c_str(),
+             state.sample_budget * 100);
+      break;
+    case SAMPLE_MODE_NONE:
+    default:
+      break;
+  }
+}
+
+void ValidateServe(const Configuration &state) {
+  if (state.serve_path.empty() == false) {
+    printf("> %s :: %s\n", "SERVE SOCKET ",
+           state.serve_path.c_str());
+  }
+}
+
+void ValidateWatch(const Configuration &state) {
+  if (state.watch_path.empty() == false) {
+    printf("> %s :: %s\n", "WATCH DIR    ",
+           state.watch_path.c_str());
+  }
+}
+
+void ValidateCatalog(const Configuration &state) {
+  if (state.catalog_file.empty() == false) {
+    printf("> %s :: %s (%zu tables)\n", "CATALOG      ",
+           state.catalog_file.c_str(), state.catalog.GetTables().size());
+  }
+  if (state.write_catalog_file.empty() == false) {
+    printf("> %s :: %s\n", "WRITE CATALOG",
+           state.write_catalog_file.c_str());
+  }
+}
+
+void ValidateBaseline(const Configuration &state) {
+  if (state.baseline_file.empty() && state.write_baseline_file.empty()) {
+    return;
+  }
+
+  // The other modes do not run a single check
+  if (state.source_path.empty() == false || state.diff_file.empty() == false ||
+      state.serve_path.empty() == false || state.watch_path.empty() == false ||
+      state.nplus1 == true) {
+    printf("INVALID BASELINE :: only applies to checking a file or standard input\n");
+    exit(EXIT_FAILURE);
+  }
+  if (state.baseline_file.empty() == false) {
+    printf("> %s :: %s (%zu findings)\n", "BASELINE     ",
+           state.baseline_file.c_str(), state.baseline->GetEntryCount());
+  }
+  if (state.write_baseline_file.empty() == false) {
+    printf("> %s :: %s\n", "NEW BASELINE ",
+           state.write_baseline_file.c_str());
+  }
+}
+
+void ValidateIndexAdvice(const Configuration &state) {
+  if (state.index_advice == true) {
+    printf("> %s :: %s\n", "INDEX ADVICE ", "ENABLED");
+  }
+}
+
+void ValidateNPlusOne(const Configuration &state) {
+  if (state.nplus1 == false) {
+    return;
+  }
+
+  if (state.nplus1_window <= 0) {
+    printf("INVALID N+1 WINDOW :: %f\n", state.nplus1_window);
+    exit(EXIT_FAILURE);
+  }
+  if (state.nplus1_threshold < 2) {
+    printf("INVALID N+1 THRESHOLD :: %llu\n",
+           (unsigned long long) state.nplus1_threshold);
+    exit(EXIT_FAILURE);
+  }
+
+  printf("> %s :: %llu QUERIES WITHIN %g S\n", "N+1 DETECTION",
+         (unsigned long long) state.nplus1_threshold,
+         state.nplus1_window);
+}
+
+void ValidateSourcePath(const Configuration &state) {
+  if (state.source_path.empty() == false) {
+    printf("> %s :: %s\n", "SOURCE TREE  ",
+           state.source_path.c_str());
+  }
+}
+
+void ValidateDiff(const Configuration &state) {
+  if (state.diff_file.empty() == false) {
+    printf("> %s :: %s\n", "DIFF         ",
+           (state.diff_file == "-") ? "stdin" : state.diff_file.c_str());
+  }
+}
+
+void ValidateProfile(const Configuration &state) {
+  if (state.profile == true) {
+    printf("> %s :: %s\n", "PROFILE      ",
+           state.profile_file.empty() ? "ENABLED" : state.profile_file.c_str());
+  }
+}
+
+void ValidateTrace(const Configuration &state) {
+  if (state.trace_file.empty() == false) {
+    printf("> %s :: %s\n", "TRACE        ", state.trace_file.c_str());
+  }
+}
+
+void ValidateStats(const Configuration &state) {
+  if (state.stats == true) {
+    printf("> %s :: %s\n", "STATS        ",
+           state.stats_file.empty() ? "ENABLED" : state.stats_file.c_str());
+  }
+  if (state.top_slowest > 0) {
+    printf("> %s :: %zu\n", "TOP SLOWEST  ", state.top_slowest);
+  }
+}
+
+void ValidateBudget(const Configuration &state) {
+  if (state.max_statement_bytes > 0) {
+    printf("> %s :: %llu\n", "MAX BYTES    ",
+           static_cast<unsigned long long>(state.max_statement_bytes));
+  }
+  if (state.statement_budget_ms > 0 || state.rule_budget_ms > 0 ||
+      state.rule_step_budget > 0) {
+    printf("> %s :: statement %llu ms, rule %llu ms, %llu steps (0 -- no limit)\n",
+           "BUDGET       ",
+           static_cast<unsigned long long>(state.statement_budget_ms),
+           static_cast<unsigned long long>(state.rule_budget_ms),
+           static_cast<unsigned long long>(state.rule_step_budget));
+  }
+}
+
+void ValidateEngine(const Configuration &state) {
+  if (state.pattern_engine == PATTERN_ENGINE_INVALID) {
+    printf("INVALID ENGINE :: use regex or prefilter\n");
+    exit(EXIT_FAILURE);
+  }
+  if (state.pattern_engine != PATTERN_ENGINE_REGEX) {
+    printf("> %s :: %s\n", "ENGINE       ",
+           PatternEngineToString(state.pattern_engine).c_str());
+  }
+}
+
+void ValidateOutput(const Configuration &state) {
+  auto& output_sinks = state.output_sinks;
+  if (output_sinks.empty()) {
+    printf("INVALID OUTPUT :: no output\n");
+    exit(EXIT_FAILURE);
+  }
+
+  std::size_t text_sinks = 0;
+  for (std::size_t i = 0; i < output_sinks.size(); i++) {
+    if (output_sinks[i].format == OUTPUT_FORMAT_INVALID ||
+        output_sinks[i].path.empty()) {
+      printf("INVALID OUTPUT :: use format:path with text, json, jsonl or sarif "
+             "(\"-\" -- standard output)\n");
+      exit(EXIT_FAILURE);
+    }
+    for (std::size_t j = 0; j < i; j++) {
+      if (output_sinks[j].path == output_sinks[i].path) {
+        printf("INVALID OUTPUT :: %s is written by more than one sink\n",
+               output_sinks[i].path.c_str());
+        exit(EXIT_FAILURE);
+      }
+    }
+    if (output_sinks[i].format == OUTPUT_FORMAT_TEXT) {
+      text_sinks++;
+    }
+  }
+  if (text_sinks > 1) {
+    printf("INVALID OUTPUT :: only one text sink is supported\n");
+    exit(EXIT_FAILURE);
+  }
+
+  // The console report alone
+  if (output_sinks.size() == 1 && text_sinks == 1 && output_sinks[0].path == "-") {
+    return;
+  }
+
+  // The other modes print their own reports
+  if (output_sinks.size() > text_sinks &&
+      (state.source_path.empty() == false || state.diff_file.empty() == false ||
+       state.serve_path.empty() == false || state.watch_path.empty() == false ||
+       state.nplus1 == true)) {
+    printf("INVALID OUTPUT :: structured formats only apply to checking a file "
+           "or standard input\n");
+    exit(EXIT_FAILURE);
+  }
+  printf("> %s :: %s\n", "OUTPUT       ",
+         OutputSinksToString(output_sinks).c_str());
+}
+
 }  // namespace sqlcheck
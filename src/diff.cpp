@@ -0,0 +1,385 @@
+// DIFF SOURCE
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <iostream>
+
+#include "include/diff.h"
+
+#include "include/checker.h"
+#include "include/file_walker.h"
+
+namespace sqlcheck {
+
+// UTILITY
+
+bool StartsWith(const std::string& text, const char* prefix){
+  return text.compare(0, std::char_traits<char>::length(prefix), prefix) == 0;
+}
+
+// Get the path of a --- or +++ line (drops the timestamp and quotes)
+std::string GetDiffPath(const std::string& text){
+
+  auto path = text.substr(0, text.find('\t'));
+  if(path.size() >= 2 && path.front() == '"' && path.back() == '"'){
+    path = path.substr(1, path.size() - 2);
+  }
+  return path;
+}
+
+// Parse a "start[,count]" range of a hunk header
+bool ParseRange(const char*& position,
+                std::uint32_t& start,
+                std::uint32_t& count){
+
+  char* end = nullptr;
+  start = static_cast<std::uint32_t>(std::strtoul(position, &end, 10));
+  if(end == position){
+    return false;
+  }
+
+  count = 1;
+  if(*end == ','){
+    position = end + 1;
+    count = static_cast<std::uint32_t>(std::strtoul(position, &end, 10));
+  }
+  position = end;
+  return true;
+}
+
+// PARSER
+
+// Read the body of a hunk. The line counts of the header decide where the
+// hunk ends, so removed "-- comment" lines are not taken for file headers.
+void ParseHunk(std::istream& input,
+               std::uint32_t old_count,
+               std::uint32_t new_count,
+               DiffHunk& hunk,
+               std::vector<std::uint32_t>& changed_lines){
+
+  std::uint32_t line_number = hunk.new_start;
+  bool pending_removal = false;
+  std::string line;
+
+  while((old_count > 0 || new_count > 0) && std::getline(input, line)){
+    if(line.empty() == false && line.back() == '\r'){
+      line.pop_back();
+    }
+
+    // Some tools strip the space of empty context lines
+    char type = line.empty() ? ' ' : line[0];
+    if(type == '\\'){
+      continue;
+    }
+
+    if(type == '-'){
+      pending_removal = true;
+      old_count--;
+      continue;
+    }
+
+    if(type != ' ' && type != '+'){
+      break;
+    }
+
+    // The line after a removal belongs to the changed statement
+    if(type == '+' || pending_removal == true){
+      changed_lines.push_back(line_number);
+    }
+    pending_removal = false;
+
+    hunk.new_lines.push_back(line.empty() ? line : line.substr(1));
+    line_number++;
+    new_count--;
+    if(type == ' '){
+      old_count--;
+    }
+  }
+
+  // Lines removed at the end of the file
+  if(pending_removal == true && line_number > 1){
+    changed_lines.push_back(line_number - 1);
+  }
+
+}
+
+bool ParseUnifiedDiff(std::istream& input,
+                      std::vector<FileDiff>& files){
+
+  std::string line;
+  std::string old_path;
+  bool found_header = false;
+  bool in_file = false;
+
+  while(std::getline(input, line)){
+    if(line.empty() == false && line.back() == '\r'){
+      line.pop_back();
+    }
+
+    if(StartsWith(line, "--- ")){
+      old_path = GetDiffPath(line.substr(4));
+      in_file = false;
+      continue;
+    }
+
+    if(StartsWith(line, "+++ ")){
+      found_header = true;
+      auto new_path = GetDiffPath(line.substr(4));
+
+      // Skip deleted files
+      in_file = (new_path != "/dev/null");
+      if(in_file == false){
+        continue;
+      }
+
+      FileDiff file;
+      file.raw_path = new_path;
+      file.path = new_path;
+      bool has_prefix = StartsWith(old_path, "a/") || old_path == "/dev/null";
+      if(has_prefix == true && StartsWith(new_path, "b/")){
+        file.path = new_path.substr(2);
+      }
+      files.push_back(file);
+      continue;
+    }
+
+    if(StartsWith(line, "@@ -") && in_file == true){
+      const char* position = line.c_str() + 4;
+      std::uint32_t old_start, old_count, new_start, new_count;
+      if(ParseRange(position, old_start, old_count) == false ||
+         StartsWith(position, " +") == false){
+        continue;
+      }
+      position += 2;
+      if(ParseRange(position, new_start, new_count) == false){
+        continue;
+      }
+
+      auto& file = files.back();
+      DiffHunk hunk;
+      hunk.new_start = new_start;
+      ParseHunk(input, old_count, new_count, hunk, file.changed_lines);
+      file.hunks.push_back(std::move(hunk));
+    }
+  }
+
+  for(auto& file : files){
+    auto& lines = file.changed_lines;
+    std::sort(lines.begin(), lines.end());
+    lines.erase(std::unique(lines.begin(), lines.end()), lines.end());
+  }
+
+  return found_header;
+}
+
+// STATEMENTS
+
+void GetChangedStatements(const std::string& text,
+                          const std::uint32_t first_line,
+                          const char delimiter,
+                          const std::vector<std::uint32_t>& changed_lines,
+                          std::vector<ChangedStatement>& statements){
+
+  auto changed = changed_lines.begin();
+  std::uint32_t line_number = first_line;
+  std::size_t begin = 0;
+
+  while(begin < text.length() && changed != changed_lines.end()){
+
+    auto end = text.find(delimiter, begin);
+    if(end == std::string::npos){
+      end = text.length();
+    }
+
+    // Lines from the first character of the statement to the delimiter
+    auto statement_line = line_number;
+    std::uint32_t content_line = 0;
+    for(auto position = begin; position < end; position++){
+      if(text[position] == '\n'){
+        line_number++;
+      }
+      else if(content_line == 0 &&
+              ::isspace(static_cast<unsigned char>(text[position])) == 0){
+        content_line = line_number;
+      }
+    }
+
+    if(content_line != 0){
+      changed = std::lower_bound(changed, changed_lines.end(), content_line);
+      if(changed != changed_lines.end() && *changed <= line_number){
+        ChangedStatement statement;
+        statement.begin = begin;
+        statement.end = end;
+        statement.line_number = statement_line;
+        statements.push_back(statement);
+      }
+    }
+
+    begin = end + 1;
+  }
+
+}
+
+// CHECKER
+
+// Read the new file, if it matches the new side of every hunk
+bool ReadNewFile(const FileDiff& file,
+                 std::string& contents){
+
+  if(ReadFile(file.path, contents) == false &&
+     ReadFile(file.raw_path, contents) == false){
+    return false;
+  }
+
+  std::vector<std::size_t> line_starts(1, 0);
+  for(std::size_t position = 0; position < contents.length(); position++){
+    if(contents[position] == '\n'){
+      line_starts.push_back(position + 1);
+    }
+  }
+
+  for(auto& hunk : file.hunks){
+    for(std::size_t i = 0; i < hunk.new_lines.size(); i++){
+      std::size_t line = hunk.new_start + i;
+      if(line == 0 || line >= line_starts.size() + 1){
+        return false;
+      }
+
+      auto begin = line_starts[line - 1];
+      auto end = (line < line_starts.size()) ? line_starts[line] - 1 : contents.length();
+      if(end > begin && contents[end - 1] == '\r'){
+        end--;
+      }
+      if(contents.compare(begin, end - begin, hunk.new_lines[i]) != 0){
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+// Keep the schema catalog up to date with the statements in [begin, end)
+void SkipStatements(Configuration& state,
+                    const std::string& text,
+                    std::size_t begin,
+                    const std::size_t end){
+
+  while(begin < end){
+    auto next = std::min(text.find(state.delimiter[0], begin), end);
+    state.catalog.AddStatement(text.substr(begin, next - begin));
+    begin = next + 1;
+  }
+
+}
+
+// Check the changed statements of a text
+std::size_t CheckChangedStatements(Configuration& state,
+                                   const std::string& text,
+                                   const std::uint32_t first_line,
+                                   const std::vector<std::uint32_t>& changed_lines,
+                                   const bool skip_unchanged){
+
+  std::vector<ChangedStatement> statements;
+  GetChangedStatements(text, first_line, state.delimiter[0], changed_lines,
+                       statements);
+
+  std::size_t next = 0;
+  for(auto& statement : statements){
+    if(skip_unchanged == true){
+      SkipStatements(state, text, next, statement.begin);
+    }
+
+    state.line_number = statement.line_number;
+    state.statement_offset = statement.begin;
+    CheckStatement(state,
+                   text.substr(statement.begin, statement.end - statement.begin) + " ");
+    next = statement.end + 1;
+  }
+
+  if(skip_unchanged == true){
+    SkipStatements(state, text, next, text.length());
+  }
+
+  return statements.size();
+}
+
+bool CheckDiff(Configuration& state,
+               std::istream& diff){
+
+  state.run_stats.Start();
+
+  std::vector<FileDiff> files;
+  ParseUnifiedDiff(diff, files);
+
+  auto file_name = state.file_name;
+  std::uint64_t file_count = 0;
+  std::uint64_t statement_count = 0;
+
+  std::cout << "==================== Results ===================\n";
+
+  for(auto& file : files){
+    if(HasExtension(file.path, ".sql") == false || file.changed_lines.empty()){
+      continue;
+    }
+
+    file_count++;
+    state.file_name = file.path;
+
+    // Check the file in the working directory
+    std::string contents;
+    if(ReadNewFile(file, contents) == true){
+      statement_count += CheckChangedStatements(state, contents, 1,
+                                                file.changed_lines, true);
+      continue;
+    }
+
+    // Otherwise only the new side of the hunks is known
+    for(auto& hunk : file.hunks){
+      std::string text;
+      for(auto& line : hunk.new_lines){
+        text += line;
+        text += '\n';
+      }
+      statement_count += CheckChangedStatements(state, text, hunk.new_start,
+                                                file.changed_lines, false);
+    }
+  }
+
+  state.file_name = file_name;
+  state.run_stats.Stop();
+
+  // Print summary
+  std::cout << "\n==================== Summary ===================\n";
+  std::cout << "Changed SQL Files            :: " << file_count << "\n";
+  std::cout << "Changed Statements           :: " << statement_count << "\n";
+  bool has_issues = (state.checker_stats[RISK_LEVEL_ALL] != 0);
+  if(has_issues == false){
+    std::cout << "No issues found.\n";
+  }
+  else {
+    std::cout << "All Anti-Patterns and Hints  :: " << state.checker_stats[RISK_LEVEL_ALL] << "\n";
+    std::cout << ">  High Risk   :: " << state.checker_stats[RISK_LEVEL_HIGH] << "\n";
+    std::cout << ">  Medium Risk :: " << state.checker_stats[RISK_LEVEL_MEDIUM] << "\n";
+    std::cout << ">  Low Risk    :: " << state.checker_stats[RISK_LEVEL_LOW] << "\n";
+    std::cout << ">  Hints       :: " << state.checker_stats[RISK_LEVEL_NONE] << "\n";
+  }
+
+  PrintSkippedChecks(state.run_stats, std::cout);
+
+  // Print the throughput and resource usage
+  if(state.stats == true){
+    PrintRunStats(state.run_stats, std::cout);
+  }
+  PrintSlowestStatements(state.run_stats, std::cout);
+
+  // Print the cost of every rule and stage
+  if(state.profile == true){
+    PrintProfile(state.profile_stats, std::cout);
+  }
+
+  return has_issues;
+}
+
+}  // namespace sqlcheck
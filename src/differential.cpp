@@ -0,0 +1,149 @@
+// DIFFERENTIAL SOURCE
+
+#include <algorithm>
+#include <sstream>
+
+#include "include/differential.h"
+
+#include "include/checker.h"
+
+namespace sqlcheck {
+
+// FINDINGS
+
+std::vector<Finding> GetFindings(const Configuration& options,
+                                 const PatternEngine pattern_engine,
+                                 const std::string& sql_text){
+
+  Configuration state;
+  CopyOptions(options, state);
+  state.collect_findings = true;
+  state.pattern_engine = pattern_engine;
+  CheckText(state, sql_text);
+  return state.findings;
+}
+
+std::string DescribeFinding(const Finding& finding){
+  std::ostringstream description;
+  description << finding.rule_id << " " << finding.title
+              << " in statement " << finding.statement_id
+              << " at line " << finding.line_number
+              << ", column " << finding.column
+              << ", bytes [" << finding.begin << ", " << finding.end << ")"
+              << ", match \"" << finding.match << "\"";
+  return description.str();
+}
+
+bool IsSameFinding(const Finding& left, const Finding& right){
+  return left.rule_id == right.rule_id &&
+      left.statement_id == right.statement_id &&
+      left.risk_level == right.risk_level &&
+      left.pattern_type == right.pattern_type &&
+      left.line_number == right.line_number &&
+      left.column == right.column &&
+      left.begin == right.begin &&
+      left.end == right.end &&
+      left.match == right.match;
+}
+
+std::string DiffFindings(const std::vector<Finding>& expected,
+                         const std::vector<Finding>& actual){
+
+  auto count = std::min(expected.size(), actual.size());
+  for(std::size_t index = 0; index < count; index++){
+    if(IsSameFinding(expected[index], actual[index]) == false){
+      return "expected " + DescribeFinding(expected[index]) +
+          "\ngot      " + DescribeFinding(actual[index]);
+    }
+  }
+
+  if(expected.size() > count){
+    return "missing  " + DescribeFinding(expected[count]);
+  }
+  if(actual.size() > count){
+    return "extra    " + DescribeFinding(actual[count]);
+  }
+  return "";
+}
+
+std::string CompareEngines(const Configuration& options,
+                           const std::string& sql_text){
+  return DiffFindings(GetFindings(options, PATTERN_ENGINE_REGEX, sql_text),
+                      GetFindings(options, options.pattern_engine, sql_text));
+}
+
+// MINIMIZER
+
+std::string JoinUnits(const std::vector<std::string>& units,
+                      const std::size_t begin,
+                      const std::size_t end){
+  std::string text;
+  for(auto index = begin; index < end; index++){
+    text += units[index];
+  }
+  return text;
+}
+
+// Zeller's ddmin: try every chunk, then every complement, and split the
+// chunks further when neither fails
+std::vector<std::string> MinimizeUnits(std::vector<std::string> units,
+                                       const std::function<bool(const std::string& input)>& fails){
+
+  std::size_t granularity = 2;
+  while(units.size() >= 2){
+    auto chunk = (units.size() + granularity - 1) / granularity;
+    bool reduced = false;
+
+    for(std::size_t begin = 0; begin < units.size() && reduced == false; begin += chunk){
+      auto end = std::min(begin + chunk, units.size());
+      if(fails(JoinUnits(units, begin, end)) == true){
+        units = std::vector<std::string>(units.begin() + begin, units.begin() + end);
+        granularity = 2;
+        reduced = true;
+      }
+    }
+
+    for(std::size_t begin = 0; begin < units.size() && reduced == false; begin += chunk){
+      auto end = std::min(begin + chunk, units.size());
+      if(fails(JoinUnits(units, 0, begin) + JoinUnits(units, end, units.size())) == true){
+        units.erase(units.begin() + begin, units.begin() + end);
+        granularity = std::max<std::size_t>(granularity - 1, 2);
+        reduced = true;
+      }
+    }
+
+    if(reduced == false){
+      if(granularity >= units.size()){
+        break;
+      }
+      granularity = std::min(granularity * 2, units.size());
+    }
+  }
+
+  return units;
+}
+
+std::string MinimizeInput(const std::string& input,
+                          const std::function<bool(const std::string& input)>& fails){
+
+  // Lines first, they shrink large inputs quickly
+  std::vector<std::string> lines;
+  std::size_t begin = 0;
+  while(begin < input.length()){
+    auto end = input.find('\n', begin);
+    end = (end == std::string::npos) ? input.length() : end + 1;
+    lines.push_back(input.substr(begin, end - begin));
+    begin = end;
+  }
+  lines = MinimizeUnits(lines, fails);
+
+  std::vector<std::string> characters;
+  for(auto c : JoinUnits(lines, 0, lines.size())){
+    characters.push_back(std::string(1, c));
+  }
+  characters = MinimizeUnits(characters, fails);
+
+  return JoinUnits(characters, 0, characters.size());
+}
+
+}  // namespace sqlcheck
@@ -0,0 +1,739 @@
+// EXTRACTOR SOURCE
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <memory>
+
+#include <sys/stat.h>
+
+#include "include/extractor.h"
+
+#include "include/checker.h"
+#include "include/color.h"
+#include "include/file_walker.h"
+#include "include/tracer.h"
+#include "include/worker_pool.h"
+
+namespace sqlcheck {
+
+// UTILITY
+
+std::uint32_t ExtractedStatement::GetLineNumber(const std::size_t offset) const {
+
+  auto entry = std::upper_bound(lines.begin(), lines.end(),
+                                std::make_pair(static_cast<std::uint32_t>(offset),
+                                               UINT32_MAX));
+  if(entry == lines.begin()){
+    return lines.empty() ? 1 : lines.front().second;
+  }
+  return (entry - 1)->second;
+}
+
+SourceLanguage GetSourceLanguage(const std::string& path){
+
+  static const std::pair<const char*, SourceLanguage> extensions[] = {
+    {".c", SOURCE_LANGUAGE_CPP}, {".cc", SOURCE_LANGUAGE_CPP},
+    {".cpp", SOURCE_LANGUAGE_CPP}, {".cxx", SOURCE_LANGUAGE_CPP},
+    {".h", SOURCE_LANGUAGE_CPP}, {".hh", SOURCE_LANGUAGE_CPP},
+    {".hpp", SOURCE_LANGUAGE_CPP}, {".hxx", SOURCE_LANGUAGE_CPP},
+    {".java", SOURCE_LANGUAGE_JAVA}, {".py", SOURCE_LANGUAGE_PYTHON},
+    {".go", SOURCE_LANGUAGE_GO}
+  };
+
+  for(auto& extension : extensions){
+    if(HasExtension(path, extension.first)){
+      return extension.second;
+    }
+  }
+  return SOURCE_LANGUAGE_UNKNOWN;
+}
+
+bool IsSourceIdentifierCharacter(const char c){
+  return std::isalnum(static_cast<unsigned char>(c)) || c == '_' ||
+      (static_cast<unsigned char>(c) & 0x80);
+}
+
+// Check if the lower-case text contains a whole word
+bool ContainsWord(const std::string& text, const char* word){
+  auto length = std::strlen(word);
+  for(auto pos = text.find(word); pos != std::string::npos;
+      pos = text.find(word, pos + 1)){
+    bool start = (pos == 0) || IsSourceIdentifierCharacter(text[pos - 1]) == false;
+    bool end = (pos + length == text.length()) ||
+        IsSourceIdentifierCharacter(text[pos + length]) == false;
+    if(start == true && end == true){
+      return true;
+    }
+  }
+  return false;
+}
+
+bool LooksLikeSql(const std::string& text){
+
+  // Keyword prefilter on the first word
+  std::size_t pos = 0;
+  while(pos < text.length() && (std::isspace(static_cast<unsigned char>(text[pos])) ||
+      text[pos] == '(')){
+    pos++;
+  }
+  auto begin = pos;
+  bool lower = false;
+  bool upper = false;
+  std::string keyword;
+  while(pos < text.length() && std::isalpha(static_cast<unsigned char>(text[pos])) &&
+      keyword.length() < 9){
+    lower = lower || std::islower(static_cast<unsigned char>(text[pos]));
+    upper = upper || std::isupper(static_cast<unsigned char>(text[pos]));
+    keyword += std::tolower(static_cast<unsigned char>(text[pos]));
+    pos++;
+  }
+  if(pos >= text.length() || std::isspace(static_cast<unsigned char>(text[pos])) == 0){
+    return false;
+  }
+
+  static const char* keywords[] = {
+    "select", "insert", "update", "delete", "create", "alter", "drop",
+    "with", "replace", "merge", "truncate"
+  };
+  if(std::find_if(std::begin(keywords), std::end(keywords),
+                  [&keyword](const char* entry){ return keyword == entry; })
+      == std::end(keywords)){
+    return false;
+  }
+
+  // Prose is capitalized, SQL keywords are not mixed case
+  if(lower == true && upper == true){
+    return false;
+  }
+
+  // Light structural check
+  std::string rest = text.substr(begin + keyword.length());
+  std::transform(rest.begin(), rest.end(), rest.begin(),
+                 [](char c){ return std::tolower(static_cast<unsigned char>(c)); });
+  auto end = rest.find_last_not_of(" \t\r\n;");
+  if(end == std::string::npos || rest[end] == '.' || rest[end] == '!'){
+    return false;
+  }
+
+  if(keyword == "select" || keyword == "delete"){
+    return ContainsWord(rest, "from");
+  }
+  if(keyword == "insert" || keyword == "replace" || keyword == "merge"){
+    return ContainsWord(rest, "into");
+  }
+  if(keyword == "update"){
+    return ContainsWord(rest, "set");
+  }
+  if(keyword == "with"){
+    return ContainsWord(rest, "as") && ContainsWord(rest, "select");
+  }
+  if(keyword == "truncate"){
+    return true;
+  }
+
+  // create, alter and drop
+  static const char* objects[] = {
+    "table", "index", "view", "database", "schema", "sequence", "trigger",
+    "procedure", "function", "unique", "temporary", "temp", "or"
+  };
+  auto object = rest.find_first_not_of(" \t\r\n");
+  for(auto entry : objects){
+    auto length = std::strlen(entry);
+    if(object != std::string::npos && rest.compare(object, length, entry) == 0 &&
+        (object + length == rest.length() ||
+         IsSourceIdentifierCharacter(rest[object + length]) == false)){
+      return true;
+    }
+  }
+  return false;
+}
+
+// LITERAL SCANNER
+
+class LiteralScanner {
+
+ public:
+
+  LiteralScanner(const char* source,
+                 const std::size_t length,
+                 const SourceLanguage language)
+   : source_(source),
+     length_(length),
+     language_(language),
+     pos_(0),
+     line_(1) {
+  }
+
+  void Scan(std::vector<ExtractedStatement>& statements){
+
+    while(pos_ < length_){
+      char c = source_[pos_];
+
+      if(c == '\n'){
+        line_++;
+        pos_++;
+        continue;
+      }
+      if(SkipComment()){
+        continue;
+      }
+
+      if(IsLiteralStart()){
+        ExtractedStatement statement;
+        ReadConcatenatedLiterals(statement);
+        if(LooksLikeSql(statement.sql)){
+          statements.push_back(std::move(statement));
+        }
+        continue;
+      }
+
+      // Character literals (and C++14 digit separators)
+      if(c == '\'' && language_ != SOURCE_LANGUAGE_PYTHON){
+        bool separator = language_ == SOURCE_LANGUAGE_CPP && pos_ > 0 &&
+            std::isalnum(static_cast<unsigned char>(source_[pos_ - 1]));
+        pos_++;
+        if(separator == false){
+          while(pos_ < length_ && source_[pos_] != '\'' && source_[pos_] != '\n'){
+            pos_ += (source_[pos_] == '\\') ? 2 : 1;
+          }
+          pos_++;
+        }
+        continue;
+      }
+
+      // Identifiers (so that string prefixes are only seen at their start)
+      if(IsSourceIdentifierCharacter(c)){
+        while(pos_ < length_ && IsSourceIdentifierCharacter(source_[pos_])){
+          pos_++;
+        }
+        continue;
+      }
+
+      pos_++;
+    }
+
+  }
+
+ private:
+
+  char Peek(const std::size_t offset = 0) const {
+    return (pos_ + offset < length_) ? source_[pos_ + offset] : '\0';
+  }
+
+  bool SkipComment(){
+
+    if(language_ == SOURCE_LANGUAGE_PYTHON){
+      if(Peek() != '#'){
+        return false;
+      }
+      while(pos_ < length_ && source_[pos_] != '\n'){
+        pos_++;
+      }
+      return true;
+    }
+
+    if(Peek() == '/' && Peek(1) == '/'){
+      while(pos_ < length_ && source_[pos_] != '\n'){
+        pos_++;
+      }
+      return true;
+    }
+    if(Peek() == '/' && Peek(1) == '*'){
+      pos_ += 2;
+      while(pos_ < length_ && (source_[pos_] != '*' || Peek(1) != '/')){
+        line_ += (source_[pos_] == '\n') ? 1 : 0;
+        pos_++;
+      }
+      pos_ = std::min(pos_ + 2, length_);
+      return true;
+    }
+    return false;
+  }
+
+  // Length of the string prefix at pos (-1 if there is no literal)
+  int GetPrefixLength(bool& raw) const {
+
+    raw = false;
+    int prefix = 0;
+    while(prefix < 3 && std::isalnum(static_cast<unsigned char>(Peek(prefix)))){
+      prefix++;
+    }
+    // the prefix must not be the tail of an identifier
+    if(prefix > 0 && pos_ > 0 && IsSourceIdentifierCharacter(source_[pos_ - 1])){
+      return -1;
+    }
+
+    char quote = Peek(prefix);
+    std::string letters(source_ + pos_, prefix);
+    switch(language_){
+      case SOURCE_LANGUAGE_CPP:
+        if(quote != '"'){
+          return -1;
+        }
+        if(letters.empty() || letters == "L" || letters == "u" ||
+            letters == "U" || letters == "u8"){
+          return prefix;
+        }
+        if(letters == "R" || letters == "LR" || letters == "uR" ||
+            letters == "UR" || letters == "u8R"){
+          raw = true;
+          return prefix;
+        }
+        return -1;
+
+      case SOURCE_LANGUAGE_PYTHON: {
+        if(quote != '"' && quote != '\''){
+          return -1;
+        }
+        if(prefix > 2){
+          return -1;
+        }
+        for(auto letter : letters){
+          letter = std::tolower(static_cast<unsigned char>(letter));
+          if(letter != 'r' && letter != 'b' && letter != 'u' && letter != 'f'){
+            return -1;
+          }
+          raw = raw || letter == 'r';
+        }
+        return prefix;
+      }
+
+      case SOURCE_LANGUAGE_GO:
+        if(prefix == 0 && quote == '`'){
+          raw = true;
+          return 0;
+        }
+        return (prefix == 0 && quote == '"') ? 0 : -1;
+
+      case SOURCE_LANGUAGE_JAVA:
+      default:
+        return (prefix == 0 && quote == '"') ? 0 : -1;
+    }
+  }
+
+  bool IsLiteralStart() const {
+    bool raw;
+    return GetPrefixLength(raw) >= 0;
+  }
+
+  void AppendCharacter(ExtractedStatement& statement, const char c){
+    statement.sql += c;
+    if(c == '\n'){
+      line_++;
+      statement.lines.emplace_back(statement.sql.length(), line_);
+    }
+  }
+
+  // Decode an escape sequence at pos (after the backslash)
+  void ReadEscape(ExtractedStatement& statement){
+    char c = Peek();
+    pos_++;
+    switch(c){
+      case 'n': statement.sql += '\n'; break;
+      case 't': statement.sql += '\t'; break;
+      case 'r': statement.sql += '\r'; break;
+      case '0': statement.sql += ' '; break;
+      case '\n':
+        // line continuation
+        line_++;
+        statement.lines.emplace_back(statement.sql.length(), line_);
+        break;
+      default: statement.sql += c; break;
+    }
+  }
+
+  // Read one literal at pos into the statement
+  void ReadLiteral(ExtractedStatement& statement){
+
+    bool raw;
+    int prefix = GetPrefixLength(raw);
+    bool format = false;
+    for(int letter = 0; letter < prefix; letter++){
+      format = format || std::tolower(static_cast<unsigned char>(Peek(letter))) == 'f';
+    }
+    pos_ += prefix;
+    statement.lines.emplace_back(statement.sql.length(), line_);
+
+    char quote = Peek();
+
+    // C++ raw string: R"delimiter( ... )delimiter"
+    if(language_ == SOURCE_LANGUAGE_CPP && raw == true){
+      auto open = pos_ + 1;
+      while(pos_ < length_ && source_[pos_] != '('){
+        pos_++;
+      }
+      std::string terminator = ")" + std::string(source_ + open, pos_ - open) + "\"";
+      pos_++;
+      while(pos_ < length_ &&
+          std::strncmp(source_ + pos_, terminator.c_str(),
+                       std::min(terminator.length(), length_ - pos_)) != 0){
+        AppendCharacter(statement, source_[pos_]);
+        pos_++;
+      }
+      pos_ = std::min(pos_ + terminator.length(), length_);
+      return;
+    }
+
+    // Triple-quoted strings (Python and Java text blocks)
+    bool triple = (language_ == SOURCE_LANGUAGE_PYTHON ||
+                   language_ == SOURCE_LANGUAGE_JAVA) &&
+        Peek(1) == quote && Peek(2) == quote;
+    if(triple == true){
+      pos_ += 3;
+      while(pos_ < length_ && (source_[pos_] != quote || Peek(1) != quote ||
+          Peek(2) != quote)){
+        if(source_[pos_] == '\\' && raw == false){
+          pos_++;
+          ReadEscape(statement);
+          continue;
+        }
+        ReadCharacter(statement, format);
+      }
+      pos_ = std::min(pos_ + 3, length_);
+      return;
+    }
+
+    // Go raw string
+    if(quote == '`'){
+      pos_++;
+      while(pos_ < length_ && source_[pos_] != '`'){
+        AppendCharacter(statement, source_[pos_]);
+        pos_++;
+      }
+      pos_ = std::min(pos_ + 1, length_);
+      return;
+    }
+
+    // Single-line string
+    pos_++;
+    while(pos_ < length_ && source_[pos_] != quote && source_[pos_] != '\n'){
+      if(source_[pos_] == '\\'){
+        pos_++;
+        if(raw == true){
+          // a raw string keeps the backslash (and the quote after it)
+          statement.sql += '\\';
+          if(pos_ < length_ && source_[pos_] != '\n'){
+            statement.sql += source_[pos_++];
+          }
+          continue;
+        }
+        ReadEscape(statement);
+        continue;
+      }
+      ReadCharacter(statement, format);
+    }
+    if(pos_ < length_ && source_[pos_] == quote){
+      pos_++;
+    }
+
+  }
+
+  // Read a literal character (format fields become placeholders)
+  void ReadCharacter(ExtractedStatement& statement, const bool format){
+    char c = source_[pos_];
+    if(format == true && c == '{'){
+      if(Peek(1) == '{'){
+        statement.sql += '{';
+        pos_ += 2;
+        return;
+      }
+      std::size_t depth = 0;
+      while(pos_ < length_){
+        depth += (source_[pos_] == '{') ? 1 : 0;
+        depth -= (source_[pos_] == '}') ? 1 : 0;
+        line_ += (source_[pos_] == '\n') ? 1 : 0;
+        pos_++;
+        if(depth == 0){
+          break;
+        }
+      }
+      statement.sql += '?';
+      return;
+    }
+    if(format == true && c == '}' && Peek(1) == '}'){
+      statement.sql += '}';
+      pos_ += 2;
+      return;
+    }
+    AppendCharacter(statement, c);
+    pos_++;
+  }
+
+  // Skip whitespace, newlines and comments
+  void SkipSpace(){
+    while(pos_ < length_){
+      char c = source_[pos_];
+      if(c == '\n'){
+        line_++;
+        pos_++;
+      }
+      else if(std::isspace(static_cast<unsigned char>(c))){
+        pos_++;
+      }
+      else if(c == '\\' && language_ == SOURCE_LANGUAGE_PYTHON && Peek(1) == '\n'){
+        pos_++;
+      }
+      else if(SkipComment() == false){
+        return;
+      }
+    }
+  }
+
+  // Skip a simple expression like name, obj.field or call(a, b)
+  bool SkipExpression(){
+    auto begin = pos_;
+    while(pos_ < length_){
+      char c = source_[pos_];
+      if(IsSourceIdentifierCharacter(c) || c == '.'){
+        pos_++;
+      }
+      else if(c == '(' || c == '['){
+        std::size_t depth = 0;
+        while(pos_ < length_){
+          char d = source_[pos_];
+          if(d == '\n' || d == '"' || d == '\''){
+            return false;
+          }
+          depth += (d == '(' || d == '[') ? 1 : 0;
+          depth -= (d == ')' || d == ']') ? 1 : 0;
+          pos_++;
+          if(depth == 0){
+            break;
+          }
+        }
+      }
+      else {
+        break;
+      }
+    }
+    return pos_ > begin;
+  }
+
+  // Read a literal and the literals concatenated with it
+  void ReadConcatenatedLiterals(ExtractedStatement& statement){
+
+    ReadLiteral(statement);
+
+    bool adjacent = language_ == SOURCE_LANGUAGE_CPP ||
+        language_ == SOURCE_LANGUAGE_PYTHON;
+    while(pos_ < length_){
+      auto saved_pos = pos_;
+      auto saved_line = line_;
+      SkipSpace();
+
+      // "a" "b"
+      if(adjacent == true && IsLiteralStart()){
+        ReadLiteral(statement);
+        continue;
+      }
+
+      // "a" + "b" and "a" + value + "b"
+      if(Peek() == '+'){
+        pos_++;
+        SkipSpace();
+        if(IsLiteralStart()){
+          ReadLiteral(statement);
+          continue;
+        }
+        if(SkipExpression()){
+          SkipSpace();
+          if(Peek() == '+'){
+            pos_++;
+            SkipSpace();
+            if(IsLiteralStart()){
+              statement.sql += '?';
+              ReadLiteral(statement);
+              continue;
+            }
+          }
+        }
+      }
+
+      pos_ = saved_pos;
+      line_ = saved_line;
+      return;
+    }
+
+  }
+
+  const char* source_;
+
+  std::size_t length_;
+
+  SourceLanguage language_;
+
+  std::size_t pos_;
+
+  std::uint32_t line_;
+
+};
+
+void ExtractSql(const char* source,
+                const std::size_t length,
+                const SourceLanguage language,
+                std::vector<ExtractedStatement>& statements){
+
+  if(source == nullptr || language == SOURCE_LANGUAGE_UNKNOWN){
+    return;
+  }
+
+  LiteralScanner scanner(source, length, language);
+  scanner.Scan(statements);
+}
+
+// CHECKING
+
+// Findings of a source file
+struct SourceFindings {
+
+  std::vector<ExtractedStatement> statements;
+
+  // findings per statement
+  std::vector<std::vector<Finding>> findings;
+
+};
+
+bool CheckSourceTree(Configuration& state,
+                     const std::string& root,
+                     std::ostream& output){
+
+  state.run_stats.Start();
+
+  // Collect the source files
+  std::vector<std::string> paths;
+  struct stat info;
+  if(stat(root.c_str(), &info) == 0 && S_ISREG(info.st_mode)){
+    paths.push_back(root);
+  }
+  else {
+    WalkDirectory(root, [&paths](const std::string& path){
+      if(GetSourceLanguage(path) != SOURCE_LANGUAGE_UNKNOWN){
+        paths.push_back(path);
+      }
+    });
+  }
+
+  // Extract and check the files in parallel
+  std::vector<SourceFindings> results(paths.size());
+  std::vector<std::unique_ptr<Configuration>> worker_states;
+  {
+    WorkerPool pool(state.num_workers);
+    for(std::size_t worker_id = 0; worker_id < pool.GetWorkerCount(); worker_id++){
+      worker_states.emplace_back(new Configuration());
+      CopyOptions(state, *worker_states.back());
+      worker_states.back()->collect_findings = true;
+      worker_states.back()->sample_mode = SAMPLE_MODE_NONE;
+    }
+
+    for(std::size_t id = 0; id < paths.size(); id++){
+      pool.Submit([&paths, &results, &worker_states, id](std::size_t worker_id){
+        MappedFile file(paths[id]);
+        if(file.IsValid() == false){
+          return;
+        }
+
+        auto& result = results[id];
+        {
+          TraceSpan span("extract", "source");
+          ExtractSql(file.GetData(), file.GetSize(), GetSourceLanguage(paths[id]),
+                     result.statements);
+        }
+
+        TraceSpan span("batch", "checker");
+        Configuration& worker_state = *worker_states[worker_id];
+        worker_state.file_name = paths[id];
+        for(auto& statement : result.statements){
+          auto first_statement = worker_state.run_stats.statements;
+          CheckText(worker_state, statement.sql);
+          result.findings.push_back(std::move(worker_state.findings));
+          worker_state.findings.clear();
+
+          // Map the slow statements of the literal to source lines
+          for(auto& slow_statement : worker_state.run_stats.slowest.GetEntries()){
+            if(slow_statement.sequence >= first_statement){
+              slow_statement.line_number = statement.GetLineNumber(slow_statement.offset);
+            }
+          }
+        }
+      });
+    }
+
+    // Pool destructor waits for the queued files
+  }
+
+  for(auto& worker_state : worker_states){
+    for(int risk_level = RISK_LEVEL_ALL; risk_level <= RISK_LEVEL_HIGH; risk_level++){
+      state.checker_stats[risk_level] += worker_state->checker_stats[risk_level];
+    }
+    state.profile_stats.Merge(worker_state->profile_stats);
+    state.run_stats.Merge(worker_state->run_stats);
+  }
+  state.run_stats.Stop();
+
+  // Print the findings in path order
+  ColorModifier red(ColorCode::FG_RED, state.color_mode, true);
+  ColorModifier green(ColorCode::FG_GREEN, state.color_mode, true);
+  ColorModifier blue(ColorCode::FG_BLUE, state.color_mode, true);
+  ColorModifier regular(ColorCode::FG_DEFAULT, state.color_mode, false);
+
+  std::uint64_t statement_count = 0;
+  output << "==================== Results ===================\n";
+  TraceSpan span("output", "output");
+  for(std::size_t id = 0; id < paths.size(); id++){
+    auto& result = results[id];
+    statement_count += result.statements.size();
+    for(std::size_t statement_id = 0; statement_id < result.statements.size(); statement_id++){
+      auto& statement = result.statements[statement_id];
+      auto& findings = result.findings[statement_id];
+      if(findings.empty()){
+        continue;
+      }
+
+      output << "\n-------------------------------------------------\n";
+      output << "SQL Statement at " << paths[id] << ":" << statement.GetLineNumber(0)
+             << ": " << red << WrapText(statement.sql) << regular << "\n";
+      for(auto& finding : findings){
+        output << "[" << paths[id] << ":" << statement.GetLineNumber(finding.begin)
+               << "]: (" << green << RiskLevelToString(finding.risk_level) << regular
+               << ") ";
+        if(state.color_mode == false){
+          output << "(" << PatternTypeToString(finding.pattern_type) << ") ";
+        }
+        output << blue << finding.title << regular << "\n";
+      }
+    }
+  }
+
+  output << "\n==================== Summary ===================\n";
+  output << "Source Files                 :: " << paths.size() << "\n";
+  output << "SQL Literals                 :: " << statement_count << "\n";
+  bool has_issues = (state.checker_stats[RISK_LEVEL_ALL] != 0);
+  if(has_issues == false){
+    output << "No issues found.\n";
+  }
+  else {
+    output << "All Anti-Patterns and Hints  :: " << state.checker_stats[RISK_LEVEL_ALL] << "\n";
+    output << ">  High Risk   :: " << state.checker_stats[RISK_LEVEL_HIGH] << "\n";
+    output << ">  Medium Risk :: " << state.checker_stats[RISK_LEVEL_MEDIUM] << "\n";
+    output << ">  Low Risk    :: " << state.checker_stats[RISK_LEVEL_LOW] << "\n";
+    output << ">  Hints       :: " << state.checker_stats[RISK_LEVEL_NONE] << "\n";
+  }
+
+  PrintSkippedChecks(state.run_stats, output);
+
+  // Print the throughput and resource usage
+  if(state.stats == true){
+    PrintRunStats(state.run_stats, output);
+  }
+  PrintSlowestStatements(state.run_stats, output);
+
+  // Print the cost of every rule and stage
+  if(state.profile == true){
+    PrintProfile(state.profile_stats, output);
+  }
+
+  return has_issues;
+}
+
+}  // namespace sqlcheck
@@ -0,0 +1,121 @@
+// FILE WALKER SOURCE
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "include/file_walker.h"
+
+namespace sqlcheck {
+
+void WalkDirectory(const std::string& root,
+                   const std::function<void(const std::string& path)>& on_file,
+                   const std::function<void(const std::string& path)>& on_directory){
+
+  DIR* directory = opendir(root.c_str());
+  if(directory == nullptr){
+    return;
+  }
+
+  if(on_directory){
+    on_directory(root);
+  }
+
+  std::vector<std::string> entries;
+  while(dirent* entry = readdir(directory)){
+    std::string name = entry->d_name;
+    if(name == "." || name == ".."){
+      continue;
+    }
+    entries.push_back(name);
+  }
+  closedir(directory);
+
+  std::sort(entries.begin(), entries.end());
+
+  for(auto& name : entries){
+    auto path = (root.empty() == false && root.back() == '/') ? root + name : root + "/" + name;
+
+    struct stat info;
+    if(lstat(path.c_str(), &info) != 0){
+      continue;
+    }
+    if(S_ISDIR(info.st_mode)){
+      WalkDirectory(path, on_file, on_directory);
+    }
+    else if(S_ISREG(info.st_mode)){
+      on_file(path);
+    }
+  }
+
+}
+
+bool ReadFile(const std::string& path, std::string& contents){
+
+  std::ifstream file(path.c_str(), std::ios::in | std::ios::binary);
+  if(file.is_open() == false){
+    return false;
+  }
+
+  std::ostringstream buffer;
+  buffer << file.rdbuf();
+  contents = buffer.str();
+  return true;
+}
+
+bool HasExtension(const std::string& path, const std::string& extension){
+
+  if(path.length() < extension.length()){
+    return false;
+  }
+
+  return std::equal(extension.rbegin(), extension.rend(), path.rbegin(),
+                    [](char a, char b){ return ::tolower(a) == ::tolower(b); });
+}
+
+MappedFile::MappedFile(const std::string& path)
+ : data_(nullptr),
+   size_(0),
+   valid_(false) {
+
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if(fd < 0){
+    return;
+  }
+
+  struct stat info;
+  if(fstat(fd, &info) != 0 || S_ISREG(info.st_mode) == false){
+    close(fd);
+    return;
+  }
+
+  size_ = info.st_size;
+  if(size_ > 0){
+    void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if(data == MAP_FAILED){
+      close(fd);
+      size_ = 0;
+      return;
+    }
+    madvise(data, size_, MADV_SEQUENTIAL);
+    data_ = static_cast<const char*>(data);
+  }
+
+  close(fd);
+  valid_ = true;
+}
+
+MappedFile::~MappedFile(){
+  if(data_ != nullptr){
+    munmap(const_cast<char*>(data_), size_);
+  }
+}
+
+}  // namespace sqlcheck
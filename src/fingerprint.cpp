@@ -0,0 +1,135 @@
+// FINGERPRINT SOURCE
+
+#include <cctype>
+
+#include "include/fingerprint.h"
+
+namespace sqlcheck {
+
+bool IsWordCharacter(const char c){
+  return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '$';
+}
+
+// Collapse a list of placeholders like "?, ?, ?" into a single "?"
+void CollapsePlaceholders(std::string& fingerprint){
+
+  auto length = fingerprint.length();
+  if(length < 3 || fingerprint[length - 1] != '?'){
+    return;
+  }
+
+  size_t pos = length - 1;
+  while(pos > 0 && fingerprint[pos - 1] == ' '){
+    pos--;
+  }
+  if(pos == 0 || fingerprint[pos - 1] != ','){
+    return;
+  }
+  pos--;
+  while(pos > 0 && fingerprint[pos - 1] == ' '){
+    pos--;
+  }
+  if(pos == 0 || fingerprint[pos - 1] != '?'){
+    return;
+  }
+
+  fingerprint.erase(pos);
+}
+
+std::string GetFingerprint(const std::string& sql_statement){
+
+  std::string fingerprint;
+  fingerprint.reserve(sql_statement.length());
+
+  size_t length = sql_statement.length();
+  size_t pos = 0;
+  bool pending_space = false;
+
+  while(pos < length){
+    char c = sql_statement[pos];
+
+    // WHITESPACE
+    if(std::isspace(static_cast<unsigned char>(c))){
+      pending_space = true;
+      pos++;
+      continue;
+    }
+
+    // LINE COMMENT
+    if(c == '-' && pos + 1 < length && sql_statement[pos + 1] == '-'){
+      while(pos < length && sql_statement[pos] != '\n'){
+        pos++;
+      }
+      pending_space = true;
+      continue;
+    }
+
+    // BLOCK COMMENT
+    if(c == '/' && pos + 1 < length && sql_statement[pos + 1] == '*'){
+      auto end = sql_statement.find("*/", pos + 2);
+      pos = (end == std::string::npos) ? length : end + 2;
+      pending_space = true;
+      continue;
+    }
+
+    if(pending_space == true && fingerprint.empty() == false){
+      fingerprint += ' ';
+    }
+    pending_space = false;
+
+    // STRING LITERAL
+    if(c == '\''){
+      pos++;
+      while(pos < length){
+        if(sql_statement[pos] == '\\' && pos + 1 < length){
+          pos += 2;
+          continue;
+        }
+        if(sql_statement[pos] == '\''){
+          if(pos + 1 < length && sql_statement[pos + 1] == '\''){
+            pos += 2;
+            continue;
+          }
+          break;
+        }
+        pos++;
+      }
+      pos++;
+      fingerprint += '?';
+      CollapsePlaceholders(fingerprint);
+      continue;
+    }
+
+    // NUMERIC LITERAL
+    bool word_before = (fingerprint.empty() == false &&
+        IsWordCharacter(fingerprint.back()));
+    if(std::isdigit(static_cast<unsigned char>(c)) && word_before == false){
+      while(pos < length &&
+          (IsWordCharacter(sql_statement[pos]) || sql_statement[pos] == '.')){
+        pos++;
+      }
+      fingerprint += '?';
+      CollapsePlaceholders(fingerprint);
+      continue;
+    }
+
+    fingerprint += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    pos++;
+  }
+
+  return fingerprint;
+}
+
+std::uint64_t HashString(const std::string& text,
+                         const std::uint64_t seed){
+
+  std::uint64_t hash = seed;
+  for(auto c : text){
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ULL;
+  }
+
+  return hash;
+}
+
+}  // namespace sqlcheck
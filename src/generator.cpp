@@ -0,0 +1,588 @@
+// GENERATOR SOURCE
+
+#include <algorithm>
+#include <cstring>
+
+#include "include/generator.h"
+
+namespace sqlcheck {
+
+// VOCABULARY
+//
+// Names and values are chosen so that no rule flags them: no digits after
+// letters in DDL, no NULL, no IN lists, no LIKE, OR, HAVING or DISTINCT,
+// and no join condition without an equality.
+
+struct ColumnTemplate {
+
+  const char* name;
+
+  const char* type;
+
+};
+
+struct TableTemplate {
+
+  const char* name;
+
+  const char* alias;
+
+  const char* key;
+
+  ColumnTemplate columns[4];
+
+};
+
+const TableTemplate tables[] = {
+  {"bugs", "b", "bug_key", {{"summary", "VARCHAR(80)"}, {"status", "VARCHAR(20)"},
+                            {"priority", "INTEGER"}, {"reported_on", "DATE"}}},
+  {"accounts", "a", "account_key", {{"first_name", "VARCHAR(40)"}, {"last_name", "VARCHAR(40)"},
+                                    {"email", "VARCHAR(80)"}, {"created_on", "DATE"}}},
+  {"products", "p", "product_key", {{"title", "VARCHAR(80)"}, {"category", "VARCHAR(40)"},
+                                    {"price", "NUMERIC(12,2)"}, {"stock", "INTEGER"}}},
+  {"comments", "c", "comment_key", {{"author", "VARCHAR(40)"}, {"body", "VARCHAR(400)"},
+                                    {"posted_on", "DATE"}, {"score", "INTEGER"}}},
+  {"orders", "o", "order_key", {{"customer", "VARCHAR(40)"}, {"amount", "NUMERIC(12,2)"},
+                                {"placed_on", "DATE"}, {"state", "VARCHAR(20)"}}},
+  {"invoices", "i", "invoice_key", {{"total", "NUMERIC(12,2)"}, {"currency", "VARCHAR(3)"},
+                                    {"issued_on", "DATE"}, {"due_on", "DATE"}}},
+  {"shipments", "s", "shipment_key", {{"carrier", "VARCHAR(40)"}, {"weight", "NUMERIC(12,2)"},
+                                      {"shipped_on", "DATE"}, {"region", "VARCHAR(20)"}}},
+  {"vendors", "v", "vendor_key", {{"name", "VARCHAR(80)"}, {"country", "VARCHAR(40)"},
+                                  {"rating", "INTEGER"}, {"contact", "VARCHAR(80)"}}}
+};
+
+const std::size_t table_count = sizeof(tables) / sizeof(tables[0]);
+
+const char* table_suffixes[] = {"", "_archive", "_history", "_staging"};
+
+const char* words[] = {
+  "open", "closed", "pending", "shipped", "draft", "alice", "bob", "carol",
+  "dave", "erin", "berlin", "paris", "tokyo", "lima", "books", "garden"
+};
+
+const char* lorem[] = {
+  "lorem", "ipsum", "dolor", "sit", "amet", "consectetur", "adipiscing",
+  "elit", "sed", "do", "eiusmod", "tempor", "incididunt", "ut", "labore",
+  "et", "dolore", "magna", "aliqua", "enim", "ad", "minim", "veniam",
+  "quis", "nostrud", "exercitation", "ullamco", "laboris", "nisi"
+};
+
+// Anti-patterns that can be injected into every kind of statement
+const char* ddl_rules[] = {
+  "1001", "1002", "1004", "1006", "1007", "2001", "2002", "2003", "2004",
+  "2005", "3003", "4001"
+};
+
+const char* oltp_rules[] = {
+  "3001", "3002", "3004", "3006", "3011", "3015", "3016", "3017", "4001"
+};
+
+// Statements at least this long are spaghetti queries (see CheckSpaghettiQuery)
+const std::size_t spaghetti_query_char_count = 500;
+
+// UTILITY
+
+std::string StatementKindToString(const StatementKind& kind){
+
+  switch (kind) {
+    case STATEMENT_KIND_DDL:
+      return "ddl";
+    case STATEMENT_KIND_OLTP:
+      return "oltp";
+    case STATEMENT_KIND_ANALYTIC:
+      return "analytic";
+    case STATEMENT_KIND_BULK_INSERT:
+      return "bulk_insert";
+    case STATEMENT_KIND_PATHOLOGICAL:
+      return "pathological";
+
+    case STATEMENT_KIND_COUNT:
+    default:
+      return "INVALID";
+  }
+
+}
+
+// Length of the statement after NormalizeStatement
+std::size_t GetNormalizedLength(const std::string& sql){
+
+  std::size_t length = 0;
+  std::size_t spaces = 0;
+  for(auto c : sql){
+    if(c == ' '){
+      spaces++;
+      continue;
+    }
+    if(spaces > 0 && length > 0){
+      length++;
+    }
+    spaces = 0;
+    length++;
+  }
+  return length;
+}
+
+bool IsRule(const char* rule, const char* id){
+  return rule != nullptr && std::strcmp(rule, id) == 0;
+}
+
+// GENERATOR
+
+CorpusGenerator::CorpusGenerator(const CorpusOptions& options)
+ : options_(options),
+   random_(options.seed),
+   total_weight_(0),
+   next_key_(1) {
+
+  for(auto weight : options_.weights){
+    total_weight_ += weight;
+  }
+
+}
+
+// std::uniform_int_distribution differs between standard libraries,
+// so the corpus is derived from the raw engine output
+std::uint64_t CorpusGenerator::Uniform(const std::uint64_t bound){
+  return random_() % bound;
+}
+
+bool CorpusGenerator::Chance(const double probability){
+  return static_cast<double>(random_() >> 11) / 9007199254740992.0 < probability;
+}
+
+StatementKind CorpusGenerator::PickKind(){
+
+  if(total_weight_ == 0){
+    return STATEMENT_KIND_OLTP;
+  }
+
+  auto pick = Uniform(total_weight_);
+  for(int kind = 0; kind < STATEMENT_KIND_COUNT; kind++){
+    if(pick < options_.weights[kind]){
+      return static_cast<StatementKind>(kind);
+    }
+    pick -= options_.weights[kind];
+  }
+  return STATEMENT_KIND_OLTP;
+}
+
+std::string CorpusGenerator::PickWord(){
+  return words[Uniform(sizeof(words) / sizeof(words[0]))];
+}
+
+std::string CorpusGenerator::PickValue(const std::string& type){
+
+  if(type == "INTEGER"){
+    return std::to_string(Uniform(1000));
+  }
+  if(type == "NUMERIC(12,2)"){
+    return std::to_string(1 + Uniform(9999)) + "." + std::to_string(10 + Uniform(90));
+  }
+  if(type == "DATE"){
+    return "'2024-" + std::to_string(10 + Uniform(3)) + "-" + std::to_string(10 + Uniform(19)) + "'";
+  }
+  return "'" + PickWord() + "'";
+}
+
+void CorpusGenerator::Next(CorpusStatement& statement){
+
+  statement.sql.clear();
+  statement.rules.clear();
+  statement.kind = PickKind();
+
+  switch (statement.kind) {
+    case STATEMENT_KIND_DDL:
+      GenerateDDL(statement, Chance(options_.density));
+      break;
+    case STATEMENT_KIND_ANALYTIC:
+      GenerateAnalytic(statement);
+      break;
+    case STATEMENT_KIND_BULK_INSERT:
+      GenerateBulkInsert(statement, Chance(options_.density));
+      break;
+    case STATEMENT_KIND_PATHOLOGICAL:
+      GeneratePathological(statement);
+      break;
+
+    case STATEMENT_KIND_OLTP:
+    case STATEMENT_KIND_COUNT:
+    default:
+      GenerateOLTP(statement, Chance(options_.density));
+      break;
+  }
+
+  // Long statements of any kind are spaghetti queries
+  if(GetNormalizedLength(statement.sql) >= spaghetti_query_char_count){
+    statement.rules.push_back("3008");
+  }
+
+  std::sort(statement.rules.begin(), statement.rules.end());
+  statement.rules.erase(std::unique(statement.rules.begin(), statement.rules.end()),
+                        statement.rules.end());
+}
+
+void CorpusGenerator::GenerateDDL(CorpusStatement& statement,
+                                  const bool inject){
+
+  auto& table = tables[Uniform(table_count)];
+  std::string name = std::string(table.name) + table_suffixes[Uniform(4)];
+  const char* rule = inject ? ddl_rules[Uniform(sizeof(ddl_rules) / sizeof(ddl_rules[0]))] : nullptr;
+  auto& sql = statement.sql;
+
+  if(IsRule(rule, "2005")){
+    std::string column = table.columns[Uniform(4)].name;
+    sql = "CREATE INDEX " + name + "_" + column + "_idx ON " + name + " (" + column + ")";
+    statement.rules.push_back(rule);
+    return;
+  }
+
+  if(IsRule(rule, "1006")){
+    name = std::string(table.name) + "_attributes";
+  }
+
+  sql = "CREATE TABLE " + name + " (\n  ";
+  sql += IsRule(rule, "1004") ? "id" : table.key;
+  sql += " INTEGER PRIMARY KEY";
+  for(auto& column : table.columns){
+    sql += ",\n  ";
+    sql += column.name;
+    sql += " ";
+    sql += column.type;
+  }
+
+  if(IsRule(rule, "1001")){
+    sql += ",\n  tag_id VARCHAR(255)";
+  }
+  else if(IsRule(rule, "1002")){
+    sql += ",\n  parent_key INTEGER REFERENCES " + name + " (" + table.key + ")";
+  }
+  else if(IsRule(rule, "1007")){
+    sql += ",\n  tag1 VARCHAR(20),\n  tag2 VARCHAR(20),\n  tag3 VARCHAR(20)";
+  }
+  else if(IsRule(rule, "2001")){
+    sql += ",\n  ratio FLOAT";
+  }
+  else if(IsRule(rule, "2002")){
+    sql += ",\n  kind ENUM('open', 'closed')";
+  }
+  else if(IsRule(rule, "2003")){
+    sql += ",\n  file_path VARCHAR(255)";
+  }
+  else if(IsRule(rule, "2004")){
+    for(auto& column : table.columns){
+      sql += ",\n  INDEX (";
+      sql += column.name;
+      sql += ")";
+    }
+  }
+  else if(IsRule(rule, "3003")){
+    sql += ",\n  note VARCHAR(80) NOT NULL";
+    statement.rules.push_back("3002");
+  }
+  else if(IsRule(rule, "4001")){
+    sql += ",\n  password VARCHAR(64)";
+  }
+  sql += "\n)";
+
+  if(rule != nullptr){
+    statement.rules.push_back(rule);
+  }
+}
+
+void CorpusGenerator::GenerateOLTP(CorpusStatement& statement,
+                                   const bool inject){
+
+  auto first = Uniform(table_count);
+  auto second = (first + 1 + Uniform(table_count - 1)) % table_count;
+  auto& x = tables[first];
+  auto& y = tables[second];
+  const char* rule = inject ? oltp_rules[Uniform(sizeof(oltp_rules) / sizeof(oltp_rules[0]))] : nullptr;
+
+  std::string xa = x.alias;
+  std::string ya = y.alias;
+  std::string c1 = x.columns[Uniform(4)].name;
+  std::string c2 = x.columns[Uniform(4)].name;
+  std::string yc = y.columns[Uniform(4)].name;
+  std::string key = std::to_string(Uniform(1000000));
+  std::string from = std::string(" FROM ") + x.name + " " + xa;
+  std::string where = " WHERE " + xa + "." + x.key + " = " + key;
+  std::string join = std::string(" JOIN ") + y.name + " " + ya + " ON " +
+      xa + "." + y.key + (IsRule(rule, "3017") ? " > " : " = ") + ya + "." + y.key;
+  auto& sql = statement.sql;
+
+  if(rule != nullptr){
+    statement.rules.push_back(rule);
+  }
+
+  // Injected anti-patterns
+  if(IsRule(rule, "3001")){
+    sql = "SELECT *" + from + where;
+    return;
+  }
+  if(IsRule(rule, "3002")){
+    sql = "SELECT " + xa + "." + c1 + from + " WHERE " + xa + "." + c2 + " IS NULL";
+    return;
+  }
+  if(IsRule(rule, "3004")){
+    sql = "SELECT " + xa + "." + c1 + " || ' ' || " + xa + "." + c2 + from + where;
+    return;
+  }
+  if(IsRule(rule, "3006")){
+    sql = "SELECT " + xa + "." + c1 + from + " ORDER BY RAND() LIMIT 1";
+    return;
+  }
+  if(IsRule(rule, "3015")){
+    sql = "SELECT " + xa + "." + c1 + from + where + " UNION SELECT " + ya + "." + yc +
+        " FROM " + y.name + " " + ya + " WHERE " + ya + "." + y.key + " = " + key;
+    return;
+  }
+  if(IsRule(rule, "3016")){
+    sql = "SELECT DISTINCT " + xa + "." + c1 + from + join + where;
+    return;
+  }
+  if(IsRule(rule, "3017")){
+    sql = "SELECT " + xa + "." + c1 + ", " + ya + "." + yc + from + join + where;
+    return;
+  }
+  if(IsRule(rule, "4001")){
+    sql = "SELECT account_key FROM accounts WHERE email = '" + PickWord() +
+        "@example.com' AND password = '" + PickWord() + "'";
+    return;
+  }
+
+  auto shape = IsRule(rule, "3011") ? 4 : Uniform(5);
+  switch (shape) {
+    case 0:
+      sql = "SELECT " + xa + "." + c1 + ", " + xa + "." + c2 + from + where;
+      break;
+    case 1:
+      sql = "SELECT " + xa + "." + c1 + ", " + ya + "." + yc + from + join + where +
+          " ORDER BY " + ya + "." + yc + " DESC LIMIT 20";
+      break;
+    case 2:
+      sql = std::string("UPDATE ") + x.name + " SET " + x.columns[0].name + " = " +
+          PickValue(x.columns[0].type) + " WHERE " + x.key + " = " + key;
+      break;
+    case 3:
+      sql = std::string("DELETE FROM ") + x.name + " WHERE " + x.key + " = " + key;
+      break;
+    default:
+      sql = std::string("INSERT INTO ") + x.name;
+      if(rule == nullptr){
+        sql += std::string(" (") + x.key;
+        for(auto& column : x.columns){
+          sql += ", ";
+          sql += column.name;
+        }
+        sql += ")";
+      }
+      sql += " VALUES (" + std::to_string(next_key_++);
+      for(auto& column : x.columns){
+        sql += ", " + PickValue(column.type);
+      }
+      sql += ")";
+      break;
+  }
+}
+
+void CorpusGenerator::GenerateAnalytic(CorpusStatement& statement){
+
+  // A fact table joined with up to four others
+  std::vector<std::size_t> joined(1, Uniform(table_count));
+  auto join_count = 2 + Uniform(3);
+  while(joined.size() <= join_count){
+    auto next = Uniform(table_count);
+    if(std::find(joined.begin(), joined.end(), next) == joined.end()){
+      joined.push_back(next);
+    }
+  }
+
+  auto& fact = tables[joined[0]];
+  std::string from = std::string(" FROM ") + fact.name + " " + fact.alias;
+  for(std::size_t i = 1; i < joined.size(); i++){
+    auto& table = tables[joined[i]];
+    from += std::string(" JOIN ") + table.name + " " + table.alias + " ON " +
+        fact.alias + "." + table.key + " = " + table.alias + "." + table.key;
+  }
+
+  std::vector<std::string> groups;
+  for(std::size_t i = 1; i < 3; i++){
+    auto& table = tables[joined[i]];
+    groups.push_back(std::string(table.alias) + "." + table.columns[Uniform(4)].name);
+  }
+
+  std::string group_by = " GROUP BY " + groups[0] + ", " + groups[1];
+  std::string where = " WHERE " + std::string(fact.alias) + "." + fact.key + " > " +
+      std::to_string(Uniform(1000)) + " AND " + fact.alias + "." + fact.columns[2].name +
+      " >= " + PickValue(fact.columns[2].type);
+  std::string order_by = " ORDER BY total_value DESC LIMIT 100";
+
+  static const char* functions[] = {"SUM", "AVG", "MIN", "MAX", "COUNT"};
+  std::string select = "SELECT " + groups[0] + ", " + groups[1] + ", SUM(" +
+      fact.alias + "." + fact.key + ") AS total_value";
+
+  // Add aggregates until the query is a spaghetti query
+  while(select.size() + from.size() + where.size() + group_by.size() + order_by.size() <
+        spaghetti_query_char_count + 20){
+    auto& table = tables[joined[Uniform(joined.size())]];
+    std::string function = functions[Uniform(5)];
+    std::string column = table.columns[Uniform(4)].name;
+    std::string name = function + "_" + column;
+    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+    select += ", " + function + "(" + table.alias + "." + column + ") AS " + name;
+  }
+
+  statement.sql = select + from + where + group_by + order_by;
+  statement.rules.push_back("3005");
+}
+
+void CorpusGenerator::GenerateBulkInsert(CorpusStatement& statement,
+                                         const bool inject){
+
+  auto& table = tables[Uniform(table_count)];
+  auto& sql = statement.sql;
+
+  sql = std::string("INSERT INTO ") + table.name;
+  if(inject == false){
+    sql += std::string(" (") + table.key;
+    for(auto& column : table.columns){
+      sql += ", ";
+      sql += column.name;
+    }
+    sql += ")";
+  }
+  else {
+    statement.rules.push_back("3011");
+  }
+  sql += " VALUES";
+
+  for(std::uint32_t row = 0; row < options_.bulk_rows; row++){
+    sql += (row == 0) ? "\n(" : ",\n(";
+    sql += std::to_string(next_key_++);
+    for(auto& column : table.columns){
+      sql += ", " + PickValue(column.type);
+    }
+    sql += ")";
+  }
+}
+
+void CorpusGenerator::GeneratePathological(CorpusStatement& statement){
+
+  auto& table = tables[Uniform(table_count)];
+  std::string alias = table.alias;
+  std::string column = table.columns[0].name;
+  std::string from = std::string(" FROM ") + table.name + " " + alias;
+  auto& sql = statement.sql;
+
+  auto AddLorem = [this](std::string& text, const std::size_t length,
+                         const char* separator){
+    while(text.size() < length){
+      text += lorem[Uniform(sizeof(lorem) / sizeof(lorem[0]))];
+      text += separator;
+    }
+  };
+
+  switch (Uniform(6)) {
+
+    // Long chain of predicates
+    case 0:
+      sql = "SELECT " + alias + "." + column + from + " WHERE " + alias + "." +
+          table.key + " = " + std::to_string(Uniform(1000));
+      while(sql.size() < 4096){
+        sql += " AND " + alias + "." + table.key + " <> " + std::to_string(Uniform(1000));
+      }
+      break;
+
+    // Deeply nested parentheses
+    case 1:
+      sql = "SELECT " + std::string(256, '(') + alias + "." + table.key +
+          std::string(256, ')') + " AS depth" + from;
+      break;
+
+    // Huge string literal
+    case 2: {
+      std::string text;
+      AddLorem(text, 8192, " ");
+      sql = std::string("INSERT INTO ") + table.name + " (" + table.key + ", " +
+          column + ") VALUES (" + std::to_string(next_key_++) + ", '" + text + "')";
+      break;
+    }
+
+    // Comment lines before a short query
+    case 3:
+      sql.clear();
+      for(int line = 0; line < 32; line++){
+        sql += "-- ";
+        AddLorem(sql, sql.size() + 60, " ");
+        sql += "\n";
+      }
+      sql += "SELECT " + alias + "." + column + from;
+      break;
+
+    // Very long identifier
+    case 4: {
+      std::string identifier = "x";
+      AddLorem(identifier, 2048, "_");
+      sql = "SELECT " + alias + "." + identifier + from;
+      break;
+    }
+
+    // Runs of spaces and blank lines
+    default:
+      sql = "SELECT" + std::string(200, ' ') + alias + "." + column + "\n\n\n" +
+          std::string(200, ' ') + "FROM " + table.name + " " + alias +
+          std::string(200, ' ');
+      break;
+  }
+}
+
+// WRITER
+
+std::uint64_t WriteCorpus(const CorpusOptions& options,
+                          const std::uint64_t max_bytes,
+                          const std::uint64_t max_statements,
+                          std::ostream& sql,
+                          std::ostream* annotations){
+
+  CorpusGenerator generator(options);
+  CorpusStatement statement;
+
+  std::uint64_t bytes = 0;
+  std::uint64_t line_number = 1;
+  std::uint64_t statement_count = 0;
+
+  while((max_bytes == 0 || bytes < max_bytes) &&
+        (max_statements == 0 || statement_count < max_statements)){
+
+    generator.Next(statement);
+
+    // 0-based statement index, like "statement" in the findings
+    if(annotations != nullptr){
+      *annotations << "{\"statement\":" << statement_count
+                   << ",\"line\":" << line_number
+                   << ",\"offset\":" << bytes
+                   << ",\"length\":" << statement.sql.size()
+                   << ",\"kind\":\"" << StatementKindToString(statement.kind)
+                   << "\",\"rules\":[";
+      for(std::size_t i = 0; i < statement.rules.size(); i++){
+        *annotations << ((i == 0) ? "\"" : ",\"") << statement.rules[i] << "\"";
+      }
+      *annotations << "]}\n";
+    }
+
+    sql << statement.sql << ";\n";
+    statement_count++;
+    bytes += statement.sql.size() + 2;
+    line_number += std::count(statement.sql.begin(), statement.sql.end(), '\n') + 1;
+
+    // Both limits unset -- one statement
+    if(max_bytes == 0 && max_statements == 0){
+      break;
+    }
+  }
+
+  return statement_count;
+}
+
+}  // namespace sqlcheck
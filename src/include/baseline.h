@@ -0,0 +1,96 @@
+// BASELINE HEADER
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace sqlcheck {
+
+// Accepted finding: a rule that matched a statement
+struct BaselineEntry {
+
+  // numeric rule id
+  std::uint32_t rule;
+
+  std::uint32_t reserved;
+
+  // hash of the statement fingerprint
+  std::uint64_t statement_hash;
+
+  bool operator<(const BaselineEntry& other) const {
+    return (rule != other.rule) ? rule < other.rule :
+        statement_hash < other.statement_hash;
+  }
+
+  bool operator==(const BaselineEntry& other) const {
+    return rule == other.rule && statement_hash == other.statement_hash;
+  }
+
+};
+
+// Findings accepted in an earlier run. A baseline file is a header followed
+// by the entries sorted by rule and statement hash (native byte order). It
+// is mapped into memory and searched in place, so loading it takes the same
+// time whatever its size.
+class Baseline {
+
+ public:
+  // record -- keep every finding for Save
+  explicit Baseline(const bool record);
+
+  ~Baseline();
+
+  Baseline(const Baseline&) = delete;
+  Baseline& operator=(const Baseline&) = delete;
+
+  bool Load(const std::string& file_name);
+
+  // Look up a finding of a rule on a statement, and record it
+  bool Match(const std::string& rule_id, const std::uint64_t statement_hash);
+
+  // Write the recorded findings
+  bool Save(const std::string& file_name);
+
+  std::size_t GetEntryCount() const {
+    return entry_count_;
+  }
+
+  // Findings that were in the baseline
+  std::uint64_t GetKnownCount() const {
+    return known_count_;
+  }
+
+  // Entries of every rule that no finding matched
+  std::map<std::uint32_t, std::size_t> GetFixedCounts() const;
+
+ private:
+
+  void Unmap();
+
+  bool record_;
+
+  void* mapping_;
+
+  std::size_t mapping_size_;
+
+  const BaselineEntry* entries_;
+
+  std::size_t entry_count_;
+
+  // entries that a finding matched (empty -- none yet)
+  std::vector<bool> matched_;
+
+  std::uint64_t known_count_;
+
+  std::vector<BaselineEntry> recorded_;
+
+};
+
+// Print the known and fixed findings
+void PrintBaseline(const Baseline& baseline, std::ostream& output);
+
+}  // namespace sqlcheck
@@ -0,0 +1,205 @@
+// CATALOG HEADER
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "tokenizer.h"
+
+namespace sqlcheck {
+
+// Interned string
+typedef std::uint32_t Symbol;
+
+// Interned string table
+class StringPool {
+
+ public:
+
+  // Get the symbol of a string (adding it if needed)
+  Symbol Intern(const std::string& text);
+
+  // Get the symbol of a string if it exists
+  bool Find(const std::string& text, Symbol& symbol) const;
+
+  const std::string& Get(const Symbol symbol) const {
+    return strings_[symbol];
+  }
+
+  std::size_t GetSize() const {
+    return strings_.size();
+  }
+
+  void Clear();
+
+ private:
+
+  std::vector<std::string> strings_;
+
+  std::unordered_map<std::string, Symbol> symbols_;
+
+};
+
+// Column of a table
+struct Column {
+
+  Symbol name;
+
+  // type with its arguments, like varchar(30)
+  Symbol type;
+
+  bool not_null;
+
+  bool primary_key;
+
+};
+
+// Foreign key of a table
+struct ForeignKey {
+
+  std::vector<Symbol> columns;
+
+  Symbol referenced_table;
+
+  // empty if the primary key is referenced
+  std::vector<Symbol> referenced_columns;
+
+};
+
+// Index of a table (including primary keys and unique constraints)
+struct Index {
+
+  // empty if the index is not named
+  Symbol name;
+
+  // indexed columns in index order
+  std::vector<Symbol> columns;
+
+  bool unique;
+
+  bool primary;
+
+};
+
+// Table
+struct Table {
+
+  Symbol name;
+
+  std::vector<Column> columns;
+
+  // column position by name
+  std::unordered_map<Symbol, std::uint32_t> column_ids;
+
+  std::vector<Symbol> primary_key;
+
+  std::vector<ForeignKey> foreign_keys;
+
+  std::vector<Index> indexes;
+
+};
+
+// Schema catalog populated from the DDL statements seen so far
+// (CREATE TABLE, CREATE INDEX, ALTER TABLE and DROP).
+//
+// Names are stored in lower case without schema qualifiers and all lookups
+// are hash lookups.
+class Catalog {
+
+ public:
+
+  Catalog();
+
+  // Record a DDL statement (returns false if it is not DDL)
+  bool AddStatement(const std::string& sql_statement);
+
+  // Get a table by name (nullptr if it does not exist)
+  const Table* FindTable(const std::string& name) const;
+
+  const Table* FindTable(const Symbol name) const;
+
+  // Get a column by name (nullptr if it does not exist)
+  const Column* FindColumn(const Table& table,
+                           const std::string& name) const;
+
+  // Get the table created or altered by the last statement
+  // (nullptr if the last statement was not about a table)
+  const Table* GetCurrentTable() const;
+
+  const std::vector<Table>& GetTables() const {
+    return tables_;
+  }
+
+  const std::string& GetString(const Symbol symbol) const {
+    return strings_.Get(symbol);
+  }
+
+  void Clear();
+
+  // Save a binary snapshot of the catalog
+  bool Save(const std::string& file_name) const;
+
+  // Load a binary snapshot of the catalog
+  bool Load(const std::string& file_name);
+
+ private:
+
+  Table& GetTable(const Symbol name);
+
+  void DropTable(const Symbol name);
+
+  bool ParseName(const std::vector<Token>& tokens,
+                 std::size_t& pos,
+                 Symbol& name);
+
+  bool ParseColumnList(const std::vector<Token>& tokens,
+                       std::size_t& pos,
+                       std::vector<Symbol>& columns);
+
+  void ParseTableElement(const std::vector<Token>& tokens,
+                         std::size_t begin,
+                         std::size_t end,
+                         Table& table);
+
+  void ParseColumn(const std::vector<Token>& tokens,
+                   std::size_t begin,
+                   std::size_t end,
+                   Table& table);
+
+  void ParseCreateTable(const std::vector<Token>& tokens,
+                        std::size_t pos);
+
+  void ParseCreateIndex(const std::vector<Token>& tokens,
+                        std::size_t pos,
+                        bool unique);
+
+  void ParseAlterTable(const std::vector<Token>& tokens,
+                       std::size_t pos);
+
+  void ParseDrop(const std::vector<Token>& tokens,
+                 std::size_t pos);
+
+  void UpdateColumnIds(Table& table);
+
+  StringPool strings_;
+
+  std::vector<Table> tables_;
+
+  // table position by name
+  std::unordered_map<Symbol, std::uint32_t> table_ids_;
+
+  // table of a named index
+  std::unordered_map<Symbol, Symbol> index_tables_;
+
+  // table created or altered by the last statement (-1 if none)
+  std::int64_t current_table_;
+
+  // symbol of the empty string
+  Symbol empty_;
+
+};
+
+}  // namespace sqlcheck
@@ -3,18 +3,43 @@
 #pragma once
 
 #include <regex>
+#include <vector>
 
 #include "configuration.h"
+#include "prefilter.h"
 
 namespace sqlcheck {
 
 // Check a set of SQL statements
 bool Check(Configuration& state);
 
+// Check the SQL statements in a text
+// (used by long-running modes together with collect_findings)
+void CheckText(Configuration& state,
+               const std::string& sql_text);
+
 // Check a SQL statement
 void CheckStatement(Configuration& state,
                     const std::string& sql_statement);
 
+// Lower-case a SQL statement and remove extra spaces
+// (offsets maps every character back to the original statement)
+void NormalizeStatement(const std::string& sql_statement,
+                        std::string& statement,
+                        std::vector<std::uint32_t>& offsets);
+
+// Skip a SQL statement without checking it
+void SkipStatement(Configuration& state,
+                   const std::string& sql_statement);
+
+// Get the line of a position in the statement being checked
+// (binary search over its newlines)
+std::uint32_t GetLineNumber(const Configuration& state,
+                            const std::size_t position);
+
+// Wrap the text at 80 characters
+std::string WrapText(const std::string& text);
+
 // Check a pattern
 void CheckPattern(Configuration& state,
                   const std::string& sql_statement,
@@ -27,4 +52,17 @@ void CheckPattern(Configuration& state,
                   const bool exists,
                   const size_t min_count = 0);
 
+// Check a rule pattern (the prefilter engine skips the regex search when
+// the statement has none of the pattern's literals)
+void CheckPattern(Configuration& state,
+                  const std::string& sql_statement,
+                  bool& print_statement,
+                  const RulePattern& anti_pattern,
+                  const RiskLevel pattern_level,
+                  const PatternType pattern_type,
+                  const std::string title,
+                  const std::string message,
+                  const bool exists,
+                  const size_t min_count = 0);
+
 }  // namespace machine
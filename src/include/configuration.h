@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <cstdint>
 #include <cstdlib>
 #include <iostream>
@@ -9,6 +10,11 @@
 #include <sstream>
 #include <memory>
 #include <map>
+#include <vector>
+
+#include "catalog.h"
+#include "profiler.h"
+#include "run_stats.h"
 
 namespace sqlcheck {
 
@@ -35,6 +41,51 @@ enum PatternType {
 
 };
 
+enum SampleMode {
+  SAMPLE_MODE_NONE = 0,
+
+  SAMPLE_MODE_RATE = 1,
+  SAMPLE_MODE_RESERVOIR = 2,
+  SAMPLE_MODE_BUDGET = 3
+
+};
+
+enum PatternEngine {
+  PATTERN_ENGINE_INVALID = 0,
+
+  PATTERN_ENGINE_REGEX = 1,
+  PATTERN_ENGINE_PREFILTER = 2
+
+};
+
+enum OutputFormat {
+  OUTPUT_FORMAT_INVALID = 0,
+
+  OUTPUT_FORMAT_TEXT = 1,
+  OUTPUT_FORMAT_JSON = 2,
+  OUTPUT_FORMAT_JSONL = 3,
+  OUTPUT_FORMAT_SARIF = 4
+
+};
+
+// Destination of the findings in a format
+struct OutputSink {
+
+  OutputSink(const OutputFormat format, const std::string& path)
+   : format(format),
+     path(path) {
+  }
+
+  OutputFormat format;
+
+  // file to write ("-" -- standard output)
+  std::string path;
+
+};
+
+class Baseline;
+class ReportWriter;
+
 // Checker stats
 struct CheckerStats {
 
@@ -47,6 +98,59 @@ struct CheckerStats {
 
 };
 
+// Checker finding
+struct Finding {
+
+  // rule id
+  std::string rule_id;
+
+  // id of the statement of the match (statements read before it)
+  std::uint64_t statement_id;
+
+  // rule title
+  std::string title;
+
+  // risk level
+  RiskLevel risk_level;
+
+  // pattern type
+  PatternType pattern_type;
+
+  // line number of the match
+  std::uint32_t line_number;
+
+  // column number of the match
+  std::uint32_t column;
+
+  // byte range of the match in the checked text
+  std::uint64_t begin;
+  std::uint64_t end;
+
+  // matching expression
+  std::string match;
+
+};
+
+// Rules skipped on a statement because they ran out of budget
+struct SkippedCheck {
+
+  // ids of the skipped rules (comma separated, "all" for the statement)
+  std::string rule_ids;
+
+  // budget that ran out
+  std::string reason;
+
+  // line and byte offset of the statement
+  std::uint32_t line_number;
+  std::uint64_t offset;
+
+};
+
+// Largest statement checked by default, and by the long-running modes in
+// any case. The recursion of std::regex overflows an 8 MB stack on some
+// patterns somewhere between 24 and 32 KB.
+const std::uint64_t kMaxStatementBytes = 16 * 1024;
+
 class Configuration {
  public:
 
@@ -58,7 +162,37 @@ class Configuration {
      delimiter(";"),
      risk_level(RiskLevel::RISK_LEVEL_ALL),
      verbose(false),
-     testing_mode(false) {
+     testing_mode(false),
+     line_number(1),
+     sample_mode(SampleMode::SAMPLE_MODE_NONE),
+     sample_rate(1.0),
+     sample_reservoir_size(0),
+     sample_budget(1.0),
+     sample_seed(0),
+     collect_findings(false),
+     rule_id(""),
+     statement_offset(0),
+     statement_id(0),
+     statement_column(1),
+     statement_line_start(0),
+     num_workers(0),
+     index_advice(false),
+     nplus1(false),
+     nplus1_window(1.0),
+     nplus1_threshold(10),
+     profile(false),
+     stats(false),
+     top_slowest(0),
+     max_statement_bytes(kMaxStatementBytes),
+     statement_budget_ms(0),
+     rule_budget_ms(0),
+     rule_step_budget(0),
+     has_deadline(false),
+     budget_steps(0),
+     pattern_engine(PatternEngine::PATTERN_ENGINE_REGEX),
+     output_sinks(1, OutputSink(OutputFormat::OUTPUT_FORMAT_TEXT, "-")),
+     report_writer(nullptr),
+     statement_hash(0) {
   }
 
   // color mode
@@ -88,14 +222,193 @@ class Configuration {
   // line number
   std::uint32_t line_number;
 
+  // sampling mode
+  SampleMode sample_mode;
+
+  // fraction of statements to check (rate sampling)
+  double sample_rate;
+
+  // statements to keep per fingerprint (reservoir sampling)
+  std::uint64_t sample_reservoir_size;
+
+  // fraction of a core to spend on checking (budget sampling)
+  double sample_budget;
+
+  // sampling seed
+  std::uint64_t sample_seed;
+
+  // collect findings instead of printing them
+  bool collect_findings;
+
+  // collected findings
+  std::vector<Finding> findings;
+
+  // id of the rule being checked
+  const char* rule_id;
+
+  // byte offset of the statement being checked
+  std::uint64_t statement_offset;
+
+  // maps the normalized statement back to the original statement
+  std::vector<std::uint32_t> statement_offsets;
+
+  // id of the statement being checked (statements read before it)
+  std::uint64_t statement_id;
+
+  // column of the first byte of the statement being checked
+  std::uint32_t statement_column;
+
+  // positions of the newlines in the normalized statement, so that a
+  // position is mapped to its line by binary search
+  std::vector<std::uint32_t> statement_newlines;
+
+  // offset in the original statement where the line of its first
+  // character starts (negative -- in an earlier statement)
+  std::int64_t statement_line_start;
+
+  // unix domain socket to serve requests on
+  std::string serve_path;
+
+  // number of worker threads (0 -- number of cores)
+  std::uint32_t num_workers;
+
+  // directory to watch for changed files
+  std::string watch_path;
+
+  // schema built from the DDL statements seen so far
+  Catalog catalog;
+
+  // catalog snapshot to load before checking
+  std::string catalog_file;
+
+  // catalog snapshot to write after checking
+  std::string write_catalog_file;
+
+  // match the workload against the declared indexes
+  bool index_advice;
+
+  // detect N+1 query bursts in a timestamped log
+  bool nplus1;
+
+  // seconds between queries that keep an N+1 window open
+  double nplus1_window;
+
+  // queries in a window that make an N+1 burst
+  std::uint64_t nplus1_threshold;
+
+  // application source tree to extract SQL from
+  std::string source_path;
+
+  // unified diff whose changed statements are checked ("-" -- stdin)
+  std::string diff_file;
+
+  // measure the cost of every rule and stage
+  bool profile;
+
+  // file to write the profile to as JSON
+  std::string profile_file;
+
+  // profile of this configuration's checks
+  Profile profile_stats;
+
+  // file to write the Chrome trace to
+  std::string trace_file;
+
+  // print the run statistics in the summary
+  bool stats;
+
+  // file to write the run statistics to as JSON
+  std::string stats_file;
+
+  // throughput and latency of this configuration's checks
+  RunStats run_stats;
+
+  // number of slowest statements to report (0 -- none)
+  std::size_t top_slowest;
+
+  // skip statements larger than this (0 -- no limit)
+  std::uint64_t max_statement_bytes;
+
+  // time budget of a statement and of a rule (0 -- no limit)
+  std::uint64_t statement_budget_ms;
+  std::uint64_t rule_budget_ms;
+
+  // regex searches a rule may run on a statement (0 -- no limit)
+  std::uint64_t rule_step_budget;
+
+  // collected rule checks that ran out of budget
+  std::vector<SkippedCheck> skipped_checks;
+
+  // budget of the rule being checked
+  bool has_deadline;
+  std::chrono::steady_clock::time_point budget_deadline;
+  std::uint64_t budget_steps;
+
+  // why the rule being checked was aborted (empty -- it was not)
+  std::string skip_reason;
+
+  // how rule patterns are matched (regex -- the reference engine)
+  PatternEngine pattern_engine;
+
+  // where the findings go (text -- the console report, printed only if
+  // there is a text sink)
+  std::vector<OutputSink> output_sinks;
+
+  // writes the findings as they are found (nullptr -- print them)
+  ReportWriter* report_writer;
+
+  // baseline to suppress the accepted findings with
+  std::string baseline_file;
+
+  // baseline of this run's findings to write after checking
+  std::string write_baseline_file;
+
+  // accepted findings (nullptr -- no baseline)
+  std::shared_ptr<Baseline> baseline;
+
+  // fingerprint hash of the statement being checked (with a baseline)
+  std::uint64_t statement_hash;
+
 };
 
+// Copy the checker options and the schema catalog (not the checker state)
+// from source to target
+void CopyOptions(const Configuration& source, Configuration& target);
+
+// Cap the statement size of a long-running mode (0 -- no limit -- included)
+void LimitStatementBytes(Configuration& state);
+
+// The rules only read the table of the statement being checked, so the
+// schema catalog outlives a check only for index advice and snapshots
+inline bool NeedsCatalog(const Configuration& state){
+  return state.index_advice == true || state.write_catalog_file.empty() == false;
+}
+
 std::string RiskLevelToString(const RiskLevel& risk_level);
 
 std::string RiskLevelToDetailedString(const RiskLevel& risk_level);
 
 std::string PatternTypeToString(const PatternType& pattern_type);
 
+std::string SampleModeToString(const SampleMode& sample_mode);
+
+std::string PatternEngineToString(const PatternEngine& pattern_engine);
+
+PatternEngine StringToPatternEngine(const std::string& text);
+
+std::string OutputFormatToString(const OutputFormat& output_format);
+
+OutputFormat StringToOutputFormat(const std::string& text);
+
+std::string OutputSinksToString(const std::vector<OutputSink>& output_sinks);
+
+// Parse "format:path,..." (a missing path is "-")
+std::vector<OutputSink> StringToOutputSinks(const std::string& text);
+
+// Find the sink of a format (nullptr -- none)
+const OutputSink* FindOutputSink(const std::vector<OutputSink>& output_sinks,
+                                 const OutputFormat& output_format);
+
 void ValidateRiskLevel(const Configuration &state);
 
 void ValidateFileName(const Configuration &state);
@@ -106,5 +419,35 @@ void ValidateVerbose(const Configuration &state);
 
 void ValidateDelimiter(const Configuration &state);
 
+void ValidateSampling(const Configuration &state);
+
+void ValidateServe(const Configuration &state);
+
+void ValidateWatch(const Configuration &state);
+
+void ValidateCatalog(const Configuration &state);
+
+void ValidateBaseline(const Configuration &state);
+
+void ValidateIndexAdvice(const Configuration &state);
+
+void ValidateNPlusOne(const Configuration &state);
+
+void ValidateSourcePath(const Configuration &state);
+
+void ValidateDiff(const Configuration &state);
+
+void ValidateProfile(const Configuration &state);
+
+void ValidateTrace(const Configuration &state);
+
+void ValidateStats(const Configuration &state);
+
+void ValidateBudget(const Configuration &state);
+
+void ValidateEngine(const Configuration &state);
+
+void ValidateOutput(const Configuration &state);
+
 
 }  // namespace sqlcheck
@@ -0,0 +1,75 @@
+// DIFF HEADER
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+#include "configuration.h"
+
+namespace sqlcheck {
+
+// Hunk of a unified diff
+struct DiffHunk {
+
+  // first line of the hunk in the new file
+  std::uint32_t new_start;
+
+  // lines of the hunk in the new file (context and added lines)
+  std::vector<std::string> new_lines;
+
+};
+
+// Changes to one file in a unified diff
+struct FileDiff {
+
+  // path of the new file (a/ and b/ prefixes removed)
+  std::string path;
+
+  // path as it appears in the diff
+  std::string raw_path;
+
+  // lines of the new file that were added, or that follow removed lines
+  // (sorted, without duplicates)
+  std::vector<std::uint32_t> changed_lines;
+
+  std::vector<DiffHunk> hunks;
+
+};
+
+// Statement of a text that overlaps the changed lines
+struct ChangedStatement {
+
+  // byte range of the statement in the text (without the delimiter)
+  std::size_t begin;
+  std::size_t end;
+
+  // line of the first byte of the statement
+  std::uint32_t line_number;
+
+};
+
+// Parse unified diff text (as written by diff -u or git diff).
+// Deleted files are skipped. Returns false if no file header is found.
+bool ParseUnifiedDiff(std::istream& input,
+                      std::vector<FileDiff>& files);
+
+// Split a text into statements and return the ones that overlap the
+// changed lines. first_line is the line number of the first byte.
+void GetChangedStatements(const std::string& text,
+                          const std::uint32_t first_line,
+                          const char delimiter,
+                          const std::vector<std::uint32_t>& changed_lines,
+                          std::vector<ChangedStatement>& statements);
+
+// Check only the statements of the .sql files that a diff changes.
+// Files are read from the working directory when they match the diff,
+// otherwise the new side of the hunks is checked.
+// Returns true if there are issues.
+bool CheckDiff(Configuration& state,
+               std::istream& diff);
+
+}  // namespace sqlcheck
@@ -0,0 +1,33 @@
+// DIFFERENTIAL HEADER
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "configuration.h"
+
+namespace sqlcheck {
+
+// Check a text with the options of a configuration and collect the findings
+std::vector<Finding> GetFindings(const Configuration& options,
+                                 const PatternEngine pattern_engine,
+                                 const std::string& sql_text);
+
+// Describe the first difference between the findings of the reference
+// engine and of another engine ("" -- they agree)
+std::string DiffFindings(const std::vector<Finding>& expected,
+                         const std::vector<Finding>& actual);
+
+// Check a text with the reference regex engine and with the engine of the
+// options, and describe the first difference ("" -- they agree)
+std::string CompareEngines(const Configuration& options,
+                           const std::string& sql_text);
+
+// Shrink an input that fails a test to a 1-minimal one (removing any
+// single line or character makes it pass) with delta debugging
+std::string MinimizeInput(const std::string& input,
+                          const std::function<bool(const std::string& input)>& fails);
+
+}  // namespace sqlcheck
@@ -0,0 +1,57 @@
+// EXTRACTOR HEADER
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "configuration.h"
+
+namespace sqlcheck {
+
+enum SourceLanguage {
+  SOURCE_LANGUAGE_UNKNOWN = 0,
+  SOURCE_LANGUAGE_CPP = 1,
+  SOURCE_LANGUAGE_JAVA = 2,
+  SOURCE_LANGUAGE_PYTHON = 3,
+  SOURCE_LANGUAGE_GO = 4
+};
+
+// SQL found in the string literals of a source file
+struct ExtractedStatement {
+
+  // text of the (concatenated) literals
+  std::string sql;
+
+  // source line of every part of the text, as (offset in sql, line) pairs
+  std::vector<std::pair<std::uint32_t, std::uint32_t>> lines;
+
+  // Get the source line of an offset in the text
+  std::uint32_t GetLineNumber(const std::size_t offset) const;
+
+};
+
+// Get the language of a source file from its extension
+SourceLanguage GetSourceLanguage(const std::string& path);
+
+// Check if a string looks like SQL
+// (keyword prefilter followed by a light structural check)
+bool LooksLikeSql(const std::string& text);
+
+// Extract the string literals that look like SQL from source code.
+// Adjacent and +-concatenated literals are joined, and escapes are decoded.
+void ExtractSql(const char* source,
+                const std::size_t length,
+                const SourceLanguage language,
+                std::vector<ExtractedStatement>& statements);
+
+// Check the SQL in the source files below a directory (or in a single file)
+// using state.num_workers threads. Returns true if there are issues.
+bool CheckSourceTree(Configuration& state,
+                     const std::string& root,
+                     std::ostream& output);
+
+}  // namespace sqlcheck
@@ -0,0 +1,59 @@
+// FILE WALKER HEADER
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+namespace sqlcheck {
+
+// Visit every regular file below root (depth-first, sorted by name).
+// on_directory is called for root and every sub-directory.
+void WalkDirectory(const std::string& root,
+                   const std::function<void(const std::string& path)>& on_file,
+                   const std::function<void(const std::string& path)>& on_directory = nullptr);
+
+// Read a whole file (returns false if it cannot be read)
+bool ReadFile(const std::string& path, std::string& contents);
+
+// Check if the path ends with the given extension (e.g. ".sql")
+bool HasExtension(const std::string& path, const std::string& extension);
+
+// Read-only memory mapping of a whole file
+class MappedFile {
+
+ public:
+  explicit MappedFile(const std::string& path);
+
+  ~MappedFile();
+
+  // false if the file cannot be mapped
+  bool IsValid() const {
+    return valid_;
+  }
+
+  // nullptr for empty files
+  const char* GetData() const {
+    return data_;
+  }
+
+  std::size_t GetSize() const {
+    return size_;
+  }
+
+ private:
+
+  MappedFile(const MappedFile&) = delete;
+
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const char* data_;
+
+  std::size_t size_;
+
+  bool valid_;
+
+};
+
+}  // namespace sqlcheck
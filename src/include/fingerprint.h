@@ -0,0 +1,18 @@
+// FINGERPRINT HEADER
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace sqlcheck {
+
+// Get the fingerprint of a SQL statement
+// (lower case, literals replaced by ?, comments and extra spaces removed)
+std::string GetFingerprint(const std::string& sql_statement);
+
+// Hash a string (64-bit FNV-1a)
+std::uint64_t HashString(const std::string& text,
+                         const std::uint64_t seed = 14695981039346656037ULL);
+
+}  // namespace sqlcheck
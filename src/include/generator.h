@@ -0,0 +1,117 @@
+// GENERATOR HEADER
+
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace sqlcheck {
+
+enum StatementKind {
+  STATEMENT_KIND_DDL = 0,
+  STATEMENT_KIND_OLTP = 1,
+  STATEMENT_KIND_ANALYTIC = 2,
+  STATEMENT_KIND_BULK_INSERT = 3,
+  STATEMENT_KIND_PATHOLOGICAL = 4,
+  STATEMENT_KIND_COUNT = 5
+};
+
+std::string StatementKindToString(const StatementKind& kind);
+
+// Corpus generator options
+struct CorpusOptions {
+
+  CorpusOptions()
+   : seed(0),
+     density(0.1),
+     bulk_rows(100) {
+    weights[STATEMENT_KIND_DDL] = 10;
+    weights[STATEMENT_KIND_OLTP] = 70;
+    weights[STATEMENT_KIND_ANALYTIC] = 10;
+    weights[STATEMENT_KIND_BULK_INSERT] = 8;
+    weights[STATEMENT_KIND_PATHOLOGICAL] = 2;
+  }
+
+  // seed of the generator (same seed -- same corpus)
+  std::uint64_t seed;
+
+  // fraction of DDL, OLTP and bulk INSERT statements with an anti-pattern
+  double density;
+
+  // relative frequency of every statement kind
+  std::uint32_t weights[STATEMENT_KIND_COUNT];
+
+  // rows per bulk INSERT statement
+  std::uint32_t bulk_rows;
+
+};
+
+// Generated statement with its ground truth
+struct CorpusStatement {
+
+  // statement text (without the delimiter)
+  std::string sql;
+
+  StatementKind kind;
+
+  // ids of the rules that flag the statement (sorted)
+  std::vector<std::string> rules;
+
+};
+
+// Deterministic generator of SQL statements. The statements are built from
+// templates that no rule flags, and anti-patterns are injected on purpose,
+// so the rules that flag a statement are known without checking it.
+class CorpusGenerator {
+
+ public:
+  explicit CorpusGenerator(const CorpusOptions& options);
+
+  // Generate the next statement
+  void Next(CorpusStatement& statement);
+
+ private:
+
+  std::uint64_t Uniform(const std::uint64_t bound);
+
+  bool Chance(const double probability);
+
+  StatementKind PickKind();
+
+  std::string PickWord();
+
+  std::string PickValue(const std::string& type);
+
+  void GenerateDDL(CorpusStatement& statement, const bool inject);
+
+  void GenerateOLTP(CorpusStatement& statement, const bool inject);
+
+  void GenerateAnalytic(CorpusStatement& statement);
+
+  void GenerateBulkInsert(CorpusStatement& statement, const bool inject);
+
+  void GeneratePathological(CorpusStatement& statement);
+
+  CorpusOptions options_;
+
+  std::mt19937_64 random_;
+
+  std::uint32_t total_weight_;
+
+  std::uint64_t next_key_;
+
+};
+
+// Write statements to sql (and their annotations as JSON lines) until
+// max_bytes or max_statements is reached (0 -- no limit).
+// Returns the number of statements written.
+std::uint64_t WriteCorpus(const CorpusOptions& options,
+                          const std::uint64_t max_bytes,
+                          const std::uint64_t max_statements,
+                          std::ostream& sql,
+                          std::ostream* annotations);
+
+}  // namespace sqlcheck
@@ -0,0 +1,116 @@
+// INDEX ADVISOR HEADER
+
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "catalog.h"
+
+namespace sqlcheck {
+
+// Predicate that no declared index serves
+struct PredicateAdvice {
+
+  std::string table;
+
+  // equality columns followed by range columns (or the ORDER BY columns)
+  std::vector<std::string> columns;
+
+  // where, join or order by
+  std::string clause;
+
+  // number of queries with this predicate
+  std::uint64_t count;
+
+  // first query with this predicate
+  std::string example;
+
+  // index over the columns in an order the predicate cannot use
+  std::string misordered_index;
+
+};
+
+// Usage of a declared index
+struct IndexUsage {
+
+  std::string table;
+
+  // empty for unnamed indexes
+  std::string index;
+
+  std::vector<std::string> columns;
+
+  bool unique;
+
+  bool primary;
+
+  // number of queries served by the index
+  std::uint64_t count;
+
+  // number of those queries that only read indexed columns
+  std::uint64_t covering_count;
+
+};
+
+// Result of the index analysis
+struct IndexAdvice {
+
+  // ranked by frequency
+  std::vector<PredicateAdvice> unserved_predicates;
+
+  // ranked by frequency
+  std::vector<IndexUsage> indexes;
+
+  std::uint64_t query_count;
+
+  std::uint64_t fingerprint_count;
+
+};
+
+// Workload-level index analysis.
+//
+// Queries are grouped by fingerprint, so each distinct query shape is
+// analysed once no matter how often it was logged. The WHERE, JOIN and
+// ORDER BY columns of every shape are matched against the indexes in the
+// schema catalog (leftmost prefix, attribute order and covering columns).
+class IndexAdvisor {
+
+ public:
+
+  IndexAdvisor();
+
+  // Add a query of the workload
+  void AddQuery(const std::string& sql_statement);
+
+  // Match the workload against the indexes in the catalog
+  void Analyze(const Catalog& catalog, IndexAdvice& advice) const;
+
+  std::uint64_t GetQueryCount() const {
+    return query_count_;
+  }
+
+ private:
+
+  // Queries with the same fingerprint
+  struct QueryGroup {
+
+    std::uint64_t count;
+
+    std::string example;
+
+  };
+
+  std::unordered_map<std::uint64_t, QueryGroup> groups_;
+
+  std::uint64_t query_count_;
+
+};
+
+// Print the index analysis
+void PrintIndexAdvice(const IndexAdvice& advice, std::ostream& output);
+
+}  // namespace sqlcheck
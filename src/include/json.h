@@ -0,0 +1,88 @@
+// JSON HEADER
+
+#pragma once
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "configuration.h"
+
+namespace sqlcheck {
+
+enum JsonType {
+  JSON_TYPE_NULL = 0,
+
+  JSON_TYPE_BOOL = 1,
+  JSON_TYPE_NUMBER = 2,
+  JSON_TYPE_STRING = 3,
+  JSON_TYPE_ARRAY = 4,
+  JSON_TYPE_OBJECT = 5
+
+};
+
+// Parsed JSON document
+class JsonValue {
+
+ public:
+  JsonValue()
+   : type(JSON_TYPE_NULL),
+     boolean(false),
+     number(0) {
+  }
+
+  // Get an object member (nullptr if missing)
+  const JsonValue* Find(const std::string& key) const;
+
+  // Get a string member (default_value if missing or not a string)
+  std::string GetString(const std::string& key,
+                        const std::string& default_value = "") const;
+
+  // Get a number member (default_value if missing or not a number)
+  double GetNumber(const std::string& key, double default_value = 0) const;
+
+  // value type
+  JsonType type;
+
+  // bool value
+  bool boolean;
+
+  // number value
+  double number;
+
+  // string value
+  std::string string;
+
+  // array elements
+  std::vector<JsonValue> array;
+
+  // object members
+  std::map<std::string, JsonValue> object;
+
+};
+
+// Parse a JSON document (returns false and sets error on failure)
+bool ParseJson(const std::string& text, JsonValue& value, std::string& error);
+
+// Write a JSON value
+void WriteJson(std::ostream& os, const JsonValue& value);
+
+// Escape a string for use inside a JSON document
+std::string EscapeJsonString(const std::string& text);
+
+// Write a finding as a JSON object
+void WriteFindingJson(std::ostream& os, const Finding& finding);
+
+// Write a finding of a file as a JSON object ("" -- no file)
+void WriteFindingJson(std::ostream& os, const Finding& finding,
+                      const std::string& file_name);
+
+// Write a list of findings as a JSON array
+void WriteFindingsJson(std::ostream& os, const std::vector<Finding>& findings);
+
+// Write a list of skipped rule checks as a JSON array
+void WriteSkippedChecksJson(std::ostream& os,
+                            const std::vector<SkippedCheck>& skipped_checks);
+
+}  // namespace sqlcheck
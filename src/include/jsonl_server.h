@@ -0,0 +1,22 @@
+// JSONL SERVER HEADER
+
+#pragma once
+
+#include <istream>
+#include <ostream>
+
+#include "configuration.h"
+
+namespace sqlcheck {
+
+// Serve newline-delimited JSON check requests until the input ends.
+//
+// Each request is a JSON object {"id": ..., "sql": "...", "options": {...}}
+// on its own line. Supported options are "risk_level" and "delimiter".
+// Requests are checked concurrently, so responses ({"id": ..., "findings":
+// [...]}) may come back out of order; clients match them by id.
+int ServeJsonLines(const Configuration& state,
+                   std::istream& input,
+                   std::ostream& output);
+
+}  // namespace sqlcheck
@@ -2,10 +2,41 @@
 
 #pragma once
 
+#include <vector>
+
 #include "configuration.h"
 
 namespace sqlcheck {
 
+// Rule check function
+typedef void (*RuleFunction)(Configuration& state,
+                             const std::string& sql_statement,
+                             bool& print_statement);
+
+// Rule table entry
+struct Rule {
+
+  // rule id (see docs/<type>/<id>.md)
+  const char* id;
+
+  // rule name (for reports)
+  const char* name;
+
+  // check function
+  RuleFunction function;
+
+  // pattern the rule matches (nullptr -- none, or built per statement)
+  const char* pattern;
+
+};
+
+// Get the rules in checking order
+const std::vector<Rule>& GetRules();
+
+// Get the name of the table created by the statement ("" -- none)
+std::string GetTableName(const Configuration& state,
+                         const std::string& sql_statement);
+
 // LOGICAL DATABASE DESIGN
 
 void CheckMultiValuedAttribute(Configuration& state,
@@ -0,0 +1,117 @@
+// LSP SERVER HEADER
+
+#pragma once
+
+#include <istream>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "configuration.h"
+#include "json.h"
+
+namespace sqlcheck {
+
+// Language server publishing findings as diagnostics.
+//
+// Every open document keeps a statement index: the byte ranges produced by
+// splitting the text on the delimiter, together with the findings of each
+// statement (stored relative to the statement). An incremental edit only
+// re-splits and re-checks the statements overlapping the edited range; the
+// others are shifted and their findings are reused.
+class LspServer {
+
+ public:
+  explicit LspServer(const Configuration& state);
+
+  // Handle one JSON-RPC message and write the outgoing messages
+  void HandleMessage(const JsonValue& message, std::ostream& output);
+
+  // Exit notification received
+  bool IsExiting() const {
+    return exiting_;
+  }
+
+  // Statements checked while handling the last message
+  std::size_t GetLastCheckedCount() const {
+    return last_checked_count_;
+  }
+
+ private:
+
+  // Statement in a document
+  struct Statement {
+
+    // byte range (excluding the delimiter)
+    std::size_t begin;
+    std::size_t end;
+
+    // findings with offsets relative to the statement
+    std::vector<Finding> findings;
+
+    // checks skipped for lack of budget
+    std::vector<SkippedCheck> skipped_checks;
+
+  };
+
+  // Open document
+  struct Document {
+
+    std::string text;
+
+    // statement index
+    std::vector<Statement> statements;
+
+    // byte offset of every line start
+    std::vector<std::size_t> line_starts;
+
+  };
+
+  void OpenDocument(const std::string& uri, const std::string& text);
+
+  void ChangeDocument(const std::string& uri, const JsonValue& changes);
+
+  // Split text[begin, ...) into statements and check them. Stops at the first
+  // statement ending at one of the given boundaries (or at the end of text).
+  std::size_t SplitAndCheck(const std::string& text,
+                            std::size_t begin,
+                            const std::vector<std::size_t>& boundaries,
+                            std::vector<Statement>& statements);
+
+  void CheckDocumentStatement(const std::string& text, Statement& statement);
+
+  void IndexLines(Document& document);
+
+  std::size_t PositionToOffset(const Document& document, const JsonValue& position) const;
+
+  void WritePosition(std::ostream& os, const Document& document, std::size_t offset) const;
+
+  void PublishDiagnostics(const std::string& uri, std::ostream& output) const;
+
+  // checker state
+  Configuration state_;
+
+  // open documents by uri
+  std::map<std::string, Document> documents_;
+
+  // statements checked while handling the last message
+  std::size_t last_checked_count_;
+
+  // shutdown request received
+  bool shutdown_;
+
+  // exit notification received
+  bool exiting_;
+
+};
+
+// Write a JSON-RPC message with its Content-Length header
+void WriteLspMessage(std::ostream& output, const std::string& content);
+
+// Run the language server over the given streams until exit
+int ServeLanguageServer(const Configuration& state,
+                        std::istream& input,
+                        std::ostream& output);
+
+}  // namespace sqlcheck
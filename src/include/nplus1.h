@@ -0,0 +1,140 @@
+// N+1 DETECTOR HEADER
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <istream>
+#include <list>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "configuration.h"
+
+namespace sqlcheck {
+
+// Statement in a query log
+struct LogEntry {
+
+  // seconds since the epoch
+  double timestamp;
+
+  // connection or session id (empty if the log has none)
+  std::string session;
+
+  std::string sql;
+
+  // line of the entry in the log
+  std::uint64_t line_number;
+
+};
+
+// Parse a log line that starts with a timestamp
+// (PostgreSQL, MySQL general log and "<timestamp> [session=<id>] <sql>" lines)
+bool ParseLogLine(const std::string& line, LogEntry& entry);
+
+// Burst of queries with the same fingerprint in one session
+struct NPlusOneBurst {
+
+  std::string session;
+
+  std::string fingerprint;
+
+  // first query of the burst
+  std::string example;
+
+  // line of the first query
+  std::uint64_t line_number;
+
+  std::uint64_t count;
+
+  // number of distinct statements (capped)
+  std::uint64_t distinct_count;
+
+  double first_timestamp;
+
+  double last_timestamp;
+
+};
+
+// Streaming N+1 detector.
+//
+// Statements are grouped into windows per (session, fingerprint). A window
+// stays open while statements keep arriving within window_seconds of each
+// other. It becomes a burst once threshold of its statements fall within
+// window_seconds, so a steady slow poll never does. When it closes, a burst
+// with varying literals is reported. Open windows live in a hash map
+// with an LRU list, so they expire in O(1) and at most max_windows are kept.
+class NPlusOneDetector {
+
+ public:
+  NPlusOneDetector(const double window_seconds,
+                   const std::uint64_t threshold,
+                   const std::size_t max_windows = 100000);
+
+  // Add a statement (closed bursts are appended to bursts)
+  void AddStatement(const LogEntry& entry,
+                    std::vector<NPlusOneBurst>& bursts);
+
+  // Close all windows
+  void Flush(std::vector<NPlusOneBurst>& bursts);
+
+  std::size_t GetWindowCount() const {
+    return windows_.size();
+  }
+
+ private:
+
+  // Statements with the same fingerprint in one session
+  struct Window {
+
+    NPlusOneBurst burst;
+
+    // hashes of the distinct statements
+    std::unordered_set<std::uint64_t> statements;
+
+    // timestamps of the last threshold statements
+    std::deque<double> recent_timestamps;
+
+    // threshold statements fell within window_seconds
+    bool is_burst;
+
+    // position in the LRU list
+    std::list<std::string>::iterator lru_position;
+
+  };
+
+  void CloseWindow(const std::string& key,
+                   std::vector<NPlusOneBurst>& bursts);
+
+  double window_seconds_;
+
+  std::uint64_t threshold_;
+
+  std::size_t max_windows_;
+
+  // open windows by session and fingerprint
+  std::unordered_map<std::string, Window> windows_;
+
+  // window keys, least recently updated first
+  std::list<std::string> lru_;
+
+};
+
+// Suggest a batched form of a query (empty if there is none)
+std::string GetBatchedQuery(const std::string& fingerprint);
+
+// Print an N+1 burst
+void PrintNPlusOneBurst(const Configuration& state,
+                        const NPlusOneBurst& burst,
+                        std::ostream& output);
+
+// Detect N+1 bursts in a query log
+int DetectNPlusOne(const Configuration& state,
+                   std::istream& input,
+                   std::ostream& output);
+
+}  // namespace sqlcheck
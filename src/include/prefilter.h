@@ -0,0 +1,30 @@
+// PREFILTER HEADER
+
+#pragma once
+
+#include <regex>
+#include <string>
+#include <vector>
+
+namespace sqlcheck {
+
+// Get literals of which every match of the pattern contains at least one
+// (empty -- the pattern has no such literals and must always run)
+std::vector<std::string> GetRequiredLiterals(const std::string& pattern);
+
+// Check if a text contains one of the required literals
+bool MayMatch(const std::vector<std::string>& literals,
+              const std::string& text);
+
+// Rule pattern with its literal prefilter
+struct RulePattern {
+
+  explicit RulePattern(const std::string& pattern);
+
+  std::regex regex;
+
+  std::vector<std::string> literals;
+
+};
+
+}  // namespace sqlcheck
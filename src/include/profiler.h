@@ -0,0 +1,109 @@
+// PROFILER HEADER
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace sqlcheck {
+
+enum ProfileStage {
+  PROFILE_STAGE_SPLITTER = 0,
+  PROFILE_STAGE_NORMALIZER = 1,
+  PROFILE_STAGE_OUTPUT = 2,
+  PROFILE_STAGE_COUNT = 3
+};
+
+std::string ProfileStageToString(const ProfileStage& stage);
+
+// Cost of a rule or a pipeline stage
+struct ProfileCounter {
+
+  ProfileCounter()
+   : invocations(0),
+     nanoseconds(0),
+     regex_evaluations(0),
+     matches(0),
+     bytes_scanned(0) {
+  }
+
+  void Add(const ProfileCounter& other);
+
+  std::uint64_t invocations;
+
+  std::uint64_t nanoseconds;
+
+  std::uint64_t regex_evaluations;
+
+  std::uint64_t matches;
+
+  std::uint64_t bytes_scanned;
+
+};
+
+// Profile of a run. Every thread fills the profile of its own
+// configuration, and the profiles are merged at the end.
+struct Profile {
+
+  Profile()
+   : current_rule(0) {
+  }
+
+  // Get the counter of a rule (indexed like GetRules())
+  ProfileCounter& GetRule(const std::size_t rule_index);
+
+  void Merge(const Profile& other);
+
+  void Clear();
+
+  ProfileCounter stages[PROFILE_STAGE_COUNT];
+
+  std::vector<ProfileCounter> rules;
+
+  // index of the rule being checked
+  std::size_t current_rule;
+
+};
+
+// Add the time spent in a scope to a counter (no-op for nullptr)
+class ProfileTimer {
+
+ public:
+  explicit ProfileTimer(ProfileCounter* counter)
+   : counter_(counter) {
+    if(counter_ != nullptr){
+      start_ = std::chrono::steady_clock::now();
+    }
+  }
+
+  ~ProfileTimer(){
+    if(counter_ != nullptr){
+      auto elapsed = std::chrono::steady_clock::now() - start_;
+      counter_->nanoseconds +=
+          std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+      counter_->invocations++;
+    }
+  }
+
+ private:
+
+  ProfileTimer(const ProfileTimer&) = delete;
+
+  ProfileTimer& operator=(const ProfileTimer&) = delete;
+
+  ProfileCounter* counter_;
+
+  std::chrono::steady_clock::time_point start_;
+
+};
+
+// Print the stages and rules sorted by time
+void PrintProfile(const Profile& profile, std::ostream& output);
+
+// Write the profile as a JSON object
+void WriteProfileJson(const Profile& profile, std::ostream& output);
+
+}  // namespace sqlcheck
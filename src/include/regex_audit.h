@@ -0,0 +1,72 @@
+// REGEX AUDIT HEADER
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sqlcheck {
+
+// Fuzzing options
+struct RegexFuzzOptions {
+
+  RegexFuzzOptions()
+   : max_input_bytes(8192),
+     time_threshold_ms(100) {
+  }
+
+  // inputs grow by doubling up to this size
+  std::size_t max_input_bytes;
+
+  // a pattern fails if one input takes longer than this
+  std::uint64_t time_threshold_ms;
+
+};
+
+// Result of auditing a pattern
+struct RegexAudit {
+
+  RegexAudit()
+   : star_height(0),
+     worst_nanoseconds(0),
+     growth(0) {
+  }
+
+  // nesting depth of unbounded quantifiers
+  int star_height;
+
+  // super-linear backtracking (fails the audit)
+  std::vector<std::string> problems;
+
+  // risks that do not fail the audit
+  std::vector<std::string> warnings;
+
+  // slowest generated input and its check time
+  std::string worst_input;
+  std::uint64_t worst_nanoseconds;
+
+  // time ratio of the slowest input family when its size doubles
+  // (~2 -- linear, ~4 -- quadratic)
+  double growth;
+
+  bool Passed() const {
+    return problems.empty();
+  }
+
+};
+
+// Look for super-linear backtracking without running the pattern: nested
+// quantifiers whose inner repetition can also start the next iteration,
+// alternatives under a quantifier that start with the same characters, and
+// adjacent quantifiers that can consume the same characters. The analysis
+// is approximate and covers the ECMAScript subset used by the rules.
+void AnalyzePattern(const std::string& pattern, RegexAudit& audit);
+
+// Time the pattern on worst-case inputs generated from its literals and
+// quantified character classes, doubling their size up to the limit
+void FuzzPattern(const std::string& pattern,
+                 const RegexFuzzOptions& options,
+                 RegexAudit& audit);
+
+}  // namespace sqlcheck
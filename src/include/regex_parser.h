@@ -0,0 +1,63 @@
+// REGEX PARSER HEADER
+
+#pragma once
+
+#include <bitset>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace sqlcheck {
+
+typedef std::bitset<256> CharSet;
+
+const std::size_t kUnbounded = std::numeric_limits<std::size_t>::max();
+
+enum RegexItemType {
+  REGEX_ITEM_CHARS = 0,
+  REGEX_ITEM_GROUP = 1,
+  REGEX_ITEM_ASSERTION = 2
+};
+
+struct RegexGroup;
+
+// Quantified atom of a pattern
+struct RegexItem {
+
+  RegexItem()
+   : type(REGEX_ITEM_CHARS),
+     min(1),
+     max(1) {
+  }
+
+  RegexItemType type;
+
+  // characters matched by a REGEX_ITEM_CHARS item
+  CharSet chars;
+
+  // alternatives of a group (and of a lookahead assertion)
+  std::shared_ptr<RegexGroup> group;
+
+  std::size_t min;
+
+  std::size_t max;
+
+};
+
+typedef std::vector<RegexItem> RegexSequence;
+
+struct RegexGroup {
+
+  std::vector<RegexSequence> alternatives;
+
+};
+
+// Parse the ECMAScript subset used by the rules. Sets
+// has_control_characters if the pattern contains one (e.g. "\b" written
+// as a backspace).
+std::shared_ptr<RegexGroup> ParseRegex(const std::string& pattern,
+                                       bool& has_control_characters);
+
+}  // namespace sqlcheck
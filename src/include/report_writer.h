@@ -0,0 +1,155 @@
+// REPORT WRITER HEADER
+
+#pragma once
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "configuration.h"
+
+namespace sqlcheck {
+
+// Buffered output to a file descriptor (closed on destruction). Used for
+// report files, and to keep stdout for a report once the console output
+// goes elsewhere.
+class FileDescriptorBuffer : public std::streambuf {
+
+ public:
+  explicit FileDescriptorBuffer(const int fd);
+
+  ~FileDescriptorBuffer();
+
+ protected:
+  int overflow(int c) override;
+
+  int sync() override;
+
+ private:
+
+  // Write out the buffered bytes
+  bool Flush();
+
+  int fd_;
+
+  std::vector<char> buffer_;
+
+};
+
+// Writes the findings of a check in a structured format. Findings are
+// written as they are found, so the memory use does not grow with the
+// number of findings.
+class ReportWriter {
+
+ public:
+  ReportWriter()
+   : finding_count_(0) {
+  }
+
+  virtual ~ReportWriter() {
+  }
+
+  // Write what comes before the findings
+  virtual void Begin() = 0;
+
+  // Write a finding of a file ("" -- standard input)
+  virtual void WriteFinding(const std::string& file_name,
+                            const Finding& finding) = 0;
+
+  // Write what comes after the findings
+  virtual void End(const Configuration& state) = 0;
+
+  std::uint64_t GetFindingCount() const {
+    return finding_count_;
+  }
+
+ protected:
+
+  std::uint64_t finding_count_;
+
+};
+
+// Writes the findings in a format on its own thread, so a slow sink does
+// not hold up the check. The checker blocks once a batch of findings is
+// queued, so the memory use stays flat.
+class ThreadedReportWriter : public ReportWriter {
+
+ public:
+  ThreadedReportWriter(const OutputFormat& output_format,
+                       std::unique_ptr<std::streambuf> buffer);
+
+  ~ThreadedReportWriter();
+
+  void Begin() override;
+
+  void WriteFinding(const std::string& file_name,
+                    const Finding& finding) override;
+
+  // Waits until every finding is written
+  void End(const Configuration& state) override;
+
+ private:
+
+  // Write the queued findings in batches
+  void Run();
+
+  std::unique_ptr<std::streambuf> buffer_;
+
+  std::ostream output_;
+
+  std::unique_ptr<ReportWriter> writer_;
+
+  std::mutex mutex_;
+
+  std::condition_variable condition_;
+
+  // findings not written yet
+  std::vector<std::pair<std::string, Finding>> queue_;
+
+  // state to summarize once the queue is drained (nullptr -- abandon)
+  const Configuration* end_state_;
+
+  bool done_;
+
+  std::thread thread_;
+
+};
+
+// Passes every finding on to several writers
+class FanOutReportWriter : public ReportWriter {
+
+ public:
+  explicit FanOutReportWriter(std::vector<std::unique_ptr<ReportWriter>> writers)
+   : writers_(std::move(writers)) {
+  }
+
+  void Begin() override;
+
+  void WriteFinding(const std::string& file_name,
+                    const Finding& finding) override;
+
+  void End(const Configuration& state) override;
+
+ private:
+
+  std::vector<std::unique_ptr<ReportWriter>> writers_;
+
+};
+
+// Get a writer for a structured format (nullptr -- text)
+std::unique_ptr<ReportWriter> CreateReportWriter(const OutputFormat& output_format,
+                                                 std::ostream& output);
+
+// Open a writer on its own thread for every structured sink and fan the
+// findings out to them (nullptr -- text only). Files are truncated, the "-"
+// sink takes over stdout_fd. Throws if a file cannot be opened.
+std::unique_ptr<ReportWriter> OpenReportSinks(const std::vector<OutputSink>& output_sinks,
+                                              const int stdout_fd);
+
+}  // namespace sqlcheck
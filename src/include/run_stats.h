@@ -0,0 +1,205 @@
+// RUN STATS HEADER
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <regex>
+#include <string>
+#include <vector>
+
+namespace sqlcheck {
+
+// Compile a rule pattern (counted in the run statistics)
+std::regex CompileRegex(const std::string& pattern);
+
+// Patterns compiled by this process
+std::uint64_t GetRegexCompilations();
+
+// Peak resident set size of this process in bytes
+std::uint64_t GetPeakRss();
+
+// HDR-style latency histogram. Values below 64 get a bucket each, larger
+// values share log-linear buckets, so a percentile is within ~3% of the
+// recorded value at any magnitude.
+class LatencyHistogram {
+
+ public:
+  LatencyHistogram();
+
+  void Record(const std::uint64_t value);
+
+  void Merge(const LatencyHistogram& other);
+
+  // Highest value of the bucket holding the given fraction of the values
+  std::uint64_t GetPercentile(const double fraction) const;
+
+  std::uint64_t GetCount() const {
+    return count_;
+  }
+
+  std::uint64_t GetTotal() const {
+    return total_;
+  }
+
+  std::uint64_t GetMax() const {
+    return max_;
+  }
+
+ private:
+
+  std::vector<std::uint64_t> buckets_;
+
+  std::uint64_t count_;
+
+  std::uint64_t total_;
+
+  std::uint64_t max_;
+
+};
+
+// Statement that took long to check
+struct SlowStatement {
+
+  SlowStatement()
+   : nanoseconds(0),
+     sequence(0),
+     offset(0),
+     length(0),
+     line_number(0),
+     rule_id(""),
+     rule_name(""),
+     rule_nanoseconds(0) {
+  }
+
+  // check latency
+  std::uint64_t nanoseconds;
+
+  // statements checked by the configuration before this one
+  std::uint64_t sequence;
+
+  std::string file_name;
+
+  // byte offset and length of the statement in the input
+  std::uint64_t offset;
+
+  std::uint64_t length;
+
+  std::uint32_t line_number;
+
+  // rule that took the most time
+  const char* rule_id;
+
+  const char* rule_name;
+
+  std::uint64_t rule_nanoseconds;
+
+};
+
+// The N slowest statements of a run, kept in a fixed-size min-heap
+class SlowestStatements {
+
+ public:
+  SlowestStatements()
+   : capacity_(0) {
+  }
+
+  // Check if a latency would make it into the heap (cheap, so the
+  // statement is only described when it does)
+  bool IsSlowEnough(const std::uint64_t nanoseconds,
+                    const std::size_t capacity) const {
+    return capacity > 0 &&
+        (heap_.size() < capacity || nanoseconds > heap_.front().nanoseconds);
+  }
+
+  // Keep a statement if it is one of the capacity slowest
+  void Add(const SlowStatement& statement, const std::size_t capacity);
+
+  void Merge(const SlowestStatements& other);
+
+  // Get the statements, slowest first
+  std::vector<SlowStatement> GetSorted() const;
+
+  // Get the heap (any order)
+  std::vector<SlowStatement>& GetEntries() {
+    return heap_;
+  }
+
+ private:
+
+  std::vector<SlowStatement> heap_;
+
+  std::size_t capacity_;
+
+};
+
+// Throughput and resource usage of a run. Every thread fills the stats of
+// its own configuration, and the stats are merged at the end.
+struct RunStats {
+
+  RunStats()
+   : statements(0),
+     bytes(0),
+     elapsed_nanoseconds(0),
+     regex_compilations(0),
+     peak_rss_bytes(0),
+     skipped_statements(0),
+     skipped_rules(0),
+     start_regex_compilations(0) {
+  }
+
+  // Start timing the run
+  void Start();
+
+  // Stop timing the run and sample the process counters
+  void Stop();
+
+  // Add the statements of another configuration
+  void Merge(const RunStats& other);
+
+  // checked statements
+  std::uint64_t statements;
+
+  // bytes of the checked statements
+  std::uint64_t bytes;
+
+  // check latency of every statement (nanoseconds)
+  LatencyHistogram latency;
+
+  // slowest statements (see Configuration::top_slowest)
+  SlowestStatements slowest;
+
+  // wall time of the run
+  std::uint64_t elapsed_nanoseconds;
+
+  // patterns compiled during the run
+  std::uint64_t regex_compilations;
+
+  std::uint64_t peak_rss_bytes;
+
+  // statements above the size cap, and rule checks out of budget
+  std::uint64_t skipped_statements;
+
+  std::uint64_t skipped_rules;
+
+  // process counters when the run started
+  std::chrono::steady_clock::time_point start_time;
+
+  std::uint64_t start_regex_compilations;
+
+};
+
+// Print the run statistics block of the summary
+void PrintRunStats(const RunStats& stats, std::ostream& output);
+
+// Print the number of skipped checks (if there are any)
+void PrintSkippedChecks(const RunStats& stats, std::ostream& output);
+
+// Print the slowest statements
+void PrintSlowestStatements(const RunStats& stats, std::ostream& output);
+
+// Write the run statistics as a JSON object
+void WriteRunStatsJson(const RunStats& stats, std::ostream& output);
+
+}  // namespace sqlcheck
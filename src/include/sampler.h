@@ -0,0 +1,89 @@
+// SAMPLER HEADER
+
+#pragma once
+
+#include <chrono>
+#include <ostream>
+#include <random>
+#include <unordered_map>
+
+#include "configuration.h"
+
+namespace sqlcheck {
+
+// Sampling front-end for high-volume statement streams.
+//
+// Every statement is admitted with an inclusion probability that depends on
+// the sampling mode. Findings of admitted statements are weighted by the
+// inverse of that probability (Horvitz-Thompson) to estimate the number of
+// findings over the whole stream.
+class Sampler {
+
+ public:
+  explicit Sampler(const Configuration& state);
+
+  // Check the statement if it is admitted into the sample
+  void CheckStatement(Configuration& state,
+                      const std::string& sql_statement);
+
+  // Print estimated population-level finding counts
+  void PrintSummary(const Configuration& state, std::ostream& output) const;
+
+  // Estimated finding count for the given risk level
+  double GetEstimate(const RiskLevel risk_level) const;
+
+  // Half-width of the 95% confidence interval of the estimate
+  double GetConfidenceInterval(const RiskLevel risk_level) const;
+
+  std::uint64_t GetSeenCount() const {
+    return seen_count_;
+  }
+
+  std::uint64_t GetCheckedCount() const {
+    return checked_count_;
+  }
+
+ private:
+
+  // Inclusion probability of the next statement
+  double GetInclusionProbability(const std::string& sql_statement);
+
+  // sampling mode
+  SampleMode sample_mode_;
+
+  // fixed sampling rate
+  double sample_rate_;
+
+  // per-fingerprint reservoir size
+  std::uint64_t reservoir_size_;
+
+  // fraction of a core to spend on checking
+  double budget_;
+
+  // random number generator
+  std::mt19937_64 generator_;
+
+  // statements seen per fingerprint
+  std::unordered_map<std::uint64_t, std::uint64_t> fingerprint_counts_;
+
+  // start of the sampling run
+  std::chrono::steady_clock::time_point start_time_;
+
+  // time spent checking admitted statements
+  std::chrono::duration<double> check_time_;
+
+  // statements seen
+  std::uint64_t seen_count_;
+
+  // statements checked
+  std::uint64_t checked_count_;
+
+  // estimated finding count per risk level
+  double estimates_[RISK_LEVEL_HIGH + 1];
+
+  // estimated variance per risk level
+  double variances_[RISK_LEVEL_HIGH + 1];
+
+};
+
+}  // namespace sqlcheck
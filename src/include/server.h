@@ -0,0 +1,143 @@
+// SERVER HEADER
+
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "configuration.h"
+#include "worker_pool.h"
+
+namespace sqlcheck {
+
+// Check daemon serving requests over a Unix domain socket.
+//
+// Requests and responses are length-prefixed frames (4-byte big-endian
+// length followed by the payload). A request carries SQL text and the
+// response carries a JSON object with the findings and the skipped checks.
+// Responses on a connection are returned in request order.
+//
+// Memory is bounded by backpressure: a connection stops being read while it
+// buffers too many bytes, and requests wait in the connection while the
+// worker queue is full.
+class Server {
+
+ public:
+  Server(const Configuration& state, const std::string& socket_path);
+
+  ~Server();
+
+  // Bind the socket and start the workers (returns false on failure)
+  bool Start();
+
+  // Run the event loop until Stop is called
+  void Run();
+
+  // Stop the event loop (thread-safe and async-signal-safe)
+  void Stop();
+
+ private:
+
+  // Client connection
+  struct Connection {
+    int fd;
+
+    // unparsed request bytes
+    std::string input;
+
+    // unsent response bytes
+    std::string output;
+
+    // sequence number of the next request
+    std::uint64_t next_request;
+
+    // sequence number of the next response to send
+    std::uint64_t next_response;
+
+    // completed responses waiting for earlier ones
+    std::map<std::uint64_t, std::string> completed;
+
+    // waiting for EPOLLIN
+    bool reading;
+
+    // waiting for EPOLLOUT
+    bool writing;
+
+    // client closed its end
+    bool closing;
+  };
+
+  // Completed request
+  struct Completion {
+    std::uint64_t connection_id;
+    std::uint64_t sequence;
+    std::size_t request_size;
+    std::string response;
+  };
+
+  void Accept();
+
+  void Read(std::uint64_t connection_id);
+
+  // Queue the complete requests of a connection while the queue has room
+  void Dispatch(std::uint64_t connection_id);
+
+  void Write(std::uint64_t connection_id);
+
+  void Close(std::uint64_t connection_id);
+
+  void DrainCompletions();
+
+  void UpdateEvents(Connection& connection, std::uint64_t connection_id);
+
+  // checker options
+  Configuration options_;
+
+  // socket path
+  std::string socket_path_;
+
+  // listening socket
+  int listen_fd_;
+
+  // epoll instance
+  int epoll_fd_;
+
+  // wakes the loop when requests complete
+  int completion_fd_;
+
+  // wakes the loop on shutdown
+  int stop_fd_;
+
+  // open connections
+  std::unordered_map<std::uint64_t, Connection> connections_;
+
+  // next connection id
+  std::uint64_t next_connection_id_;
+
+  // bytes of the requests queued or running
+  std::size_t queued_bytes_;
+
+  // completed requests
+  std::deque<Completion> completions_;
+
+  // protects completions
+  std::mutex completion_mutex_;
+
+  // per-worker checker state
+  std::vector<std::unique_ptr<Configuration>> worker_states_;
+
+  // workers
+  std::unique_ptr<WorkerPool> pool_;
+
+};
+
+// Run the check daemon until it is interrupted
+int Serve(const Configuration& state);
+
+}  // namespace sqlcheck
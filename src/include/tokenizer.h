@@ -0,0 +1,56 @@
+// TOKENIZER HEADER
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace sqlcheck {
+
+enum TokenType {
+  TOKEN_TYPE_WORD = 0,        // keyword or identifier (lower case)
+  TOKEN_TYPE_IDENTIFIER = 1,  // quoted identifier ("x", `x` or [x])
+  TOKEN_TYPE_STRING = 2,      // string literal
+  TOKEN_TYPE_NUMBER = 3,      // numeric literal
+  TOKEN_TYPE_PARAMETER = 4,   // ?, $1, :name or @name
+  TOKEN_TYPE_SYMBOL = 5       // operator or punctuation
+};
+
+// SQL token
+struct Token {
+
+  TokenType type;
+
+  // text (words in lower case, quoted identifiers without quotes)
+  std::string text;
+
+  // offset in the statement
+  std::size_t begin;
+
+  // length in the statement
+  std::size_t length;
+
+  // check if the token is the given word or symbol
+  bool Is(const char* value) const {
+    return (type == TOKEN_TYPE_WORD || type == TOKEN_TYPE_SYMBOL) &&
+        text == value;
+  }
+
+  // check if the token names something (table, column, index)
+  bool IsName() const {
+    return type == TOKEN_TYPE_WORD || type == TOKEN_TYPE_IDENTIFIER;
+  }
+
+};
+
+// Split a SQL statement into tokens (comments and whitespace are dropped)
+void Tokenize(const std::string& sql_statement,
+              std::vector<Token>& tokens);
+
+// Find the token closing the parenthesis at the given token
+// (returns tokens.size() if it is not closed)
+std::size_t FindClosingParenthesis(const std::vector<Token>& tokens,
+                                   std::size_t open);
+
+}  // namespace sqlcheck
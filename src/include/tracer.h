@@ -0,0 +1,78 @@
+// TRACER HEADER
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace sqlcheck {
+
+// Set while a trace is recorded (checked before every span)
+extern std::atomic<bool> tracing_enabled;
+
+inline bool IsTracing(){
+  return tracing_enabled.load(std::memory_order_relaxed);
+}
+
+// Start recording spans (the trace time starts at zero)
+void StartTracing();
+
+// Stop recording spans and drop the recorded ones
+void StopTracing();
+
+// Nanoseconds since the trace was started
+std::uint64_t GetTraceTime();
+
+// Name the calling thread in the trace
+void SetTraceThreadName(const std::string& name);
+
+// Record a span of the calling thread. Names and categories must be
+// string literals or otherwise outlive the trace.
+void RecordTraceSpan(const char* name,
+                     const char* category,
+                     const std::uint64_t start,
+                     const std::uint64_t end);
+
+// Write the recorded spans as Chrome trace-event JSON (loads in Perfetto and
+// chrome://tracing). Call once the traced threads are done.
+void WriteTrace(std::ostream& output);
+
+// Record the scope as a span of the calling thread (no-op when not tracing)
+class TraceSpan {
+
+ public:
+  TraceSpan(const char* name, const char* category)
+   : name_(name),
+     category_(category),
+     active_(IsTracing()),
+     start_(0) {
+    if(active_ == true){
+      start_ = GetTraceTime();
+    }
+  }
+
+  ~TraceSpan(){
+    if(active_ == true){
+      RecordTraceSpan(name_, category_, start_, GetTraceTime());
+    }
+  }
+
+ private:
+
+  TraceSpan(const TraceSpan&) = delete;
+
+  TraceSpan& operator=(const TraceSpan&) = delete;
+
+  const char* name_;
+
+  const char* category_;
+
+  bool active_;
+
+  std::uint64_t start_;
+
+};
+
+}  // namespace sqlcheck
@@ -0,0 +1,107 @@
+// WATCHER HEADER
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "configuration.h"
+
+namespace sqlcheck {
+
+// Watch mode: re-checks .sql files as they change and prints the findings
+// that appeared (+) and disappeared (-).
+//
+// Per-statement results are cached by statement hash, so only statements
+// whose text changed are re-evaluated when a file is saved.
+class Watcher {
+
+ public:
+  Watcher(const Configuration& state, const std::string& root);
+
+  ~Watcher();
+
+  // Check every .sql file below root and start watching it
+  bool Start(std::ostream& output);
+
+  // Process file system events until Stop is called
+  void Run(std::ostream& output);
+
+  // Stop the event loop (thread-safe and async-signal-safe)
+  void Stop();
+
+  // Re-check a file and print the finding diff
+  void UpdateFile(const std::string& path, std::ostream& output);
+
+  // Forget a deleted file and print the findings that disappeared
+  void RemoveFile(const std::string& path, std::ostream& output);
+
+  // Statements checked by the last update
+  std::size_t GetLastCheckedCount() const {
+    return last_checked_count_;
+  }
+
+ private:
+
+  // Finding in a file
+  struct FileFinding {
+
+    // identifies the finding across edits
+    std::string key;
+
+    // absolute line number
+    std::uint32_t line_number;
+
+    Finding finding;
+
+  };
+
+  // Checked file
+  struct File {
+
+    // findings by statement hash (lines relative to the statement)
+    std::unordered_map<std::uint64_t, std::vector<Finding>> statements;
+
+    // current findings
+    std::vector<FileFinding> findings;
+
+  };
+
+  void AddWatch(const std::string& directory);
+
+  void PrintFinding(std::ostream& output,
+                    const char* marker,
+                    const std::string& path,
+                    const FileFinding& file_finding) const;
+
+  // checker state
+  Configuration state_;
+
+  // watched directory
+  std::string root_;
+
+  // inotify instance
+  int inotify_fd_;
+
+  // wakes the loop on shutdown
+  int stop_fd_;
+
+  // watched directories by watch descriptor
+  std::unordered_map<int, std::string> directories_;
+
+  // checked files by path
+  std::map<std::string, File> files_;
+
+  // statements checked by the last update
+  std::size_t last_checked_count_;
+
+};
+
+// Run watch mode until it is interrupted
+int Watch(const Configuration& state);
+
+}  // namespace sqlcheck
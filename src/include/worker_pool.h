@@ -0,0 +1,55 @@
+// WORKER POOL HEADER
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sqlcheck {
+
+// Fixed-size pool of worker threads
+class WorkerPool {
+
+ public:
+  // Task (gets the id of the worker running it)
+  typedef std::function<void(std::size_t worker_id)> Task;
+
+  // Start the workers (0 -- number of cores)
+  explicit WorkerPool(std::size_t num_workers);
+
+  // Run the pending tasks and stop the workers
+  ~WorkerPool();
+
+  // Queue a task
+  void Submit(Task task);
+
+  std::size_t GetWorkerCount() const {
+    return workers_.size();
+  }
+
+ private:
+
+  void Run(std::size_t worker_id);
+
+  // worker threads
+  std::vector<std::thread> workers_;
+
+  // pending tasks
+  std::deque<Task> tasks_;
+
+  // protects tasks and shutdown flag
+  std::mutex mutex_;
+
+  // signals new tasks
+  std::condition_variable condition_;
+
+  // stop the workers
+  bool shutdown_;
+
+};
+
+}  // namespace sqlcheck
@@ -0,0 +1,643 @@
+// INDEX ADVISOR SOURCE
+
+#include <algorithm>
+#include <map>
+#include <unordered_set>
+
+#include "include/index_advisor.h"
+
+#include "include/fingerprint.h"
+#include "include/tokenizer.h"
+
+namespace sqlcheck {
+
+// UTILITY
+
+enum Clause {
+  CLAUSE_OTHER = 0,
+  CLAUSE_SELECT = 1,
+  CLAUSE_FROM = 2,
+  CLAUSE_WHERE = 3,
+  CLAUSE_ON = 4,
+  CLAUSE_ORDER = 5
+};
+
+// Table read by a query
+struct TableAccess {
+
+  const Table* table;
+
+  // columns compared with =, IN or IS
+  std::vector<Symbol> equality;
+
+  // columns compared with <, >, BETWEEN or LIKE
+  std::vector<Symbol> range;
+
+  // ORDER BY columns in order
+  std::vector<Symbol> order;
+
+  // all columns read by the query
+  std::vector<Symbol> referenced;
+
+  // some predicate columns come from a JOIN condition
+  bool join;
+
+  // the query reads all columns
+  bool select_star;
+
+};
+
+bool IsKeyword(const Token& token){
+
+  static const std::unordered_set<std::string> keywords = {
+    "all", "and", "any", "as", "asc", "between", "by", "case", "cross",
+    "current_date", "current_time", "current_timestamp", "default", "delete",
+    "desc", "distinct", "else", "end", "escape", "except", "exists", "false",
+    "fetch", "first", "for", "from", "full", "group", "having", "ilike", "in",
+    "inner", "insert", "intersect", "interval", "into", "is", "join", "last",
+    "lateral", "left", "like", "limit", "natural", "not", "null", "nulls",
+    "offset", "on", "or", "order", "outer", "over", "partition", "right",
+    "rows", "select", "set", "some", "straight_join", "then", "true", "union",
+    "unknown", "update", "using", "values", "when", "where", "window", "with"
+  };
+
+  return token.type == TOKEN_TYPE_WORD && keywords.count(token.text) != 0;
+}
+
+void AddUnique(std::vector<Symbol>& symbols, const Symbol symbol){
+  if(std::find(symbols.begin(), symbols.end(), symbol) == symbols.end()){
+    symbols.push_back(symbol);
+  }
+}
+
+bool Contains(const std::vector<Symbol>& symbols, const Symbol symbol){
+  return std::find(symbols.begin(), symbols.end(), symbol) != symbols.end();
+}
+
+// Collect the tables read by a query (and their aliases)
+void FindTables(const Catalog& catalog,
+                const std::vector<Token>& tokens,
+                std::vector<TableAccess>& accesses,
+                std::map<std::string, std::size_t>& aliases){
+
+  std::vector<std::size_t> from_depths;
+  std::size_t depth = 0;
+
+  for(std::size_t pos = 0; pos < tokens.size(); pos++){
+    auto& token = tokens[pos];
+    if(token.Is("(")){
+      depth++;
+      continue;
+    }
+    if(token.Is(")")){
+      depth = (depth > 0) ? depth - 1 : 0;
+      while(from_depths.empty() == false && from_depths.back() > depth){
+        from_depths.pop_back();
+      }
+      continue;
+    }
+
+    bool in_from = from_depths.empty() == false && from_depths.back() == depth;
+    bool table_follows = token.Is("from") || token.Is("join") ||
+        (token.Is("update") && pos == 0) || (token.Is(",") && in_from);
+    if(IsKeyword(token) && table_follows == false){
+      // any other clause ends the FROM clause
+      if(in_from == true && token.Is("as") == false &&
+          token.Is("inner") == false && token.Is("left") == false &&
+          token.Is("right") == false && token.Is("full") == false &&
+          token.Is("outer") == false && token.Is("cross") == false &&
+          token.Is("natural") == false && token.Is("lateral") == false){
+        from_depths.pop_back();
+      }
+      continue;
+    }
+    if(table_follows == false){
+      continue;
+    }
+    if(token.Is("from") || token.Is("update")){
+      if(in_from == false){
+        from_depths.push_back(depth);
+      }
+    }
+
+    // Table name
+    auto name_pos = pos + 1;
+    if(name_pos >= tokens.size() || tokens[name_pos].IsName() == false ||
+        IsKeyword(tokens[name_pos])){
+      continue;
+    }
+    auto last = name_pos;
+    while(last + 2 < tokens.size() && tokens[last + 1].Is(".") &&
+        tokens[last + 2].IsName()){
+      last += 2;
+    }
+
+    TableAccess access;
+    access.table = catalog.FindTable(tokens[last].text);
+    access.join = false;
+    access.select_star = false;
+    aliases[tokens[last].text] = accesses.size();
+
+    // Alias
+    auto alias_pos = last + 1;
+    if(alias_pos < tokens.size() && tokens[alias_pos].Is("as")){
+      alias_pos++;
+    }
+    if(alias_pos < tokens.size() && tokens[alias_pos].IsName() &&
+        IsKeyword(tokens[alias_pos]) == false){
+      aliases[tokens[alias_pos].text] = accesses.size();
+      last = alias_pos;
+    }
+
+    accesses.push_back(access);
+    pos = last;
+  }
+
+}
+
+// Find the table of a column
+bool ResolveColumn(const Catalog& catalog,
+                   std::vector<TableAccess>& accesses,
+                   const std::map<std::string, std::size_t>& aliases,
+                   const std::string& qualifier,
+                   const std::string& name,
+                   std::size_t& access_id,
+                   Symbol& column){
+
+  if(qualifier.empty() == false){
+    auto alias = aliases.find(qualifier);
+    if(alias == aliases.end() || accesses[alias->second].table == nullptr){
+      return false;
+    }
+    auto entry = catalog.FindColumn(*accesses[alias->second].table, name);
+    if(entry == nullptr){
+      return false;
+    }
+    access_id = alias->second;
+    column = entry->name;
+    return true;
+  }
+
+  // Unqualified columns must belong to exactly one table
+  bool found = false;
+  for(std::size_t id = 0; id < accesses.size(); id++){
+    if(accesses[id].table == nullptr){
+      continue;
+    }
+    auto entry = catalog.FindColumn(*accesses[id].table, name);
+    if(entry != nullptr){
+      if(found == true && accesses[id].table != accesses[access_id].table){
+        return false;
+      }
+      found = true;
+      access_id = id;
+      column = entry->name;
+    }
+  }
+
+  return found;
+}
+
+// Collect the predicate, ORDER BY and referenced columns of a query
+void AnalyzeQuery(const Catalog& catalog,
+                  const std::string& sql_statement,
+                  std::vector<TableAccess>& accesses){
+
+  std::vector<Token> tokens;
+  Tokenize(sql_statement, tokens);
+  if(tokens.empty() || (tokens[0].Is("select") == false &&
+      tokens[0].Is("with") == false && tokens[0].Is("update") == false &&
+      tokens[0].Is("delete") == false)){
+    return;
+  }
+
+  std::map<std::string, std::size_t> aliases;
+  FindTables(catalog, tokens, accesses, aliases);
+  if(accesses.empty()){
+    return;
+  }
+
+  // Clause at every parenthesis depth
+  std::vector<Clause> clauses(1, CLAUSE_OTHER);
+
+  for(std::size_t pos = 0; pos < tokens.size(); pos++){
+    auto& token = tokens[pos];
+    auto& clause = clauses.back();
+
+    if(token.Is("(")){
+      clauses.push_back(clause);
+      continue;
+    }
+    if(token.Is(")")){
+      if(clauses.size() > 1){
+        clauses.pop_back();
+      }
+      continue;
+    }
+
+    if(token.type == TOKEN_TYPE_WORD){
+      if(token.Is("select")){
+        clause = CLAUSE_SELECT;
+      }
+      else if(token.Is("from") || token.Is("join") || token.Is("update")){
+        clause = CLAUSE_FROM;
+      }
+      else if(token.Is("where")){
+        clause = CLAUSE_WHERE;
+      }
+      else if(token.Is("on")){
+        clause = CLAUSE_ON;
+      }
+      else if(token.Is("order") && pos + 1 < tokens.size() &&
+          tokens[pos + 1].Is("by")){
+        clause = CLAUSE_ORDER;
+        pos++;
+        continue;
+      }
+      else if(token.Is("group") || token.Is("having") || token.Is("limit") ||
+          token.Is("union") || token.Is("set") || token.Is("returning")){
+        clause = CLAUSE_OTHER;
+      }
+    }
+
+    // SELECT * and SELECT t.*
+    if(token.Is("*") && clause == CLAUSE_SELECT){
+      bool qualified = pos >= 2 && tokens[pos - 1].Is(".");
+      auto alias = qualified ? aliases.find(tokens[pos - 2].text) : aliases.end();
+      for(std::size_t id = 0; id < accesses.size(); id++){
+        if(qualified == false || (alias != aliases.end() && alias->second == id)){
+          accesses[id].select_star = true;
+        }
+      }
+      continue;
+    }
+
+    if(clause == CLAUSE_FROM || token.IsName() == false || IsKeyword(token)){
+      continue;
+    }
+
+    // Column reference: column, table.column or schema.table.column
+    auto begin = pos;
+    std::string qualifier;
+    std::string name = token.text;
+    while(pos + 2 < tokens.size() && tokens[pos + 1].Is(".") &&
+        tokens[pos + 2].IsName()){
+      qualifier = name;
+      name = tokens[pos + 2].text;
+      pos += 2;
+    }
+    if(pos + 1 < tokens.size() && (tokens[pos + 1].Is("(") ||
+        tokens[pos + 1].Is("."))){
+      continue;
+    }
+
+    std::size_t access_id = 0;
+    Symbol column;
+    if(ResolveColumn(catalog, accesses, aliases, qualifier, name,
+                     access_id, column) == false){
+      continue;
+    }
+    auto& access = accesses[access_id];
+    AddUnique(access.referenced, column);
+
+    if(clause == CLAUSE_ORDER){
+      AddUnique(access.order, column);
+      continue;
+    }
+    if(clause != CLAUSE_WHERE && clause != CLAUSE_ON){
+      continue;
+    }
+
+    // Comparison after or before the column
+    const Token* next = (pos + 1 < tokens.size()) ? &tokens[pos + 1] : nullptr;
+    const Token* previous = (begin > 0) ? &tokens[begin - 1] : nullptr;
+    bool equality = false;
+    bool range = false;
+    if(next != nullptr){
+      equality = next->Is("=") || next->Is("in") || next->Is("is");
+      range = next->Is("<") || next->Is(">") || next->Is("<=") ||
+          next->Is(">=") || next->Is("between") || next->Is("like");
+    }
+    if(equality == false && range == false && previous != nullptr){
+      equality = previous->Is("=");
+      range = previous->Is("<") || previous->Is(">") || previous->Is("<=") ||
+          previous->Is(">=");
+    }
+
+    if(equality == true){
+      AddUnique(access.equality, column);
+    }
+    else if(range == true){
+      AddUnique(access.range, column);
+    }
+    if((equality == true || range == true) && clause == CLAUSE_ON){
+      access.join = true;
+    }
+  }
+
+}
+
+// How well an index serves a table access
+struct IndexMatch {
+
+  // leading index columns matched by equality predicates
+  std::size_t prefix;
+
+  // the next index column is matched by a range predicate
+  bool range;
+
+  // the index returns rows in ORDER BY order
+  bool order;
+
+  // the index holds every column the query reads
+  bool covering;
+
+  bool IsUsable() const {
+    return prefix > 0 || range == true;
+  }
+
+  bool IsBetterThan(const IndexMatch& other) const {
+    auto score = prefix * 2 + (range ? 1 : 0);
+    auto other_score = other.prefix * 2 + (other.range ? 1 : 0);
+    if(score != other_score){
+      return score > other_score;
+    }
+    if(order != other.order){
+      return order;
+    }
+    return covering == true && other.covering == false;
+  }
+
+};
+
+IndexMatch MatchIndex(const TableAccess& access, const Index& index){
+
+  IndexMatch match;
+  auto& columns = index.columns;
+
+  // Leftmost prefix
+  match.prefix = 0;
+  while(match.prefix < columns.size() &&
+      Contains(access.equality, columns[match.prefix])){
+    match.prefix++;
+  }
+  match.range = match.prefix < columns.size() &&
+      Contains(access.range, columns[match.prefix]);
+
+  // ORDER BY columns that are not fixed by equality must follow the prefix
+  // (starting with the range column, if any)
+  match.order = false;
+  std::vector<Symbol> order;
+  for(auto column : access.order){
+    if(Contains(access.equality, column) == false){
+      order.push_back(column);
+    }
+  }
+  if(access.order.empty() == false){
+    match.order = order.size() <= columns.size() - match.prefix &&
+        std::equal(order.begin(), order.end(), columns.begin() + match.prefix);
+  }
+
+  match.covering = access.select_star == false;
+  for(auto column : access.referenced){
+    match.covering = match.covering && Contains(columns, column);
+  }
+
+  return match;
+}
+
+std::string JoinNames(const Catalog& catalog,
+                      const std::vector<Symbol>& symbols){
+  std::string text;
+  for(auto symbol : symbols){
+    text += (text.empty() ? "" : ", ") + catalog.GetString(symbol);
+  }
+  return text;
+}
+
+std::vector<std::string> GetNames(const Catalog& catalog,
+                                  const std::vector<Symbol>& symbols){
+  std::vector<std::string> names;
+  for(auto symbol : symbols){
+    names.push_back(catalog.GetString(symbol));
+  }
+  return names;
+}
+
+// INDEX ADVISOR
+
+IndexAdvisor::IndexAdvisor()
+ : query_count_(0) {
+}
+
+void IndexAdvisor::AddQuery(const std::string& sql_statement){
+
+  auto fingerprint = GetFingerprint(sql_statement);
+  if(fingerprint.compare(0, 6, "select") != 0 &&
+      fingerprint.compare(0, 4, "with") != 0 &&
+      fingerprint.compare(0, 6, "update") != 0 &&
+      fingerprint.compare(0, 6, "delete") != 0){
+    return;
+  }
+
+  query_count_++;
+  auto& group = groups_[HashString(fingerprint)];
+  if(group.count++ == 0){
+    group.example = sql_statement;
+  }
+}
+
+void IndexAdvisor::Analyze(const Catalog& catalog, IndexAdvice& advice) const {
+
+  advice.unserved_predicates.clear();
+  advice.indexes.clear();
+  advice.query_count = query_count_;
+  advice.fingerprint_count = groups_.size();
+
+  std::map<std::string, PredicateAdvice> unserved;
+  std::map<std::pair<const Table*, std::size_t>, std::pair<std::uint64_t, std::uint64_t>> usage;
+
+  for(auto& entry : groups_){
+    auto& group = entry.second;
+    std::vector<TableAccess> accesses;
+    AnalyzeQuery(catalog, group.example, accesses);
+
+    for(auto& access : accesses){
+      if(access.table == nullptr){
+        continue;
+      }
+      auto& indexes = access.table->indexes;
+      bool has_predicate = access.equality.empty() == false ||
+          access.range.empty() == false;
+
+      // Pick the best index for the predicate
+      std::size_t best = indexes.size();
+      std::size_t best_order = indexes.size();
+      IndexMatch best_match = IndexMatch();
+      for(std::size_t id = 0; id < indexes.size(); id++){
+        auto match = MatchIndex(access, indexes[id]);
+        if(match.IsUsable() &&
+            (best == indexes.size() || match.IsBetterThan(best_match))){
+          best = id;
+          best_match = match;
+        }
+        if(match.order == true && best_order == indexes.size()){
+          best_order = id;
+        }
+      }
+
+      if(best != indexes.size()){
+        auto& counts = usage[std::make_pair(access.table, best)];
+        counts.first += group.count;
+        counts.second += best_match.covering ? group.count : 0;
+      }
+      else if(has_predicate == true){
+        // Predicate without a usable index
+        std::vector<Symbol> columns = access.equality;
+        columns.insert(columns.end(), access.range.begin(), access.range.end());
+        std::vector<Symbol> sorted_columns = columns;
+        std::sort(sorted_columns.begin(), sorted_columns.end());
+        auto clause = access.join ? "join" : "where";
+        auto key = catalog.GetString(access.table->name) + ":" + clause + ":" +
+            JoinNames(catalog, sorted_columns);
+
+        auto& predicate = unserved[key];
+        if(predicate.count == 0){
+          predicate.table = catalog.GetString(access.table->name);
+          predicate.columns = GetNames(catalog, columns);
+          predicate.clause = clause;
+          predicate.example = group.example;
+
+          // An index over the columns in the wrong order
+          for(auto& index : indexes){
+            for(auto column : columns){
+              if(Contains(index.columns, column)){
+                predicate.misordered_index = catalog.GetString(index.name).empty() == false ?
+                    catalog.GetString(index.name) :
+                    "(" + JoinNames(catalog, index.columns) + ")";
+                break;
+              }
+            }
+            if(predicate.misordered_index.empty() == false){
+              break;
+            }
+          }
+        }
+        predicate.count += group.count;
+      }
+
+      // ORDER BY without an index in that order
+      bool order_served = best_order != indexes.size() &&
+          (best == indexes.size() || best == best_order);
+      if(access.order.empty() == false){
+        if(order_served == true){
+          if(best != best_order){
+            usage[std::make_pair(access.table, best_order)].first += group.count;
+          }
+        }
+        else if(best == indexes.size() || MatchIndex(access, indexes[best]).order == false){
+          auto key = catalog.GetString(access.table->name) + ":order by:" +
+              JoinNames(catalog, access.order);
+          auto& predicate = unserved[key];
+          if(predicate.count == 0){
+            predicate.table = catalog.GetString(access.table->name);
+            predicate.columns = GetNames(catalog, access.order);
+            predicate.clause = "order by";
+            predicate.example = group.example;
+          }
+          predicate.count += group.count;
+        }
+      }
+    }
+  }
+
+  // Rank the predicates by frequency
+  for(auto& entry : unserved){
+    advice.unserved_predicates.push_back(entry.second);
+  }
+  std::stable_sort(advice.unserved_predicates.begin(),
+                   advice.unserved_predicates.end(),
+                   [](const PredicateAdvice& a, const PredicateAdvice& b){
+                     return a.count > b.count;
+                   });
+
+  // Rank the indexes by frequency
+  for(auto& table : catalog.GetTables()){
+    for(std::size_t id = 0; id < table.indexes.size(); id++){
+      auto& index = table.indexes[id];
+      IndexUsage index_usage;
+      index_usage.table = catalog.GetString(table.name);
+      index_usage.index = catalog.GetString(index.name);
+      index_usage.columns = GetNames(catalog, index.columns);
+      index_usage.unique = index.unique;
+      index_usage.primary = index.primary;
+      auto counts = usage.find(std::make_pair(&table, id));
+      index_usage.count = (counts == usage.end()) ? 0 : counts->second.first;
+      index_usage.covering_count = (counts == usage.end()) ? 0 : counts->second.second;
+      advice.indexes.push_back(index_usage);
+    }
+  }
+  std::stable_sort(advice.indexes.begin(), advice.indexes.end(),
+                   [](const IndexUsage& a, const IndexUsage& b){
+                     return a.count > b.count;
+                   });
+
+}
+
+std::string GetIndexLabel(const IndexUsage& index){
+  std::string columns;
+  for(auto& column : index.columns){
+    columns += (columns.empty() ? "" : ", ") + column;
+  }
+  std::string name = index.primary ? "PRIMARY KEY" :
+      (index.index.empty() ? (index.unique ? "UNIQUE" : "INDEX") : index.index);
+  return name + " ON " + index.table + " (" + columns + ")";
+}
+
+void PrintIndexAdvice(const IndexAdvice& advice, std::ostream& output){
+
+  output << "\n==================== Index Advice ==============\n";
+  output << "Queries :: " << advice.query_count << " ("
+         << advice.fingerprint_count << " distinct)\n";
+
+  output << "\nPredicates without a usable index:\n";
+  if(advice.unserved_predicates.empty()){
+    output << "  None\n";
+  }
+  for(auto& predicate : advice.unserved_predicates){
+    std::string columns;
+    for(auto& column : predicate.columns){
+      columns += (columns.empty() ? "" : ", ") + column;
+    }
+    output << "  [" << predicate.count << "] " << predicate.clause << " "
+           << predicate.table << " (" << columns << ")\n";
+    if(predicate.misordered_index.empty() == false){
+      output << "      index " << predicate.misordered_index
+             << " has these columns in a different order\n";
+    }
+  }
+
+  output << "\nUnused indexes:\n";
+  bool unused = false;
+  for(auto& index : advice.indexes){
+    // keys still enforce constraints
+    if(index.count == 0 && index.unique == false && index.primary == false){
+      output << "  " << GetIndexLabel(index) << "\n";
+      unused = true;
+    }
+  }
+  if(unused == false){
+    output << "  None\n";
+  }
+
+  output << "\nIndex usage:\n";
+  for(auto& index : advice.indexes){
+    if(index.count != 0){
+      output << "  [" << index.count << ", " << index.covering_count
+             << " covering] " << GetIndexLabel(index) << "\n";
+    }
+  }
+
+}
+
+}  // namespace sqlcheck
@@ -0,0 +1,489 @@
+// JSON SOURCE
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+#include "include/json.h"
+
+namespace sqlcheck {
+
+std::string EscapeJsonString(const std::string& text){
+
+  std::string escaped;
+  escaped.reserve(text.length() + 2);
+
+  for(auto c : text){
+    switch (c) {
+      case '"':
+        escaped += "\\\"";
+        break;
+      case '\\':
+        escaped += "\\\\";
+        break;
+      case '\n':
+        escaped += "\\n";
+        break;
+      case '\r':
+        escaped += "\\r";
+        break;
+      case '\t':
+        escaped += "\\t";
+        break;
+      default:
+        if(static_cast<unsigned char>(c) < 0x20){
+          char buffer[8];
+          snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+          escaped += buffer;
+        }
+        else {
+          escaped += c;
+        }
+    }
+  }
+
+  return escaped;
+}
+
+void WriteFindingJson(std::ostream& os, const Finding& finding){
+  WriteFindingJson(os, finding, "");
+}
+
+void WriteFindingJson(std::ostream& os, const Finding& finding,
+                      const std::string& file_name){
+
+  os << "{";
+  if(file_name.empty() == false){
+    os << "\"file\":\"" << EscapeJsonString(file_name) << "\",";
+  }
+  os << "\"rule\":\"" << EscapeJsonString(finding.rule_id) << "\""
+     << ",\"title\":\"" << EscapeJsonString(finding.title) << "\""
+     << ",\"risk\":\"" << RiskLevelToString(finding.risk_level) << "\""
+     << ",\"type\":\"" << PatternTypeToString(finding.pattern_type) << "\""
+     << ",\"statement\":" << finding.statement_id
+     << ",\"line\":" << finding.line_number
+     << ",\"column\":" << finding.column
+     << ",\"begin\":" << finding.begin
+     << ",\"end\":" << finding.end
+     << ",\"match\":\"" << EscapeJsonString(finding.match) << "\""
+     << "}";
+
+}
+
+void WriteFindingsJson(std::ostream& os, const std::vector<Finding>& findings){
+
+  os << "[";
+  for(size_t i = 0; i < findings.size(); i++){
+    if(i > 0){
+      os << ",";
+    }
+    WriteFindingJson(os, findings[i]);
+  }
+  os << "]";
+
+}
+
+void WriteSkippedChecksJson(std::ostream& os,
+                            const std::vector<SkippedCheck>& skipped_checks){
+
+  os << "[";
+  for(size_t i = 0; i < skipped_checks.size(); i++){
+    auto& skipped_check = skipped_checks[i];
+    if(i > 0){
+      os << ",";
+    }
+    os << "{\"rules\":\"" << EscapeJsonString(skipped_check.rule_ids) << "\""
+       << ",\"reason\":\"" << EscapeJsonString(skipped_check.reason) << "\""
+       << ",\"line\":" << skipped_check.line_number
+       << ",\"offset\":" << skipped_check.offset << "}";
+  }
+  os << "]";
+
+}
+
+// JSON PARSER
+
+const JsonValue* JsonValue::Find(const std::string& key) const {
+
+  if(type != JSON_TYPE_OBJECT){
+    return nullptr;
+  }
+
+  auto member = object.find(key);
+  if(member == object.end()){
+    return nullptr;
+  }
+
+  return &member->second;
+}
+
+std::string JsonValue::GetString(const std::string& key,
+                                 const std::string& default_value) const {
+  auto member = Find(key);
+  if(member == nullptr || member->type != JSON_TYPE_STRING){
+    return default_value;
+  }
+  return member->string;
+}
+
+double JsonValue::GetNumber(const std::string& key, double default_value) const {
+  auto member = Find(key);
+  if(member == nullptr || member->type != JSON_TYPE_NUMBER){
+    return default_value;
+  }
+  return member->number;
+}
+
+class JsonParser {
+
+ public:
+  JsonParser(const std::string& text)
+   : text_(text),
+     pos_(0) {
+  }
+
+  bool Parse(JsonValue& value, std::string& error){
+    if(ParseValue(value, 0) == false){
+      error = error_;
+      return false;
+    }
+    SkipSpace();
+    if(pos_ != text_.length()){
+      error = "unexpected trailing characters at offset " + std::to_string(pos_);
+      return false;
+    }
+    return true;
+  }
+
+ private:
+
+  // Deepest accepted nesting
+  static const int kMaxDepth = 256;
+
+  bool Fail(const std::string& message){
+    error_ = message + " at offset " + std::to_string(pos_);
+    return false;
+  }
+
+  void SkipSpace(){
+    while(pos_ < text_.length() &&
+        (text_[pos_] == ' ' || text_[pos_] == '\t' ||
+         text_[pos_] == '\n' || text_[pos_] == '\r')){
+      pos_++;
+    }
+  }
+
+  bool Consume(const char* literal){
+    auto length = strlen(literal);
+    if(text_.compare(pos_, length, literal) != 0){
+      return false;
+    }
+    pos_ += length;
+    return true;
+  }
+
+  bool ParseValue(JsonValue& value, int depth){
+
+    if(depth > kMaxDepth){
+      return Fail("nesting too deep");
+    }
+
+    SkipSpace();
+    if(pos_ >= text_.length()){
+      return Fail("unexpected end of input");
+    }
+
+    switch (text_[pos_]) {
+      case '{':
+        return ParseObject(value, depth);
+      case '[':
+        return ParseArray(value, depth);
+      case '"':
+        value.type = JSON_TYPE_STRING;
+        return ParseString(value.string);
+      case 't':
+        value.type = JSON_TYPE_BOOL;
+        value.boolean = true;
+        return Consume("true") || Fail("invalid literal");
+      case 'f':
+        value.type = JSON_TYPE_BOOL;
+        value.boolean = false;
+        return Consume("false") || Fail("invalid literal");
+      case 'n':
+        value.type = JSON_TYPE_NULL;
+        return Consume("null") || Fail("invalid literal");
+      default:
+        return ParseNumber(value);
+    }
+
+  }
+
+  bool ParseNumber(JsonValue& value){
+
+    const char* begin = text_.c_str() + pos_;
+    char* end = nullptr;
+    value.number = strtod(begin, &end);
+    if(end == begin){
+      return Fail("invalid value");
+    }
+    value.type = JSON_TYPE_NUMBER;
+    pos_ += end - begin;
+    return true;
+  }
+
+  void AppendUtf8(std::string& out, std::uint32_t code_point){
+    if(code_point < 0x80){
+      out += static_cast<char>(code_point);
+    }
+    else if(code_point < 0x800){
+      out += static_cast<char>(0xc0 | (code_point >> 6));
+      out += static_cast<char>(0x80 | (code_point & 0x3f));
+    }
+    else if(code_point < 0x10000){
+      out += static_cast<char>(0xe0 | (code_point >> 12));
+      out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3f));
+      out += static_cast<char>(0x80 | (code_point & 0x3f));
+    }
+    else {
+      out += static_cast<char>(0xf0 | (code_point >> 18));
+      out += static_cast<char>(0x80 | ((code_point >> 12) & 0x3f));
+      out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3f));
+      out += static_cast<char>(0x80 | (code_point & 0x3f));
+    }
+  }
+
+  bool ParseHex(std::uint32_t& code_point){
+    if(pos_ + 4 > text_.length()){
+      return Fail("truncated unicode escape");
+    }
+    code_point = 0;
+    for(int i = 0; i < 4; i++){
+      char c = text_[pos_++];
+      code_point <<= 4;
+      if(c >= '0' && c <= '9'){
+        code_point |= c - '0';
+      }
+      else if(c >= 'a' && c <= 'f'){
+        code_point |= c - 'a' + 10;
+      }
+      else if(c >= 'A' && c <= 'F'){
+        code_point |= c - 'A' + 10;
+      }
+      else {
+        return Fail("invalid unicode escape");
+      }
+    }
+    return true;
+  }
+
+  bool ParseString(std::string& out){
+
+    // Skip opening quote
+    pos_++;
+
+    while(pos_ < text_.length()){
+      char c = text_[pos_++];
+      if(c == '"'){
+        return true;
+      }
+      if(c != '\\'){
+        out += c;
+        continue;
+      }
+
+      if(pos_ >= text_.length()){
+        break;
+      }
+      c = text_[pos_++];
+      switch (c) {
+        case '"':
+        case '\\':
+        case '/':
+          out += c;
+          break;
+        case 'b':
+          out += '\b';
+          break;
+        case 'f':
+          out += '\f';
+          break;
+        case 'n':
+          out += '\n';
+          break;
+        case 'r':
+          out += '\r';
+          break;
+        case 't':
+          out += '\t';
+          break;
+        case 'u': {
+          std::uint32_t code_point;
+          if(ParseHex(code_point) == false){
+            return false;
+          }
+          // Surrogate pair
+          if(code_point >= 0xd800 && code_point < 0xdc00 && Consume("\\u")){
+            std::uint32_t low;
+            if(ParseHex(low) == false){
+              return false;
+            }
+            code_point = 0x10000 + ((code_point - 0xd800) << 10) + (low - 0xdc00);
+          }
+          AppendUtf8(out, code_point);
+          break;
+        }
+        default:
+          return Fail("invalid escape");
+      }
+    }
+
+    return Fail("unterminated string");
+  }
+
+  bool ParseArray(JsonValue& value, int depth){
+
+    value.type = JSON_TYPE_ARRAY;
+    pos_++;
+
+    SkipSpace();
+    if(pos_ < text_.length() && text_[pos_] == ']'){
+      pos_++;
+      return true;
+    }
+
+    while(true){
+      value.array.emplace_back();
+      if(ParseValue(value.array.back(), depth + 1) == false){
+        return false;
+      }
+      SkipSpace();
+      if(pos_ < text_.length() && text_[pos_] == ','){
+        pos_++;
+        continue;
+      }
+      if(pos_ < text_.length() && text_[pos_] == ']'){
+        pos_++;
+        return true;
+      }
+      return Fail("expected , or ]");
+    }
+
+  }
+
+  bool ParseObject(JsonValue& value, int depth){
+
+    value.type = JSON_TYPE_OBJECT;
+    pos_++;
+
+    SkipSpace();
+    if(pos_ < text_.length() && text_[pos_] == '}'){
+      pos_++;
+      return true;
+    }
+
+    while(true){
+      SkipSpace();
+      if(pos_ >= text_.length() || text_[pos_] != '"'){
+        return Fail("expected member name");
+      }
+      std::string key;
+      if(ParseString(key) == false){
+        return false;
+      }
+      SkipSpace();
+      if(pos_ >= text_.length() || text_[pos_] != ':'){
+        return Fail("expected :");
+      }
+      pos_++;
+      if(ParseValue(value.object[key], depth + 1) == false){
+        return false;
+      }
+      SkipSpace();
+      if(pos_ < text_.length() && text_[pos_] == ','){
+        pos_++;
+        continue;
+      }
+      if(pos_ < text_.length() && text_[pos_] == '}'){
+        pos_++;
+        return true;
+      }
+      return Fail("expected , or }");
+    }
+
+  }
+
+  // input text
+  const std::string& text_;
+
+  // current offset
+  std::size_t pos_;
+
+  // error message
+  std::string error_;
+
+};
+
+bool ParseJson(const std::string& text, JsonValue& value, std::string& error){
+  value = JsonValue();
+  JsonParser parser(text);
+  return parser.Parse(value, error);
+}
+
+void WriteJson(std::ostream& os, const JsonValue& value){
+
+  switch (value.type) {
+    case JSON_TYPE_BOOL:
+      os << (value.boolean ? "true" : "false");
+      break;
+    case JSON_TYPE_NUMBER: {
+      if(std::isfinite(value.number) == false){
+        os << "null";
+      }
+      else if(value.number == std::floor(value.number) && std::fabs(value.number) < 1e15){
+        os << static_cast<long long>(value.number);
+      }
+      else {
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), "%.17g", value.number);
+        os << buffer;
+      }
+      break;
+    }
+    case JSON_TYPE_STRING:
+      os << "\"" << EscapeJsonString(value.string) << "\"";
+      break;
+    case JSON_TYPE_ARRAY: {
+      os << "[";
+      for(size_t i = 0; i < value.array.size(); i++){
+        if(i > 0){
+          os << ",";
+        }
+        WriteJson(os, value.array[i]);
+      }
+      os << "]";
+      break;
+    }
+    case JSON_TYPE_OBJECT: {
+      os << "{";
+      bool first = true;
+      for(auto& member : value.object){
+        if(first == false){
+          os << ",";
+        }
+        first = false;
+        os << "\"" << EscapeJsonString(member.first) << "\":";
+        WriteJson(os, member.second);
+      }
+      os << "}";
+      break;
+    }
+    case JSON_TYPE_NULL:
+    default:
+      os << "null";
+  }
+
+}
+
+}  // namespace sqlcheck
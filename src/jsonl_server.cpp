@@ -0,0 +1,121 @@
+// JSONL SERVER SOURCE
+
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "include/jsonl_server.h"
+
+#include "include/checker.h"
+#include "include/json.h"
+#include "include/tracer.h"
+#include "include/worker_pool.h"
+
+namespace sqlcheck {
+
+void WriteJsonLinesError(std::ostream& os,
+                         const JsonValue& id,
+                         const std::string& message){
+  os << "{\"id\":";
+  WriteJson(os, id);
+  os << ",\"error\":\"" << EscapeJsonString(message) << "\"}\n";
+}
+
+int ServeJsonLines(const Configuration& state,
+                   std::istream& input,
+                   std::ostream& output){
+
+  Configuration options;
+  CopyOptions(state, options);
+  options.collect_findings = true;
+  options.sample_mode = SAMPLE_MODE_NONE;
+  LimitStatementBytes(options);
+
+  // Nothing reads the schema catalog here, so it is reset per text
+  options.index_advice = false;
+  options.write_catalog_file.clear();
+
+  std::mutex output_mutex;
+  auto write_response = [&output, &output_mutex](const std::string& response){
+    TraceSpan span("flush", "output");
+    std::lock_guard<std::mutex> lock(output_mutex);
+    output << response << std::flush;
+  };
+
+  // Per-worker checker state
+  std::vector<std::unique_ptr<Configuration>> worker_states;
+  {
+    WorkerPool pool(options.num_workers);
+    for(std::size_t worker_id = 0; worker_id < pool.GetWorkerCount(); worker_id++){
+      worker_states.emplace_back(new Configuration());
+      CopyOptions(options, *worker_states.back());
+    }
+
+    std::string line;
+    while(std::getline(input, line)){
+      if(line.find_first_not_of(" \t\r") == std::string::npos){
+        continue;
+      }
+
+      // Parse on the reader thread so malformed requests fail fast
+      std::shared_ptr<JsonValue> request(new JsonValue());
+      std::string error;
+      if(ParseJson(line, *request, error) == false){
+        std::ostringstream response;
+        WriteJsonLinesError(response, JsonValue(), "invalid request: " + error);
+        write_response(response.str());
+        continue;
+      }
+
+      pool.Submit([&options, &worker_states, &write_response, request](std::size_t worker_id){
+        std::ostringstream response;
+
+        const JsonValue* id = request->Find("id");
+        const JsonValue null_id;
+        const JsonValue* sql = request->Find("sql");
+        if(sql == nullptr || sql->type != JSON_TYPE_STRING){
+          WriteJsonLinesError(response, id ? *id : null_id, "missing sql");
+          write_response(response.str());
+          return;
+        }
+
+        // Apply per-request options
+        Configuration& worker_state = *worker_states[worker_id];
+        worker_state.risk_level = options.risk_level;
+        worker_state.delimiter = options.delimiter;
+        const JsonValue* request_options = request->Find("options");
+        if(request_options != nullptr){
+          auto risk_level = request_options->GetNumber("risk_level", 0);
+          if(risk_level >= RISK_LEVEL_ALL && risk_level <= RISK_LEVEL_HIGH){
+            worker_state.risk_level = static_cast<RiskLevel>(static_cast<int>(risk_level));
+          }
+          auto delimiter = request_options->GetString("delimiter");
+          if(delimiter.empty() == false){
+            worker_state.delimiter = delimiter;
+          }
+        }
+
+        CheckText(worker_state, sql->string);
+
+        response << "{\"id\":";
+        WriteJson(response, id ? *id : null_id);
+        response << ",\"findings\":";
+        WriteFindingsJson(response, worker_state.findings);
+        if(worker_state.skipped_checks.empty() == false){
+          response << ",\"skipped\":";
+          WriteSkippedChecksJson(response, worker_state.skipped_checks);
+        }
+        response << "}\n";
+        write_response(response.str());
+      });
+    }
+
+    // Pool destructor waits for the queued requests
+  }
+
+  return EXIT_SUCCESS;
+}
+
+}  // namespace sqlcheck
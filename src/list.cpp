@@ -1,38 +1,16 @@
 // LIST SOURCE
 
+#include <cctype>
 #include <regex>
 
 #include "include/list.h"
 #include "include/checker.h"
+#include "include/run_stats.h"
 
 namespace sqlcheck {
 
 // UTILITY
 
-std::string GetTableName(const std::string& sql_statement){
-  std::string table_template = "create table";
-  std::size_t found = sql_statement.find(table_template);
-  if (found == std::string::npos) {
-    return "";
-  }
-
-  // Locate table name
-  auto rest = sql_statement.substr(found + table_template.size());
-  // Strip space at beginning
-  rest = std::regex_replace(rest, std::regex("^ +| +$|( ) +"), "$1");
-  // check if space or ( comes first in remaining string
-  if (rest.find(' ') < rest.find('(')) {
-    // space comes first
-    rest = rest.substr(0, rest.find(' '));
-  } else {
-    // ( comes first
-    rest = rest.substr(0, rest.find('('));
-  }
-  auto table_name = rest;
-
-  return table_name;
-}
-
 bool IsDDLStatement(const std::string& sql_statement){
   std::string create_table_template = "create table";
   std::size_t found = sql_statement.find(create_table_template);
@@ -59,14 +37,48 @@ bool IsCreateStatement(const std::string& sql_statement){
   return false;
 }
 
+// Get the table created by the statement being checked
+const Table* GetCreatedTable(const Configuration& state,
+                             const std::string& sql_statement){
+  if(IsCreateStatement(sql_statement) == false){
+    return nullptr;
+  }
+  return state.catalog.GetCurrentTable();
+}
+
+std::string GetTableName(const Configuration& state,
+                         const std::string& sql_statement){
+  auto table = GetCreatedTable(state, sql_statement);
+  if(table == nullptr){
+    return "";
+  }
+  return state.catalog.GetString(table->name);
+}
+
+// Escape a name for use in a regex
+std::string EscapeRegex(const std::string& text){
+  std::string escaped;
+  for(auto c : text){
+    if(std::isalnum(static_cast<unsigned char>(c)) == false && c != '_' &&
+        (c & 0x80) == 0){
+      escaped += '\\';
+    }
+    escaped += c;
+  }
+  return escaped;
+}
+
 // LOGICAL DATABASE DESIGN
 
 
+const char* const kMultiValuedAttributePattern =
+    "(id\\s+varchar)|(id\\s+text)|(id\\s+regexp)";
+
 void CheckMultiValuedAttribute(Configuration& state,
                                const std::string& sql_statement,
                                bool& print_statement){
 
-  std::regex pattern("(id\\s+varchar)|(id\\s+text)|(id\\s+regexp)");
+  static const RulePattern pattern(kMultiValuedAttributePattern);
   std::string title = "Multi-Valued Attribute";
   PatternType pattern_type = PatternType::PATTERN_TYPE_LOGICAL_DATABASE_DESIGN;
 
@@ -98,12 +110,22 @@ void CheckRecursiveDependency(Configuration& state,
                               const std::string& sql_statement,
                               bool& print_statement){
 
-  std::string table_name = GetTableName(sql_statement);
-  if(table_name.empty()){
+  auto table = GetCreatedTable(state, sql_statement);
+  if(table == nullptr){
+    return;
+  }
+
+  // Look for a foreign key to the table itself
+  bool recursive = false;
+  for(auto& foreign_key : table->foreign_keys){
+    recursive = recursive || (foreign_key.referenced_table == table->name);
+  }
+  if(recursive == false){
     return;
   }
 
-  std::regex pattern("(references\\s+" + table_name+ ")");
+  auto table_name = EscapeRegex(state.catalog.GetString(table->name));
+  std::regex pattern = CompileRegex("(references\\s+[\"`\\[]?(\\w+\\.)?" + table_name + ")");
   std::string title = "Recursive Dependency";
   PatternType pattern_type = PatternType::PATTERN_TYPE_LOGICAL_DATABASE_DESIGN;
 
@@ -131,6 +153,9 @@ void CheckRecursiveDependency(Configuration& state,
 
 }
 
+const char* const kPrimaryKeyExistsPattern =
+    "(primary key)";
+
 void CheckPrimaryKeyExists(Configuration& state,
                            const std::string& sql_statement,
                            bool& print_statement){
@@ -140,7 +165,7 @@ void CheckPrimaryKeyExists(Configuration& state,
     return;
   }
 
-  std::regex pattern("(primary key)");
+  static const RulePattern pattern(kPrimaryKeyExistsPattern);
   std::string title = "Primary Key Does Not Exist";
   PatternType pattern_type = PatternType::PATTERN_TYPE_LOGICAL_DATABASE_DESIGN;
 
@@ -166,6 +191,9 @@ void CheckPrimaryKeyExists(Configuration& state,
 
 }
 
+const char* const kGenericPrimaryKeyPattern =
+    "(\\s[\\(]?id\\s)|(,id\\s)|(\\sid\\s+serial)";
+
 void CheckGenericPrimaryKey(Configuration& state,
                             const std::string& sql_statement,
                             bool& print_statement){
@@ -175,7 +203,7 @@ void CheckGenericPrimaryKey(Configuration& state,
     return;
   }
 
-  std::regex pattern("(\\s+[\\(]?id\\s+)|(,id\\s+)|(\\s+id\\s+serial)");
+  static const RulePattern pattern(kGenericPrimaryKeyPattern);
   std::string title = "Generic Primary Key";
   PatternType pattern_type = PatternType::PATTERN_TYPE_LOGICAL_DATABASE_DESIGN;
 
@@ -200,6 +228,9 @@ void CheckGenericPrimaryKey(Configuration& state,
 
 }
 
+const char* const kForeignKeyExistsPattern =
+    "(foreign key)";
+
 void CheckForeignKeyExists(Configuration& state,
                            const std::string& sql_statement,
                            bool& print_statement){
@@ -209,7 +240,7 @@ void CheckForeignKeyExists(Configuration& state,
     return;
   }
 
-  std::regex pattern("(foreign key)");
+  static const RulePattern pattern(kForeignKeyExistsPattern);
   std::string title = "Foreign Key Does Not Exist";
   PatternType pattern_type = PatternType::PATTERN_TYPE_LOGICAL_DATABASE_DESIGN;
 
@@ -239,11 +270,14 @@ void CheckForeignKeyExists(Configuration& state,
 
 }
 
+const char* const kVariableAttributePattern =
+    "(attribute)";
+
 void CheckVariableAttribute(Configuration& state,
                             const std::string& sql_statement,
                             bool& print_statement){
 
-  std::string table_name = GetTableName(sql_statement);
+  std::string table_name = GetTableName(state, sql_statement);
   if(table_name.empty()){
     return;
   }
@@ -253,7 +287,7 @@ void CheckVariableAttribute(Configuration& state,
     return;
   }
 
-  std::regex pattern("(attribute)");
+  static const RulePattern pattern(kVariableAttributePattern);
   std::string title = "Entity-Attribute-Value Pattern";
   PatternType pattern_type = PatternType::PATTERN_TYPE_LOGICAL_DATABASE_DESIGN;
 
@@ -295,6 +329,9 @@ void CheckVariableAttribute(Configuration& state,
 
 }
 
+const char* const kMetadataTribblesPattern =
+    "(?:^|[^A-Za-z\\-_@])[A-Za-z\\-_@]+[0-9]+ ";
+
 void CheckMetadataTribbles(Configuration& state,
                            const std::string& sql_statement,
                            bool& print_statement){
@@ -304,7 +341,7 @@ void CheckMetadataTribbles(Configuration& state,
     return;
   }
 
-  std::regex pattern("[A-za-z\\-_@]+[0-9]+ ");
+  static const RulePattern pattern(kMetadataTribblesPattern);
   std::string title = "Metadata Tribbles";
   PatternType pattern_type = PatternType::PATTERN_TYPE_LOGICAL_DATABASE_DESIGN;
 
@@ -351,11 +388,14 @@ void CheckMetadataTribbles(Configuration& state,
 
 // PHYSICAL DATABASE DESIGN
 
+const char* const kFloatPattern =
+    "(float)|(real)|(double precision)|(0\\.000[0-9]*)";
+
 void CheckFloat(Configuration& state,
                 const std::string& sql_statement,
                 bool& print_statement){
 
-  std::regex pattern("(float)|(real)|(double precision)|(0\\.000[0-9]*)");
+  static const RulePattern pattern(kFloatPattern);
   std::string title = "Imprecise Data Type";
   PatternType pattern_type = PatternType::PATTERN_TYPE_PHYSICAL_DATABASE_DESIGN;
 
@@ -382,6 +422,9 @@ void CheckFloat(Configuration& state,
 
 }
 
+const char* const kValuesInDefinitionPattern =
+    "( enum)|( in \\()";
+
 void CheckValuesInDefinition(Configuration& state,
                              const std::string& sql_statement,
                              bool& print_statement){
@@ -391,7 +434,7 @@ void CheckValuesInDefinition(Configuration& state,
     return;
   }
 
-  std::regex pattern("( enum)|( in \\()");
+  static const RulePattern pattern(kValuesInDefinitionPattern);
   std::string title = "Values In Definition";
   PatternType pattern_type = PatternType::PATTERN_TYPE_PHYSICAL_DATABASE_DESIGN;
 
@@ -426,11 +469,14 @@ void CheckValuesInDefinition(Configuration& state,
 
 }
 
+const char* const kExternalFilesPattern =
+    "(path varchar)|(unlink\\s?\\()";
+
 void CheckExternalFiles(Configuration& state,
                         const std::string& sql_statement,
                         bool& print_statement){
 
-  std::regex pattern("(path varchar)|(unlink\\s?\\()");
+  static const RulePattern pattern(kExternalFilesPattern);
   std::string title = "Files Are Not SQL Data Types";
   PatternType pattern_type = PatternType::PATTERN_TYPE_PHYSICAL_DATABASE_DESIGN;
 
@@ -457,6 +503,9 @@ void CheckExternalFiles(Configuration& state,
 
 }
 
+const char* const kIndexCountPattern =
+    "(index)";
+
 void CheckIndexCount(Configuration& state,
                      const std::string& sql_statement,
                      bool& print_statement){
@@ -467,7 +516,7 @@ void CheckIndexCount(Configuration& state,
   }
 
   std::size_t min_count = 3;
-  std::regex pattern("(index)");
+  static const RulePattern pattern(kIndexCountPattern);
   std::string title = "Too Many Indexes";
   PatternType pattern_type = PatternType::PATTERN_TYPE_PHYSICAL_DATABASE_DESIGN;
 
@@ -495,12 +544,15 @@ void CheckIndexCount(Configuration& state,
 
 }
 
+const char* const kIndexAttributeOrderPattern =
+    "(create index)";
+
 void CheckIndexAttributeOrder(Configuration& state,
                               const std::string& sql_statement,
                               bool& print_statement){
 
 
-  std::regex pattern("(create index)");
+  static const RulePattern pattern(kIndexAttributeOrderPattern);
   std::string title = "Index Attribute Order";
   PatternType pattern_type = PatternType::PATTERN_TYPE_PHYSICAL_DATABASE_DESIGN;
 
@@ -529,11 +581,14 @@ void CheckIndexAttributeOrder(Configuration& state,
 
 // QUERY
 
+const char* const kSelectStarPattern =
+    "(select\\s+\\*)";
+
 void CheckSelectStar(Configuration& state,
                      const std::string& sql_statement,
                      bool& print_statement){
 
-  std::regex pattern("(select\\s+\\*)");
+  static const RulePattern pattern(kSelectStarPattern);
   std::string title = "SELECT *";
   PatternType pattern_type = PatternType::PATTERN_TYPE_QUERY;
 
@@ -584,10 +639,13 @@ void CheckSelectStar(Configuration& state,
 
 }
 
+const char* const kJoinWithoutEqualityPattern =
+    "join[\\s\\._]?[^=]+?(left|right|join|where|case)";
+
 void CheckJoinWithoutEquality(Configuration& state,
                               const std::string& sql_statement,
                               bool& print_statement) {
-  std::regex pattern("join[\\s\\._]?[^=]+?(left|right|join|where|case)");
+  static const RulePattern pattern(kJoinWithoutEqualityPattern);
   std::string title = "JOIN Without Equality Check";
   PatternType pattern_type = PatternType::PATTERN_TYPE_QUERY;
 
@@ -606,11 +664,14 @@ void CheckJoinWithoutEquality(Configuration& state,
                true);
 }
 
+const char* const kNullUsagePattern =
+    "(null)";
+
 void CheckNullUsage(Configuration& state,
                     const std::string& sql_statement,
                     bool& print_statement) {
 
-  std::regex pattern("(null)");
+  static const RulePattern pattern(kNullUsagePattern);
   std::string title = "NULL Usage";
   PatternType pattern_type = PatternType::PATTERN_TYPE_QUERY;
 
@@ -637,6 +698,9 @@ void CheckNullUsage(Configuration& state,
 
 }
 
+const char* const kNotNullUsagePattern =
+    "(not null)";
+
 void CheckNotNullUsage(Configuration& state,
                        const std::string& sql_statement,
                        bool& print_statement) {
@@ -646,7 +710,7 @@ void CheckNotNullUsage(Configuration& state,
     return;
   }
 
-  std::regex pattern("(not null)");
+  static const RulePattern pattern(kNotNullUsagePattern);
   std::string title = "NOT NULL Usage";
   PatternType pattern_type = PatternType::PATTERN_TYPE_QUERY;
 
@@ -668,12 +732,15 @@ void CheckNotNullUsage(Configuration& state,
 
 }
 
+const char* const kConcatenationPattern =
+    "\\|\\|";
+
 void CheckConcatenation(Configuration& state,
                         const std::string& sql_statement,
                         bool& print_statement) {
 
 
-  std::regex pattern("\\|\\|");
+  static const RulePattern pattern(kConcatenationPattern);
   std::string title = "String Concatenation";
   PatternType pattern_type = PatternType::PATTERN_TYPE_QUERY;
 
@@ -698,11 +765,14 @@ void CheckConcatenation(Configuration& state,
 
 }
 
+const char* const kGroupByUsagePattern =
+    "(group by)";
+
 void CheckGroupByUsage(Configuration& state,
                        const std::string& sql_statement,
                        bool& print_statement){
 
-  std::regex pattern("(group by)");
+  static const RulePattern pattern(kGroupByUsagePattern);
   std::string title = "GROUP BY Usage";
   PatternType pattern_type = PatternType::PATTERN_TYPE_QUERY;
 
@@ -732,11 +802,14 @@ void CheckGroupByUsage(Configuration& state,
 
 }
 
+const char* const kOrderByRandPattern =
+    "(order by rand\\()";
+
 void CheckOrderByRand(Configuration& state,
                       const std::string& sql_statement,
                       bool& print_statement){
 
-  std::regex pattern("(order by rand\\()");
+  static const RulePattern pattern(kOrderByRandPattern);
   std::string title = "ORDER BY RAND Usage";
   PatternType pattern_type = PatternType::PATTERN_TYPE_QUERY;
 
@@ -767,11 +840,14 @@ void CheckOrderByRand(Configuration& state,
 
 }
 
+const char* const kPatternMatchingPattern =
+    "(\blike\b)|(\bregexp\b)|(\bsimilar to\b)";
+
 void CheckPatternMatching(Configuration& state,
                           const std::string& sql_statement,
                           bool& print_statement){
 
-  std::regex pattern("(\blike\b)|(\bregexp\b)|(\bsimilar to\b)");
+  static const RulePattern pattern(kPatternMatchingPattern);
   std::string title = "Pattern Matching Usage";
   PatternType pattern_type = PatternType::PATTERN_TYPE_QUERY;
 
@@ -797,24 +873,23 @@ void CheckPatternMatching(Configuration& state,
 
 }
 
+// One match at the first character (leading blank lines are dropped)
+const char* const kSpaghettiQueryPattern =
+    "^\\S";
+
 void CheckSpaghettiQuery(Configuration& state,
                          const std::string& sql_statement,
                          bool& print_statement){
 
-  std::regex true_pattern(".+?");
-  std::regex false_pattern("pattern must not exist");
-  std::regex pattern;
+  static const RulePattern true_pattern(kSpaghettiQueryPattern);
+  static const RulePattern false_pattern("pattern must not exist");
 
   std::string title = "Spaghetti Query Alert";
   PatternType pattern_type = PatternType::PATTERN_TYPE_QUERY;
   std::size_t spaghetti_query_char_count = 500;
 
-  if(sql_statement.size() >= spaghetti_query_char_count){
-    pattern = true_pattern;
-  }
-  else {
-    pattern = false_pattern;
-  }
+  const RulePattern& pattern =
+      (sql_statement.size() >= spaghetti_query_char_count) ? true_pattern : false_pattern;
 
   auto message =
       "● Split up a complex spaghetti query into several simpler queries:  "
@@ -851,11 +926,14 @@ void CheckSpaghettiQuery(Configuration& state,
 
 }
 
+const char* const kJoinCountPattern =
+    "(\bjoin\b)";
+
 void CheckJoinCount(Configuration& state,
                     const std::string& sql_statement,
                     bool& print_statement){
 
-  std::regex pattern("(\bjoin\b)");
+  static const RulePattern pattern(kJoinCountPattern);
   std::string title = "Reduce Number of JOINs";
   PatternType pattern_type = PatternType::PATTERN_TYPE_QUERY;
   std::size_t min_count = 5;
@@ -878,11 +956,14 @@ void CheckJoinCount(Configuration& state,
 
 }
 
+const char* const kDistinctCountPattern =
+    "(\bdistinct\b)";
+
 void CheckDistinctCount(Configuration& state,
                         const std::string& sql_statement,
                         bool& print_statement){
 
-  std::regex pattern("(\bdistinct\b)");
+  static const RulePattern pattern(kDistinctCountPattern);
   std::string title = "Eliminate Unnecessary DISTINCT Conditions";
   PatternType pattern_type = PatternType::PATTERN_TYPE_QUERY;
   std::size_t min_count = 5;
@@ -908,11 +989,14 @@ void CheckDistinctCount(Configuration& state,
 
 }
 
+const char* const kImplicitColumnsPattern =
+    "(insert into \\S+ values)";
+
 void CheckImplicitColumns(Configuration& state,
                           const std::string& sql_statement,
                           bool& print_statement){
 
-  std::regex pattern("(insert into \\S+ values)");
+  static const RulePattern pattern(kImplicitColumnsPattern);
   std::string title = "Implicit Column Usage";
   PatternType pattern_type = PatternType::PATTERN_TYPE_QUERY;
 
@@ -936,11 +1020,14 @@ void CheckImplicitColumns(Configuration& state,
 
 }
 
+const char* const kHavingPattern =
+    "(\bhaving\b)";
+
 void CheckHaving(Configuration& state,
                  const std::string& sql_statement,
                  bool& print_statement){
 
-  std::regex pattern("(\bhaving\b)");
+  static const RulePattern pattern(kHavingPattern);
   std::string title = "HAVING Clause Usage";
   PatternType pattern_type = PatternType::PATTERN_TYPE_QUERY;
 
@@ -965,11 +1052,14 @@ void CheckHaving(Configuration& state,
 
 }
 
+const char* const kNestingPattern =
+    "(\bselect\b)";
+
 void CheckNesting(Configuration& state,
                   const std::string& sql_statement,
                   bool& print_statement){
 
-  std::regex pattern("(\bselect\b)");
+  static const RulePattern pattern(kNestingPattern);
   std::string title = "Nested sub queries";
   PatternType pattern_type = PatternType::PATTERN_TYPE_QUERY;
   std::size_t min_count = 2;
@@ -1002,11 +1092,14 @@ void CheckNesting(Configuration& state,
 
 }
 
+const char* const kOrPattern =
+    "(\bor\b)";
+
 void CheckOr(Configuration& state,
                  const std::string& sql_statement,
                  bool& print_statement){
 
-  std::regex pattern("(\bor\b)");
+  static const RulePattern pattern(kOrPattern);
   std::string title = "OR Usage";
   PatternType pattern_type = PatternType::PATTERN_TYPE_QUERY;
 
@@ -1033,11 +1126,14 @@ void CheckOr(Configuration& state,
 
 }
 
+const char* const kUnionPattern =
+    "(union)";
+
 void CheckUnion(Configuration& state,
                 const std::string& sql_statement,
                 bool& print_statement){
 
-  std::regex pattern("(union)");
+  static const RulePattern pattern(kUnionPattern);
   std::string title = "UNION Usage";
   PatternType pattern_type = PatternType::PATTERN_TYPE_QUERY;
 
@@ -1059,11 +1155,14 @@ void CheckUnion(Configuration& state,
 
 }
 
+const char* const kDistinctJoinPattern =
+    "(distinct[^d\\n]*(?:d(?!istinct)[^d\\n]*)*join)";
+
 void CheckDistinctJoin(Configuration& state,
                        const std::string& sql_statement,
                        bool& print_statement){
 
-  std::regex pattern("(distinct.*join)");
+  static const RulePattern pattern(kDistinctJoinPattern);
   std::string title = "DISTINCT & JOIN Usage";
   PatternType pattern_type = PatternType::PATTERN_TYPE_QUERY;
 
@@ -1094,12 +1193,15 @@ void CheckDistinctJoin(Configuration& state,
 
 // APPLICATION
 
+const char* const kReadablePasswordsPattern =
+    "(password varchar)|(password text)|(password =)| "
+    "(pwd varchar)|(pwd text)|(pwd =)";
+
 void CheckReadablePasswords(Configuration& state,
                             const std::string& sql_statement,
                             bool& print_statement){
 
-  std::regex pattern("(password varchar)|(password text)|(password =)| "
-      "(pwd varchar)|(pwd text)|(pwd =)");
+  static const RulePattern pattern(kReadablePasswordsPattern);
   std::string title = "Readable Passwords";
   PatternType pattern_type = PatternType::PATTERN_TYPE_APPLICATION;
 
@@ -1130,5 +1232,87 @@ void CheckReadablePasswords(Configuration& state,
 
 }
 
-}  // namespace machine
+// RULES
+
+const std::vector<Rule>& GetRules(){
+
+  static const std::vector<Rule> rules = {
+
+    // LOGICAL DATABASE DESIGN
+
+    {"1001", "MultiValuedAttribute", CheckMultiValuedAttribute,
+     kMultiValuedAttributePattern},
+    {"1002", "RecursiveDependency", CheckRecursiveDependency,
+     nullptr},
+    {"1003", "PrimaryKeyExists", CheckPrimaryKeyExists,
+     kPrimaryKeyExistsPattern},
+    {"1004", "GenericPrimaryKey", CheckGenericPrimaryKey,
+     kGenericPrimaryKeyPattern},
+    {"1005", "ForeignKeyExists", CheckForeignKeyExists,
+     kForeignKeyExistsPattern},
+    {"1006", "VariableAttribute", CheckVariableAttribute,
+     kVariableAttributePattern},
+    {"1007", "MetadataTribbles", CheckMetadataTribbles,
+     kMetadataTribblesPattern},
+
+    // PHYSICAL DATABASE DESIGN
+
+    {"2001", "Float", CheckFloat,
+     kFloatPattern},
+    {"2002", "ValuesInDefinition", CheckValuesInDefinition,
+     kValuesInDefinitionPattern},
+    {"2003", "ExternalFiles", CheckExternalFiles,
+     kExternalFilesPattern},
+    {"2004", "IndexCount", CheckIndexCount,
+     kIndexCountPattern},
+    {"2005", "IndexAttributeOrder", CheckIndexAttributeOrder,
+     kIndexAttributeOrderPattern},
+
+    // QUERY
+
+    {"3001", "SelectStar", CheckSelectStar,
+     kSelectStarPattern},
+    {"3017", "JoinWithoutEquality", CheckJoinWithoutEquality,
+     kJoinWithoutEqualityPattern},
+    {"3002", "NullUsage", CheckNullUsage,
+     kNullUsagePattern},
+    {"3003", "NotNullUsage", CheckNotNullUsage,
+     kNotNullUsagePattern},
+    {"3004", "Concatenation", CheckConcatenation,
+     kConcatenationPattern},
+    {"3005", "GroupByUsage", CheckGroupByUsage,
+     kGroupByUsagePattern},
+    {"3006", "OrderByRand", CheckOrderByRand,
+     kOrderByRandPattern},
+    {"3007", "PatternMatching", CheckPatternMatching,
+     kPatternMatchingPattern},
+    {"3008", "SpaghettiQuery", CheckSpaghettiQuery,
+     kSpaghettiQueryPattern},
+    {"3009", "JoinCount", CheckJoinCount,
+     kJoinCountPattern},
+    {"3010", "DistinctCount", CheckDistinctCount,
+     kDistinctCountPattern},
+    {"3011", "ImplicitColumns", CheckImplicitColumns,
+     kImplicitColumnsPattern},
+    {"3012", "Having", CheckHaving,
+     kHavingPattern},
+    {"3013", "Nesting", CheckNesting,
+     kNestingPattern},
+    {"3014", "Or", CheckOr,
+     kOrPattern},
+    {"3015", "Union", CheckUnion,
+     kUnionPattern},
+    {"3016", "DistinctJoin", CheckDistinctJoin,
+     kDistinctJoinPattern},
+
+    // APPLICATION
+
+    {"4001", "ReadablePasswords", CheckReadablePasswords,
+     kReadablePasswordsPattern}
+
+  };
+
+  return rules;
+}
 
+}  // namespace machine
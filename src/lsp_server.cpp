@@ -0,0 +1,424 @@
+// LSP SERVER SOURCE
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <sstream>
+
+#include "include/lsp_server.h"
+
+#include "include/checker.h"
+
+namespace sqlcheck {
+
+// JSON-RPC error codes
+const int kMethodNotFound = -32601;
+const int kInvalidRequest = -32600;
+
+// LSP diagnostic severities
+const int kSeverityWarning = 2;
+const int kSeverityInformation = 3;
+const int kSeverityHint = 4;
+
+int RiskLevelToSeverity(const RiskLevel risk_level){
+  switch (risk_level) {
+    case RISK_LEVEL_HIGH:
+    case RISK_LEVEL_MEDIUM:
+      return kSeverityWarning;
+    case RISK_LEVEL_LOW:
+      return kSeverityInformation;
+    default:
+      return kSeverityHint;
+  }
+}
+
+void WriteLspMessage(std::ostream& output, const std::string& content){
+  output << "Content-Length: " << content.length() << "\r\n\r\n" << content << std::flush;
+}
+
+LspServer::LspServer(const Configuration& state)
+ : last_checked_count_(0),
+   shutdown_(false),
+   exiting_(false) {
+
+  CopyOptions(state, state_);
+  state_.collect_findings = true;
+  state_.sample_mode = SAMPLE_MODE_NONE;
+  LimitStatementBytes(state_);
+
+  // Nothing reads the schema catalog here, so it is reset per text
+  state_.index_advice = false;
+  state_.write_catalog_file.clear();
+
+}
+
+void LspServer::CheckDocumentStatement(const std::string& text, Statement& statement){
+
+  state_.findings.clear();
+  state_.skipped_checks.clear();
+  state_.line_number = 1;
+  state_.statement_offset = 0;
+  CheckStatement(state_, text.substr(statement.begin, statement.end - statement.begin) + " ");
+  statement.findings.swap(state_.findings);
+  statement.skipped_checks.swap(state_.skipped_checks);
+  last_checked_count_++;
+
+}
+
+std::size_t LspServer::SplitAndCheck(const std::string& text,
+                                     std::size_t begin,
+                                     const std::vector<std::size_t>& boundaries,
+                                     std::vector<Statement>& statements){
+
+  auto delimiter = state_.delimiter[0];
+  while(true){
+    auto end = text.find(delimiter, begin);
+    if(end == std::string::npos){
+      end = text.length();
+    }
+
+    Statement statement;
+    statement.begin = begin;
+    statement.end = end;
+    CheckDocumentStatement(text, statement);
+    statements.push_back(std::move(statement));
+
+    // Back in sync with the old statement index
+    auto boundary = std::lower_bound(boundaries.begin(), boundaries.end(), end);
+    if(boundary != boundaries.end() && *boundary == end){
+      return boundary - boundaries.begin();
+    }
+
+    if(end == text.length()){
+      return boundaries.size();
+    }
+    begin = end + 1;
+  }
+
+}
+
+void LspServer::IndexLines(Document& document){
+
+  document.line_starts.clear();
+  document.line_starts.push_back(0);
+  auto& text = document.text;
+  for(auto pos = text.find('\n'); pos != std::string::npos; pos = text.find('\n', pos + 1)){
+    document.line_starts.push_back(pos + 1);
+  }
+
+}
+
+void LspServer::OpenDocument(const std::string& uri, const std::string& text){
+
+  Document& document = documents_[uri];
+  document.text = text;
+  document.statements.clear();
+  IndexLines(document);
+  SplitAndCheck(document.text, 0, std::vector<std::size_t>(), document.statements);
+
+}
+
+// Positions count UTF-16 code units within the line
+std::size_t LspServer::PositionToOffset(const Document& document,
+                                        const JsonValue& position) const {
+
+  auto line = static_cast<std::size_t>(position.GetNumber("line"));
+  auto character = static_cast<std::size_t>(position.GetNumber("character"));
+  if(line >= document.line_starts.size()){
+    return document.text.length();
+  }
+
+  auto& text = document.text;
+  auto offset = document.line_starts[line];
+  std::size_t units = 0;
+  while(offset < text.length() && text[offset] != '\n' && units < character){
+    auto lead = static_cast<unsigned char>(text[offset]);
+    auto length = (lead < 0x80) ? 1 : (lead >> 5) == 0x6 ? 2 : (lead >> 4) == 0xe ? 3 : 4;
+    units += (length == 4) ? 2 : 1;
+    offset = std::min(offset + length, text.length());
+  }
+
+  return offset;
+}
+
+void LspServer::WritePosition(std::ostream& os,
+                              const Document& document,
+                              std::size_t offset) const {
+
+  auto line_start = std::upper_bound(document.line_starts.begin(),
+                                     document.line_starts.end(),
+                                     offset) - 1;
+  auto line = line_start - document.line_starts.begin();
+
+  std::size_t units = 0;
+  for(auto pos = *line_start; pos < offset && pos < document.text.length(); pos++){
+    auto byte = static_cast<unsigned char>(document.text[pos]);
+    if((byte & 0xc0) != 0x80){
+      units += (byte >= 0xf0) ? 2 : 1;
+    }
+  }
+
+  os << "{\"line\":" << line << ",\"character\":" << units << "}";
+}
+
+void LspServer::ChangeDocument(const std::string& uri, const JsonValue& changes){
+
+  auto entry = documents_.find(uri);
+  if(entry == documents_.end()){
+    return;
+  }
+  Document& document = entry->second;
+
+  for(auto& change : changes.array){
+    const JsonValue* range = change.Find("range");
+    auto new_text = change.GetString("text");
+
+    // Full document sync
+    if(range == nullptr){
+      OpenDocument(uri, new_text);
+      continue;
+    }
+
+    // Ignore malformed edits
+    const JsonValue* start_position = range->Find("start");
+    const JsonValue* end_position = range->Find("end");
+    if(start_position == nullptr || start_position->type != JSON_TYPE_OBJECT ||
+       end_position == nullptr || end_position->type != JSON_TYPE_OBJECT){
+      continue;
+    }
+
+    auto start = PositionToOffset(document, *start_position);
+    auto old_end = std::max(start, PositionToOffset(document, *end_position));
+    long delta = (long) new_text.length() - (long) (old_end - start);
+    document.text.replace(start, old_end - start, new_text);
+    IndexLines(document);
+
+    // Statements overlapping the edit, including the delimiter after them
+    auto& statements = document.statements;
+    auto first = std::lower_bound(statements.begin(), statements.end(), start,
+        [](const Statement& statement, std::size_t offset){
+          return statement.end < offset;
+        });
+    auto last = std::upper_bound(first, statements.end(), old_end,
+        [](std::size_t offset, const Statement& statement){
+          return offset < statement.begin;
+        });
+    if(first == statements.end()){
+      first = statements.end() - 1;
+    }
+    if(last == first){
+      last = first + 1;
+    }
+
+    // Old statement ends after the edit, shifted into the new text
+    std::vector<std::size_t> boundaries;
+    for(auto statement = last - 1; statement != statements.end(); ++statement){
+      boundaries.push_back(statement->end + delta);
+    }
+
+    std::vector<Statement> replacement;
+    auto resync = SplitAndCheck(document.text, first->begin, boundaries, replacement);
+
+    // Replace the re-split statements and shift the reused ones
+    auto first_index = first - statements.begin();
+    auto replaced_end = (last - 1 - statements.begin()) + std::min(resync + 1, boundaries.size());
+    statements.erase(statements.begin() + first_index, statements.begin() + replaced_end);
+    for(auto statement = statements.begin() + first_index; statement != statements.end(); ++statement){
+      statement->begin += delta;
+      statement->end += delta;
+    }
+    statements.insert(statements.begin() + first_index,
+                      std::make_move_iterator(replacement.begin()),
+                      std::make_move_iterator(replacement.end()));
+  }
+
+}
+
+void LspServer::PublishDiagnostics(const std::string& uri, std::ostream& output) const {
+
+  std::ostringstream content;
+  content << "{\"jsonrpc\":\"2.0\",\"method\":\"textDocument/publishDiagnostics\","
+          << "\"params\":{\"uri\":\"" << EscapeJsonString(uri) << "\",\"diagnostics\":[";
+
+  auto entry = documents_.find(uri);
+  if(entry != documents_.end()){
+    const Document& document = entry->second;
+    bool first = true;
+    for(auto& statement : document.statements){
+      for(auto& finding : statement.findings){
+        if(first == false){
+          content << ",";
+        }
+        first = false;
+
+        content << "{\"range\":{\"start\":";
+        WritePosition(content, document, statement.begin + finding.begin);
+        content << ",\"end\":";
+        WritePosition(content, document, statement.begin + finding.end);
+        content << "},\"severity\":" << RiskLevelToSeverity(finding.risk_level)
+                << ",\"code\":\"" << EscapeJsonString(finding.rule_id) << "\""
+                << ",\"source\":\"sqlcheck\""
+                << ",\"message\":\"" << EscapeJsonString(finding.title) << " ("
+                << RiskLevelToString(finding.risk_level) << ")\"}";
+      }
+
+      // Skipped checks cover the whole statement, so that it does not look clean
+      auto begin = statement.begin;
+      while(begin < statement.end && std::isspace(static_cast<unsigned char>(document.text[begin]))){
+        begin++;
+      }
+      for(auto& skipped_check : statement.skipped_checks){
+        if(first == false){
+          content << ",";
+        }
+        first = false;
+
+        auto message = (skipped_check.rule_ids == "all") ? skipped_check.reason :
+            skipped_check.rule_ids + " (" + skipped_check.reason + ")";
+        content << "{\"range\":{\"start\":";
+        WritePosition(content, document, begin);
+        content << ",\"end\":";
+        WritePosition(content, document, statement.end);
+        content << "},\"severity\":" << kSeverityInformation
+                << ",\"source\":\"sqlcheck\""
+                << ",\"message\":\"not checked: " << EscapeJsonString(message) << "\"}";
+      }
+    }
+  }
+
+  content << "]}}";
+  WriteLspMessage(output, content.str());
+
+}
+
+void WriteLspResponse(std::ostream& output, const JsonValue& id, const std::string& result){
+  std::ostringstream content;
+  content << "{\"jsonrpc\":\"2.0\",\"id\":";
+  WriteJson(content, id);
+  content << ",\"result\":" << result << "}";
+  WriteLspMessage(output, content.str());
+}
+
+void WriteLspError(std::ostream& output, const JsonValue& id, int code, const std::string& message){
+  std::ostringstream content;
+  content << "{\"jsonrpc\":\"2.0\",\"id\":";
+  WriteJson(content, id);
+  content << ",\"error\":{\"code\":" << code
+          << ",\"message\":\"" << EscapeJsonString(message) << "\"}}";
+  WriteLspMessage(output, content.str());
+}
+
+void LspServer::HandleMessage(const JsonValue& message, std::ostream& output){
+
+  last_checked_count_ = 0;
+
+  auto method = message.GetString("method");
+  const JsonValue* id = message.Find("id");
+  const JsonValue* params = message.Find("params");
+  const JsonValue empty;
+  if(params == nullptr){
+    params = &empty;
+  }
+
+  // Requests without an id cannot be answered
+  if((method == "initialize" || method == "shutdown") && id == nullptr){
+    WriteLspError(output, empty, kInvalidRequest, "missing id: " + method);
+  }
+  else if(method == "initialize"){
+    WriteLspResponse(output, *id,
+                     "{\"capabilities\":{\"textDocumentSync\":"
+                     "{\"openClose\":true,\"change\":2}},"
+                     "\"serverInfo\":{\"name\":\"sqlcheck\"}}");
+  }
+  else if(method == "shutdown"){
+    shutdown_ = true;
+    WriteLspResponse(output, *id, "null");
+  }
+  else if(method == "exit"){
+    exiting_ = true;
+  }
+  else if(method == "textDocument/didOpen"){
+    const JsonValue* document = params->Find("textDocument");
+    if(document != nullptr){
+      auto uri = document->GetString("uri");
+      OpenDocument(uri, document->GetString("text"));
+      PublishDiagnostics(uri, output);
+    }
+  }
+  else if(method == "textDocument/didChange"){
+    const JsonValue* document = params->Find("textDocument");
+    const JsonValue* changes = params->Find("contentChanges");
+    if(document != nullptr && changes != nullptr){
+      auto uri = document->GetString("uri");
+      ChangeDocument(uri, *changes);
+      PublishDiagnostics(uri, output);
+    }
+  }
+  else if(method == "textDocument/didClose"){
+    const JsonValue* document = params->Find("textDocument");
+    if(document != nullptr){
+      auto uri = document->GetString("uri");
+      documents_.erase(uri);
+      PublishDiagnostics(uri, output);
+    }
+  }
+  else if(id != nullptr && method.empty() == false){
+    WriteLspError(output, *id, kMethodNotFound, "unsupported method: " + method);
+  }
+  else if(id != nullptr && method.empty()){
+    WriteLspError(output, *id, kInvalidRequest, "missing method");
+  }
+
+}
+
+int ServeLanguageServer(const Configuration& state,
+                        std::istream& input,
+                        std::ostream& output){
+
+  LspServer server(state);
+
+  while(server.IsExiting() == false){
+
+    // Read the headers
+    std::size_t content_length = 0;
+    std::string header;
+    bool has_header = false;
+    while(std::getline(input, header)){
+      if(header.empty() == false && header.back() == '\r'){
+        header.pop_back();
+      }
+      if(header.empty()){
+        if(has_header){
+          break;
+        }
+        continue;
+      }
+      has_header = true;
+      const std::string content_length_header = "Content-Length:";
+      if(header.compare(0, content_length_header.length(), content_length_header) == 0){
+        content_length = std::strtoull(header.c_str() + content_length_header.length(), nullptr, 10);
+      }
+    }
+    if(input.good() == false){
+      break;
+    }
+
+    // Read the content
+    std::string content(content_length, '\0');
+    input.read(&content[0], content_length);
+    if(static_cast<std::size_t>(input.gcount()) != content_length){
+      break;
+    }
+
+    JsonValue message;
+    std::string error;
+    if(ParseJson(content, message, error) == false){
+      continue;
+    }
+    server.HandleMessage(message, output);
+  }
+
+  return EXIT_SUCCESS;
+}
+
+}  // namespace sqlcheck
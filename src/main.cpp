@@ -2,9 +2,23 @@
 
 #include <iostream>
 #include <fstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
 
 #include "checker.h"
+#include "include/baseline.h"
 #include "include/configuration.h"
+#include "include/diff.h"
+#include "include/extractor.h"
+#include "include/jsonl_server.h"
+#include "include/lsp_server.h"
+#include "include/nplus1.h"
+#include "include/report_writer.h"
+#include "include/server.h"
+#include "include/tracer.h"
+#include "include/watcher.h"
 
 #include "gflags/gflags.h"
 
@@ -33,6 +47,62 @@ DEFINE_uint64(risk_level, sqlcheck::RISK_LEVEL_ALL,
               "3 (only high risk anti-patterns) \n");
 DEFINE_string(f, "", "SQL file name"); // standard input
 DEFINE_string(file_name, "", "SQL file name"); // standard input
+DEFINE_double(sample_rate, 0, "Check only this fraction of the statements");
+DEFINE_uint64(sample_reservoir, 0, "Check at most this many statements per "
+              "fingerprint (reservoir sampling)");
+DEFINE_double(sample_budget, 0, "Spend at most this percentage of a core on "
+              "checking statements");
+DEFINE_uint64(sample_seed, 0, "Seed for the sampling front-end");
+DEFINE_string(serve, "", "Serve check requests on this Unix domain socket");
+DEFINE_bool(jsonl_server, false, "Serve JSON-lines check requests over stdin/stdout");
+DEFINE_bool(lsp, false, "Run as a language server over stdin/stdout");
+DEFINE_string(watch, "", "Re-check .sql files below this directory as they change");
+DEFINE_string(catalog, "", "Load a schema catalog snapshot before checking");
+DEFINE_string(write_catalog, "", "Write a schema catalog snapshot after checking");
+DEFINE_string(baseline, "", "Suppress the findings of this baseline, report "
+              "only new and fixed ones");
+DEFINE_string(write_baseline, "", "Write a baseline of the findings after checking");
+DEFINE_bool(index_advice, false, "Match the queries against the declared indexes");
+DEFINE_bool(nplus1, false, "Detect N+1 query bursts in a timestamped query log");
+DEFINE_double(nplus1_window, 1.0, "Seconds between queries that keep an N+1 window open");
+DEFINE_uint64(nplus1_threshold, 10, "Queries in a window that make an N+1 burst");
+DEFINE_string(source, "", "Check the SQL in the C++, Java, Python and Go "
+              "string literals below this directory");
+DEFINE_string(diff, "", "Check only the statements changed by this unified "
+              "diff (- reads the diff from standard input)");
+DEFINE_bool(profile, false, "Print the cost of every rule and stage");
+DEFINE_string(profile_json, "", "Write the cost of every rule and stage "
+              "to this file as JSON");
+DEFINE_bool(stats, false, "Print the throughput and resource usage of the run");
+DEFINE_string(stats_json, "", "Write the throughput and resource usage of "
+              "the run to this file as JSON");
+DEFINE_uint64(top_slowest, 0, "Print the N slowest statements with the rule "
+              "that dominated each one");
+DEFINE_uint64(max_statement_bytes, sqlcheck::kMaxStatementBytes,
+              "Skip statements larger than this (0 -- no limit)");
+DEFINE_uint64(statement_budget_ms, 0, "Skip the remaining rules of a statement "
+              "after this many milliseconds (0 -- no limit)");
+DEFINE_uint64(rule_budget_ms, 0, "Abort a rule after this many milliseconds "
+              "on a statement (0 -- no limit)");
+DEFINE_uint64(rule_step_budget, 0, "Abort a rule after this many regex searches "
+              "on a statement (0 -- no limit)");
+DEFINE_string(engine, "regex", "Pattern engine: regex (reference) or prefilter "
+              "(skips patterns whose literals are not in the statement)");
+DEFINE_string(format, "text", "Output format of the findings: text, json, jsonl "
+              "or sarif");
+DEFINE_string(output, "", "Write the findings of one check to several sinks: "
+              "format:path,... (\"-\" -- standard output)");
+DEFINE_string(trace, "", "Write a Chrome trace of the checker threads "
+              "to this file");
+DEFINE_uint64(workers, 0, "Number of worker threads (default -- number of cores)");
+
+// -format is a single sink on stdout
+std::vector<sqlcheck::OutputSink> GetOutputSinks() {
+  if(FLAGS_output.empty() == false){
+    return sqlcheck::StringToOutputSinks(FLAGS_output);
+  }
+  return {sqlcheck::OutputSink(sqlcheck::StringToOutputFormat(FLAGS_format), "-")};
+}
 
 void ConfigureChecker(sqlcheck::Configuration &state) {
 
@@ -44,6 +114,7 @@ void ConfigureChecker(sqlcheck::Configuration &state) {
   state.verbose = false;
   state.color_mode = false;
   state.line_number = 1;
+  state.sample_mode = sqlcheck::SAMPLE_MODE_NONE;
 
   // Configure checker
   state.color_mode = FLAGS_c || FLAGS_color_mode;
@@ -66,6 +137,64 @@ void ConfigureChecker(sqlcheck::Configuration &state) {
   if(FLAGS_risk_level != 0){
     state.risk_level = (sqlcheck::RiskLevel) FLAGS_risk_level;
   }
+  if(FLAGS_sample_rate != 0){
+    state.sample_mode = sqlcheck::SAMPLE_MODE_RATE;
+    state.sample_rate = FLAGS_sample_rate;
+  }
+  if(FLAGS_sample_reservoir != 0){
+    state.sample_mode = sqlcheck::SAMPLE_MODE_RESERVOIR;
+    state.sample_reservoir_size = FLAGS_sample_reservoir;
+  }
+  if(FLAGS_sample_budget != 0){
+    state.sample_mode = sqlcheck::SAMPLE_MODE_BUDGET;
+    state.sample_budget = FLAGS_sample_budget / 100;
+  }
+  state.sample_seed = FLAGS_sample_seed;
+  state.serve_path = FLAGS_serve;
+  state.num_workers = FLAGS_workers;
+  state.watch_path = FLAGS_watch;
+  state.catalog_file = FLAGS_catalog;
+  state.write_catalog_file = FLAGS_write_catalog;
+  state.baseline_file = FLAGS_baseline;
+  state.write_baseline_file = FLAGS_write_baseline;
+  state.index_advice = FLAGS_index_advice;
+  state.nplus1 = FLAGS_nplus1;
+  state.nplus1_window = FLAGS_nplus1_window;
+  state.nplus1_threshold = FLAGS_nplus1_threshold;
+  state.source_path = FLAGS_source;
+  state.diff_file = FLAGS_diff;
+  state.profile = FLAGS_profile || (FLAGS_profile_json.empty() == false);
+  state.profile_file = FLAGS_profile_json;
+  state.trace_file = FLAGS_trace;
+  state.stats = FLAGS_stats || (FLAGS_stats_json.empty() == false);
+  state.stats_file = FLAGS_stats_json;
+  state.top_slowest = FLAGS_top_slowest;
+  state.max_statement_bytes = FLAGS_max_statement_bytes;
+  state.statement_budget_ms = FLAGS_statement_budget_ms;
+  state.rule_budget_ms = FLAGS_rule_budget_ms;
+  state.rule_step_budget = FLAGS_rule_step_budget;
+  state.pattern_engine = sqlcheck::StringToPatternEngine(FLAGS_engine);
+  state.output_sinks = GetOutputSinks();
+
+  // Load the schema catalog
+  if(state.catalog_file.empty() == false &&
+     state.catalog.Load(state.catalog_file) == false){
+    throw std::runtime_error("Cannot load catalog: " + state.catalog_file);
+  }
+
+  // Map the baseline
+  if(state.baseline_file.empty() == false || state.write_baseline_file.empty() == false){
+    state.baseline = std::make_shared<sqlcheck::Baseline>(state.write_baseline_file.empty() == false);
+    if(state.baseline_file.empty() == false &&
+       state.baseline->Load(state.baseline_file) == false){
+      throw std::runtime_error("Cannot load baseline: " + state.baseline_file);
+    }
+  }
+
+  // Keep stdout for protocol messages
+  if(FLAGS_jsonl_server == true || FLAGS_lsp == true){
+    return;
+  }
 
   // Run validators
   std::cout << "+-------------------------------------------------+\n"
@@ -77,6 +206,21 @@ void ConfigureChecker(sqlcheck::Configuration &state) {
   ValidateColorMode(state);
   ValidateVerbose(state);
   ValidateDelimiter(state);
+  ValidateSampling(state);
+  ValidateServe(state);
+  ValidateWatch(state);
+  ValidateCatalog(state);
+  ValidateBaseline(state);
+  ValidateIndexAdvice(state);
+  ValidateNPlusOne(state);
+  ValidateSourcePath(state);
+  ValidateDiff(state);
+  ValidateProfile(state);
+  ValidateTrace(state);
+  ValidateStats(state);
+  ValidateBudget(state);
+  ValidateEngine(state);
+  ValidateOutput(state);
 
   std::cout << "-------------------------------------------------\n";
 
@@ -93,9 +237,70 @@ void Usage() {
       "   -c -color_mode         :  Display warnings in color mode \n"
       "   -v -verbose            :  Display verbose warnings \n"
       "   -d -delimiter          :  Query delimiter string (; by default) \n"
+      "   -sample_rate           :  Check only this fraction of the statements \n"
+      "   -sample_reservoir      :  Check at most N statements per fingerprint \n"
+      "   -sample_budget         :  Spend at most this % of a core on checking \n"
+      "   -sample_seed           :  Seed for the sampling front-end \n"
+      "   -serve                 :  Serve check requests on a Unix domain socket \n"
+      "   -jsonl_server          :  Serve JSON-lines check requests over stdin/stdout \n"
+      "   -lsp                   :  Run as a language server over stdin/stdout \n"
+      "   -watch                 :  Re-check .sql files below a directory as they change \n"
+      "   -catalog               :  Load a schema catalog snapshot before checking \n"
+      "   -write_catalog         :  Write a schema catalog snapshot after checking \n"
+      "   -baseline              :  Suppress the findings of this baseline, report \n"
+      "                          :  only new and fixed ones \n"
+      "   -write_baseline        :  Write a baseline of the findings after checking \n"
+      "   -index_advice          :  Match the queries against the declared indexes \n"
+      "   -nplus1                :  Detect N+1 query bursts in a timestamped query log \n"
+      "   -nplus1_window         :  Seconds between queries of one burst (1 by default) \n"
+      "   -nplus1_threshold      :  Queries that make a burst (10 by default) \n"
+      "   -source                :  Check the SQL in the string literals of C++, Java, \n"
+      "                          :  Python and Go files below a directory \n"
+      "   -diff                  :  Check only the statements changed by a unified \n"
+      "                          :  diff (- reads the diff from standard input) \n"
+      "   -profile               :  Print the cost of every rule and stage \n"
+      "   -profile_json          :  Write the cost of every rule and stage to a \n"
+      "                          :  JSON file \n"
+      "   -stats                 :  Print the throughput and resource usage of the run \n"
+      "   -stats_json            :  Write the throughput and resource usage of the \n"
+      "                          :  run to a JSON file \n"
+      "   -top_slowest           :  Print the N slowest statements with the rule that \n"
+      "                          :  dominated each one \n"
+      "   -max_statement_bytes   :  Skip statements larger than this (16 KB by \n"
+      "                          :  default, 0 -- no limit; at most 16 KB in the \n"
+      "                          :  server and watch modes) \n"
+      "   -statement_budget_ms   :  Time budget of a statement (milliseconds) \n"
+      "   -rule_budget_ms        :  Time budget of a rule on a statement (milliseconds) \n"
+      "   -rule_step_budget      :  Regex searches a rule may run on a statement \n"
+      "   -engine                :  Pattern engine: regex (reference, default) or \n"
+      "                          :  prefilter (skips patterns whose literals are \n"
+      "                          :  not in the statement) \n"
+      "   -format                :  Output format of the findings: text (default), \n"
+      "                          :  json, jsonl or sarif (written to stdout, the \n"
+      "                          :  rest of the output goes to stderr) \n"
+      "   -output                :  Write the findings of one check to several \n"
+      "                          :  sinks: format:path,... (\"-\" -- stdout), \n"
+      "                          :  e.g. text:-,json:report.json,sarif:out.sarif \n"
+      "   -trace                 :  Write a Chrome trace of the checker threads \n"
+      "                          :  (loads in Perfetto and chrome://tracing) \n"
+      "   -workers               :  Number of worker threads (default -- cores) \n"
       "   -h -help               :  Print help message \n";
 }
 
+// Write the trace of the threads, if one was recorded
+void SaveTrace(const sqlcheck::Configuration &state) {
+
+  if(state.trace_file.empty() == true){
+    return;
+  }
+
+  std::ofstream trace(state.trace_file.c_str());
+  sqlcheck::WriteTrace(trace);
+  if(trace.good() == false){
+    throw std::runtime_error("Cannot write trace: " + state.trace_file);
+  }
+}
+
 int main(int argc, char **argv) {
 
   bool has_issues = false;
@@ -117,11 +322,160 @@ int main(int argc, char **argv) {
       return (EXIT_SUCCESS);
     }
 
+    // Keep stdout for a structured report, the console output goes to the
+    // text sink (stderr -- none)
+    int report_fd = -1;
+    auto output_sinks = GetOutputSinks();
+    auto text_sink = sqlcheck::FindOutputSink(output_sinks, sqlcheck::OUTPUT_FORMAT_TEXT);
+    if(FLAGS_jsonl_server == false && FLAGS_lsp == false &&
+       (text_sink == nullptr || text_sink->path != "-")){
+      std::cout.flush();
+      fflush(stdout);
+      for(auto& output_sink : output_sinks){
+        if(output_sink.format != sqlcheck::OUTPUT_FORMAT_TEXT &&
+           output_sink.format != sqlcheck::OUTPUT_FORMAT_INVALID &&
+           output_sink.path == "-"){
+          report_fd = dup(STDOUT_FILENO);
+        }
+      }
+      int console_fd = STDERR_FILENO;
+      if(text_sink != nullptr){
+        console_fd = open(text_sink->path.c_str(),
+                          O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if(console_fd < 0){
+          throw std::runtime_error("Cannot write report: " + text_sink->path);
+        }
+      }
+      dup2(console_fd, STDOUT_FILENO);
+      if(console_fd != STDERR_FILENO){
+        close(console_fd);
+      }
+    }
+
     // Customize the checker configuration
     ConfigureChecker(sqlcheck::state);
 
+    // Record the trace of the threads
+    if(sqlcheck::state.trace_file.empty() == false){
+      sqlcheck::StartTracing();
+      sqlcheck::SetTraceThreadName("main");
+    }
+
+    // Serve JSON-lines requests
+    if(FLAGS_jsonl_server == true){
+      auto status = sqlcheck::ServeJsonLines(sqlcheck::state, std::cin, std::cout);
+      SaveTrace(sqlcheck::state);
+      gflags::ShutDownCommandLineFlags();
+      return status;
+    }
+
+    // Run the language server
+    if(FLAGS_lsp == true){
+      auto status = sqlcheck::ServeLanguageServer(sqlcheck::state, std::cin, std::cout);
+      gflags::ShutDownCommandLineFlags();
+      return status;
+    }
+
+    // Run watch mode
+    if(sqlcheck::state.watch_path.empty() == false){
+      auto status = sqlcheck::Watch(sqlcheck::state);
+      gflags::ShutDownCommandLineFlags();
+      return status;
+    }
+
+    // Detect N+1 bursts in a query log
+    if(sqlcheck::state.nplus1 == true){
+      int status;
+      if(sqlcheck::state.file_name.empty()){
+        status = sqlcheck::DetectNPlusOne(sqlcheck::state, std::cin, std::cout);
+      }
+      else {
+        std::ifstream log(sqlcheck::state.file_name.c_str());
+        status = sqlcheck::DetectNPlusOne(sqlcheck::state, log, std::cout);
+      }
+      gflags::ShutDownCommandLineFlags();
+      return status;
+    }
+
+    // Run the check daemon
+    if(sqlcheck::state.serve_path.empty() == false){
+      auto status = sqlcheck::Serve(sqlcheck::state);
+      SaveTrace(sqlcheck::state);
+      gflags::ShutDownCommandLineFlags();
+      return status;
+    }
+
     // Invoke the checker
-    has_issues = sqlcheck::Check(sqlcheck::state);
+    if(sqlcheck::state.diff_file.empty() == false){
+      if(sqlcheck::state.diff_file == "-"){
+        has_issues = sqlcheck::CheckDiff(sqlcheck::state, std::cin);
+      }
+      else {
+        std::ifstream diff(sqlcheck::state.diff_file.c_str());
+        if(diff.is_open() == false){
+          throw std::runtime_error("Cannot read diff: " +
+                                   sqlcheck::state.diff_file);
+        }
+        has_issues = sqlcheck::CheckDiff(sqlcheck::state, diff);
+      }
+    }
+    else if(sqlcheck::state.source_path.empty() == false){
+      has_issues = sqlcheck::CheckSourceTree(sqlcheck::state,
+                                             sqlcheck::state.source_path,
+                                             std::cout);
+    }
+    else {
+      // Stream the findings to the structured sinks
+      auto report_writer = sqlcheck::OpenReportSinks(sqlcheck::state.output_sinks,
+                                                     report_fd);
+      if(report_writer){
+        sqlcheck::state.report_writer = report_writer.get();
+        report_writer->Begin();
+      }
+
+      has_issues = sqlcheck::Check(sqlcheck::state);
+
+      if(report_writer){
+        report_writer->End(sqlcheck::state);
+        sqlcheck::state.report_writer = nullptr;
+      }
+    }
+
+    SaveTrace(sqlcheck::state);
+
+    // Save the run statistics
+    if(sqlcheck::state.stats_file.empty() == false){
+      std::ofstream stats(sqlcheck::state.stats_file.c_str());
+      sqlcheck::WriteRunStatsJson(sqlcheck::state.run_stats, stats);
+      if(stats.good() == false){
+        throw std::runtime_error("Cannot write stats: " +
+                                 sqlcheck::state.stats_file);
+      }
+    }
+
+    // Save the profile
+    if(sqlcheck::state.profile_file.empty() == false){
+      std::ofstream profile(sqlcheck::state.profile_file.c_str());
+      sqlcheck::WriteProfileJson(sqlcheck::state.profile_stats, profile);
+      if(profile.good() == false){
+        throw std::runtime_error("Cannot write profile: " +
+                                 sqlcheck::state.profile_file);
+      }
+    }
+
+    // Save the baseline
+    if(sqlcheck::state.write_baseline_file.empty() == false &&
+       sqlcheck::state.baseline->Save(sqlcheck::state.write_baseline_file) == false){
+      throw std::runtime_error("Cannot write baseline: " +
+                               sqlcheck::state.write_baseline_file);
+    }
+
+    // Save the schema catalog
+    if(sqlcheck::state.write_catalog_file.empty() == false &&
+       sqlcheck::state.catalog.Save(sqlcheck::state.write_catalog_file) == false){
+      throw std::runtime_error("Cannot write catalog: " +
+                               sqlcheck::state.write_catalog_file);
+    }
 
   }
   // Catching at the top level ensures that
@@ -0,0 +1,437 @@
+// N+1 DETECTOR SOURCE
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <regex>
+
+#include "include/nplus1.h"
+
+#include "include/checker.h"
+#include "include/color.h"
+#include "include/fingerprint.h"
+#include "include/run_stats.h"
+
+namespace sqlcheck {
+
+// LOG PARSING
+
+// Read a fixed number of digits
+bool ReadDigits(const std::string& line,
+                std::size_t& pos,
+                const std::size_t count,
+                int& value){
+
+  value = 0;
+  for(std::size_t digit = 0; digit < count; digit++, pos++){
+    if(pos >= line.length() || std::isdigit(static_cast<unsigned char>(line[pos])) == 0){
+      return false;
+    }
+    value = value * 10 + (line[pos] - '0');
+  }
+  return true;
+}
+
+// Days since 1970-01-01 of a civil date
+std::int64_t GetDaysFromCivil(int year, const int month, const int day){
+  year -= (month <= 2) ? 1 : 0;
+  std::int64_t era = (year >= 0 ? year : year - 399) / 400;
+  std::int64_t year_of_era = year - era * 400;
+  std::int64_t day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+  std::int64_t day_of_era = year_of_era * 365 + year_of_era / 4 -
+      year_of_era / 100 + day_of_year;
+  return era * 146097 + day_of_era - 719468;
+}
+
+// Parse "YYYY-MM-DD[T ]HH:MM:SS[.fraction]" or seconds since the epoch
+bool ParseTimestamp(const std::string& line,
+                    std::size_t& pos,
+                    double& timestamp){
+
+  auto begin = pos;
+  int year, month, day, hour, minute, second;
+  if(ReadDigits(line, pos, 4, year) && pos < line.length() && line[pos] == '-'){
+    pos++;
+    if(ReadDigits(line, pos, 2, month) == false || pos >= line.length() ||
+        line[pos++] != '-' || ReadDigits(line, pos, 2, day) == false ||
+        pos >= line.length() || (line[pos] != 'T' && line[pos] != ' ')){
+      return false;
+    }
+    pos++;
+    if(ReadDigits(line, pos, 2, hour) == false || pos >= line.length() ||
+        line[pos++] != ':' || ReadDigits(line, pos, 2, minute) == false ||
+        pos >= line.length() || line[pos++] != ':' ||
+        ReadDigits(line, pos, 2, second) == false){
+      return false;
+    }
+    timestamp = GetDaysFromCivil(year, month, day) * 86400.0 +
+        hour * 3600 + minute * 60 + second;
+
+    // Fraction
+    if(pos < line.length() && (line[pos] == '.' || line[pos] == ',')){
+      double scale = 0.1;
+      for(pos++; pos < line.length() &&
+          std::isdigit(static_cast<unsigned char>(line[pos])); pos++){
+        timestamp += (line[pos] - '0') * scale;
+        scale /= 10;
+      }
+    }
+
+    // Time zone (Z, +hh:mm or a zone name)
+    if(pos < line.length() && line[pos] == 'Z'){
+      pos++;
+    }
+    else if(pos < line.length() && (line[pos] == '+' || line[pos] == '-')){
+      pos++;
+      while(pos < line.length() && (std::isdigit(static_cast<unsigned char>(line[pos])) ||
+          line[pos] == ':')){
+        pos++;
+      }
+    }
+    auto zone = line.find_first_not_of(' ', pos);
+    auto zone_end = zone;
+    while(zone_end < line.length() && std::isupper(static_cast<unsigned char>(line[zone_end]))){
+      zone_end++;
+    }
+    if(zone != std::string::npos && zone_end - zone >= 2 && zone_end - zone <= 5 &&
+        zone_end < line.length() && line[zone_end] == ' '){
+      pos = zone_end;
+    }
+    return true;
+  }
+
+  // Seconds (or milliseconds) since the epoch
+  pos = begin;
+  std::size_t digits = 0;
+  while(pos < line.length() && std::isdigit(static_cast<unsigned char>(line[pos]))){
+    pos++;
+    digits++;
+  }
+  if(digits < 9){
+    return false;
+  }
+  if(pos < line.length() && line[pos] == '.'){
+    pos++;
+    while(pos < line.length() && std::isdigit(static_cast<unsigned char>(line[pos]))){
+      pos++;
+    }
+  }
+  timestamp = std::strtod(line.c_str() + begin, nullptr);
+  if(digits >= 13){
+    timestamp /= 1000;
+  }
+  return true;
+}
+
+bool ParseLogLine(const std::string& line, LogEntry& entry){
+
+  std::size_t pos = line.find_first_not_of(" \t");
+  if(pos == std::string::npos || ParseTimestamp(line, pos, entry.timestamp) == false){
+    return false;
+  }
+
+  entry.session.clear();
+  pos = line.find_first_not_of(" \t", pos);
+  if(pos == std::string::npos){
+    return false;
+  }
+
+  // [pid] (PostgreSQL)
+  if(line[pos] == '[' && line.find(']', pos) != std::string::npos){
+    auto end = line.find(']', pos);
+    entry.session = line.substr(pos + 1, end - pos - 1);
+    entry.session = entry.session.substr(0, entry.session.find('-'));
+    pos = end + 1;
+  }
+  // thread id followed by the command (MySQL general log)
+  else if(std::isdigit(static_cast<unsigned char>(line[pos]))){
+    auto end = line.find_first_not_of("0123456789", pos);
+    end = (end == std::string::npos) ? line.length() : end;
+    entry.session = line.substr(pos, end - pos);
+    pos = line.find_first_not_of(" \t", end);
+    pos = (pos == std::string::npos) ? line.length() : pos;
+    static const char* commands[] = {"Query", "Execute", "Prepare"};
+    for(auto command : commands){
+      if(line.compare(pos, std::strlen(command), command) == 0){
+        pos += std::strlen(command);
+      }
+    }
+  }
+  // session=<id>
+  else {
+    static const std::regex session_pattern = CompileRegex(
+        "^(session|session_id|conn|connection|connection_id|pid|thread|thread_id)=(\\S+)");
+    std::smatch match;
+    auto rest = line.substr(pos);
+    if(std::regex_search(rest, match, session_pattern)){
+      entry.session = match.str(2);
+      pos += match.length(0);
+    }
+  }
+
+  // Statement
+  std::size_t statement = line.find("statement: ", pos);
+  if(statement != std::string::npos){
+    pos = statement + std::strlen("statement: ");
+  }
+  else if((statement = line.find("execute ", pos)) != std::string::npos &&
+      line.find(": ", statement) != std::string::npos){
+    pos = line.find(": ", statement) + 2;
+  }
+
+  pos = line.find_first_not_of(" \t", pos);
+  entry.sql = (pos == std::string::npos) ? "" : line.substr(pos);
+  return true;
+}
+
+// DETECTOR
+
+// Statements kept per window for counting distinct literals
+const std::size_t kMaxDistinctStatements = 64;
+
+NPlusOneDetector::NPlusOneDetector(const double window_seconds,
+                                   const std::uint64_t threshold,
+                                   const std::size_t max_windows)
+ : window_seconds_(window_seconds),
+   threshold_(threshold),
+   max_windows_(std::max<std::size_t>(max_windows, 1)) {
+}
+
+void NPlusOneDetector::CloseWindow(const std::string& key,
+                                   std::vector<NPlusOneBurst>& bursts){
+
+  auto entry = windows_.find(key);
+  if(entry == windows_.end()){
+    return;
+  }
+
+  auto& window = entry->second;
+  window.burst.distinct_count = window.statements.size();
+  if(window.is_burst == true && window.burst.distinct_count >= 2){
+    bursts.push_back(window.burst);
+  }
+
+  lru_.erase(window.lru_position);
+  windows_.erase(entry);
+}
+
+void NPlusOneDetector::AddStatement(const LogEntry& entry,
+                                    std::vector<NPlusOneBurst>& bursts){
+
+  // Close the windows that saw no statement for window_seconds
+  while(lru_.empty() == false){
+    auto& window = windows_[lru_.front()];
+    if(entry.timestamp - window.burst.last_timestamp <= window_seconds_){
+      break;
+    }
+    auto key = lru_.front();
+    CloseWindow(key, bursts);
+  }
+
+  auto fingerprint = GetFingerprint(entry.sql);
+  if(fingerprint.compare(0, 6, "select") != 0 &&
+      fingerprint.compare(0, 6, "insert") != 0 &&
+      fingerprint.compare(0, 6, "update") != 0 &&
+      fingerprint.compare(0, 6, "delete") != 0){
+    return;
+  }
+
+  char hash[17];
+  snprintf(hash, sizeof(hash), "%016llx",
+           static_cast<unsigned long long>(HashString(fingerprint)));
+  auto key = entry.session + "/" + hash;
+
+  auto window_entry = windows_.find(key);
+  if(window_entry == windows_.end()){
+    // Bound the number of open windows
+    if(windows_.size() >= max_windows_){
+      auto oldest = lru_.front();
+      CloseWindow(oldest, bursts);
+    }
+
+    auto& window = windows_[key];
+    window.burst.session = entry.session;
+    window.burst.fingerprint = fingerprint;
+    window.burst.example = entry.sql;
+    window.burst.line_number = entry.line_number;
+    window.burst.count = 0;
+    window.burst.distinct_count = 0;
+    window.burst.first_timestamp = entry.timestamp;
+    window.is_burst = false;
+    window.lru_position = lru_.insert(lru_.end(), key);
+    window_entry = windows_.find(key);
+  }
+  else {
+    lru_.splice(lru_.end(), lru_, window_entry->second.lru_position);
+  }
+
+  auto& window = window_entry->second;
+  window.burst.count++;
+  window.burst.last_timestamp = entry.timestamp;
+  if(window.statements.size() < kMaxDistinctStatements){
+    window.statements.insert(HashString(entry.sql));
+  }
+
+  // Sliding rate: the last threshold statements within window_seconds
+  auto& recent = window.recent_timestamps;
+  recent.push_back(entry.timestamp);
+  if(recent.size() > std::max<std::uint64_t>(threshold_, 1)){
+    recent.pop_front();
+  }
+  if(recent.size() >= threshold_ &&
+     recent.back() - recent.front() <= window_seconds_){
+    window.is_burst = true;
+  }
+
+}
+
+void NPlusOneDetector::Flush(std::vector<NPlusOneBurst>& bursts){
+  while(lru_.empty() == false){
+    auto key = lru_.front();
+    CloseWindow(key, bursts);
+  }
+}
+
+// REPORTING
+
+std::string GetBatchedQuery(const std::string& fingerprint){
+
+  // INSERT ... VALUES (...) -> multi-row INSERT
+  static const std::regex values_pattern = CompileRegex("(values\\s*(\\([^()]*\\)))\\s*$");
+  std::smatch match;
+  if(std::regex_search(fingerprint, match, values_pattern)){
+    return fingerprint.substr(0, match.position(0)) + match.str(1) + ", " +
+        match.str(2) + ", ...";
+  }
+
+  // A single key lookup -> IN list
+  static const std::regex key_pattern = CompileRegex("([\\w.\"`]+)\\s*=\\s*\\?");
+  auto begin = std::sregex_iterator(fingerprint.begin(), fingerprint.end(), key_pattern);
+  auto end = std::sregex_iterator();
+  if(std::distance(begin, end) == 1){
+    match = *begin;
+    return match.prefix().str() + match.str(1) + " in (?, ?, ...)" +
+        match.suffix().str();
+  }
+
+  return "";
+}
+
+void PrintNPlusOneBurst(const Configuration& state,
+                        const NPlusOneBurst& burst,
+                        std::ostream& output){
+
+  ColorModifier red(ColorCode::FG_RED, state.color_mode, true);
+  ColorModifier green(ColorCode::FG_GREEN, state.color_mode, true);
+  ColorModifier blue(ColorCode::FG_BLUE, state.color_mode, true);
+  ColorModifier regular(ColorCode::FG_DEFAULT, state.color_mode, false);
+
+  output << "\n-------------------------------------------------\n";
+  output << "SQL Statement at line " << burst.line_number;
+  if(burst.session.empty() == false){
+    output << " (session " << burst.session << ")";
+  }
+  output << ": " << red << WrapText(burst.fingerprint) << regular << "\n";
+
+  if(state.file_name.empty() == false){
+    output << "[" << state.file_name << "]: ";
+  }
+  output << "(" << green << RiskLevelToString(RISK_LEVEL_HIGH) << regular << ") ";
+  if(state.color_mode == false){
+    output << "(" << PatternTypeToString(PATTERN_TYPE_APPLICATION) << ") ";
+  }
+  output << blue << "N+1 Queries" << regular << "\n";
+
+  if(state.verbose == true){
+    output << WrapText(
+        "● Batch repeated lookups:  "
+        "The same query was issued many times in a short window with a different "
+        "key each time. This usually comes from loading related rows one at a time "
+        "in a loop (often through an ORM's lazy loading). Each query pays a round trip "
+        "and parsing cost. Fetch all the rows with a single query, using an IN list "
+        "or a JOIN, or enable eager loading for the relationship.") << "\n";
+  }
+
+  char summary[128];
+  snprintf(summary, sizeof(summary), "%llu queries in %.3f s, %llu%s distinct",
+           static_cast<unsigned long long>(burst.count),
+           burst.last_timestamp - burst.first_timestamp,
+           static_cast<unsigned long long>(burst.distinct_count),
+           (burst.distinct_count >= kMaxDistinctStatements) ? "+" : "");
+  output << "[Burst: " << summary << "]\n";
+
+  auto batched = GetBatchedQuery(burst.fingerprint);
+  if(batched.empty() == false){
+    output << "[Suggested Batch: " << blue << WrapText(batched) << regular << "]\n";
+  }
+
+}
+
+int DetectNPlusOne(const Configuration& state,
+                   std::istream& input,
+                   std::ostream& output){
+
+  NPlusOneDetector detector(state.nplus1_window, state.nplus1_threshold);
+  std::vector<NPlusOneBurst> bursts;
+  std::uint64_t burst_count = 0;
+  std::uint64_t statement_count = 0;
+
+  output << "==================== Results ===================\n";
+
+  auto report = [&](){
+    for(auto& burst : bursts){
+      PrintNPlusOneBurst(state, burst, output);
+    }
+    burst_count += bursts.size();
+    bursts.clear();
+  };
+
+  // Statements can continue over lines without a timestamp
+  LogEntry pending;
+  bool has_pending = false;
+  std::string line;
+  std::uint64_t line_number = 0;
+  while(std::getline(input, line)){
+    line_number++;
+
+    LogEntry entry;
+    if(ParseLogLine(line, entry) == false){
+      if(has_pending == true){
+        pending.sql += "\n" + line;
+      }
+      continue;
+    }
+
+    if(has_pending == true){
+      detector.AddStatement(pending, bursts);
+      statement_count++;
+      report();
+    }
+    entry.line_number = line_number;
+    pending = entry;
+    has_pending = true;
+  }
+
+  if(has_pending == true){
+    detector.AddStatement(pending, bursts);
+    statement_count++;
+  }
+  detector.Flush(bursts);
+  report();
+
+  if(burst_count == 0){
+    output << "No issues found.\n";
+  }
+  else {
+    output << "\n==================== Summary ===================\n";
+    output << "Log Statements               :: " << statement_count << "\n";
+    output << "N+1 Bursts                   :: " << burst_count << "\n";
+  }
+
+  return (burst_count == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+}  // namespace sqlcheck
@@ -0,0 +1,130 @@
+// PREFILTER SOURCE
+
+#include <algorithm>
+
+#include "include/prefilter.h"
+
+#include "include/regex_parser.h"
+#include "include/run_stats.h"
+
+namespace sqlcheck {
+
+// Literals of which a match contains one (the empty set -- none)
+typedef std::vector<std::string> LiteralSet;
+
+// Length of the shortest literal of a set (0 -- no requirement)
+std::size_t GetSetScore(const LiteralSet& literals){
+  std::size_t score = 0;
+  for(auto& literal : literals){
+    score = (score == 0) ? literal.length() : std::min(score, literal.length());
+  }
+  return score;
+}
+
+LiteralSet GetRequiredLiterals(const RegexSequence& sequence);
+
+// Every alternative must contribute a requirement
+LiteralSet GetRequiredLiterals(const RegexGroup& group){
+  LiteralSet literals;
+  for(auto& alternative : group.alternatives){
+    auto alternative_literals = GetRequiredLiterals(alternative);
+    if(GetSetScore(alternative_literals) == 0){
+      return LiteralSet();
+    }
+    literals.insert(literals.end(), alternative_literals.begin(),
+                    alternative_literals.end());
+  }
+  return literals;
+}
+
+// Pick the most selective requirement of a sequence: a run of single
+// characters that must appear in a row, or a group that must match
+LiteralSet GetRequiredLiterals(const RegexSequence& sequence){
+
+  LiteralSet best;
+  std::string run;
+
+  auto consider = [&best](const LiteralSet& candidate){
+    auto score = GetSetScore(candidate);
+    auto best_score = GetSetScore(best);
+    if(score > best_score ||
+       (score == best_score && score > 0 && candidate.size() < best.size())){
+      best = candidate;
+    }
+  };
+
+  for(auto& item : sequence){
+    bool single = (item.type == REGEX_ITEM_CHARS && item.chars.count() == 1 &&
+                   item.min > 0);
+    if(single == true){
+      for(int c = 0; c < 256; c++){
+        if(item.chars.test(c)){
+          run += static_cast<char>(c);
+        }
+      }
+      // Repeated characters end the run
+      if(item.min == 1 && item.max == 1){
+        continue;
+      }
+    }
+
+    if(run.empty() == false){
+      consider(LiteralSet(1, run));
+      run.clear();
+    }
+    if(item.type == REGEX_ITEM_GROUP && item.min > 0){
+      consider(GetRequiredLiterals(*item.group));
+    }
+  }
+
+  if(run.empty() == false){
+    consider(LiteralSet(1, run));
+  }
+  return best;
+}
+
+std::vector<std::string> GetRequiredLiterals(const std::string& pattern){
+
+  bool has_control_characters = false;
+  auto group = ParseRegex(pattern, has_control_characters);
+  auto literals = GetRequiredLiterals(*group);
+
+  std::sort(literals.begin(), literals.end());
+  literals.erase(std::unique(literals.begin(), literals.end()), literals.end());
+
+  // A literal that contains another one adds nothing
+  std::vector<std::string> shortest;
+  for(auto& literal : literals){
+    bool redundant = false;
+    for(auto& other : literals){
+      if(other != literal && literal.find(other) != std::string::npos){
+        redundant = true;
+      }
+    }
+    if(redundant == false){
+      shortest.push_back(literal);
+    }
+  }
+  return shortest;
+}
+
+bool MayMatch(const std::vector<std::string>& literals,
+              const std::string& text){
+
+  if(literals.empty()){
+    return true;
+  }
+  for(auto& literal : literals){
+    if(text.find(literal) != std::string::npos){
+      return true;
+    }
+  }
+  return false;
+}
+
+RulePattern::RulePattern(const std::string& pattern)
+ : regex(CompileRegex(pattern)),
+   literals(GetRequiredLiterals(pattern)) {
+}
+
+}  // namespace sqlcheck
@@ -0,0 +1,161 @@
+// PROFILER SOURCE
+
+#include <algorithm>
+#include <cstdio>
+
+#include "include/profiler.h"
+
+#include "include/list.h"
+
+namespace sqlcheck {
+
+std::string ProfileStageToString(const ProfileStage& stage){
+
+  switch (stage) {
+    case PROFILE_STAGE_SPLITTER:
+      return "splitter";
+    case PROFILE_STAGE_NORMALIZER:
+      return "normalizer";
+    case PROFILE_STAGE_OUTPUT:
+      return "output";
+
+    case PROFILE_STAGE_COUNT:
+    default:
+      return "INVALID";
+  }
+
+}
+
+void ProfileCounter::Add(const ProfileCounter& other){
+  invocations += other.invocations;
+  nanoseconds += other.nanoseconds;
+  regex_evaluations += other.regex_evaluations;
+  matches += other.matches;
+  bytes_scanned += other.bytes_scanned;
+}
+
+ProfileCounter& Profile::GetRule(const std::size_t rule_index){
+  if(rules.size() <= rule_index){
+    rules.resize(GetRules().size());
+  }
+  return rules[rule_index];
+}
+
+void Profile::Merge(const Profile& other){
+
+  for(int stage = 0; stage < PROFILE_STAGE_COUNT; stage++){
+    stages[stage].Add(other.stages[stage]);
+  }
+  for(std::size_t rule_index = 0; rule_index < other.rules.size(); rule_index++){
+    GetRule(rule_index).Add(other.rules[rule_index]);
+  }
+
+}
+
+void Profile::Clear(){
+
+  for(auto& stage : stages){
+    stage = ProfileCounter();
+  }
+  rules.clear();
+  current_rule = 0;
+
+}
+
+// REPORT
+
+struct ProfileRow {
+
+  // "stage" or "rule"
+  const char* kind;
+
+  // rule id (empty for stages)
+  std::string id;
+
+  std::string name;
+
+  const ProfileCounter* counter;
+
+};
+
+// Stages and rules, most expensive first
+void GetProfileRows(const Profile& profile,
+                    std::vector<ProfileRow>& rows,
+                    std::uint64_t& total_nanoseconds){
+
+  total_nanoseconds = 0;
+  for(int stage = 0; stage < PROFILE_STAGE_COUNT; stage++){
+    rows.push_back({"stage", "", ProfileStageToString(static_cast<ProfileStage>(stage)),
+                    &profile.stages[stage]});
+    total_nanoseconds += profile.stages[stage].nanoseconds;
+  }
+
+  auto& rules = GetRules();
+  for(std::size_t rule_index = 0; rule_index < profile.rules.size(); rule_index++){
+    rows.push_back({"rule", rules[rule_index].id, rules[rule_index].name,
+                    &profile.rules[rule_index]});
+    total_nanoseconds += profile.rules[rule_index].nanoseconds;
+  }
+
+  std::stable_sort(rows.begin(), rows.end(),
+                   [](const ProfileRow& left, const ProfileRow& right){
+                     return left.counter->nanoseconds > right.counter->nanoseconds;
+                   });
+}
+
+void PrintProfile(const Profile& profile, std::ostream& output){
+
+  std::vector<ProfileRow> rows;
+  std::uint64_t total_nanoseconds;
+  GetProfileRows(profile, rows, total_nanoseconds);
+
+  char line[256];
+  output << "\n==================== Profile ===================\n";
+  snprintf(line, sizeof(line), "%-28s %10s %6s %10s %10s %10s %10s\n",
+           "Stage / Rule", "Time (ms)", "Share", "Calls", "Regexes", "Matches",
+           "MB Scanned");
+  output << line;
+
+  for(auto& row : rows){
+    auto& counter = *row.counter;
+    auto name = row.id.empty() ? row.name : row.id + " " + row.name;
+    double share = (total_nanoseconds == 0) ? 0 :
+        100.0 * counter.nanoseconds / total_nanoseconds;
+    snprintf(line, sizeof(line), "%-28s %10.3f %5.1f%% %10llu %10llu %10llu %10.2f\n",
+             name.c_str(),
+             counter.nanoseconds / 1e6,
+             share,
+             static_cast<unsigned long long>(counter.invocations),
+             static_cast<unsigned long long>(counter.regex_evaluations),
+             static_cast<unsigned long long>(counter.matches),
+             counter.bytes_scanned / 1e6);
+    output << line;
+  }
+
+  snprintf(line, sizeof(line), "%-28s %10.3f\n", "Total", total_nanoseconds / 1e6);
+  output << line;
+}
+
+void WriteProfileJson(const Profile& profile, std::ostream& output){
+
+  std::vector<ProfileRow> rows;
+  std::uint64_t total_nanoseconds;
+  GetProfileRows(profile, rows, total_nanoseconds);
+
+  output << "{\"total_nanoseconds\":" << total_nanoseconds << ",\"entries\":[";
+  for(std::size_t i = 0; i < rows.size(); i++){
+    auto& counter = *rows[i].counter;
+    output << ((i == 0) ? "" : ",")
+           << "{\"kind\":\"" << rows[i].kind << "\""
+           << ",\"id\":\"" << rows[i].id << "\""
+           << ",\"name\":\"" << rows[i].name << "\""
+           << ",\"invocations\":" << counter.invocations
+           << ",\"nanoseconds\":" << counter.nanoseconds
+           << ",\"regex_evaluations\":" << counter.regex_evaluations
+           << ",\"matches\":" << counter.matches
+           << ",\"bytes_scanned\":" << counter.bytes_scanned << "}";
+  }
+  output << "]}\n";
+}
+
+}  // namespace sqlcheck
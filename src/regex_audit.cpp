@@ -0,0 +1,371 @@
+// REGEX AUDIT SOURCE
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <regex>
+
+#include "include/regex_audit.h"
+
+#include "include/regex_parser.h"
+
+namespace sqlcheck {
+
+// ANALYSIS
+
+CharSet GetChars(const RegexItem& item){
+  if(item.type == REGEX_ITEM_CHARS){
+    return item.chars;
+  }
+  CharSet chars;
+  if(item.type == REGEX_ITEM_GROUP){
+    for(auto& alternative : item.group->alternatives){
+      for(auto& inner : alternative){
+        chars |= GetChars(inner);
+      }
+    }
+  }
+  return chars;
+}
+
+bool IsNullable(const RegexSequence& sequence);
+
+bool IsNullable(const RegexItem& item){
+  if(item.min == 0 || item.type == REGEX_ITEM_ASSERTION){
+    return true;
+  }
+  if(item.type == REGEX_ITEM_GROUP){
+    for(auto& alternative : item.group->alternatives){
+      if(IsNullable(alternative) == true){
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+bool IsNullable(const RegexSequence& sequence){
+  for(auto& item : sequence){
+    if(IsNullable(item) == false){
+      return false;
+    }
+  }
+  return true;
+}
+
+bool IsUnbounded(const RegexItem& item){
+  if(item.type == REGEX_ITEM_ASSERTION){
+    return false;
+  }
+  if(item.max == kUnbounded){
+    return true;
+  }
+  if(item.type == REGEX_ITEM_GROUP){
+    for(auto& alternative : item.group->alternatives){
+      for(auto& inner : alternative){
+        if(IsUnbounded(inner) == true){
+          return true;
+        }
+      }
+    }
+  }
+  return false;
+}
+
+CharSet GetFirstChars(const RegexSequence& sequence);
+
+// Characters that can start a match of the item
+CharSet GetFirstChars(const RegexItem& item){
+  if(item.type != REGEX_ITEM_GROUP){
+    return item.chars;
+  }
+  CharSet chars;
+  for(auto& alternative : item.group->alternatives){
+    chars |= GetFirstChars(alternative);
+  }
+  return chars;
+}
+
+// Characters that can start a match of the sequence
+CharSet GetFirstChars(const RegexSequence& sequence){
+  CharSet chars;
+  for(auto& item : sequence){
+    chars |= GetFirstChars(item);
+    if(IsNullable(item) == false){
+      break;
+    }
+  }
+  return chars;
+}
+
+// Describe a character for a report
+std::string DescribeChar(const CharSet& chars){
+  for(int c = 0; c < 256; c++){
+    if(chars.test(c) && std::isprint(c) && c != ' '){
+      return std::string("'") + static_cast<char>(c) + "'";
+    }
+  }
+  return chars.test(' ') ? "' '" : "a control character";
+}
+
+int Analyze(const std::shared_ptr<RegexGroup>& group, RegexAudit& audit);
+
+// Get the star height of an item and check it
+int Analyze(const RegexItem& item, RegexAudit& audit){
+
+  int height = 0;
+  if(item.group){
+    height = Analyze(item.group, audit);
+  }
+  if(item.type == REGEX_ITEM_ASSERTION || item.max != kUnbounded){
+    return height;
+  }
+
+  // Alternatives of a repeated group that match the same text, and inner
+  // repetitions that can also start the next iteration
+  if(item.type == REGEX_ITEM_GROUP){
+    auto first = GetFirstChars(item);
+    auto& alternatives = item.group->alternatives;
+    for(std::size_t i = 0; i < alternatives.size(); i++){
+      if(IsNullable(alternatives[i]) == true){
+        audit.problems.push_back("repeated group can match the empty string");
+      }
+      for(std::size_t j = i + 1; j < alternatives.size(); j++){
+        auto overlap = GetFirstChars(alternatives[i]) & GetFirstChars(alternatives[j]);
+        if(overlap.any()){
+          audit.problems.push_back("alternatives of a repeated group both start with " +
+                                   DescribeChar(overlap));
+        }
+      }
+      for(auto& inner : alternatives[i]){
+        auto overlap = first & GetChars(inner);
+        if(IsUnbounded(inner) == true && overlap.any()){
+          audit.problems.push_back("nested quantifiers can both consume " +
+                                   DescribeChar(overlap));
+        }
+      }
+    }
+  }
+
+  // Unbounded matches over almost any character
+  if(item.type == REGEX_ITEM_CHARS && item.chars.count() > 200){
+    audit.warnings.push_back("unbounded match over almost any character: "
+                             "std::regex recursion grows with the statement");
+  }
+
+  return height + 1;
+}
+
+int Analyze(const std::shared_ptr<RegexGroup>& group, RegexAudit& audit){
+
+  int height = 0;
+  for(auto& sequence : group->alternatives){
+    for(std::size_t i = 0; i < sequence.size(); i++){
+      height = std::max(height, Analyze(sequence[i], audit));
+
+      // Adjacent unbounded items that can consume the same characters
+      if(IsUnbounded(sequence[i]) == false){
+        continue;
+      }
+      auto chars = GetChars(sequence[i]);
+      for(std::size_t j = i + 1; j < sequence.size(); j++){
+        auto overlap = chars & GetFirstChars(sequence[j]);
+        if(IsUnbounded(sequence[j]) == true && overlap.any()){
+          audit.problems.push_back("adjacent quantifiers can both consume " +
+                                   DescribeChar(overlap));
+        }
+        if(IsNullable(sequence[j]) == false){
+          break;
+        }
+      }
+    }
+  }
+
+  return height;
+}
+
+void AnalyzePattern(const std::string& pattern, RegexAudit& audit){
+
+  bool has_control_characters = false;
+  auto group = ParseRegex(pattern, has_control_characters);
+
+  audit.star_height = Analyze(group, audit);
+
+  if(has_control_characters == true){
+    audit.warnings.push_back("control character in the pattern "
+                             "(\"\\b\" instead of \"\\\\b\"?)");
+  }
+
+  // Report every problem once
+  for(auto list : {&audit.problems, &audit.warnings}){
+    std::sort(list->begin(), list->end());
+    list->erase(std::unique(list->begin(), list->end()), list->end());
+  }
+
+}
+
+// FUZZER
+
+// Worst-case input family, built by repeating a unit after a prefix
+struct FuzzInput {
+
+  std::string prefix;
+
+  std::string unit;
+
+  std::string Build(const std::size_t size) const {
+    std::string input = prefix;
+    while(input.length() < size){
+      input += unit;
+    }
+    input.resize(std::max(size, prefix.length()));
+    return input;
+  }
+
+  std::string Describe(const std::size_t size) const {
+    auto repeated = "\"" + unit + "\" repeated (" + std::to_string(size) + " bytes)";
+    return prefix.empty() ? repeated : "\"" + prefix + "\" + " + repeated;
+  }
+
+};
+
+// Collect the literal words and the characters of the unbounded items
+void CollectFuzzParts(const std::shared_ptr<RegexGroup>& group,
+                      std::vector<std::string>& words,
+                      std::string& pumps){
+
+  for(auto& sequence : group->alternatives){
+    std::string word;
+    for(auto& item : sequence){
+      bool literal = (item.type == REGEX_ITEM_CHARS && item.chars.count() == 1 &&
+                      item.min == 1 && item.max == 1);
+      if(literal == true){
+        for(int c = 0; c < 256; c++){
+          if(item.chars.test(c)){
+            word += static_cast<char>(c);
+          }
+        }
+        continue;
+      }
+
+      if(word.length() >= 2){
+        words.push_back(word);
+      }
+      word.clear();
+
+      if(item.group){
+        CollectFuzzParts(item.group, words, pumps);
+      }
+      if(item.type == REGEX_ITEM_CHARS && item.max == kUnbounded){
+        // Prefer letters, then spaces, then digits
+        auto chars = item.chars;
+        char pump = 0;
+        for(auto candidate : std::string("a _0.,(=*")){
+          if(chars.test(static_cast<unsigned char>(candidate))){
+            pump = candidate;
+            break;
+          }
+        }
+        if(pump != 0 && pumps.find(pump) == std::string::npos){
+          pumps += pump;
+        }
+      }
+    }
+    if(word.length() >= 2){
+      words.push_back(word);
+    }
+  }
+
+}
+
+// Time a full scan of the input, like CheckPattern does
+std::uint64_t TimePattern(const std::regex& pattern, const std::string& input){
+
+  auto start = std::chrono::steady_clock::now();
+  std::sregex_iterator search(input.begin(), input.end(), pattern);
+  for(std::sregex_iterator end; search != end; ++search){
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+}
+
+std::string FormatMilliseconds(const std::uint64_t nanoseconds){
+  char text[32];
+  snprintf(text, sizeof(text), "%.1f ms", nanoseconds / 1e6);
+  return text;
+}
+
+void FuzzPattern(const std::string& pattern,
+                 const RegexFuzzOptions& options,
+                 RegexAudit& audit){
+
+  bool has_control_characters = false;
+  auto group = ParseRegex(pattern, has_control_characters);
+
+  std::vector<std::string> words;
+  std::string pumps = "a ";
+  CollectFuzzParts(group, words, pumps);
+  std::sort(words.begin(), words.end());
+  words.erase(std::unique(words.begin(), words.end()), words.end());
+
+  // Repeated words, words followed by a long run that never completes the
+  // match, long runs, and all the words in a row
+  std::vector<FuzzInput> inputs;
+  std::string all_words;
+  for(auto& word : words){
+    inputs.push_back(FuzzInput{"", word + " "});
+    for(auto pump : pumps){
+      inputs.push_back(FuzzInput{word, std::string(1, pump)});
+      inputs.push_back(FuzzInput{"", word + std::string(8, pump)});
+    }
+    all_words += word + " ";
+  }
+  for(auto pump : pumps){
+    inputs.push_back(FuzzInput{"", std::string(1, pump)});
+  }
+  if(all_words.empty() == false){
+    inputs.push_back(FuzzInput{"", all_words});
+  }
+
+  std::regex regex;
+  try {
+    regex = std::regex(pattern);
+  } catch (std::regex_error& e) {
+    audit.problems.push_back("pattern does not compile");
+    return;
+  }
+
+  auto threshold = options.time_threshold_ms * 1000 * 1000;
+  for(auto& input : inputs){
+    std::uint64_t previous = 0;
+    for(std::size_t size = 256; size <= options.max_input_bytes; size *= 2){
+      auto text = input.Build(size);
+
+      // Best of two runs to filter out noise
+      std::uint64_t nanoseconds = 0;
+      try {
+        nanoseconds = std::min(TimePattern(regex, text), TimePattern(regex, text));
+      } catch (std::regex_error& e) {
+        audit.problems.push_back("regex engine gives up on " + input.Describe(size));
+        break;
+      }
+
+      if(nanoseconds >= audit.worst_nanoseconds){
+        audit.worst_nanoseconds = nanoseconds;
+        audit.worst_input = input.Describe(size);
+        audit.growth = (previous > 0) ? static_cast<double>(nanoseconds) / previous : 0;
+      }
+      previous = nanoseconds;
+
+      if(nanoseconds > threshold){
+        audit.problems.push_back(input.Describe(size) + " takes " +
+                                 FormatMilliseconds(nanoseconds));
+        break;
+      }
+    }
+  }
+
+}
+
+}  // namespace sqlcheck
@@ -0,0 +1,305 @@
+// REGEX PARSER SOURCE
+
+#include "include/regex_parser.h"
+
+namespace sqlcheck {
+
+CharSet GetRange(const int first, const int last){
+  CharSet chars;
+  for(int c = first; c <= last; c++){
+    chars.set(static_cast<unsigned char>(c));
+  }
+  return chars;
+}
+
+CharSet GetDigits(){
+  return GetRange('0', '9');
+}
+
+CharSet GetWordCharacters(){
+  auto chars = GetRange('a', 'z') | GetRange('A', 'Z') | GetDigits();
+  chars.set('_');
+  return chars;
+}
+
+CharSet GetSpaces(){
+  CharSet chars;
+  for(auto c : std::string(" \t\n\r\f\v")){
+    chars.set(static_cast<unsigned char>(c));
+  }
+  return chars;
+}
+
+// Recursive-descent parser of the ECMAScript subset used by the rules
+class RegexParser {
+
+ public:
+  explicit RegexParser(const std::string& pattern)
+   : pattern_(pattern),
+     pos_(0),
+     has_control_characters_(false) {
+  }
+
+  std::shared_ptr<RegexGroup> Parse(){
+    return ParseGroup();
+  }
+
+  bool HasControlCharacters() const {
+    return has_control_characters_;
+  }
+
+ private:
+
+  bool AtEnd() const {
+    return pos_ >= pattern_.length();
+  }
+
+  unsigned char Peek() const {
+    return static_cast<unsigned char>(pattern_[pos_]);
+  }
+
+  unsigned char Next(){
+    auto c = Peek();
+    if(c < 0x20){
+      has_control_characters_ = true;
+    }
+    pos_++;
+    return c;
+  }
+
+  std::shared_ptr<RegexGroup> ParseGroup(){
+    std::shared_ptr<RegexGroup> group(new RegexGroup());
+    group->alternatives.push_back(ParseSequence());
+    while(AtEnd() == false && Peek() == '|'){
+      Next();
+      group->alternatives.push_back(ParseSequence());
+    }
+    return group;
+  }
+
+  RegexSequence ParseSequence(){
+    RegexSequence sequence;
+    while(AtEnd() == false && Peek() != '|' && Peek() != ')'){
+      RegexItem item;
+      ParseAtom(item);
+      ParseQuantifier(item);
+      sequence.push_back(item);
+    }
+    return sequence;
+  }
+
+  void ParseAtom(RegexItem& item){
+
+    auto c = Next();
+    switch (c) {
+      case '(': {
+        item.type = REGEX_ITEM_GROUP;
+        if(pattern_.compare(pos_, 2, "?:") == 0){
+          pos_ += 2;
+        }
+        else if(pattern_.compare(pos_, 2, "?=") == 0 ||
+                pattern_.compare(pos_, 2, "?!") == 0){
+          item.type = REGEX_ITEM_ASSERTION;
+          pos_ += 2;
+        }
+        item.group = ParseGroup();
+        if(AtEnd() == false){
+          Next();
+        }
+        break;
+      }
+      case '[':
+        item.chars = ParseClass();
+        break;
+      case '.':
+        item.chars = ~CharSet();
+        item.chars.reset('\n');
+        item.chars.reset('\r');
+        break;
+      case '^':
+      case '$':
+        item.type = REGEX_ITEM_ASSERTION;
+        break;
+      case '\\': {
+        bool assertion = false;
+        item.chars = ParseEscape(false, assertion);
+        if(assertion == true){
+          item.type = REGEX_ITEM_ASSERTION;
+        }
+        break;
+      }
+      default:
+        item.chars.set(c);
+        break;
+    }
+
+  }
+
+  CharSet ParseEscape(const bool in_class, bool& assertion){
+
+    CharSet chars;
+    if(AtEnd() == true){
+      chars.set('\\');
+      return chars;
+    }
+
+    auto c = Next();
+    switch (c) {
+      case 'd':
+        return GetDigits();
+      case 'D':
+        return ~GetDigits();
+      case 's':
+        return GetSpaces();
+      case 'S':
+        return ~GetSpaces();
+      case 'w':
+        return GetWordCharacters();
+      case 'W':
+        return ~GetWordCharacters();
+      case 'b':
+        if(in_class == true){
+          chars.set('\b');
+        }
+        else {
+          assertion = true;
+        }
+        return chars;
+      case 'B':
+        assertion = true;
+        return chars;
+      case 'n':
+        chars.set('\n');
+        return chars;
+      case 't':
+        chars.set('\t');
+        return chars;
+      case 'r':
+        chars.set('\r');
+        return chars;
+      case 'f':
+        chars.set('\f');
+        return chars;
+      case 'v':
+        chars.set('\v');
+        return chars;
+      default:
+        chars.set(c);
+        return chars;
+    }
+
+  }
+
+  CharSet ParseClass(){
+
+    CharSet chars;
+    bool negated = false;
+    if(AtEnd() == false && Peek() == '^'){
+      negated = true;
+      Next();
+    }
+
+    bool first = true;
+    while(AtEnd() == false && (Peek() != ']' || first == true)){
+      first = false;
+
+      // Single character or escape
+      CharSet item;
+      int single = -1;
+      auto c = Next();
+      if(c == '\\'){
+        bool assertion = false;
+        item = ParseEscape(true, assertion);
+        if(item.count() == 1){
+          for(int i = 0; i < 256; i++){
+            single = item.test(i) ? i : single;
+          }
+        }
+      }
+      else {
+        item.set(c);
+        single = c;
+      }
+
+      // Range
+      if(single >= 0 && pos_ + 1 < pattern_.length() && Peek() == '-' &&
+         pattern_[pos_ + 1] != ']'){
+        Next();
+        int last = Next();
+        if(last == '\\' && AtEnd() == false){
+          last = Next();
+        }
+        if(last >= single){
+          item = GetRange(single, last);
+        }
+      }
+      chars |= item;
+    }
+
+    if(AtEnd() == false){
+      Next();
+    }
+    return negated ? ~chars : chars;
+  }
+
+  void ParseQuantifier(RegexItem& item){
+
+    if(AtEnd() == true){
+      return;
+    }
+
+    auto c = Peek();
+    if(c == '*' || c == '+' || c == '?'){
+      Next();
+      item.min = (c == '+') ? 1 : 0;
+      item.max = (c == '?') ? 1 : kUnbounded;
+    }
+    else if(c == '{'){
+      // {n}, {n,} or {n,m} (anything else is a literal brace)
+      auto end = pattern_.find('}', pos_);
+      if(end == std::string::npos){
+        return;
+      }
+      auto bounds = pattern_.substr(pos_ + 1, end - pos_ - 1);
+      auto comma = bounds.find(',');
+      auto min_text = bounds.substr(0, comma);
+      if(min_text.empty() ||
+         min_text.find_first_not_of("0123456789") != std::string::npos){
+        return;
+      }
+      item.min = std::stoul(min_text);
+      item.max = item.min;
+      if(comma != std::string::npos){
+        auto max_text = bounds.substr(comma + 1);
+        item.max = max_text.empty() ? kUnbounded : std::stoul(max_text);
+      }
+      pos_ = end + 1;
+    }
+    else {
+      return;
+    }
+
+    // Lazy quantifiers backtrack the same way
+    if(AtEnd() == false && Peek() == '?'){
+      Next();
+    }
+
+  }
+
+  std::string pattern_;
+
+  std::size_t pos_;
+
+  bool has_control_characters_;
+
+};
+
+std::shared_ptr<RegexGroup> ParseRegex(const std::string& pattern,
+                                       bool& has_control_characters){
+  RegexParser parser(pattern);
+  auto group = parser.Parse();
+  has_control_characters = parser.HasControlCharacters();
+  return group;
+}
+
+}  // namespace sqlcheck
@@ -0,0 +1,383 @@
+// REPORT WRITER SOURCE
+
+#include <cerrno>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "include/report_writer.h"
+
+#include "include/json.h"
+#include "include/list.h"
+#include "include/tracer.h"
+
+namespace sqlcheck {
+
+// OUTPUT BUFFER
+
+FileDescriptorBuffer::FileDescriptorBuffer(const int fd)
+ : fd_(fd),
+   buffer_(64 * 1024) {
+  setp(buffer_.data(), buffer_.data() + buffer_.size());
+}
+
+FileDescriptorBuffer::~FileDescriptorBuffer(){
+  Flush();
+  if(fd_ >= 0){
+    close(fd_);
+  }
+}
+
+bool FileDescriptorBuffer::Flush(){
+
+  auto data = pbase();
+  auto length = pptr() - pbase();
+  while(length > 0){
+    auto written = write(fd_, data, length);
+    if(written < 0 && errno == EINTR){
+      continue;
+    }
+    if(written <= 0){
+      return false;
+    }
+    data += written;
+    length -= written;
+  }
+
+  setp(buffer_.data(), buffer_.data() + buffer_.size());
+  return true;
+}
+
+int FileDescriptorBuffer::overflow(int c){
+
+  if(Flush() == false){
+    return traits_type::eof();
+  }
+  if(traits_type::eq_int_type(c, traits_type::eof()) == false){
+    *pptr() = traits_type::to_char_type(c);
+    pbump(1);
+  }
+  return traits_type::not_eof(c);
+}
+
+int FileDescriptorBuffer::sync(){
+  return (Flush() == true) ? 0 : -1;
+}
+
+// JSON
+
+// Single JSON document: the findings and the summary of the run
+class JsonReportWriter : public ReportWriter {
+
+ public:
+  explicit JsonReportWriter(std::ostream& output)
+   : output_(output) {
+  }
+
+  void Begin() override {
+    output_ << "{\"findings\":[";
+  }
+
+  void WriteFinding(const std::string& file_name, const Finding& finding) override {
+    output_ << ((finding_count_ == 0) ? "\n" : ",\n");
+    WriteFindingJson(output_, finding, file_name);
+    finding_count_++;
+  }
+
+  void End(const Configuration& state) override {
+    auto count = [&state](const RiskLevel risk_level){
+      auto entry = state.checker_stats.find(risk_level);
+      return (entry == state.checker_stats.end()) ? 0 : entry->second;
+    };
+
+    output_ << "\n],\"summary\":{\"findings\":" << finding_count_
+            << ",\"all\":" << count(RISK_LEVEL_ALL)
+            << ",\"high\":" << count(RISK_LEVEL_HIGH)
+            << ",\"medium\":" << count(RISK_LEVEL_MEDIUM)
+            << ",\"low\":" << count(RISK_LEVEL_LOW)
+            << ",\"hints\":" << count(RISK_LEVEL_NONE)
+            << ",\"statements\":" << state.run_stats.statements << "}}\n"
+            << std::flush;
+  }
+
+ private:
+
+  std::ostream& output_;
+
+};
+
+// JSON LINES
+
+// One JSON object per finding
+class JsonLinesReportWriter : public ReportWriter {
+
+ public:
+  explicit JsonLinesReportWriter(std::ostream& output)
+   : output_(output) {
+  }
+
+  void Begin() override {
+  }
+
+  void WriteFinding(const std::string& file_name, const Finding& finding) override {
+    WriteFindingJson(output_, finding, file_name);
+    output_ << "\n";
+    finding_count_++;
+  }
+
+  void End(const Configuration&) override {
+    output_ << std::flush;
+  }
+
+ private:
+
+  std::ostream& output_;
+
+};
+
+// SARIF
+
+std::string RiskLevelToSarifLevel(const RiskLevel& risk_level){
+
+  switch (risk_level) {
+    case RISK_LEVEL_HIGH:
+      return "error";
+    case RISK_LEVEL_MEDIUM:
+      return "warning";
+    default:
+      return "note";
+  }
+
+}
+
+// SARIF 2.1.0 log with a single run. The rules are known up front, so only
+// the closing brackets are left for the end.
+class SarifReportWriter : public ReportWriter {
+
+ public:
+  explicit SarifReportWriter(std::ostream& output)
+   : output_(output) {
+  }
+
+  void Begin() override {
+    output_ << "{\"$schema\":\"https://json.schemastore.org/sarif-2.1.0.json\","
+            << "\"version\":\"2.1.0\",\"runs\":[{\"tool\":{\"driver\":{"
+            << "\"name\":\"sqlcheck\","
+            << "\"informationUri\":\"https://github.com/jarulraj/sqlcheck\","
+            << "\"rules\":[";
+
+    auto& rules = GetRules();
+    for(std::size_t rule_index = 0; rule_index < rules.size(); rule_index++){
+      auto& rule = rules[rule_index];
+      rule_indexes_[rule.id] = rule_index;
+      output_ << ((rule_index == 0) ? "\n" : ",\n")
+              << "{\"id\":\"" << EscapeJsonString(rule.id) << "\""
+              << ",\"name\":\"" << EscapeJsonString(rule.name) << "\""
+              << ",\"shortDescription\":{\"text\":\"" << EscapeJsonString(rule.name)
+              << "\"}}";
+    }
+
+    output_ << "]}},\"results\":[";
+  }
+
+  void WriteFinding(const std::string& file_name, const Finding& finding) override {
+    output_ << ((finding_count_ == 0) ? "\n" : ",\n")
+            << "{\"ruleId\":\"" << EscapeJsonString(finding.rule_id) << "\"";
+
+    auto rule_index = rule_indexes_.find(finding.rule_id);
+    if(rule_index != rule_indexes_.end()){
+      output_ << ",\"ruleIndex\":" << rule_index->second;
+    }
+
+    output_ << ",\"level\":\"" << RiskLevelToSarifLevel(finding.risk_level) << "\""
+            << ",\"message\":{\"text\":\"" << EscapeJsonString(finding.title)
+            << " (" << RiskLevelToString(finding.risk_level) << ", "
+            << PatternTypeToString(finding.pattern_type) << ")\"}"
+            << ",\"locations\":[{\"physicalLocation\":{";
+    if(file_name.empty() == false){
+      output_ << "\"artifactLocation\":{\"uri\":\"" << EscapeJsonString(file_name)
+              << "\"},";
+    }
+    output_ << "\"region\":{\"startLine\":" << finding.line_number
+            << ",\"startColumn\":" << finding.column
+            << ",\"charOffset\":" << finding.begin
+            << ",\"charLength\":" << (finding.end - finding.begin)
+            << ",\"snippet\":{\"text\":\"" << EscapeJsonString(finding.match)
+            << "\"}}}}]}";
+    finding_count_++;
+  }
+
+  void End(const Configuration&) override {
+    output_ << "\n]}]}\n" << std::flush;
+  }
+
+ private:
+
+  std::ostream& output_;
+
+  // position of every rule in the rules array
+  std::map<std::string, std::size_t> rule_indexes_;
+
+};
+
+std::unique_ptr<ReportWriter> CreateReportWriter(const OutputFormat& output_format,
+                                                 std::ostream& output){
+
+  switch (output_format) {
+    case OUTPUT_FORMAT_JSON:
+      return std::unique_ptr<ReportWriter>(new JsonReportWriter(output));
+    case OUTPUT_FORMAT_JSONL:
+      return std::unique_ptr<ReportWriter>(new JsonLinesReportWriter(output));
+    case OUTPUT_FORMAT_SARIF:
+      return std::unique_ptr<ReportWriter>(new SarifReportWriter(output));
+
+    case OUTPUT_FORMAT_TEXT:
+    case OUTPUT_FORMAT_INVALID:
+    default:
+      return nullptr;
+  }
+
+}
+
+// THREADED WRITER
+
+// Findings queued before the checker waits for the writer
+const std::size_t kMaxQueuedFindings = 1024;
+
+ThreadedReportWriter::ThreadedReportWriter(const OutputFormat& output_format,
+                                           std::unique_ptr<std::streambuf> buffer)
+ : buffer_(std::move(buffer)),
+   output_(buffer_.get()),
+   writer_(CreateReportWriter(output_format, output_)),
+   end_state_(nullptr),
+   done_(false) {
+}
+
+ThreadedReportWriter::~ThreadedReportWriter(){
+
+  if(thread_.joinable()){
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      done_ = true;
+    }
+    condition_.notify_all();
+    thread_.join();
+  }
+
+}
+
+void ThreadedReportWriter::Begin(){
+  thread_ = std::thread(&ThreadedReportWriter::Run, this);
+}
+
+void ThreadedReportWriter::WriteFinding(const std::string& file_name,
+                                        const Finding& finding){
+
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    condition_.wait(lock, [this]{ return queue_.size() < kMaxQueuedFindings; });
+    queue_.emplace_back(file_name, finding);
+  }
+  condition_.notify_all();
+  finding_count_++;
+
+}
+
+void ThreadedReportWriter::End(const Configuration& state){
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    end_state_ = &state;
+    done_ = true;
+  }
+  condition_.notify_all();
+  thread_.join();
+
+}
+
+void ThreadedReportWriter::Run(){
+
+  SetTraceThreadName("report writer");
+  writer_->Begin();
+
+  std::vector<std::pair<std::string, Finding>> batch;
+  while(true){
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      condition_.wait(lock, [this]{ return done_ || queue_.empty() == false; });
+      if(queue_.empty()){
+        break;
+      }
+      batch.swap(queue_);
+    }
+    condition_.notify_all();
+
+    TraceSpan span("write", "output");
+    for(auto& entry : batch){
+      writer_->WriteFinding(entry.first, entry.second);
+    }
+    batch.clear();
+  }
+
+  // The checker waits in End, so its state is not changing
+  if(end_state_ != nullptr){
+    writer_->End(*end_state_);
+  }
+  output_.flush();
+
+}
+
+// FAN OUT
+
+void FanOutReportWriter::Begin(){
+  for(auto& writer : writers_){
+    writer->Begin();
+  }
+}
+
+void FanOutReportWriter::WriteFinding(const std::string& file_name,
+                                      const Finding& finding){
+  for(auto& writer : writers_){
+    writer->WriteFinding(file_name, finding);
+  }
+  finding_count_++;
+}
+
+void FanOutReportWriter::End(const Configuration& state){
+  for(auto& writer : writers_){
+    writer->End(state);
+  }
+}
+
+std::unique_ptr<ReportWriter> OpenReportSinks(const std::vector<OutputSink>& output_sinks,
+                                              const int stdout_fd){
+
+  std::vector<std::unique_ptr<ReportWriter>> writers;
+  for(auto& output_sink : output_sinks){
+    if(output_sink.format == OUTPUT_FORMAT_TEXT){
+      continue;
+    }
+
+    int fd = stdout_fd;
+    if(output_sink.path != "-"){
+      fd = open(output_sink.path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+      if(fd < 0){
+        throw std::runtime_error("Cannot write report: " + output_sink.path);
+      }
+    }
+    std::unique_ptr<std::streambuf> buffer(new FileDescriptorBuffer(fd));
+    writers.emplace_back(new ThreadedReportWriter(output_sink.format, std::move(buffer)));
+  }
+
+  if(writers.empty()){
+    return nullptr;
+  }
+  if(writers.size() == 1){
+    return std::move(writers[0]);
+  }
+  return std::unique_ptr<ReportWriter>(new FanOutReportWriter(std::move(writers)));
+
+}
+
+}  // namespace sqlcheck
@@ -0,0 +1,326 @@
+// RUN STATS SOURCE
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+
+#include <sys/resource.h>
+
+#include "include/run_stats.h"
+
+#include "include/json.h"
+
+namespace sqlcheck {
+
+// UTILITY
+
+std::atomic<std::uint64_t> regex_compilations(0);
+
+std::regex CompileRegex(const std::string& pattern){
+  regex_compilations++;
+  return std::regex(pattern);
+}
+
+std::uint64_t GetRegexCompilations(){
+  return regex_compilations.load();
+}
+
+std::uint64_t GetPeakRss(){
+
+  struct rusage usage;
+  if(getrusage(RUSAGE_SELF, &usage) != 0){
+    return 0;
+  }
+
+#ifdef __APPLE__
+  return static_cast<std::uint64_t>(usage.ru_maxrss);
+#else
+  return static_cast<std::uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+}
+
+// HISTOGRAM
+
+// Values below 2^kSubBucketBits get a bucket each. Larger values are split
+// by magnitude, and every magnitude into 2^(kSubBucketBits - 1) buckets.
+const int kSubBucketBits = 6;
+
+const std::uint64_t kSubBucketCount = 1 << kSubBucketBits;
+
+const std::uint64_t kSubBucketHalfCount = kSubBucketCount / 2;
+
+int GetMostSignificantBit(std::uint64_t value){
+  int bit = -1;
+  while(value != 0){
+    value >>= 1;
+    bit++;
+  }
+  return bit;
+}
+
+std::size_t GetBucketIndex(const std::uint64_t value){
+  if(value < kSubBucketCount){
+    return static_cast<std::size_t>(value);
+  }
+  auto shift = GetMostSignificantBit(value) - (kSubBucketBits - 1);
+  return static_cast<std::size_t>(shift * kSubBucketHalfCount + (value >> shift));
+}
+
+std::uint64_t GetBucketHighestValue(const std::size_t index){
+  if(index < kSubBucketCount){
+    return index;
+  }
+  auto shift = (index - kSubBucketHalfCount) / kSubBucketHalfCount;
+  auto sub_bucket = index - shift * kSubBucketHalfCount;
+  return ((sub_bucket + 1) << shift) - 1;
+}
+
+LatencyHistogram::LatencyHistogram()
+ : buckets_(GetBucketIndex(UINT64_MAX) + 1, 0),
+   count_(0),
+   total_(0),
+   max_(0) {
+}
+
+void LatencyHistogram::Record(const std::uint64_t value){
+  buckets_[GetBucketIndex(value)]++;
+  count_++;
+  total_ += value;
+  if(value > max_){
+    max_ = value;
+  }
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram& other){
+  for(std::size_t index = 0; index < buckets_.size(); index++){
+    buckets_[index] += other.buckets_[index];
+  }
+  count_ += other.count_;
+  total_ += other.total_;
+  if(other.max_ > max_){
+    max_ = other.max_;
+  }
+}
+
+std::uint64_t LatencyHistogram::GetPercentile(const double fraction) const {
+
+  if(count_ == 0){
+    return 0;
+  }
+
+  auto rank = static_cast<std::uint64_t>(std::ceil(fraction * count_));
+  if(rank == 0){
+    rank = 1;
+  }
+
+  std::uint64_t seen = 0;
+  for(std::size_t index = 0; index < buckets_.size(); index++){
+    seen += buckets_[index];
+    if(seen >= rank){
+      auto value = GetBucketHighestValue(index);
+      return (value < max_) ? value : max_;
+    }
+  }
+
+  return max_;
+}
+
+// SLOWEST STATEMENTS
+
+bool IsFaster(const SlowStatement& left, const SlowStatement& right){
+  return left.nanoseconds > right.nanoseconds;
+}
+
+void SlowestStatements::Add(const SlowStatement& statement,
+                            const std::size_t capacity){
+
+  capacity_ = std::max(capacity_, capacity);
+  if(IsSlowEnough(statement.nanoseconds, capacity_) == false){
+    return;
+  }
+
+  // Drop the fastest statement of a full heap
+  if(heap_.size() >= capacity_){
+    std::pop_heap(heap_.begin(), heap_.end(), IsFaster);
+    heap_.pop_back();
+  }
+  heap_.push_back(statement);
+  std::push_heap(heap_.begin(), heap_.end(), IsFaster);
+
+}
+
+void SlowestStatements::Merge(const SlowestStatements& other){
+  for(auto& statement : other.heap_){
+    Add(statement, other.capacity_);
+  }
+}
+
+std::vector<SlowStatement> SlowestStatements::GetSorted() const {
+  auto statements = heap_;
+  std::sort(statements.begin(), statements.end(), IsFaster);
+  return statements;
+}
+
+// RUN STATS
+
+void RunStats::Start(){
+  start_time = std::chrono::steady_clock::now();
+  start_regex_compilations = GetRegexCompilations();
+}
+
+void RunStats::Stop(){
+  auto elapsed = std::chrono::steady_clock::now() - start_time;
+  elapsed_nanoseconds =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+  regex_compilations = GetRegexCompilations() - start_regex_compilations;
+  peak_rss_bytes = GetPeakRss();
+}
+
+void RunStats::Merge(const RunStats& other){
+  statements += other.statements;
+  bytes += other.bytes;
+  skipped_statements += other.skipped_statements;
+  skipped_rules += other.skipped_rules;
+  latency.Merge(other.latency);
+  slowest.Merge(other.slowest);
+}
+
+// Get a rate per second
+double GetRate(const std::uint64_t value, const std::uint64_t nanoseconds){
+  if(nanoseconds == 0){
+    return 0;
+  }
+  return value * 1e9 / nanoseconds;
+}
+
+// Format nanoseconds with a readable unit
+std::string FormatDuration(const std::uint64_t nanoseconds){
+  char text[32];
+  if(nanoseconds < 1000){
+    snprintf(text, sizeof(text), "%llu ns",
+             static_cast<unsigned long long>(nanoseconds));
+  }
+  else if(nanoseconds < 1000 * 1000){
+    snprintf(text, sizeof(text), "%.1f us", nanoseconds / 1e3);
+  }
+  else if(nanoseconds < 1000 * 1000 * 1000){
+    snprintf(text, sizeof(text), "%.1f ms", nanoseconds / 1e6);
+  }
+  else {
+    snprintf(text, sizeof(text), "%.2f s", nanoseconds / 1e9);
+  }
+  return text;
+}
+
+void PrintRunStats(const RunStats& stats, std::ostream& output){
+
+  char line[160];
+  auto seconds = stats.elapsed_nanoseconds / 1e9;
+  auto& latency = stats.latency;
+
+  output << "\n==================== Run Stats =================\n";
+  snprintf(line, sizeof(line),
+           "Statements                   :: %llu (%.0f / s)\n",
+           static_cast<unsigned long long>(stats.statements),
+           GetRate(stats.statements, stats.elapsed_nanoseconds));
+  output << line;
+  snprintf(line, sizeof(line),
+           "Bytes                        :: %llu (%.2f MB / s)\n",
+           static_cast<unsigned long long>(stats.bytes),
+           GetRate(stats.bytes, stats.elapsed_nanoseconds) / (1024 * 1024));
+  output << line;
+  snprintf(line, sizeof(line),
+           "Elapsed                      :: %.3f s\n", seconds);
+  output << line;
+  output << "Statement Latency            :: total "
+         << FormatDuration(latency.GetTotal())
+         << ", p50 " << FormatDuration(latency.GetPercentile(0.50))
+         << ", p99 " << FormatDuration(latency.GetPercentile(0.99))
+         << ", max " << FormatDuration(latency.GetMax()) << "\n";
+  snprintf(line, sizeof(line),
+           "Peak RSS                     :: %.1f MB\n",
+           stats.peak_rss_bytes / (1024.0 * 1024));
+  output << line;
+  output << "Regex Compilations           :: " << stats.regex_compilations << "\n";
+  output << "Skipped (budget)             :: " << stats.skipped_statements
+         << " statements, " << stats.skipped_rules << " rule checks\n";
+
+}
+
+void PrintSkippedChecks(const RunStats& stats, std::ostream& output){
+  if(stats.skipped_statements > 0 || stats.skipped_rules > 0){
+    output << "Skipped (budget)             :: " << stats.skipped_statements
+           << " statements, " << stats.skipped_rules << " rule checks\n";
+  }
+}
+
+void PrintSlowestStatements(const RunStats& stats, std::ostream& output){
+
+  auto statements = stats.slowest.GetSorted();
+  if(statements.empty()){
+    return;
+  }
+
+  output << "\n==================== Slowest Statements ========\n";
+  for(std::size_t rank = 0; rank < statements.size(); rank++){
+    auto& statement = statements[rank];
+    auto location = statement.file_name.empty() ? "<stdin>" : statement.file_name;
+    auto share = (statement.nanoseconds == 0) ? 0 :
+        100.0 * statement.rule_nanoseconds / statement.nanoseconds;
+
+    char line[96];
+    snprintf(line, sizeof(line), "%2zu. %10s  ", rank + 1,
+             FormatDuration(statement.nanoseconds).c_str());
+    output << line << location << ":" << statement.line_number
+           << " (offset " << statement.offset << ", " << statement.length
+           << " bytes)\n";
+    snprintf(line, sizeof(line), "%.0f%%", share);
+    output << "                 Dominant rule: " << statement.rule_id << " "
+           << statement.rule_name << " (" << line << ")\n";
+  }
+
+}
+
+void WriteRunStatsJson(const RunStats& stats, std::ostream& output){
+
+  auto& latency = stats.latency;
+  char rates[96];
+  snprintf(rates, sizeof(rates),
+           "\"statements_per_second\":%.3f,\"bytes_per_second\":%.3f",
+           GetRate(stats.statements, stats.elapsed_nanoseconds),
+           GetRate(stats.bytes, stats.elapsed_nanoseconds));
+
+  output << "{\"statements\":" << stats.statements
+         << ",\"bytes\":" << stats.bytes
+         << ",\"elapsed_nanoseconds\":" << stats.elapsed_nanoseconds
+         << "," << rates
+         << ",\"latency_nanoseconds\":{\"count\":" << latency.GetCount()
+         << ",\"total\":" << latency.GetTotal()
+         << ",\"p50\":" << latency.GetPercentile(0.50)
+         << ",\"p99\":" << latency.GetPercentile(0.99)
+         << ",\"max\":" << latency.GetMax() << "}"
+         << ",\"peak_rss_bytes\":" << stats.peak_rss_bytes
+         << ",\"regex_compilations\":" << stats.regex_compilations
+         << ",\"skipped_statements\":" << stats.skipped_statements
+         << ",\"skipped_rules\":" << stats.skipped_rules
+         << ",\"slowest\":[";
+
+  auto statements = stats.slowest.GetSorted();
+  for(std::size_t rank = 0; rank < statements.size(); rank++){
+    auto& statement = statements[rank];
+    output << ((rank == 0) ? "" : ",")
+           << "{\"nanoseconds\":" << statement.nanoseconds
+           << ",\"file\":\"" << EscapeJsonString(statement.file_name) << "\""
+           << ",\"line\":" << statement.line_number
+           << ",\"offset\":" << statement.offset
+           << ",\"length\":" << statement.length
+           << ",\"rule_id\":\"" << statement.rule_id << "\""
+           << ",\"rule_name\":\"" << statement.rule_name << "\""
+           << ",\"rule_nanoseconds\":" << statement.rule_nanoseconds << "}";
+  }
+  output << "]}\n";
+
+}
+
+}  // namespace sqlcheck
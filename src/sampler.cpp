@@ -0,0 +1,148 @@
+// SAMPLER SOURCE
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#include "include/sampler.h"
+
+#include "include/checker.h"
+#include "include/fingerprint.h"
+
+namespace sqlcheck {
+
+// Smallest inclusion probability (keeps the estimator bounded)
+const double kMinInclusionProbability = 1e-4;
+
+// z-score of the 95% confidence interval
+const double kConfidenceZScore = 1.96;
+
+Sampler::Sampler(const Configuration& state)
+ : sample_mode_(state.sample_mode),
+   sample_rate_(state.sample_rate),
+   reservoir_size_(state.sample_reservoir_size),
+   budget_(state.sample_budget),
+   generator_(state.sample_seed),
+   start_time_(std::chrono::steady_clock::now()),
+   check_time_(0),
+   seen_count_(0),
+   checked_count_(0) {
+
+  std::fill(estimates_, estimates_ + RISK_LEVEL_HIGH + 1, 0.0);
+  std::fill(variances_, variances_ + RISK_LEVEL_HIGH + 1, 0.0);
+
+}
+
+double Sampler::GetInclusionProbability(const std::string& sql_statement){
+
+  switch (sample_mode_) {
+    case SAMPLE_MODE_RATE:
+      return sample_rate_;
+
+    case SAMPLE_MODE_RESERVOIR: {
+      // The n-th statement of a fingerprint enters a reservoir of size k
+      // with probability k/n
+      auto fingerprint = HashString(GetFingerprint(sql_statement));
+      auto count = ++fingerprint_counts_[fingerprint];
+      if(count <= reservoir_size_){
+        return 1.0;
+      }
+      return std::max(kMinInclusionProbability,
+                      (double) reservoir_size_ / (double) count);
+    }
+
+    case SAMPLE_MODE_BUDGET: {
+      // Throttle so that checking uses at most the budgeted share of the
+      // wall-clock time elapsed so far
+      std::chrono::duration<double> elapsed =
+          std::chrono::steady_clock::now() - start_time_;
+      if(check_time_.count() <= 0){
+        return 1.0;
+      }
+      auto probability = budget_ * elapsed.count() / check_time_.count();
+      return std::max(kMinInclusionProbability, std::min(1.0, probability));
+    }
+
+    case SAMPLE_MODE_NONE:
+    default:
+      return 1.0;
+  }
+
+}
+
+void Sampler::CheckStatement(Configuration& state,
+                             const std::string& sql_statement){
+
+  if(sample_mode_ == SAMPLE_MODE_NONE){
+    sqlcheck::CheckStatement(state, sql_statement);
+    return;
+  }
+
+  seen_count_++;
+
+  auto probability = GetInclusionProbability(sql_statement);
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  if(probability < 1.0 && uniform(generator_) >= probability){
+    SkipStatement(state, sql_statement);
+    return;
+  }
+
+  checked_count_++;
+
+  // Check the statement and collect its findings
+  auto stats_before = state.checker_stats;
+  auto check_start = std::chrono::steady_clock::now();
+
+  sqlcheck::CheckStatement(state, sql_statement);
+
+  check_time_ += std::chrono::steady_clock::now() - check_start;
+
+  // Update the estimates
+  for(int risk_level = RISK_LEVEL_ALL; risk_level <= RISK_LEVEL_HIGH; risk_level++){
+    double findings = state.checker_stats[risk_level] - stats_before[risk_level];
+    if(findings == 0){
+      continue;
+    }
+    estimates_[risk_level] += findings / probability;
+    variances_[risk_level] +=
+        (1.0 - probability) / (probability * probability) * findings * findings;
+  }
+
+}
+
+double Sampler::GetEstimate(const RiskLevel risk_level) const {
+  return estimates_[risk_level];
+}
+
+double Sampler::GetConfidenceInterval(const RiskLevel risk_level) const {
+  return kConfidenceZScore * std::sqrt(variances_[risk_level]);
+}
+
+void Sampler::PrintSummary(const Configuration& state, std::ostream& output) const {
+
+  if(sample_mode_ == SAMPLE_MODE_NONE){
+    return;
+  }
+
+  auto print_estimate = [this, &output](const char* label, const RiskLevel risk_level){
+    char line[128];
+    snprintf(line, sizeof(line), "%s :: %.1f (95%% CI +/- %.1f)\n",
+             label, GetEstimate(risk_level), GetConfidenceInterval(risk_level));
+    output << line;
+  };
+
+  output << "\n==================== Sampling ==================\n";
+  output << "Sampling Mode                :: "
+      << SampleModeToString(state.sample_mode) << "\n";
+  output << "Statements Seen              :: " << seen_count_ << "\n";
+  output << "Statements Checked           :: " << checked_count_ << "\n";
+
+  print_estimate("Estimated Anti-Patterns     ", RISK_LEVEL_ALL);
+  print_estimate(">  High Risk  ", RISK_LEVEL_HIGH);
+  print_estimate(">  Medium Risk", RISK_LEVEL_MEDIUM);
+  print_estimate(">  Low Risk   ", RISK_LEVEL_LOW);
+  print_estimate(">  Hints      ", RISK_LEVEL_NONE);
+
+}
+
+}  // namespace sqlcheck
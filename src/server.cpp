@@ -0,0 +1,513 @@
+// SERVER SOURCE
+
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "include/server.h"
+
+#include "include/checker.h"
+#include "include/json.h"
+
+namespace sqlcheck {
+
+// Reserved epoll ids
+const std::uint64_t kListenId = 0;
+const std::uint64_t kCompletionId = 1;
+const std::uint64_t kStopId = 2;
+const std::uint64_t kFirstConnectionId = 3;
+
+// Frame header size
+const std::size_t kFrameHeaderSize = 4;
+
+// Largest accepted request (statements are capped separately)
+const std::uint32_t kMaxRequestSize = 16 * 1024 * 1024;
+
+// Unparsed request and unsent response bytes above which a connection is not
+// read until its client catches up (room for one request of the largest size)
+const std::size_t kMaxConnectionBytes = 2 * kMaxRequestSize;
+
+// Request bytes queued for the workers across connections (a request always
+// fits into an empty queue)
+const std::size_t kMaxQueuedBytes = 4 * kMaxRequestSize;
+
+void AppendFrame(std::string& buffer, const std::string& payload){
+
+  std::uint32_t length = payload.length();
+  buffer += static_cast<char>((length >> 24) & 0xff);
+  buffer += static_cast<char>((length >> 16) & 0xff);
+  buffer += static_cast<char>((length >> 8) & 0xff);
+  buffer += static_cast<char>(length & 0xff);
+  buffer += payload;
+
+}
+
+std::uint32_t ReadFrameLength(const char* header){
+
+  auto bytes = reinterpret_cast<const unsigned char*>(header);
+  return (static_cast<std::uint32_t>(bytes[0]) << 24) |
+      (static_cast<std::uint32_t>(bytes[1]) << 16) |
+      (static_cast<std::uint32_t>(bytes[2]) << 8) |
+      static_cast<std::uint32_t>(bytes[3]);
+
+}
+
+void SignalEventFd(int fd){
+  std::uint64_t value = 1;
+  ssize_t written = write(fd, &value, sizeof(value));
+  (void) written;
+}
+
+void ClearEventFd(int fd){
+  std::uint64_t value;
+  ssize_t bytes_read = read(fd, &value, sizeof(value));
+  (void) bytes_read;
+}
+
+Server::Server(const Configuration& state, const std::string& socket_path)
+ : socket_path_(socket_path),
+   listen_fd_(-1),
+   epoll_fd_(-1),
+   completion_fd_(-1),
+   stop_fd_(-1),
+   next_connection_id_(kFirstConnectionId),
+   queued_bytes_(0) {
+
+  CopyOptions(state, options_);
+  options_.collect_findings = true;
+  options_.sample_mode = SAMPLE_MODE_NONE;
+
+  // A request may hold many statements, but a single oversized one would
+  // overflow the regex stack of the worker and take down every connection
+  LimitStatementBytes(options_);
+
+  // Nothing reads the schema catalog here, so it is reset per text
+  options_.index_advice = false;
+  options_.write_catalog_file.clear();
+
+}
+
+Server::~Server(){
+
+  // Stop the workers before closing the descriptors they signal
+  pool_.reset();
+
+  for(auto& entry : connections_){
+    close(entry.second.fd);
+  }
+
+  if(listen_fd_ >= 0){
+    close(listen_fd_);
+    unlink(socket_path_.c_str());
+  }
+  if(epoll_fd_ >= 0){
+    close(epoll_fd_);
+  }
+  if(completion_fd_ >= 0){
+    close(completion_fd_);
+  }
+  if(stop_fd_ >= 0){
+    close(stop_fd_);
+  }
+
+}
+
+bool Server::Start(){
+
+  sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if(socket_path_.length() >= sizeof(address.sun_path)){
+    std::cerr << "Socket path is too long: " << socket_path_ << "\n";
+    return false;
+  }
+  strncpy(address.sun_path, socket_path_.c_str(), sizeof(address.sun_path) - 1);
+
+  listen_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if(listen_fd_ < 0){
+    perror("socket");
+    return false;
+  }
+
+  unlink(socket_path_.c_str());
+  if(bind(listen_fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+      listen(listen_fd_, SOMAXCONN) < 0){
+    perror("bind");
+    close(listen_fd_);
+    listen_fd_ = -1;
+    return false;
+  }
+
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  completion_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  stop_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if(epoll_fd_ < 0 || completion_fd_ < 0 || stop_fd_ < 0){
+    perror("epoll");
+    return false;
+  }
+
+  const std::pair<int, std::uint64_t> sources[] = {
+    {listen_fd_, kListenId},
+    {completion_fd_, kCompletionId},
+    {stop_fd_, kStopId}
+  };
+  for(auto& source : sources){
+    epoll_event event;
+    event.events = EPOLLIN;
+    event.data.u64 = source.second;
+    if(epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, source.first, &event) < 0){
+      perror("epoll_ctl");
+      return false;
+    }
+  }
+
+  // Compiled rules stay resident in the workers
+  pool_.reset(new WorkerPool(options_.num_workers));
+  for(std::size_t worker_id = 0; worker_id < pool_->GetWorkerCount(); worker_id++){
+    worker_states_.emplace_back(new Configuration());
+    CopyOptions(options_, *worker_states_.back());
+  }
+
+  return true;
+}
+
+void Server::Run(){
+
+  const int kMaxEvents = 64;
+  epoll_event events[kMaxEvents];
+
+  while(true){
+    int count = epoll_wait(epoll_fd_, events, kMaxEvents, -1);
+    if(count < 0){
+      if(errno == EINTR){
+        continue;
+      }
+      perror("epoll_wait");
+      return;
+    }
+
+    for(int i = 0; i < count; i++){
+      auto id = events[i].data.u64;
+
+      if(id == kStopId){
+        return;
+      }
+      else if(id == kListenId){
+        Accept();
+      }
+      else if(id == kCompletionId){
+        ClearEventFd(completion_fd_);
+        DrainCompletions();
+      }
+      else {
+        if(events[i].events & (EPOLLERR | EPOLLHUP)){
+          Close(id);
+          continue;
+        }
+        if(events[i].events & EPOLLIN){
+          Read(id);
+        }
+        if(events[i].events & EPOLLOUT){
+          Write(id);
+        }
+      }
+    }
+  }
+
+}
+
+void Server::Stop(){
+  if(stop_fd_ >= 0){
+    SignalEventFd(stop_fd_);
+  }
+}
+
+void Server::Accept(){
+
+  while(true){
+    int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if(fd < 0){
+      return;
+    }
+
+    auto connection_id = next_connection_id_++;
+    Connection& connection = connections_[connection_id];
+    connection.fd = fd;
+    connection.next_request = 0;
+    connection.next_response = 0;
+    connection.reading = true;
+    connection.writing = false;
+    connection.closing = false;
+
+    epoll_event event;
+    event.events = EPOLLIN;
+    event.data.u64 = connection_id;
+    if(epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) < 0){
+      perror("epoll_ctl");
+      close(fd);
+      connections_.erase(connection_id);
+    }
+  }
+
+}
+
+void Server::Read(std::uint64_t connection_id){
+
+  auto entry = connections_.find(connection_id);
+  if(entry == connections_.end()){
+    return;
+  }
+  Connection& connection = entry->second;
+
+  // Stop at the high-water mark, the rest stays in the socket
+  char buffer[64 * 1024];
+  while(connection.input.length() + connection.output.length() < kMaxConnectionBytes){
+    ssize_t bytes_read = read(connection.fd, buffer, sizeof(buffer));
+    if(bytes_read > 0){
+      connection.input.append(buffer, bytes_read);
+      continue;
+    }
+    if(bytes_read == 0){
+      // Client is done sending, answer the pending requests first
+      connection.closing = true;
+      break;
+    }
+    if(errno == EINTR){
+      continue;
+    }
+    if(errno == EAGAIN || errno == EWOULDBLOCK){
+      break;
+    }
+    Close(connection_id);
+    return;
+  }
+
+  Dispatch(connection_id);
+
+}
+
+void Server::Dispatch(std::uint64_t connection_id){
+
+  auto entry = connections_.find(connection_id);
+  if(entry == connections_.end()){
+    return;
+  }
+  Connection& connection = entry->second;
+
+  // Dispatch complete requests to the workers
+  std::size_t offset = 0;
+  while(connection.input.length() - offset >= kFrameHeaderSize){
+    auto length = ReadFrameLength(connection.input.data() + offset);
+    if(length > kMaxRequestSize){
+      Close(connection_id);
+      return;
+    }
+    if(connection.input.length() - offset - kFrameHeaderSize < length){
+      break;
+    }
+
+    // Leave the request in the connection until the queue has room
+    if(queued_bytes_ > 0 && queued_bytes_ + length > kMaxQueuedBytes){
+      break;
+    }
+    queued_bytes_ += length;
+
+    auto sql_text = connection.input.substr(offset + kFrameHeaderSize, length);
+    auto sequence = connection.next_request++;
+    offset += kFrameHeaderSize + length;
+
+    pool_->Submit([this, connection_id, sequence, sql_text](std::size_t worker_id){
+      Configuration& state = *worker_states_[worker_id];
+      CheckText(state, sql_text);
+
+      // Skipped checks tell an unchecked statement from a clean one
+      std::ostringstream response;
+      response << "{\"findings\":";
+      WriteFindingsJson(response, state.findings);
+      if(state.skipped_checks.empty() == false){
+        response << ",\"skipped\":";
+        WriteSkippedChecksJson(response, state.skipped_checks);
+      }
+      response << "}";
+
+      {
+        std::lock_guard<std::mutex> lock(completion_mutex_);
+        completions_.push_back(Completion{connection_id, sequence, sql_text.length(),
+                                          response.str()});
+      }
+      SignalEventFd(completion_fd_);
+    });
+  }
+  connection.input.erase(0, offset);
+
+  UpdateEvents(connection, connection_id);
+
+}
+
+void Server::DrainCompletions(){
+
+  std::deque<Completion> completions;
+  {
+    std::lock_guard<std::mutex> lock(completion_mutex_);
+    completions.swap(completions_);
+  }
+
+  for(auto& completion : completions){
+    queued_bytes_ -= completion.request_size;
+
+    auto entry = connections_.find(completion.connection_id);
+    if(entry == connections_.end()){
+      // Client went away
+      continue;
+    }
+
+    Connection& connection = entry->second;
+    connection.completed[completion.sequence] = std::move(completion.response);
+
+    // Keep responses in request order
+    auto next = connection.completed.begin();
+    while(next != connection.completed.end() && next->first == connection.next_response){
+      AppendFrame(connection.output, next->second);
+      next = connection.completed.erase(next);
+      connection.next_response++;
+    }
+
+    Write(completion.connection_id);
+  }
+
+  // Queue the requests that waited for room
+  std::vector<std::uint64_t> waiting;
+  for(auto& entry : connections_){
+    if(entry.second.input.length() >= kFrameHeaderSize){
+      waiting.push_back(entry.first);
+    }
+  }
+  for(auto connection_id : waiting){
+    Dispatch(connection_id);
+  }
+
+}
+
+void Server::Write(std::uint64_t connection_id){
+
+  auto entry = connections_.find(connection_id);
+  if(entry == connections_.end()){
+    return;
+  }
+  Connection& connection = entry->second;
+
+  std::size_t offset = 0;
+  while(offset < connection.output.length()){
+    ssize_t written = send(connection.fd, connection.output.data() + offset,
+                           connection.output.length() - offset, MSG_NOSIGNAL);
+    if(written < 0){
+      if(errno == EINTR){
+        continue;
+      }
+      if(errno == EAGAIN || errno == EWOULDBLOCK){
+        break;
+      }
+      Close(connection_id);
+      return;
+    }
+    offset += written;
+  }
+  connection.output.erase(0, offset);
+
+  UpdateEvents(connection, connection_id);
+
+}
+
+bool HasCompleteFrame(const std::string& input){
+  return input.length() >= kFrameHeaderSize &&
+      input.length() - kFrameHeaderSize >= ReadFrameLength(input.data());
+}
+
+void Server::UpdateEvents(Connection& connection, std::uint64_t connection_id){
+
+  // Close half-closed connections once every response is sent
+  if(connection.closing == true && connection.output.empty() &&
+      connection.next_response == connection.next_request &&
+      HasCompleteFrame(connection.input) == false){
+    Close(connection_id);
+    return;
+  }
+
+  // Stop polling for input on half-closed and backed up connections
+  bool reading = (connection.closing == false &&
+      connection.input.length() + connection.output.length() < kMaxConnectionBytes);
+  bool writing = (connection.output.empty() == false);
+  if(reading == connection.reading && writing == connection.writing){
+    return;
+  }
+
+  epoll_event event;
+  event.events = 0;
+  if(reading == true){
+    event.events |= EPOLLIN;
+  }
+  if(writing == true){
+    event.events |= EPOLLOUT;
+  }
+  event.data.u64 = connection_id;
+  if(epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, connection.fd, &event) < 0){
+    Close(connection_id);
+    return;
+  }
+  connection.reading = reading;
+  connection.writing = writing;
+
+}
+
+void Server::Close(std::uint64_t connection_id){
+
+  auto entry = connections_.find(connection_id);
+  if(entry == connections_.end()){
+    return;
+  }
+
+  epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, entry->second.fd, nullptr);
+  close(entry->second.fd);
+  connections_.erase(entry);
+
+}
+
+// Server interrupted by signals
+Server* active_server = nullptr;
+
+void StopActiveServer(int){
+  if(active_server != nullptr){
+    active_server->Stop();
+  }
+}
+
+int Serve(const Configuration& state){
+
+  Server server(state, state.serve_path);
+  if(server.Start() == false){
+    return EXIT_FAILURE;
+  }
+
+  active_server = &server;
+  signal(SIGINT, StopActiveServer);
+  signal(SIGTERM, StopActiveServer);
+  signal(SIGPIPE, SIG_IGN);
+
+  std::cout << "Serving requests on " << state.serve_path << "\n" << std::flush;
+  server.Run();
+
+  active_server = nullptr;
+  return EXIT_SUCCESS;
+}
+
+}  // namespace sqlcheck
@@ -0,0 +1,148 @@
+// TOKENIZER SOURCE
+
+#include <cctype>
+
+#include "include/tokenizer.h"
+
+namespace sqlcheck {
+
+bool IsIdentifierStart(const char c){
+  return std::isalpha(static_cast<unsigned char>(c)) || c == '_' ||
+      (static_cast<unsigned char>(c) & 0x80);
+}
+
+bool IsIdentifierCharacter(const char c){
+  return IsIdentifierStart(c) || std::isdigit(static_cast<unsigned char>(c)) ||
+      c == '$';
+}
+
+void Tokenize(const std::string& sql_statement,
+              std::vector<Token>& tokens){
+
+  tokens.clear();
+
+  const std::string& sql = sql_statement;
+  std::size_t length = sql.length();
+  std::size_t pos = 0;
+
+  while(pos < length){
+    char c = sql[pos];
+    char next = (pos + 1 < length) ? sql[pos + 1] : '\0';
+
+    // WHITESPACE
+    if(std::isspace(static_cast<unsigned char>(c))){
+      pos++;
+      continue;
+    }
+
+    // LINE COMMENT
+    if(c == '-' && next == '-'){
+      while(pos < length && sql[pos] != '\n'){
+        pos++;
+      }
+      continue;
+    }
+
+    // BLOCK COMMENT
+    if(c == '/' && next == '*'){
+      auto end = sql.find("*/", pos + 2);
+      pos = (end == std::string::npos) ? length : end + 2;
+      continue;
+    }
+
+    Token token;
+    token.begin = pos;
+
+    // WORD
+    if(IsIdentifierStart(c)){
+      while(pos < length && IsIdentifierCharacter(sql[pos])){
+        token.text += std::tolower(static_cast<unsigned char>(sql[pos]));
+        pos++;
+      }
+      token.type = TOKEN_TYPE_WORD;
+    }
+    // NUMBER
+    else if(std::isdigit(static_cast<unsigned char>(c)) ||
+        (c == '.' && std::isdigit(static_cast<unsigned char>(next)))){
+      while(pos < length && (std::isalnum(static_cast<unsigned char>(sql[pos])) ||
+          sql[pos] == '.')){
+        pos++;
+      }
+      token.text = sql.substr(token.begin, pos - token.begin);
+      token.type = TOKEN_TYPE_NUMBER;
+    }
+    // STRING OR QUOTED IDENTIFIER
+    else if(c == '\'' || c == '"' || c == '`' || c == '['){
+      char close = (c == '[') ? ']' : c;
+      pos++;
+      while(pos < length){
+        if(sql[pos] == close){
+          // doubled quote
+          if(close != ']' && pos + 1 < length && sql[pos + 1] == close){
+            token.text += close;
+            pos += 2;
+            continue;
+          }
+          pos++;
+          break;
+        }
+        if(sql[pos] == '\\' && c == '\'' && pos + 1 < length){
+          token.text += sql[pos + 1];
+          pos += 2;
+          continue;
+        }
+        token.text += sql[pos];
+        pos++;
+      }
+      token.type = (c == '\'') ? TOKEN_TYPE_STRING : TOKEN_TYPE_IDENTIFIER;
+    }
+    // PARAMETER
+    else if(c == '?' ||
+        ((c == '$' || c == ':' || c == '@') && IsIdentifierCharacter(next))){
+      pos++;
+      while(c != '?' && pos < length && IsIdentifierCharacter(sql[pos])){
+        pos++;
+      }
+      token.text = sql.substr(token.begin, pos - token.begin);
+      token.type = TOKEN_TYPE_PARAMETER;
+    }
+    // SYMBOL
+    else {
+      static const char* operators[] = {"<=", ">=", "<>", "!=", "||", "::"};
+      token.text = c;
+      for(auto op : operators){
+        if(op[0] == c && op[1] == next){
+          token.text += next;
+          break;
+        }
+      }
+      pos += token.text.length();
+      token.type = TOKEN_TYPE_SYMBOL;
+    }
+
+    token.length = pos - token.begin;
+    tokens.push_back(std::move(token));
+  }
+
+}
+
+std::size_t FindClosingParenthesis(const std::vector<Token>& tokens,
+                                   std::size_t open){
+
+  std::size_t depth = 0;
+  for(auto pos = open; pos < tokens.size(); pos++){
+    if(tokens[pos].Is("(")){
+      depth++;
+    }
+    else if(tokens[pos].Is(")")){
+      depth--;
+      if(depth == 0){
+        return pos;
+      }
+    }
+  }
+
+  return tokens.size();
+}
+
+}  // namespace sqlcheck
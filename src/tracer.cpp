@@ -0,0 +1,203 @@
+// TRACER SOURCE
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "include/tracer.h"
+
+#include "include/json.h"
+
+namespace sqlcheck {
+
+std::atomic<bool> tracing_enabled(false);
+
+// Spans kept per thread (the oldest ones are overwritten)
+const std::size_t kTraceBufferSize = 1 << 16;
+
+// Completed span
+struct TraceEvent {
+
+  const char* name;
+
+  const char* category;
+
+  std::uint64_t start;
+
+  std::uint64_t end;
+
+};
+
+// Ring buffer of a thread. Only the owning thread writes to it, so
+// recording a span takes no lock.
+struct TraceBuffer {
+
+  explicit TraceBuffer(const std::uint32_t id)
+   : thread_id(id),
+     events(kTraceBufferSize),
+     head(0) {
+  }
+
+  std::uint32_t thread_id;
+
+  std::string thread_name;
+
+  std::vector<TraceEvent> events;
+
+  // spans recorded so far
+  std::atomic<std::uint64_t> head;
+
+};
+
+// Buffers of all threads (owned here so they outlive their threads)
+struct TraceRegistry {
+
+  TraceRegistry()
+   : generation(1) {
+  }
+
+  std::mutex mutex;
+
+  std::vector<std::unique_ptr<TraceBuffer>> buffers;
+
+  // bumped when the buffers are dropped
+  std::atomic<std::uint64_t> generation;
+
+  std::chrono::steady_clock::time_point origin;
+
+};
+
+TraceRegistry& GetTraceRegistry(){
+  static TraceRegistry registry;
+  return registry;
+}
+
+thread_local TraceBuffer* thread_buffer = nullptr;
+
+thread_local std::uint64_t thread_generation = 0;
+
+thread_local std::string thread_name;
+
+// Get the buffer of the calling thread (registered on first use)
+TraceBuffer* GetThreadBuffer(){
+
+  auto& registry = GetTraceRegistry();
+  auto generation = registry.generation.load(std::memory_order_acquire);
+  if(thread_buffer != nullptr && thread_generation == generation){
+    return thread_buffer;
+  }
+
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  auto thread_id = static_cast<std::uint32_t>(registry.buffers.size() + 1);
+  registry.buffers.emplace_back(new TraceBuffer(thread_id));
+  thread_buffer = registry.buffers.back().get();
+  thread_buffer->thread_name = thread_name;
+  thread_generation = generation;
+  return thread_buffer;
+}
+
+void StartTracing(){
+
+  auto& registry = GetTraceRegistry();
+  {
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.origin = std::chrono::steady_clock::now();
+  }
+  tracing_enabled.store(true, std::memory_order_release);
+
+}
+
+void StopTracing(){
+
+  auto& registry = GetTraceRegistry();
+  tracing_enabled.store(false, std::memory_order_release);
+
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.buffers.clear();
+  registry.generation++;
+
+}
+
+std::uint64_t GetTraceTime(){
+  auto elapsed = std::chrono::steady_clock::now() - GetTraceRegistry().origin;
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+}
+
+void SetTraceThreadName(const std::string& name){
+
+  thread_name = name;
+  if(IsTracing() == false){
+    return;
+  }
+
+  auto buffer = GetThreadBuffer();
+  std::lock_guard<std::mutex> lock(GetTraceRegistry().mutex);
+  buffer->thread_name = name;
+
+}
+
+void RecordTraceSpan(const char* name,
+                     const char* category,
+                     const std::uint64_t start,
+                     const std::uint64_t end){
+
+  auto buffer = GetThreadBuffer();
+  auto head = buffer->head.load(std::memory_order_relaxed);
+  auto& event = buffer->events[head & (kTraceBufferSize - 1)];
+  event.name = name;
+  event.category = category;
+  event.start = start;
+  event.end = (end > start) ? end : start;
+  buffer->head.store(head + 1, std::memory_order_release);
+
+}
+
+// Write nanoseconds as microseconds
+void WriteMicroseconds(std::ostream& output,
+                       const std::uint64_t nanoseconds){
+  char text[32];
+  snprintf(text, sizeof(text), "%llu.%03llu",
+           static_cast<unsigned long long>(nanoseconds / 1000),
+           static_cast<unsigned long long>(nanoseconds % 1000));
+  output << text;
+}
+
+void WriteTrace(std::ostream& output){
+
+  auto& registry = GetTraceRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+
+  output << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+  output << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,"
+         << "\"args\":{\"name\":\"sqlcheck\"}}";
+
+  for(auto& buffer : registry.buffers){
+    auto thread_id = buffer->thread_id;
+    auto name = buffer->thread_name.empty() ?
+        "thread " + std::to_string(thread_id) : buffer->thread_name;
+    output << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+           << thread_id << ",\"args\":{\"name\":\"" << EscapeJsonString(name)
+           << "\"}}";
+
+    // Spans in recording order, without the overwritten ones
+    auto head = buffer->head.load(std::memory_order_acquire);
+    auto first = (head > kTraceBufferSize) ? head - kTraceBufferSize : 0;
+    for(auto index = first; index < head; index++){
+      auto& event = buffer->events[index & (kTraceBufferSize - 1)];
+      output << ",\n{\"name\":\"" << EscapeJsonString(event.name)
+             << "\",\"cat\":\"" << EscapeJsonString(event.category)
+             << "\",\"ph\":\"X\",\"ts\":";
+      WriteMicroseconds(output, event.start);
+      output << ",\"dur\":";
+      WriteMicroseconds(output, event.end - event.start);
+      output << ",\"pid\":1,\"tid\":" << thread_id << "}";
+    }
+  }
+
+  output << "\n]}\n";
+
+}
+
+}  // namespace sqlcheck
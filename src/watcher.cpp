@@ -0,0 +1,343 @@
+// WATCHER SOURCE
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <set>
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include "include/watcher.h"
+
+#include "include/checker.h"
+#include "include/color.h"
+#include "include/file_walker.h"
+#include "include/fingerprint.h"
+
+namespace sqlcheck {
+
+Watcher::Watcher(const Configuration& state, const std::string& root)
+ : root_(root),
+   inotify_fd_(-1),
+   stop_fd_(-1),
+   last_checked_count_(0) {
+
+  CopyOptions(state, state_);
+  state_.collect_findings = true;
+  state_.sample_mode = SAMPLE_MODE_NONE;
+  LimitStatementBytes(state_);
+
+  // Nothing reads the schema catalog here, so it is reset per text
+  state_.index_advice = false;
+  state_.write_catalog_file.clear();
+
+}
+
+Watcher::~Watcher(){
+
+  if(inotify_fd_ >= 0){
+    close(inotify_fd_);
+  }
+  if(stop_fd_ >= 0){
+    close(stop_fd_);
+  }
+
+}
+
+void Watcher::AddWatch(const std::string& directory){
+
+  const std::uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM |
+      IN_DELETE | IN_CREATE;
+  int wd = inotify_add_watch(inotify_fd_, directory.c_str(), mask);
+  if(wd >= 0){
+    directories_[wd] = directory;
+  }
+
+}
+
+bool Watcher::Start(std::ostream& output){
+
+  inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  stop_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if(inotify_fd_ < 0 || stop_fd_ < 0){
+    perror("inotify");
+    return false;
+  }
+
+  WalkDirectory(root_,
+      [this, &output](const std::string& path){
+        if(HasExtension(path, ".sql")){
+          UpdateFile(path, output);
+        }
+      },
+      [this](const std::string& directory){
+        AddWatch(directory);
+      });
+
+  if(directories_.empty()){
+    std::cerr << "Cannot watch directory: " << root_ << "\n";
+    return false;
+  }
+
+  return true;
+}
+
+void Watcher::PrintFinding(std::ostream& output,
+                           const char* marker,
+                           const std::string& path,
+                           const FileFinding& file_finding) const {
+
+  ColorModifier green(ColorCode::FG_GREEN, state_.color_mode, true);
+  ColorModifier red(ColorCode::FG_RED, state_.color_mode, true);
+  ColorModifier regular(ColorCode::FG_DEFAULT, state_.color_mode, false);
+
+  auto& finding = file_finding.finding;
+  output << ((marker[0] == '+') ? green : red) << marker << regular
+         << " [" << path << ":" << file_finding.line_number << "]: "
+         << "(" << RiskLevelToString(finding.risk_level) << ") "
+         << finding.title << " [" << finding.rule_id << "]\n";
+
+}
+
+void Watcher::UpdateFile(const std::string& path, std::ostream& output){
+
+  last_checked_count_ = 0;
+
+  std::string text;
+  if(ReadFile(path, text) == false){
+    RemoveFile(path, output);
+    return;
+  }
+
+  File& file = files_[path];
+  std::unordered_map<std::uint64_t, std::vector<Finding>> statements;
+  std::vector<FileFinding> findings;
+  std::map<std::uint64_t, std::uint32_t> occurrences;
+
+  // Go over the statements in the file
+  std::uint32_t line_number = 1;
+  std::size_t begin = 0;
+  auto delimiter = state_.delimiter[0];
+  while(begin < text.length()){
+    auto end = text.find(delimiter, begin);
+    if(end == std::string::npos){
+      end = text.length();
+    }
+
+    // Leading whitespace only moves a statement
+    auto first = text.find_first_not_of(" \t\r\n", begin);
+    if(first == std::string::npos || first > end){
+      first = end;
+    }
+    line_number += std::count(text.begin() + begin, text.begin() + first, '\n');
+
+    auto statement_text = text.substr(first, end - first);
+    begin = end + 1;
+    if(statement_text.empty()){
+      continue;
+    }
+    auto hash = HashString(statement_text);
+
+    // Only check statements whose text changed
+    auto cached = statements.find(hash);
+    if(cached == statements.end()){
+      auto previous = file.statements.find(hash);
+      if(previous != file.statements.end()){
+        cached = statements.emplace(hash, std::move(previous->second)).first;
+      }
+      else {
+        state_.findings.clear();
+        state_.skipped_checks.clear();
+        state_.line_number = 1;
+        state_.statement_offset = 0;
+        CheckStatement(state_, statement_text + " ");
+        last_checked_count_++;
+
+        // Statements that were not checked would otherwise look clean
+        for(auto& skipped_check : state_.skipped_checks){
+          output << "! [" << path << ":" << line_number + skipped_check.line_number - 1
+                 << "]: Skipped (budget) :: " << skipped_check.rule_ids << " -- "
+                 << skipped_check.reason << "\n";
+        }
+        cached = statements.emplace(hash, std::move(state_.findings)).first;
+        state_.findings.clear();
+      }
+    }
+
+    auto occurrence = occurrences[hash]++;
+    for(auto& finding : cached->second){
+      FileFinding file_finding;
+      file_finding.key = finding.rule_id + ":" + std::to_string(hash) + ":" +
+          std::to_string(occurrence) + ":" + std::to_string(finding.line_number) +
+          ":" + std::to_string(finding.column) + ":" + finding.match;
+      file_finding.line_number = line_number + finding.line_number - 1;
+      file_finding.finding = finding;
+      findings.push_back(file_finding);
+    }
+
+    line_number += std::count(statement_text.begin(), statement_text.end(), '\n');
+  }
+
+  // Print the findings that disappeared and appeared
+  std::set<std::string> old_keys;
+  std::set<std::string> new_keys;
+  for(auto& file_finding : file.findings){
+    old_keys.insert(file_finding.key);
+  }
+  for(auto& file_finding : findings){
+    new_keys.insert(file_finding.key);
+  }
+  for(auto& file_finding : file.findings){
+    if(new_keys.count(file_finding.key) == 0){
+      PrintFinding(output, "-", path, file_finding);
+    }
+  }
+  for(auto& file_finding : findings){
+    if(old_keys.count(file_finding.key) == 0){
+      PrintFinding(output, "+", path, file_finding);
+    }
+  }
+  output << std::flush;
+
+  file.statements.swap(statements);
+  file.findings.swap(findings);
+
+}
+
+void Watcher::RemoveFile(const std::string& path, std::ostream& output){
+
+  auto entry = files_.find(path);
+  if(entry == files_.end()){
+    return;
+  }
+
+  for(auto& file_finding : entry->second.findings){
+    PrintFinding(output, "-", path, file_finding);
+  }
+  output << std::flush;
+  files_.erase(entry);
+
+}
+
+void Watcher::Run(std::ostream& output){
+
+  // Large enough for a burst of events
+  alignas(inotify_event) char buffer[64 * 1024];
+
+  while(true){
+    pollfd sources[2];
+    sources[0].fd = inotify_fd_;
+    sources[0].events = POLLIN;
+    sources[1].fd = stop_fd_;
+    sources[1].events = POLLIN;
+
+    if(poll(sources, 2, -1) < 0){
+      if(errno == EINTR){
+        continue;
+      }
+      perror("poll");
+      return;
+    }
+    if(sources[1].revents & POLLIN){
+      return;
+    }
+
+    // Collect the changed paths of a burst of events
+    std::set<std::string> changed;
+    std::set<std::string> removed;
+    while(true){
+      ssize_t length = read(inotify_fd_, buffer, sizeof(buffer));
+      if(length <= 0){
+        break;
+      }
+
+      for(char* pos = buffer; pos < buffer + length;){
+        auto event = reinterpret_cast<inotify_event*>(pos);
+        pos += sizeof(inotify_event) + event->len;
+
+        auto directory = directories_.find(event->wd);
+        if(directory == directories_.end() || event->len == 0){
+          continue;
+        }
+        auto path = directory->second + "/" + event->name;
+
+        if(event->mask & IN_ISDIR){
+          if(event->mask & (IN_CREATE | IN_MOVED_TO)){
+            WalkDirectory(path,
+                [&changed](const std::string& file_path){
+                  if(HasExtension(file_path, ".sql")){
+                    changed.insert(file_path);
+                  }
+                },
+                [this](const std::string& sub_directory){
+                  AddWatch(sub_directory);
+                });
+          }
+          continue;
+        }
+        if(HasExtension(path, ".sql") == false){
+          continue;
+        }
+        if(event->mask & (IN_DELETE | IN_MOVED_FROM)){
+          removed.insert(path);
+          changed.erase(path);
+        }
+        else if(event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)){
+          changed.insert(path);
+          removed.erase(path);
+        }
+      }
+    }
+
+    for(auto& path : removed){
+      RemoveFile(path, output);
+    }
+    for(auto& path : changed){
+      UpdateFile(path, output);
+    }
+  }
+
+}
+
+void Watcher::Stop(){
+  if(stop_fd_ >= 0){
+    std::uint64_t value = 1;
+    ssize_t written = write(stop_fd_, &value, sizeof(value));
+    (void) written;
+  }
+}
+
+// Watcher interrupted by signals
+Watcher* active_watcher = nullptr;
+
+void StopActiveWatcher(int){
+  if(active_watcher != nullptr){
+    active_watcher->Stop();
+  }
+}
+
+int Watch(const Configuration& state){
+
+  Watcher watcher(state, state.watch_path);
+  if(watcher.Start(std::cout) == false){
+    return EXIT_FAILURE;
+  }
+
+  active_watcher = &watcher;
+  signal(SIGINT, StopActiveWatcher);
+  signal(SIGTERM, StopActiveWatcher);
+
+  std::cout << "Watching " << state.watch_path << " for changes...\n" << std::flush;
+  watcher.Run(std::cout);
+
+  active_watcher = nullptr;
+  return EXIT_SUCCESS;
+}
+
+}  // namespace sqlcheck
@@ -0,0 +1,74 @@
+// WORKER POOL SOURCE
+
+#include <algorithm>
+#include <string>
+
+#include "include/worker_pool.h"
+
+#include "include/tracer.h"
+
+namespace sqlcheck {
+
+WorkerPool::WorkerPool(std::size_t num_workers)
+ : shutdown_(false) {
+
+  if(num_workers == 0){
+    num_workers = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  for(std::size_t worker_id = 0; worker_id < num_workers; worker_id++){
+    workers_.emplace_back(&WorkerPool::Run, this, worker_id);
+  }
+
+}
+
+WorkerPool::~WorkerPool(){
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shutdown_ = true;
+  }
+  condition_.notify_all();
+
+  for(auto& worker : workers_){
+    worker.join();
+  }
+
+}
+
+void WorkerPool::Submit(Task task){
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push_back(std::move(task));
+  }
+  condition_.notify_one();
+
+}
+
+void WorkerPool::Run(std::size_t worker_id){
+
+  SetTraceThreadName("worker " + std::to_string(worker_id));
+
+  while(true){
+    Task task;
+
+    {
+      // Time spent starved of tasks
+      TraceSpan span("wait", "pool");
+      std::unique_lock<std::mutex> lock(mutex_);
+      condition_.wait(lock, [this]{ return shutdown_ || tasks_.empty() == false; });
+      if(tasks_.empty()){
+        return;
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+
+    TraceSpan span("task", "pool");
+    task(worker_id);
+  }
+
+}
+
+}  // namespace sqlcheck
@@ -1,8 +1,44 @@
 // TEST SUITE
 
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <random>
+#include <set>
 #include <sstream>
+#include <thread>
 
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "baseline.h"
+#include "catalog.h"
 #include "checker.h"
+#include "diff.h"
+#include "differential.h"
+#include "extractor.h"
+#include "fingerprint.h"
+#include "generator.h"
+#include "index_advisor.h"
+#include "json.h"
+#include "jsonl_server.h"
+#include "list.h"
+#include "lsp_server.h"
+#include "nplus1.h"
+#include "prefilter.h"
+#include "profiler.h"
+#include "report_writer.h"
+#include "regex_audit.h"
+#include "run_stats.h"
+#include "sampler.h"
+#include "tokenizer.h"
+#include "tracer.h"
+#include "server.h"
+#include "watcher.h"
+#include "worker_pool.h"
 
 #include <gtest/gtest.h>
 
@@ -527,4 +563,1351 @@ TEST(TestSuite, SingleColumnTable) {
   Check(default_conf);
 }
 
+TEST(TestSuite, FingerprintTest) {
+
+  EXPECT_EQ(GetFingerprint("SELECT  *\n FROM Foo WHERE id = 42 AND name = 'it''s'"),
+            "select * from foo where id = ? and name = ?");
+  EXPECT_EQ(GetFingerprint("select * from foo where id in (1, 2,3) -- comment"),
+            "select * from foo where id in (?)");
+  EXPECT_EQ(GetFingerprint("select col1 /* hint */ from t2"),
+            "select col1 from t2");
+  EXPECT_EQ(HashString(GetFingerprint("SELECT * FROM foo WHERE id = 1")),
+            HashString(GetFingerprint("select * from foo where id = 2")));
+
+}
+
+TEST(TestSuite, SamplingTest) {
+
+  std::stringstream workload;
+  for(int i = 0; i < 2000; i++){
+    workload << "SELECT * FROM foo WHERE id = " << i << ";\n";
+  }
+
+  // Fixed rate
+  Configuration rate_conf;
+  rate_conf.sample_mode = SAMPLE_MODE_RATE;
+  rate_conf.sample_rate = 0.25;
+  rate_conf.sample_seed = 7;
+
+  Sampler rate_sampler(rate_conf);
+  std::string statement;
+  while(std::getline(workload, statement, ';')){
+    rate_sampler.CheckStatement(rate_conf, statement);
+  }
+
+  EXPECT_EQ(rate_sampler.GetSeenCount(), 2001);
+  EXPECT_LT(rate_sampler.GetCheckedCount(), 2001);
+  EXPECT_GT(rate_sampler.GetCheckedCount(), 0);
+  EXPECT_NEAR(rate_sampler.GetEstimate(RISK_LEVEL_HIGH), 2000,
+              rate_sampler.GetConfidenceInterval(RISK_LEVEL_HIGH) * 2);
+  EXPECT_EQ(rate_conf.line_number, 2001);
+
+  std::ostringstream summary;
+  rate_sampler.PrintSummary(rate_conf, summary);
+  EXPECT_NE(summary.str().find("Statements Seen              :: 2001\n"), std::string::npos);
+  EXPECT_NE(summary.str().find(">  High Risk   :: "), std::string::npos);
+
+  // Per-fingerprint reservoir
+  Configuration reservoir_conf;
+  reservoir_conf.sample_mode = SAMPLE_MODE_RESERVOIR;
+  reservoir_conf.sample_reservoir_size = 10;
+
+  Sampler reservoir_sampler(reservoir_conf);
+  workload.clear();
+  workload.seekg(0);
+  while(std::getline(workload, statement, ';')){
+    reservoir_sampler.CheckStatement(reservoir_conf, statement);
+  }
+
+  EXPECT_LT(reservoir_sampler.GetCheckedCount(), 200);
+  EXPECT_GE(reservoir_sampler.GetCheckedCount(), 10);
+
+}
+
+TEST(TestSuite, CheckTextTest) {
+
+  Configuration default_conf;
+  default_conf.collect_findings = true;
+
+  CheckText(default_conf,
+            "SELECT a FROM foo;\n"
+            "\n"
+            "SELECT *\n"
+            "FROM bar;\n");
+
+  ASSERT_EQ(default_conf.findings.size(), 1);
+  EXPECT_EQ(default_conf.findings[0].rule_id, "3001");
+  EXPECT_EQ(default_conf.findings[0].line_number, 3);
+  EXPECT_EQ(default_conf.findings[0].match, "select *");
+
+}
+
+TEST(TestSuite, FindingModelTest) {
+
+  Configuration default_conf;
+  default_conf.collect_findings = true;
+
+  // Every match gets a finding, placed with the newline index
+  CheckText(default_conf,
+            "SELECT a FROM t; SELECT * FROM u;\n"
+            "SELECT *\n"
+            "FROM a JOIN b ON a.x = b.x\n"
+            "  WHERE a.y IN (SELECT * FROM c);\n");
+
+  std::vector<Finding> select_star;
+  for(auto& finding : default_conf.findings){
+    if(finding.rule_id == "3001"){
+      select_star.push_back(finding);
+    }
+  }
+
+  ASSERT_EQ(select_star.size(), 3);
+  EXPECT_EQ(select_star[0].statement_id, 1);
+  EXPECT_EQ(select_star[0].line_number, 1);
+  EXPECT_EQ(select_star[0].column, 18);
+  EXPECT_EQ(select_star[0].begin, 17);
+  EXPECT_EQ(select_star[0].end, 25);
+
+  EXPECT_EQ(select_star[1].statement_id, 2);
+  EXPECT_EQ(select_star[1].line_number, 2);
+  EXPECT_EQ(select_star[1].column, 1);
+  EXPECT_EQ(select_star[1].begin, 34);
+
+  EXPECT_EQ(select_star[2].statement_id, 2);
+  EXPECT_EQ(select_star[2].line_number, 4);
+  EXPECT_EQ(select_star[2].column, 17);
+  EXPECT_EQ(select_star[2].begin, 86);
+  EXPECT_EQ(select_star[2].match, "select *");
+
+  // The checker stats count every rule once per statement
+  std::set<std::pair<std::string, std::uint64_t>> hits;
+  for(auto& finding : default_conf.findings){
+    hits.insert(std::make_pair(finding.rule_id, finding.statement_id));
+  }
+  EXPECT_EQ(default_conf.checker_stats[RISK_LEVEL_ALL], hits.size());
+
+  // Blank lines before a statement are not part of it
+  Configuration blank_conf;
+  blank_conf.collect_findings = true;
+  std::string spaghetti = "SELECT a FROM t WHERE " + std::string(600, 'b') + " = 1;";
+  CheckText(blank_conf, "SELECT a FROM t;\n\n  " + spaghetti);
+  std::vector<Finding> spaghetti_findings;
+  for(auto& finding : blank_conf.findings){
+    if(finding.rule_id == "3008"){
+      spaghetti_findings.push_back(finding);
+    }
+  }
+  ASSERT_EQ(spaghetti_findings.size(), 1);
+  EXPECT_EQ(spaghetti_findings[0].line_number, 3);
+  EXPECT_EQ(spaghetti_findings[0].column, 3);
+  EXPECT_EQ(spaghetti_findings[0].begin, 20);
+  EXPECT_EQ(spaghetti_findings[0].match, "s");
+
+}
+
+TEST(TestSuite, ServerTest) {
+
+  std::string socket_path = "/tmp/sqlcheck_test_" + std::to_string(getpid()) + ".sock";
+
+  Configuration default_conf;
+  default_conf.num_workers = 2;
+
+  Server server(default_conf, socket_path);
+  ASSERT_TRUE(server.Start());
+  std::thread loop([&server]{ server.Run(); });
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+  ASSERT_EQ(connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+
+  // Pipeline two requests after one that would overflow the regex stack
+  std::string hostile = "SELECT a FROM t JOIN " + std::string(80 * 1024, 'x') + ";";
+  std::string requests;
+  for(std::string sql : {hostile, std::string("SELECT * FROM foo;"),
+                         std::string("SELECT a FROM foo;")}){
+    std::uint32_t length = htonl(sql.length());
+    requests.append(reinterpret_cast<const char*>(&length), sizeof(length));
+    requests += sql;
+  }
+  ASSERT_EQ(write(fd, requests.data(), requests.length()), (ssize_t) requests.length());
+  shutdown(fd, SHUT_WR);
+
+  std::string responses;
+  char buffer[4096];
+  ssize_t bytes_read;
+  while((bytes_read = read(fd, buffer, sizeof(buffer))) > 0){
+    responses.append(buffer, bytes_read);
+  }
+  close(fd);
+
+  server.Stop();
+  loop.join();
+
+  // Responses come back in request order
+  std::vector<std::string> payloads;
+  std::size_t offset = 0;
+  while(responses.length() - offset >= 4){
+    std::uint32_t length;
+    memcpy(&length, responses.data() + offset, sizeof(length));
+    length = ntohl(length);
+    payloads.push_back(responses.substr(offset + 4, length));
+    offset += 4 + length;
+  }
+  ASSERT_EQ(payloads.size(), 3);
+  EXPECT_EQ(payloads[0], "{\"findings\":[],\"skipped\":[{\"rules\":\"all\","
+            "\"reason\":\"statement exceeds 16384 bytes\",\"line\":1,\"offset\":0}]}");
+  EXPECT_NE(payloads[1].find("\"rule\":\"3001\""), std::string::npos);
+  EXPECT_EQ(payloads[2], "{\"findings\":[]}");
+
+}
+
+TEST(TestSuite, JsonTest) {
+
+  JsonValue value;
+  std::string error;
+  ASSERT_TRUE(ParseJson("{\"id\": 7, \"sql\": \"a\\n\\u00e9\", \"list\": [true, null, -1.5]}",
+                        value, error));
+  EXPECT_EQ(value.GetNumber("id"), 7);
+  EXPECT_EQ(value.GetString("sql"), "a\n\xc3\xa9");
+  ASSERT_EQ(value.Find("list")->array.size(), 3);
+
+  std::ostringstream os;
+  WriteJson(os, value);
+  EXPECT_EQ(os.str(), "{\"id\":7,\"list\":[true,null,-1.5],\"sql\":\"a\\n\xc3\xa9\"}");
+
+  EXPECT_FALSE(ParseJson("{\"id\": }", value, error));
+  EXPECT_FALSE(ParseJson("[1, 2", value, error));
+
+}
+
+TEST(TestSuite, ReportWriterTest) {
+
+  const std::string sql_text = "SELECT * FROM foo;\nSELECT a FROM bar ORDER BY RAND();\n";
+
+  // Findings are written as they are found, not collected
+  auto write_report = [&sql_text](const OutputFormat output_format){
+    std::ostringstream output;
+    auto report_writer = CreateReportWriter(output_format, output);
+    Configuration default_conf;
+    default_conf.file_name = "a.sql";
+    default_conf.output_sinks = {OutputSink(output_format, "-")};
+    default_conf.report_writer = report_writer.get();
+    report_writer->Begin();
+    CheckText(default_conf, sql_text);
+    report_writer->End(default_conf);
+    EXPECT_TRUE(default_conf.findings.empty());
+    EXPECT_EQ(report_writer->GetFindingCount(), 2);
+    return output.str();
+  };
+
+  EXPECT_TRUE(CreateReportWriter(OUTPUT_FORMAT_TEXT, std::cout) == nullptr);
+
+  JsonValue json;
+  std::string error;
+  ASSERT_TRUE(ParseJson(write_report(OUTPUT_FORMAT_JSON), json, error)) << error;
+  auto& findings = json.Find("findings")->array;
+  ASSERT_EQ(findings.size(), 2);
+  EXPECT_EQ(findings[0].GetString("file"), "a.sql");
+  EXPECT_EQ(findings[1].GetNumber("statement"), 1);
+  EXPECT_EQ(json.Find("summary")->GetNumber("findings"), 2);
+
+  std::istringstream lines(write_report(OUTPUT_FORMAT_JSONL));
+  std::string line;
+  std::vector<std::string> rules;
+  while(std::getline(lines, line)){
+    ASSERT_TRUE(ParseJson(line, json, error)) << error;
+    rules.push_back(json.GetString("rule"));
+  }
+  EXPECT_EQ(rules, (std::vector<std::string>{"3001", "3006"}));
+
+  ASSERT_TRUE(ParseJson(write_report(OUTPUT_FORMAT_SARIF), json, error)) << error;
+  EXPECT_EQ(json.GetString("version"), "2.1.0");
+  auto& run = json.Find("runs")->array[0];
+  EXPECT_EQ(run.Find("tool")->Find("driver")->Find("rules")->array.size(), GetRules().size());
+  auto& results = run.Find("results")->array;
+  ASSERT_EQ(results.size(), 2);
+  EXPECT_EQ(results[0].GetString("ruleId"), "3001");
+  EXPECT_EQ(results[0].GetString("level"), "error");
+  auto& location = results[1].Find("locations")->array[0];
+  EXPECT_EQ(location.Find("physicalLocation")->Find("artifactLocation")->GetString("uri"), "a.sql");
+  EXPECT_EQ(location.Find("physicalLocation")->Find("region")->GetNumber("startLine"), 2);
+
+}
+
+TEST(TestSuite, MultiSinkTest) {
+
+  auto output_sinks = StringToOutputSinks("text:-,json:report.json,sarif");
+  ASSERT_EQ(output_sinks.size(), 3);
+  EXPECT_EQ(output_sinks[1].format, OUTPUT_FORMAT_JSON);
+  EXPECT_EQ(output_sinks[1].path, "report.json");
+  EXPECT_EQ(output_sinks[2].path, "-");
+  EXPECT_EQ(OutputSinksToString(output_sinks), "text:-,json:report.json,sarif:-");
+  EXPECT_EQ(StringToOutputSinks("xml:a.xml")[0].format, OUTPUT_FORMAT_INVALID);
+
+  // One check fans out to a file per format
+  std::string prefix = "/tmp/sqlcheck_report_" + std::to_string(getpid());
+  Configuration default_conf;
+  default_conf.output_sinks = {OutputSink(OUTPUT_FORMAT_JSON, prefix + ".json"),
+                               OutputSink(OUTPUT_FORMAT_JSONL, prefix + ".jsonl")};
+  auto report_writer = OpenReportSinks(default_conf.output_sinks, -1);
+  ASSERT_TRUE(report_writer != nullptr);
+  default_conf.report_writer = report_writer.get();
+  report_writer->Begin();
+  std::string sql_text;
+  for(int i = 0; i < 2000; i++){
+    sql_text += "SELECT * FROM foo;\n";
+  }
+  CheckText(default_conf, sql_text);
+  report_writer->End(default_conf);
+  EXPECT_EQ(report_writer->GetFindingCount(), 2000);
+
+  std::ifstream json_file(prefix + ".json");
+  std::string json_text((std::istreambuf_iterator<char>(json_file)),
+                        std::istreambuf_iterator<char>());
+  JsonValue json;
+  std::string error;
+  ASSERT_TRUE(ParseJson(json_text, json, error)) << error;
+  EXPECT_EQ(json.Find("findings")->array.size(), 2000);
+  EXPECT_EQ(json.Find("summary")->GetNumber("findings"), 2000);
+
+  std::ifstream lines(prefix + ".jsonl");
+  std::string line;
+  std::size_t line_count = 0;
+  while(std::getline(lines, line)){
+    line_count++;
+  }
+  EXPECT_EQ(line_count, 2000);
+
+  unlink((prefix + ".json").c_str());
+  unlink((prefix + ".jsonl").c_str());
+
+  std::vector<OutputSink> unwritable = {OutputSink(OUTPUT_FORMAT_JSON, "/nonexistent/report.json")};
+  EXPECT_THROW(OpenReportSinks(unwritable, -1), std::runtime_error);
+
+}
+
+TEST(TestSuite, JsonLinesServerTest) {
+
+  Configuration default_conf;
+  default_conf.num_workers = 2;
+
+  std::istringstream input(
+      "{\"id\": 1, \"sql\": \"SELECT a FROM foo;\\nSELECT * FROM bar;\"}\n"
+      "not json\n"
+      "{\"id\": \"two\", \"sql\": \"SELECT * FROM foo\", \"options\": {\"risk_level\": 4}}\n"
+  );
+  std::ostringstream output;
+
+  ServeJsonLines(default_conf, input, output);
+
+  // Responses may arrive in any order
+  std::istringstream responses(output.str());
+  std::string line;
+  std::map<std::string, JsonValue> by_id;
+  int errors = 0;
+  while(std::getline(responses, line)){
+    JsonValue response;
+    std::string error;
+    ASSERT_TRUE(ParseJson(line, response, error)) << line;
+    if(response.Find("error") != nullptr){
+      errors++;
+      continue;
+    }
+    std::ostringstream id;
+    WriteJson(id, *response.Find("id"));
+    by_id[id.str()] = response;
+  }
+
+  EXPECT_EQ(errors, 1);
+  ASSERT_EQ(by_id.count("1"), 1);
+  auto& findings = by_id["1"].Find("findings")->array;
+  ASSERT_EQ(findings.size(), 1);
+  EXPECT_EQ(findings[0].GetString("rule"), "3001");
+  EXPECT_EQ(findings[0].GetNumber("line"), 2);
+  EXPECT_EQ(findings[0].GetNumber("column"), 1);
+  EXPECT_EQ(findings[0].GetNumber("begin"), 19);
+  EXPECT_EQ(findings[0].GetNumber("end"), 27);
+  ASSERT_EQ(by_id.count("\"two\""), 1);
+
+  // Statements that would overflow the regex stack are skipped
+  std::string hostile = "SELECT DISTINCT " + std::string(80 * 1024, 'a') + ";";
+  std::istringstream hostile_input("{\"id\": 3, \"sql\": \"" + hostile + "\"}\n"
+                                   "{\"id\": 4, \"sql\": \"SELECT * FROM foo\"}\n");
+  std::ostringstream hostile_output;
+  ServeJsonLines(default_conf, hostile_input, hostile_output);
+  std::istringstream hostile_responses(hostile_output.str());
+  std::size_t skipped = 0, answered = 0;
+  while(std::getline(hostile_responses, line)){
+    JsonValue response;
+    std::string error;
+    ASSERT_TRUE(ParseJson(line, response, error)) << line;
+    answered++;
+    if(response.GetNumber("id") == 3){
+      ASSERT_NE(response.Find("skipped"), nullptr);
+      skipped += response.Find("skipped")->array.size();
+    }
+  }
+  EXPECT_EQ(answered, 2);
+  EXPECT_EQ(skipped, 1);
+
+}
+
+std::string LspPosition(const std::string& text, std::size_t offset){
+  auto line = std::count(text.begin(), text.begin() + offset, '\n');
+  auto line_start = text.rfind('\n', offset == 0 ? 0 : offset - 1);
+  auto character = (line_start == std::string::npos || offset == 0) ?
+      offset : offset - line_start - 1;
+  return "{\"line\":" + std::to_string(line) + ",\"character\":" + std::to_string(character) + "}";
+}
+
+JsonValue LspMessage(const std::string& content){
+  JsonValue message;
+  std::string error;
+  ParseJson(content, message, error);
+  return message;
+}
+
+TEST(TestSuite, LspServerTest) {
+
+  Configuration default_conf;
+  LspServer server(default_conf);
+
+  std::string text =
+      "SELECT a FROM foo;\n"
+      "SELECT * FROM bar;\n"
+      "SELECT b FROM baz;\n";
+
+  std::ostringstream output;
+  server.HandleMessage(LspMessage(
+      "{\"jsonrpc\":\"2.0\",\"method\":\"textDocument/didOpen\",\"params\":"
+      "{\"textDocument\":{\"uri\":\"file:///a.sql\",\"text\":\"" +
+      EscapeJsonString(text) + "\"}}}"), output);
+  EXPECT_NE(output.str().find("\"code\":\"3001\""), std::string::npos);
+  EXPECT_NE(output.str().find("\"start\":{\"line\":1,\"character\":0}"), std::string::npos);
+
+  // Editing the last statement only re-checks that statement
+  output.str("");
+  server.HandleMessage(LspMessage(
+      "{\"jsonrpc\":\"2.0\",\"method\":\"textDocument/didChange\",\"params\":"
+      "{\"textDocument\":{\"uri\":\"file:///a.sql\"},\"contentChanges\":"
+      "[{\"range\":{\"start\":{\"line\":2,\"character\":7},\"end\":{\"line\":2,\"character\":8}},"
+      "\"text\":\"*\"}]}}"), output);
+  EXPECT_EQ(server.GetLastCheckedCount(), 1);
+  EXPECT_NE(output.str().find("\"start\":{\"line\":2,\"character\":0}"), std::string::npos);
+  text.replace(text.find("SELECT b"), 8, "SELECT *");
+
+  // Requests without an id get an error instead of a response
+  output.str("");
+  server.HandleMessage(LspMessage(
+      "{\"jsonrpc\":\"2.0\",\"method\":\"initialize\",\"params\":{}}"), output);
+  EXPECT_NE(output.str().find("\"id\":null,\"error\":{\"code\":-32600"), std::string::npos);
+
+  // Edits with an incomplete range are ignored
+  output.str("");
+  server.HandleMessage(LspMessage(
+      "{\"jsonrpc\":\"2.0\",\"method\":\"textDocument/didChange\",\"params\":"
+      "{\"textDocument\":{\"uri\":\"file:///a.sql\"},\"contentChanges\":"
+      "[{\"range\":{\"start\":{\"line\":0,\"character\":0}},\"text\":\"x\"}]}}"), output);
+  EXPECT_EQ(server.GetLastCheckedCount(), 0);
+  EXPECT_NE(output.str().find("publishDiagnostics"), std::string::npos);
+
+  // Oversized statements are reported as not checked
+  std::ostringstream skipped;
+  server.HandleMessage(LspMessage(
+      "{\"jsonrpc\":\"2.0\",\"method\":\"textDocument/didOpen\",\"params\":"
+      "{\"textDocument\":{\"uri\":\"file:///b.sql\",\"text\":\"SELECT a FROM t;\\n"
+      "SELECT DISTINCT " + std::string(20 * 1024, 'a') + ";\"}}}"), skipped);
+  EXPECT_NE(skipped.str().find("{\"range\":{\"start\":{\"line\":1,\"character\":0}"),
+            std::string::npos);
+  EXPECT_NE(skipped.str().find("\"message\":\"not checked: statement exceeds 16384 bytes\""),
+            std::string::npos);
+
+  // Incremental results match a full re-check after random edits
+  std::mt19937 generator(42);
+  const char* fragments[] = {";", "\n", "SELECT * ", "id int", " ", "x", "CREATE TABLE t ("};
+  for(int i = 0; i < 200; i++){
+    auto start = generator() % (text.length() + 1);
+    auto end = std::min(text.length(), start + generator() % 8);
+    std::string replacement = fragments[generator() % 7];
+
+    output.str("");
+    server.HandleMessage(LspMessage(
+        "{\"jsonrpc\":\"2.0\",\"method\":\"textDocument/didChange\",\"params\":"
+        "{\"textDocument\":{\"uri\":\"file:///a.sql\"},\"contentChanges\":"
+        "[{\"range\":{\"start\":" + LspPosition(text, start) + ",\"end\":" +
+        LspPosition(text, end) + "},\"text\":\"" + EscapeJsonString(replacement) + "\"}]}}"),
+        output);
+    text.replace(start, end - start, replacement);
+
+    LspServer reference(default_conf);
+    std::ostringstream expected;
+    reference.HandleMessage(LspMessage(
+        "{\"jsonrpc\":\"2.0\",\"method\":\"textDocument/didOpen\",\"params\":"
+        "{\"textDocument\":{\"uri\":\"file:///a.sql\",\"text\":\"" +
+        EscapeJsonString(text) + "\"}}}"), expected);
+    ASSERT_EQ(output.str(), expected.str()) << "edit " << i;
+  }
+
+}
+
+TEST(TestSuite, WatcherTest) {
+
+  char directory[] = "/tmp/sqlcheck_watch_XXXXXX";
+  ASSERT_NE(mkdtemp(directory), nullptr);
+  std::string path = std::string(directory) + "/query.sql";
+
+  Configuration default_conf;
+  default_conf.color_mode = false;
+
+  std::ofstream(path) << "SELECT a FROM foo;\nSELECT * FROM bar;\n";
+
+  std::ostringstream initial;
+  Watcher watcher(default_conf, directory);
+  ASSERT_TRUE(watcher.Start(initial));
+  EXPECT_NE(initial.str().find("+ [" + path + ":2]"), std::string::npos);
+
+  // Only the edited statement is checked again
+  std::ofstream(path) << "SELECT a FROM foo;\nSELECT b FROM bar;\n";
+  std::ostringstream update;
+  watcher.UpdateFile(path, update);
+  EXPECT_EQ(watcher.GetLastCheckedCount(), 1);
+  EXPECT_NE(update.str().find("- [" + path + ":2]"), std::string::npos);
+  EXPECT_EQ(update.str().find("+ ["), std::string::npos);
+
+  // Moved statements are not checked again
+  std::ofstream(path) << "\n\nSELECT a FROM foo;\nSELECT b FROM bar;\n";
+  std::ostringstream moved;
+  watcher.UpdateFile(path, moved);
+  EXPECT_EQ(watcher.GetLastCheckedCount(), 0);
+
+  // Oversized statements are reported as skipped
+  std::ofstream(path) << "SELECT a FROM foo;\nSELECT DISTINCT " << std::string(20 * 1024, 'a') << ";\n";
+  std::ostringstream skipped;
+  watcher.UpdateFile(path, skipped);
+  EXPECT_NE(skipped.str().find("! [" + path + ":2]: Skipped (budget) :: all -- "
+                               "statement exceeds 16384 bytes"), std::string::npos);
+
+  // Changes picked up through inotify
+  std::ostringstream events;
+  std::thread loop([&watcher, &events]{ watcher.Run(events); });
+  std::ofstream(path) << "SELECT * FROM bar;\n";
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  unlink(path.c_str());
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  watcher.Stop();
+  loop.join();
+  EXPECT_NE(events.str().find("+ [" + path + ":1]"), std::string::npos);
+  EXPECT_NE(events.str().find("- [" + path + ":1]"), std::string::npos);
+
+  rmdir(directory);
+
+}
+
+TEST(TestSuite, CatalogTest) {
+
+  std::vector<Token> tokens;
+  Tokenize("SELECT \"Name\" FROM t -- comment\nWHERE a <> 'it''s';", tokens);
+  ASSERT_EQ(tokens.size(), 9);
+  EXPECT_EQ(tokens[1].type, TOKEN_TYPE_IDENTIFIER);
+  EXPECT_EQ(tokens[1].text, "Name");
+  EXPECT_TRUE(tokens[6].Is("<>"));
+  EXPECT_EQ(tokens[7].text, "it's");
+
+  Catalog catalog;
+  EXPECT_FALSE(catalog.AddStatement("SELECT * FROM users;"));
+  EXPECT_TRUE(catalog.AddStatement(
+      "-- users\n"
+      "CREATE TABLE IF NOT EXISTS app.Users ("
+      "  id BIGINT NOT NULL,"
+      "  name VARCHAR(100),"
+      "  parent_id BIGINT REFERENCES users(id),"
+      "  PRIMARY KEY (id),"
+      "  KEY users_name (name, id));"));
+  EXPECT_TRUE(catalog.AddStatement("CREATE UNIQUE INDEX users_parent ON users (parent_id DESC);"));
+  EXPECT_TRUE(catalog.AddStatement("ALTER TABLE users ADD COLUMN email TEXT, DROP COLUMN name;"));
+  EXPECT_TRUE(catalog.AddStatement("CREATE TABLE dropped (a INT);"));
+  EXPECT_TRUE(catalog.AddStatement("DROP TABLE dropped;"));
+  EXPECT_TRUE(catalog.AddStatement("DROP INDEX users_name;"));
+
+  auto table = catalog.FindTable("USERS");
+  ASSERT_NE(table, nullptr);
+  EXPECT_EQ(catalog.GetCurrentTable(), nullptr);
+  EXPECT_EQ(catalog.FindTable("dropped"), nullptr);
+  EXPECT_EQ(catalog.FindColumn(*table, "name"), nullptr);
+  ASSERT_NE(catalog.FindColumn(*table, "id"), nullptr);
+  EXPECT_TRUE(catalog.FindColumn(*table, "id")->not_null);
+  EXPECT_EQ(catalog.GetString(catalog.FindColumn(*table, "email")->type), "text");
+  EXPECT_EQ(table->primary_key.size(), 1);
+  ASSERT_EQ(table->foreign_keys.size(), 1);
+  EXPECT_EQ(table->foreign_keys[0].referenced_table, table->name);
+  ASSERT_EQ(table->indexes.size(), 2);
+  EXPECT_TRUE(table->indexes[1].unique);
+  EXPECT_EQ(catalog.GetString(table->indexes[1].columns[0]), "parent_id");
+
+  // Snapshot round trip
+  std::string file_name = "/tmp/sqlcheck_catalog_" + std::to_string(getpid());
+  ASSERT_TRUE(catalog.Save(file_name));
+  Catalog loaded;
+  ASSERT_TRUE(loaded.Load(file_name));
+  table = loaded.FindTable("users");
+  ASSERT_NE(table, nullptr);
+  EXPECT_EQ(table->columns.size(), 3);
+  EXPECT_EQ(table->indexes.size(), 2);
+  EXPECT_NE(loaded.FindColumn(*table, "email"), nullptr);
+
+  // Truncated snapshots are rejected
+  std::ifstream input(file_name, std::ios::binary);
+  std::string snapshot((std::istreambuf_iterator<char>(input)),
+                       std::istreambuf_iterator<char>());
+  std::ofstream(file_name, std::ios::binary) << snapshot.substr(0, snapshot.size() - 3);
+  EXPECT_FALSE(loaded.Load(file_name));
+  EXPECT_NE(loaded.FindTable("users"), nullptr);
+  unlink(file_name.c_str());
+
+  // Texts keep the schema of earlier texts only when something reads it
+  Configuration default_conf;
+  default_conf.collect_findings = true;
+  CheckText(default_conf, "CREATE TABLE t (a INT PRIMARY KEY);");
+  CheckText(default_conf, "CREATE TABLE u (a INT PRIMARY KEY);");
+  ASSERT_EQ(default_conf.catalog.GetTables().size(), 1);
+  EXPECT_EQ(default_conf.catalog.FindTable("t"), nullptr);
+  default_conf.index_advice = true;
+  CheckText(default_conf, "CREATE TABLE v (a INT PRIMARY KEY);");
+  EXPECT_EQ(default_conf.catalog.GetTables().size(), 2);
+
+}
+
+TEST(TestSuite, BaselineTest) {
+
+  // Record the findings of the first run
+  std::string file_name = "/tmp/sqlcheck_baseline_" + std::to_string(getpid());
+  Configuration default_conf;
+  default_conf.collect_findings = true;
+  default_conf.baseline = std::make_shared<Baseline>(true);
+  CheckText(default_conf, "SELECT * FROM foo WHERE id = 1;\n"
+                          "SELECT a FROM bar ORDER BY RAND();\n");
+  ASSERT_TRUE(default_conf.baseline->Save(file_name));
+
+  // Known findings are suppressed even if their literals change
+  Configuration next_conf;
+  next_conf.collect_findings = true;
+  next_conf.baseline = std::make_shared<Baseline>(false);
+  ASSERT_TRUE(next_conf.baseline->Load(file_name));
+  EXPECT_GE(next_conf.baseline->GetEntryCount(), 2);
+  CheckText(next_conf, "SELECT * FROM foo WHERE id = 42;\n"
+                       "SELECT * FROM baz;\n");
+  ASSERT_FALSE(next_conf.findings.empty());
+  for(auto& finding : next_conf.findings){
+    EXPECT_EQ(finding.statement_id, 1);
+  }
+  EXPECT_EQ(next_conf.findings[0].rule_id, "3001");
+  EXPECT_GE(next_conf.baseline->GetKnownCount(), 1);
+
+  // The findings of the removed statement are fixed
+  auto fixed_counts = next_conf.baseline->GetFixedCounts();
+  EXPECT_EQ(fixed_counts[3006], 1);
+  EXPECT_EQ(fixed_counts.count(3001), 0);
+
+  // Truncated baselines are rejected
+  std::ifstream input(file_name, std::ios::binary);
+  std::string data((std::istreambuf_iterator<char>(input)),
+                   std::istreambuf_iterator<char>());
+  std::ofstream(file_name, std::ios::binary) << data.substr(0, data.size() - 3);
+  Baseline truncated(false);
+  EXPECT_FALSE(truncated.Load(file_name));
+  unlink(file_name.c_str());
+
+}
+
+TEST(TestSuite, IndexAdvisorTest) {
+
+  Catalog catalog;
+  catalog.AddStatement("CREATE TABLE accounts (id INT PRIMARY KEY, first_name TEXT, "
+                       "last_name TEXT, city TEXT, created DATE);");
+  catalog.AddStatement("CREATE INDEX telephone_book ON accounts (last_name, first_name);");
+  catalog.AddStatement("CREATE INDEX account_city ON accounts (city);");
+  catalog.AddStatement("CREATE INDEX account_created ON accounts (created);");
+
+  IndexAdvisor advisor;
+  for(int i = 0; i < 10; i++){
+    advisor.AddQuery("SELECT first_name FROM accounts WHERE last_name = '" +
+                     std::to_string(i) + "' AND first_name LIKE 'a%';");
+  }
+  for(int i = 0; i < 3; i++){
+    advisor.AddQuery("SELECT * FROM Accounts a WHERE a.first_name = 'x' ORDER BY a.id;");
+  }
+  advisor.AddQuery("SELECT id FROM accounts WHERE created > '2020-01-01' ORDER BY created;");
+  advisor.AddQuery("SELECT * FROM accounts ORDER BY last_name, city;");
+  advisor.AddQuery("CREATE TABLE ignored (a INT);");
+
+  IndexAdvice advice;
+  advisor.Analyze(catalog, advice);
+  EXPECT_EQ(advice.query_count, 15);
+  EXPECT_EQ(advice.fingerprint_count, 4);
+
+  // Ranked by frequency
+  ASSERT_EQ(advice.unserved_predicates.size(), 2);
+  EXPECT_EQ(advice.unserved_predicates[0].count, 3);
+  EXPECT_EQ(advice.unserved_predicates[0].clause, "where");
+  EXPECT_EQ(advice.unserved_predicates[0].columns, std::vector<std::string>{"first_name"});
+  EXPECT_EQ(advice.unserved_predicates[0].misordered_index, "telephone_book");
+  EXPECT_EQ(advice.unserved_predicates[1].clause, "order by");
+  EXPECT_EQ(advice.unserved_predicates[1].count, 1);
+
+  ASSERT_EQ(advice.indexes.size(), 4);
+  EXPECT_EQ(advice.indexes[0].index, "telephone_book");
+  EXPECT_EQ(advice.indexes[0].count, 10);
+  EXPECT_EQ(advice.indexes[0].covering_count, 10);
+  EXPECT_EQ(advice.indexes[1].index, "");
+  EXPECT_EQ(advice.indexes[1].count, 3);
+  EXPECT_EQ(advice.indexes[2].index, "account_created");
+  EXPECT_EQ(advice.indexes[3].index, "account_city");
+  EXPECT_EQ(advice.indexes[3].count, 0);
+
+  std::ostringstream output;
+  PrintIndexAdvice(advice, output);
+  EXPECT_NE(output.str().find("account_city ON accounts (city)"), std::string::npos);
+
+}
+
+TEST(TestSuite, NPlusOneTest) {
+
+  LogEntry entry;
+  ASSERT_TRUE(ParseLogLine("2023-11-14 22:13:20.500 UTC [4242] LOG:  statement: SELECT 1", entry));
+  EXPECT_DOUBLE_EQ(entry.timestamp, 1700000000.5);
+  EXPECT_EQ(entry.session, "4242");
+  EXPECT_EQ(entry.sql, "SELECT 1");
+  ASSERT_TRUE(ParseLogLine("2023-11-14T22:13:20.000000Z\t   12 Query\tSELECT 2", entry));
+  EXPECT_EQ(entry.session, "12");
+  EXPECT_EQ(entry.sql, "SELECT 2");
+  ASSERT_TRUE(ParseLogLine("1700000000123 session=abc SELECT 3", entry));
+  EXPECT_DOUBLE_EQ(entry.timestamp, 1700000000.123);
+  EXPECT_EQ(entry.session, "abc");
+  EXPECT_FALSE(ParseLogLine("  WHERE id = 3", entry));
+
+  EXPECT_EQ(GetBatchedQuery("select * from items where id = ?"),
+            "select * from items where id in (?, ?, ...)");
+  EXPECT_EQ(GetBatchedQuery("select * from t where a = ? and b = ?"), "");
+
+  // Bursts per session, with varying literals only
+  NPlusOneDetector detector(1.0, 5, 2);
+  std::vector<NPlusOneBurst> bursts;
+  for(int i = 0; i < 20; i++){
+    LogEntry query = {100.0 + i * 0.01, "a", "SELECT * FROM items WHERE id = " +
+                      std::to_string(i), static_cast<std::uint64_t>(i + 1)};
+    detector.AddStatement(query, bursts);
+    LogEntry repeated = {100.0 + i * 0.01, "b", "SELECT * FROM items WHERE id = 1", 0};
+    detector.AddStatement(repeated, bursts);
+  }
+  EXPECT_TRUE(bursts.empty());
+  EXPECT_EQ(detector.GetWindowCount(), 2);
+
+  // Windows expire after a quiet period
+  LogEntry later = {110.0, "a", "SELECT * FROM users WHERE id = 1", 100};
+  detector.AddStatement(later, bursts);
+  ASSERT_EQ(bursts.size(), 1);
+  EXPECT_EQ(bursts[0].session, "a");
+  EXPECT_EQ(bursts[0].count, 20);
+  EXPECT_EQ(bursts[0].distinct_count, 20);
+  EXPECT_EQ(bursts[0].line_number, 1);
+  EXPECT_EQ(detector.GetWindowCount(), 1);
+
+  // A steady poll slower than the threshold rate is not a burst
+  NPlusOneDetector poll_detector(1.0, 10);
+  std::vector<NPlusOneBurst> poll_bursts;
+  for(int i = 0; i < 300; i++){
+    LogEntry poll = {200.0 + i * 0.9, "c", "SELECT * FROM jobs WHERE id = " +
+                     std::to_string(i), 0};
+    poll_detector.AddStatement(poll, poll_bursts);
+  }
+  poll_detector.Flush(poll_bursts);
+  EXPECT_TRUE(poll_bursts.empty());
+
+  // The number of open windows is bounded
+  for(int i = 0; i < 10; i++){
+    LogEntry other = {110.0, std::to_string(i), "SELECT 1", 0};
+    detector.AddStatement(other, bursts);
+  }
+  EXPECT_EQ(detector.GetWindowCount(), 2);
+
+  // End to end over a log
+  Configuration default_conf;
+  default_conf.color_mode = false;
+  default_conf.nplus1_threshold = 3;
+  std::istringstream log(
+      "2023-11-14 22:13:20.000 UTC [1] LOG:  statement: SELECT * FROM items\n"
+      "\tWHERE id = 1\n"
+      "2023-11-14 22:13:20.010 UTC [1] LOG:  statement: SELECT * FROM items WHERE id = 2\n"
+      "2023-11-14 22:13:20.020 UTC [1] LOG:  statement: SELECT * FROM items WHERE id = 3\n");
+  std::ostringstream output;
+  EXPECT_EQ(DetectNPlusOne(default_conf, log, output), EXIT_FAILURE);
+  EXPECT_NE(output.str().find("3 queries in 0.020 s"), std::string::npos);
+  EXPECT_NE(output.str().find("where id in (?, ?, ...)"), std::string::npos);
+
+}
+
+TEST(TestSuite, ExtractorTest) {
+
+  EXPECT_TRUE(LooksLikeSql("SELECT a FROM t"));
+  EXPECT_TRUE(LooksLikeSql("create index i on t (a)"));
+  EXPECT_FALSE(LooksLikeSql("Select the file from disk"));
+  EXPECT_FALSE(LooksLikeSql("select an option"));
+  EXPECT_FALSE(LooksLikeSql("update me later"));
+
+  // Concatenated Java literals with a value in between
+  std::string java =
+      "class A {\n"
+      "  // \"SELECT * FROM comment\"\n"
+      "  char c = '\"';\n"
+      "  String q = \"SELECT * FROM users \" +\n"
+      "             \"WHERE id = \" + user.getId() + \" ORDER BY name\";\n"
+      "}\n";
+  std::vector<ExtractedStatement> statements;
+  ExtractSql(java.data(), java.length(), SOURCE_LANGUAGE_JAVA, statements);
+  ASSERT_EQ(statements.size(), 1);
+  EXPECT_EQ(statements[0].sql, "SELECT * FROM users WHERE id = ? ORDER BY name");
+  EXPECT_EQ(statements[0].GetLineNumber(0), 4);
+  EXPECT_EQ(statements[0].GetLineNumber(statements[0].sql.find("ORDER")), 5);
+
+  // Adjacent, triple-quoted and format strings in Python
+  std::string python =
+      "q = (\"SELECT a \"\n"
+      "     'FROM t')\n"
+      "s = f\"\"\"\n"
+      "DELETE FROM t\n"
+      "WHERE id = {obj.id}\"\"\"\n";
+  statements.clear();
+  ExtractSql(python.data(), python.length(), SOURCE_LANGUAGE_PYTHON, statements);
+  ASSERT_EQ(statements.size(), 2);
+  EXPECT_EQ(statements[0].sql, "SELECT a FROM t");
+  EXPECT_EQ(statements[1].sql, "\nDELETE FROM t\nWHERE id = ?");
+  EXPECT_EQ(statements[1].GetLineNumber(statements[1].sql.find("WHERE")), 5);
+
+  // Raw strings in C++ and Go
+  std::string cpp = "int x = 1'000;\nauto q = R\"sql(SELECT *\nFROM t)sql\";\n";
+  statements.clear();
+  ExtractSql(cpp.data(), cpp.length(), SOURCE_LANGUAGE_CPP, statements);
+  ASSERT_EQ(statements.size(), 1);
+  EXPECT_EQ(statements[0].sql, "SELECT *\nFROM t");
+  std::string go = "q := `SELECT a\nFROM t` + \" WHERE b = 1\"\n";
+  statements.clear();
+  ExtractSql(go.data(), go.length(), SOURCE_LANGUAGE_GO, statements);
+  ASSERT_EQ(statements.size(), 1);
+  EXPECT_EQ(statements[0].sql, "SELECT a\nFROM t WHERE b = 1");
+
+  // Findings are mapped back to file:line
+  char directory[] = "/tmp/sqlcheck_source_XXXXXX";
+  ASSERT_NE(mkdtemp(directory), nullptr);
+  std::string path = std::string(directory) + "/Dao.java";
+  std::ofstream(path) << java;
+  std::string ignored = std::string(directory) + "/notes.txt";
+  std::ofstream(ignored) << "SELECT * FROM t";
+
+  Configuration default_conf;
+  default_conf.color_mode = false;
+  default_conf.num_workers = 2;
+  std::ostringstream output;
+  EXPECT_TRUE(CheckSourceTree(default_conf, directory, output));
+  EXPECT_NE(output.str().find("[" + path + ":4]: (HIGH RISK)"), std::string::npos);
+  EXPECT_NE(output.str().find("Source Files                 :: 1"), std::string::npos);
+
+  unlink(path.c_str());
+  unlink(ignored.c_str());
+  rmdir(directory);
+
+}
+
+TEST(TestSuite, DiffTest) {
+
+  // A removed "-- comment" line must not look like a file header
+  std::string diff_text =
+      "diff --git a/db/missing.sql b/db/missing.sql\n"
+      "--- a/db/missing.sql\n"
+      "+++ b/db/missing.sql\n"
+      "@@ -10,7 +10,7 @@\n"
+      " SELECT id FROM t WHERE id = 1;\n"
+      "--- old comment\n"
+      "+-- new comment\n"
+      " SELECT id FROM t WHERE id = 2;\n"
+      " \n"
+      " SELECT name\n"
+      "   FROM t;\n"
+      "+SELECT * FROM t;\n"
+      "--- a/gone.sql\n"
+      "+++ /dev/null\n"
+      "@@ -1 +0,0 @@\n"
+      "-SELECT 1;\n";
+  std::istringstream diff(diff_text);
+  std::vector<FileDiff> files;
+  ASSERT_TRUE(ParseUnifiedDiff(diff, files));
+  ASSERT_EQ(files.size(), 1);
+  EXPECT_EQ(files[0].path, "db/missing.sql");
+  ASSERT_EQ(files[0].hunks.size(), 1);
+  EXPECT_EQ(files[0].hunks[0].new_lines.size(), 7);
+  EXPECT_EQ(files[0].changed_lines, std::vector<std::uint32_t>({11, 16}));
+
+  // Only the statements that overlap changed lines
+  std::string text = "SELECT 1;\n-- note\nSELECT 2\n  FROM t;\nSELECT 3;\n";
+  std::vector<ChangedStatement> statements;
+  GetChangedStatements(text, 1, ';', {3}, statements);
+  ASSERT_EQ(statements.size(), 1);
+  EXPECT_EQ(text.substr(statements[0].begin, statements[0].end - statements[0].begin),
+            "\n-- note\nSELECT 2\n  FROM t");
+  EXPECT_EQ(statements[0].line_number, 1);
+  statements.clear();
+  GetChangedStatements(text, 1, ';', {4, 5}, statements);
+  EXPECT_EQ(statements.size(), 2);
+
+  // The file is not on disk, so the hunk is checked with its line numbers
+  Configuration default_conf;
+  default_conf.color_mode = false;
+  default_conf.collect_findings = true;
+  diff.clear();
+  diff.str(diff_text);
+  testing::internal::CaptureStdout();
+  bool has_issues = CheckDiff(default_conf, diff);
+  std::string output = testing::internal::GetCapturedStdout();
+  EXPECT_TRUE(has_issues);
+  EXPECT_NE(output.find("Changed Statements           :: 2"), std::string::npos);
+  ASSERT_EQ(default_conf.findings.size(), 1);
+  EXPECT_EQ(default_conf.findings[0].title, "SELECT *");
+  EXPECT_EQ(default_conf.findings[0].line_number, 16);
+
+}
+
+TEST(TestSuite, CorpusGeneratorTest) {
+
+  CorpusOptions options;
+  options.seed = 42;
+  options.density = 0.5;
+  options.bulk_rows = 5;
+
+  // Same seed, same corpus
+  std::ostringstream first, second, annotations;
+  EXPECT_EQ(WriteCorpus(options, 64 << 10, 0, first, &annotations),
+            WriteCorpus(options, 64 << 10, 0, second, nullptr));
+  EXPECT_EQ(first.str(), second.str());
+  EXPECT_GE(first.str().size(), 64 << 10);
+  EXPECT_NE(annotations.str().find("\"kind\":\"analytic\",\"rules\":[\"3005\",\"3008\"]"),
+            std::string::npos);
+
+  options.seed = 43;
+  std::ostringstream third;
+  WriteCorpus(options, 64 << 10, 0, third, nullptr);
+  EXPECT_NE(first.str(), third.str());
+
+  // Annotations and findings number the statements the same way
+  std::map<std::uint64_t, std::set<std::string>> annotated_rules;
+  std::istringstream annotation_lines(annotations.str());
+  std::string annotation_line;
+  while(std::getline(annotation_lines, annotation_line)){
+    JsonValue annotation;
+    std::string error;
+    ASSERT_TRUE(ParseJson(annotation_line, annotation, error)) << error;
+    auto& rules = annotated_rules[annotation.GetNumber("statement")];
+    for(auto& rule : annotation.Find("rules")->array){
+      rules.insert(rule.string);
+    }
+  }
+  Configuration corpus_conf;
+  corpus_conf.collect_findings = true;
+  CheckText(corpus_conf, first.str());
+  ASSERT_FALSE(corpus_conf.findings.empty());
+  std::size_t joined = 0;
+  for(auto& finding : corpus_conf.findings){
+    joined += annotated_rules[finding.statement_id].count(finding.rule_id);
+  }
+  EXPECT_EQ(joined, corpus_conf.findings.size());
+
+  // The annotations match the rules that flag every statement
+  options.weights[STATEMENT_KIND_DDL] = 30;
+  options.weights[STATEMENT_KIND_OLTP] = 30;
+  options.weights[STATEMENT_KIND_PATHOLOGICAL] = 20;
+  Configuration default_conf;
+  default_conf.collect_findings = true;
+  CorpusGenerator generator(options);
+  CorpusStatement statement;
+  for(int i = 0; i < 800; i++){
+    generator.Next(statement);
+    CheckText(default_conf, "\n" + statement.sql);
+
+    std::vector<std::string> rules;
+    for(auto& finding : default_conf.findings){
+      rules.push_back(finding.rule_id);
+    }
+    std::sort(rules.begin(), rules.end());
+    rules.erase(std::unique(rules.begin(), rules.end()), rules.end());
+    EXPECT_EQ(rules, statement.rules) << statement.sql.substr(0, 400);
+  }
+
+}
+
+TEST(TestSuite, ProfileTest) {
+
+  Configuration default_conf;
+  default_conf.collect_findings = true;
+  default_conf.profile = true;
+  CheckText(default_conf, "SELECT * FROM t;\nSELECT * FROM u WHERE a = 1;");
+
+  // Rules are counted per statement, regexes per evaluation
+  auto& rules = GetRules();
+  auto rule = std::find_if(rules.begin(), rules.end(), [](const Rule& entry){
+    return std::string(entry.id) == "3001";
+  });
+  ASSERT_NE(rule, rules.end());
+  auto& counter = default_conf.profile_stats.GetRule(rule - rules.begin());
+  EXPECT_EQ(counter.invocations, 2);
+  EXPECT_EQ(counter.regex_evaluations, 2);
+  EXPECT_EQ(counter.matches, 2);
+  EXPECT_GT(counter.bytes_scanned, 0);
+  EXPECT_EQ(default_conf.profile_stats.stages[PROFILE_STAGE_NORMALIZER].invocations, 2);
+
+  // Per-thread profiles are merged
+  Profile merged;
+  merged.Merge(default_conf.profile_stats);
+  merged.Merge(default_conf.profile_stats);
+  EXPECT_EQ(merged.GetRule(rule - rules.begin()).matches, 4);
+
+  std::ostringstream json;
+  WriteProfileJson(merged, json);
+  JsonValue value;
+  std::string error;
+  ASSERT_TRUE(ParseJson(json.str(), value, error)) << error;
+  ASSERT_NE(value.Find("entries"), nullptr);
+  EXPECT_EQ(value.Find("entries")->array.size(), PROFILE_STAGE_COUNT + rules.size());
+  EXPECT_NE(json.str().find("\"name\":\"SelectStar\""), std::string::npos);
+
+  std::ostringstream table;
+  PrintProfile(merged, table);
+  EXPECT_NE(table.str().find("3001 SelectStar"), std::string::npos);
+
+}
+
+TEST(TestSuite, TraceTest) {
+
+  Configuration default_conf;
+  default_conf.collect_findings = true;
+
+  // Nothing is recorded while tracing is off
+  CheckText(default_conf, "SELECT * FROM t;");
+  std::ostringstream empty_trace;
+  WriteTrace(empty_trace);
+  EXPECT_EQ(empty_trace.str().find("\"ph\":\"X\""), std::string::npos);
+
+  StartTracing();
+  SetTraceThreadName("test");
+  CheckText(default_conf, "SELECT * FROM t;");
+  {
+    WorkerPool pool(2);
+    pool.Submit([](std::size_t){
+      TraceSpan span("work", "test");
+    });
+  }
+
+  std::ostringstream trace;
+  WriteTrace(trace);
+  StopTracing();
+
+  JsonValue value;
+  std::string error;
+  ASSERT_TRUE(ParseJson(trace.str(), value, error)) << error;
+  auto events = value.Find("traceEvents");
+  ASSERT_NE(events, nullptr);
+
+  std::map<std::string, std::string> thread_names;
+  std::set<std::string> spans;
+  for(auto& event : events->array){
+    auto tid = std::to_string(static_cast<int>(event.GetNumber("tid")));
+    if(event.GetString("ph") == "M"){
+      thread_names[tid] = event.Find("args")->GetString("name");
+      continue;
+    }
+    EXPECT_EQ(event.GetString("ph"), "X");
+    EXPECT_GE(event.GetNumber("dur"), 0);
+    spans.insert(thread_names[tid] + "/" + event.GetString("cat") + "/" +
+                 event.GetString("name"));
+  }
+
+  EXPECT_EQ(spans.count("test/rule/SelectStar"), 1);
+  EXPECT_EQ(spans.count("test/checker/normalize"), 1);
+  bool worker_span = (spans.count("worker 0/test/work") +
+                      spans.count("worker 1/test/work")) == 1;
+  EXPECT_TRUE(worker_span);
+  EXPECT_TRUE(spans.count("worker 0/pool/wait") || spans.count("worker 1/pool/wait"));
+
+}
+
+TEST(TestSuite, RunStatsTest) {
+
+  // Percentiles stay within the bucket precision
+  LatencyHistogram histogram;
+  for(std::uint64_t value = 1; value <= 10000; value++){
+    histogram.Record(value);
+  }
+  EXPECT_EQ(histogram.GetCount(), 10000);
+  EXPECT_EQ(histogram.GetMax(), 10000);
+  EXPECT_NEAR(histogram.GetPercentile(0.50), 5000, 5000 * 0.03);
+  EXPECT_NEAR(histogram.GetPercentile(0.99), 9900, 9900 * 0.03);
+  EXPECT_EQ(histogram.GetPercentile(1.0), 10000);
+
+  LatencyHistogram small;
+  small.Record(7);
+  small.Record(3);
+  EXPECT_EQ(small.GetPercentile(0.50), 3);
+  histogram.Merge(small);
+  EXPECT_EQ(histogram.GetCount(), 10002);
+  EXPECT_EQ(histogram.GetPercentile(0), 1);
+
+  // Every checked statement is counted
+  Configuration default_conf;
+  default_conf.collect_findings = true;
+  default_conf.run_stats.Start();
+  CheckText(default_conf, "SELECT * FROM t;\nSELECT a FROM u;");
+  auto compilations = GetRegexCompilations();
+  CompileRegex("(a)");
+  EXPECT_EQ(GetRegexCompilations(), compilations + 1);
+  default_conf.run_stats.Stop();
+
+  auto& stats = default_conf.run_stats;
+  EXPECT_EQ(stats.statements, 2);
+  EXPECT_EQ(stats.latency.GetCount(), 2);
+  EXPECT_GT(stats.bytes, 0);
+  EXPECT_GT(stats.elapsed_nanoseconds, 0);
+  EXPECT_GE(stats.regex_compilations, 1);
+  EXPECT_GT(stats.peak_rss_bytes, 0);
+
+  std::ostringstream json;
+  WriteRunStatsJson(stats, json);
+  JsonValue value;
+  std::string error;
+  ASSERT_TRUE(ParseJson(json.str(), value, error)) << error;
+  EXPECT_EQ(value.GetNumber("statements"), 2);
+  ASSERT_NE(value.Find("latency_nanoseconds"), nullptr);
+  EXPECT_EQ(value.Find("latency_nanoseconds")->GetNumber("count"), 2);
+
+}
+
+TEST(TestSuite, TopSlowestTest) {
+
+  // The heap keeps the slowest statements
+  SlowestStatements slowest;
+  for(std::uint64_t nanoseconds = 1; nanoseconds <= 10; nanoseconds++){
+    SlowStatement statement;
+    statement.nanoseconds = nanoseconds * 7 % 11;
+    slowest.Add(statement, 3);
+  }
+  auto sorted = slowest.GetSorted();
+  ASSERT_EQ(sorted.size(), 3);
+  EXPECT_EQ(sorted[0].nanoseconds, 10);
+  EXPECT_EQ(sorted[2].nanoseconds, 8);
+  EXPECT_FALSE(slowest.IsSlowEnough(8, 3));
+  EXPECT_TRUE(slowest.IsSlowEnough(9, 3));
+
+  SlowestStatements other;
+  SlowStatement statement;
+  statement.nanoseconds = 100;
+  other.Add(statement, 3);
+  slowest.Merge(other);
+  sorted = slowest.GetSorted();
+  ASSERT_EQ(sorted.size(), 3);
+  EXPECT_EQ(sorted[0].nanoseconds, 100);
+  EXPECT_EQ(sorted[2].nanoseconds, 9);
+
+  // Checked statements keep their location and dominant rule
+  Configuration default_conf;
+  default_conf.collect_findings = true;
+  default_conf.top_slowest = 2;
+  std::string text = "SELECT a FROM t;\nSELECT * FROM u;\nSELECT b FROM v";
+  CheckText(default_conf, text);
+
+  sorted = default_conf.run_stats.slowest.GetSorted();
+  ASSERT_EQ(sorted.size(), 2);
+  for(auto& slow_statement : sorted){
+    EXPECT_GT(slow_statement.nanoseconds, 0);
+    EXPECT_GE(slow_statement.nanoseconds, slow_statement.rule_nanoseconds);
+    EXPECT_NE(std::string(slow_statement.rule_id), "");
+    auto end = slow_statement.offset + slow_statement.length;
+    EXPECT_TRUE(end == text.length() || text[end] == ';');
+  }
+
+  std::ostringstream report;
+  PrintSlowestStatements(default_conf.run_stats, report);
+  EXPECT_NE(report.str().find("Dominant rule"), std::string::npos);
+
+}
+
+TEST(TestSuite, BudgetTest) {
+
+  // Oversized statements are skipped
+  Configuration default_conf;
+  default_conf.collect_findings = true;
+  default_conf.max_statement_bytes = 20;
+  CheckText(default_conf, "SELECT * FROM some_table;\nSELECT * FROM t;");
+  ASSERT_EQ(default_conf.skipped_checks.size(), 1);
+  EXPECT_EQ(default_conf.skipped_checks[0].rule_ids, "all");
+  EXPECT_EQ(default_conf.run_stats.skipped_statements, 1);
+  ASSERT_EQ(default_conf.findings.size(), 1);
+  EXPECT_EQ(default_conf.findings[0].line_number, 2);
+
+  // Statements that would overflow the stack of std::regex are skipped by
+  // default
+  Configuration file_conf;
+  file_conf.collect_findings = true;
+  CheckText(file_conf, "SELECT DISTINCT " + std::string(40 * 1024, 'a') +
+            ";\nSELECT * FROM t;");
+  ASSERT_EQ(file_conf.skipped_checks.size(), 1);
+  EXPECT_EQ(file_conf.skipped_checks[0].reason, "statement exceeds 16384 bytes");
+  ASSERT_EQ(file_conf.findings.size(), 1);
+  EXPECT_EQ(file_conf.findings[0].rule_id, "3001");
+
+  // Rules out of steps are aborted and the other rules still run
+  Configuration step_conf;
+  step_conf.collect_findings = true;
+  step_conf.rule_step_budget = 5;
+  std::string select_stars;
+  for(int i = 0; i < 8; i++){
+    select_stars += "select * ";
+  }
+  CheckText(step_conf, "SELECT * FROM t WHERE a = '" + select_stars + "' ORDER BY RAND()");
+  ASSERT_EQ(step_conf.skipped_checks.size(), 1);
+  EXPECT_EQ(step_conf.skipped_checks[0].rule_ids, "3001");
+  EXPECT_EQ(step_conf.skipped_checks[0].reason, "rule step budget");
+  EXPECT_EQ(step_conf.run_stats.skipped_rules, 1);
+  ASSERT_EQ(step_conf.findings.size(), 1);
+  EXPECT_EQ(step_conf.findings[0].rule_id, "3006");
+
+  std::ostringstream json;
+  WriteSkippedChecksJson(json, step_conf.skipped_checks);
+  JsonValue value;
+  std::string error;
+  ASSERT_TRUE(ParseJson(json.str(), value, error)) << error;
+  ASSERT_EQ(value.array.size(), 1);
+  EXPECT_EQ(value.array[0].GetString("rules"), "3001");
+
+  // An exhausted statement budget skips the remaining rules
+  Configuration time_conf;
+  time_conf.collect_findings = true;
+  time_conf.max_statement_bytes = 0;
+  time_conf.statement_budget_ms = 1;
+  CheckText(time_conf, "SELECT * FROM t WHERE a = '" + std::string(200000, 'x') + "'");
+  ASSERT_FALSE(time_conf.skipped_checks.empty());
+  EXPECT_GT(time_conf.run_stats.skipped_rules, 0);
+
+}
+
+TEST(TestSuite, FuzzRegressionTest) {
+
+  // Words longer than a line get a line of their own
+  auto wrapped = WrapText(std::string(100, 'x') + " a b");
+  EXPECT_EQ(wrapped, std::string(100, 'x') + "\na b");
+
+  // Statements that normalize to nothing
+  Configuration statement_conf;
+  statement_conf.collect_findings = true;
+  CheckStatement(statement_conf, "");
+  CheckStatement(statement_conf, "\n");
+  EXPECT_TRUE(statement_conf.findings.empty());
+
+  // Input that ends without a delimiter
+  Configuration check_conf;
+  check_conf.testing_mode = true;
+  std::unique_ptr<std::istringstream> stream(new std::istringstream());
+  stream->str("\n;;SELECT * FROM t");
+  check_conf.test_stream.reset(stream.release());
+  Check(check_conf);
+  EXPECT_EQ(check_conf.run_stats.statements, 3);
+
+}
+
+TEST(TestSuite, DifferentialTest) {
+
+  // Literals every match of a pattern contains
+  EXPECT_EQ(GetRequiredLiterals("(select\\s+\\*)"), std::vector<std::string>{"select"});
+  EXPECT_TRUE(GetRequiredLiterals(".+?").empty());
+  EXPECT_TRUE(MayMatch({"select"}, "SELECT * FROM t") == false);
+  EXPECT_TRUE(MayMatch({"select"}, "select * from t"));
+
+  // Both engines report the same findings
+  Configuration options;
+  options.pattern_engine = PATTERN_ENGINE_PREFILTER;
+  for(auto sql_text : {"SELECT * FROM t;", "CREATE TABLE t (id INT, tags TEXT);",
+                       "SELECT DISTINCT a FROM t JOIN u ON t.x = u.x;",
+                       "select 'abc' || a from t where b like '%x' order by rand();"}){
+    EXPECT_EQ(CompareEngines(options, sql_text), "");
+  }
+
+  // Changed findings are reported
+  auto findings = GetFindings(options, PATTERN_ENGINE_REGEX, "SELECT * FROM t;");
+  ASSERT_FALSE(findings.empty());
+  auto changed = findings;
+  changed[0].column++;
+  EXPECT_NE(DiffFindings(findings, changed), "");
+  changed.pop_back();
+  EXPECT_NE(DiffFindings(findings, changed), "");
+
+  // Reproducers keep only what the failure needs
+  auto reproducer = MinimizeInput("abc\nxdef\nghy", [](const std::string& text){
+    return text.find('x') != std::string::npos && text.find('y') != std::string::npos;
+  });
+  EXPECT_EQ(reproducer, "xy");
+
+}
+
+TEST(TestSuite, RegexAuditTest) {
+
+  // Nested and ambiguous quantifiers
+  RegexAudit nested;
+  AnalyzePattern("(a+)+b", nested);
+  EXPECT_EQ(nested.star_height, 2);
+  EXPECT_FALSE(nested.Passed());
+
+  // Every iteration starts with a character the inner loop cannot consume
+  RegexAudit unrolled;
+  AnalyzePattern("(a[^a]*)*b", unrolled);
+  EXPECT_EQ(unrolled.star_height, 2);
+  EXPECT_TRUE(unrolled.Passed());
+
+  RegexAudit alternatives;
+  AnalyzePattern("(ab|a)*c", alternatives);
+  EXPECT_FALSE(alternatives.Passed());
+
+  RegexAudit adjacent;
+  AnalyzePattern("[a-z]+_?[a-z0-9]+x", adjacent);
+  EXPECT_FALSE(adjacent.Passed());
+
+  RegexAudit linear;
+  AnalyzePattern("(select\\s+\\*)", linear);
+  EXPECT_EQ(linear.star_height, 1);
+  EXPECT_TRUE(linear.Passed());
+  EXPECT_TRUE(linear.warnings.empty());
+
+  RegexAudit backspace;
+  AnalyzePattern("(\bor\b)", backspace);
+  EXPECT_TRUE(backspace.Passed());
+  EXPECT_EQ(backspace.warnings.size(), 1);
+
+  // A search that rescans the input from every position
+  RegexFuzzOptions options;
+  options.max_input_bytes = 8192;
+  options.time_threshold_ms = 1;
+  RegexAudit quadratic;
+  FuzzPattern("\\s+x", options, quadratic);
+  EXPECT_FALSE(quadratic.Passed());
+  EXPECT_NE(quadratic.worst_input.find("\" \" repeated"), std::string::npos);
+
+  // Every rule passes the analysis
+  for(auto& rule : GetRules()){
+    if(rule.pattern == nullptr){
+      continue;
+    }
+    RegexAudit audit;
+    AnalyzePattern(rule.pattern, audit);
+    EXPECT_TRUE(audit.Passed()) << rule.id;
+  }
+
+}
+
 }  // End machine sqlcheck
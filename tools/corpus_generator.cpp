@@ -0,0 +1,122 @@
+// CORPUS GENERATOR SOURCE
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+
+#include "generator.h"
+
+#include "gflags/gflags.h"
+
+DEFINE_bool(h, false, "Print help message");
+DEFINE_uint64(seed, 0, "Seed of the generator");
+DEFINE_double(density, 0.1, "Fraction of DDL, OLTP and bulk INSERT statements "
+              "with an anti-pattern");
+DEFINE_string(size, "1M", "Stop after this many bytes (K, M and G suffixes)");
+DEFINE_uint64(statements, 0, "Stop after this many statements");
+DEFINE_string(weights, "10,70,10,8,2", "Relative frequency of DDL, OLTP, "
+              "analytic, bulk INSERT and pathological statements");
+DEFINE_uint64(bulk_rows, 100, "Rows per bulk INSERT statement");
+DEFINE_string(output, "", "SQL output file (default -- standard output)");
+DEFINE_string(annotations, "", "Ground truth output file (JSON lines)");
+
+void Usage() {
+  std::cout <<
+      "Command line options : corpus_generator <options>\n"
+      "   -seed                  :  Seed of the generator (0 by default) \n"
+      "   -density               :  Fraction of DDL, OLTP and bulk INSERT statements \n"
+      "                          :  with an anti-pattern (0.1 by default) \n"
+      "   -size                  :  Stop after this many bytes (e.g. 64K, 10M, 2G) \n"
+      "   -statements            :  Stop after this many statements \n"
+      "   -weights               :  Frequency of DDL, OLTP, analytic, bulk INSERT and \n"
+      "                          :  pathological statements (10,70,10,8,2 by default) \n"
+      "   -bulk_rows             :  Rows per bulk INSERT statement (100 by default) \n"
+      "   -output                :  SQL output file (default -- standard output) \n"
+      "   -annotations           :  Ground truth output file (JSON lines) \n"
+      "   -h -help               :  Print help message \n";
+}
+
+// Parse a size with an optional K, M or G suffix
+bool ParseSize(const std::string& text, std::uint64_t& size){
+
+  char* end = nullptr;
+  size = std::strtoull(text.c_str(), &end, 10);
+  if(end == text.c_str()){
+    return false;
+  }
+
+  switch (::toupper(static_cast<unsigned char>(*end))) {
+    case 'G':
+      size <<= 10;
+      // fall through
+    case 'M':
+      size <<= 10;
+      // fall through
+    case 'K':
+      size <<= 10;
+      end++;
+      break;
+    default:
+      break;
+  }
+  return *end == '\0';
+}
+
+int main(int argc, char **argv) {
+
+  gflags::SetUsageMessage("");
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  if(FLAGS_h == true){
+    Usage();
+    gflags::ShutDownCommandLineFlags();
+    return (EXIT_SUCCESS);
+  }
+
+  sqlcheck::CorpusOptions options;
+  options.seed = FLAGS_seed;
+  options.density = FLAGS_density;
+  options.bulk_rows = FLAGS_bulk_rows;
+
+  std::istringstream weights(FLAGS_weights);
+  std::string weight;
+  for(int kind = 0; kind < sqlcheck::STATEMENT_KIND_COUNT; kind++){
+    if(!std::getline(weights, weight, ',')){
+      printf("INVALID WEIGHTS :: %s\n", FLAGS_weights.c_str());
+      exit(EXIT_FAILURE);
+    }
+    options.weights[kind] = std::strtoul(weight.c_str(), nullptr, 10);
+  }
+
+  std::uint64_t max_bytes = 0;
+  if(FLAGS_size.empty() == false && ParseSize(FLAGS_size, max_bytes) == false){
+    printf("INVALID SIZE :: %s\n", FLAGS_size.c_str());
+    exit(EXIT_FAILURE);
+  }
+
+  if(options.density < 0 || options.density > 1){
+    printf("INVALID DENSITY :: %f\n", options.density);
+    exit(EXIT_FAILURE);
+  }
+
+  // Set up outputs
+  std::unique_ptr<std::ofstream> sql_file;
+  if(FLAGS_output.empty() == false){
+    sql_file.reset(new std::ofstream(FLAGS_output.c_str()));
+  }
+  std::unique_ptr<std::ofstream> annotations;
+  if(FLAGS_annotations.empty() == false){
+    annotations.reset(new std::ofstream(FLAGS_annotations.c_str()));
+  }
+
+  std::ostream& sql = sql_file ? *sql_file : std::cout;
+  sqlcheck::WriteCorpus(options, max_bytes, FLAGS_statements, sql,
+                        annotations.get());
+
+  gflags::ShutDownCommandLineFlags();
+  return (EXIT_SUCCESS);
+}
@@ -0,0 +1,187 @@
+// DIFFERENTIAL SOURCE
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include "differential.h"
+#include "file_walker.h"
+#include "generator.h"
+#include "list.h"
+#include "prefilter.h"
+
+#include "gflags/gflags.h"
+
+DEFINE_bool(h, false, "Print help message");
+DEFINE_string(engine, "prefilter", "Engine to compare with the regex engine");
+DEFINE_uint64(seed, 1, "Seed of the corpus and of the mutations");
+DEFINE_uint64(corpus_bytes, 1 << 20, "Bytes of generated corpus to compare");
+DEFINE_uint64(mutations, 1000, "Mutated statements to compare");
+DEFINE_uint64(max_reports, 5, "Stop after this many disagreements");
+
+void Usage() {
+  std::cout <<
+      "Command line options : differential <options> [files and directories]\n"
+      "   -engine                :  Engine to compare with the regex engine \n"
+      "                          :  (prefilter by default) \n"
+      "   -seed                  :  Seed of the corpus and of the mutations \n"
+      "   -corpus_bytes          :  Bytes of generated corpus to compare (1M by default) \n"
+      "   -mutations             :  Mutated statements to compare (1000 by default) \n"
+      "   -max_reports           :  Stop after this many disagreements (5 by default) \n"
+      "   -h -help               :  Print help message \n";
+}
+
+// Split a text into its statements (with their delimiters)
+std::vector<std::string> SplitStatements(const std::string& text){
+  std::vector<std::string> statements;
+  std::size_t begin = 0;
+  while(begin < text.length()){
+    auto end = text.find(';', begin);
+    end = (end == std::string::npos) ? text.length() : end + 1;
+    statements.push_back(text.substr(begin, end - begin));
+    begin = end;
+  }
+  return statements;
+}
+
+// Mutate a statement: insert rule literals and other statements, drop,
+// repeat and change bytes
+std::string Mutate(const std::string& statement,
+                   const std::vector<std::string>& statements,
+                   const std::vector<std::string>& literals,
+                   std::mt19937_64& random){
+
+  auto text = statement;
+  auto mutations = 1 + random() % 4;
+  for(std::uint64_t mutation = 0; mutation < mutations; mutation++){
+    auto position = text.empty() ? 0 : random() % (text.length() + 1);
+    auto length = text.empty() ? 0 : random() % std::min<std::size_t>(text.length(), 32);
+    switch (random() % 6) {
+      case 0:
+      case 1:
+        text.insert(position, literals[random() % literals.size()]);
+        break;
+      case 2:
+        text.erase(position, length);
+        break;
+      case 3:
+        text.insert(position, text.substr(position, length));
+        break;
+      case 4:
+        text.insert(position, 1, static_cast<char>(random() % 256));
+        break;
+      default:
+        text.insert(position, statements[random() % statements.size()]);
+        break;
+    }
+  }
+  return text;
+}
+
+int main(int argc, char **argv) {
+
+  gflags::SetUsageMessage("");
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  if(FLAGS_h == true){
+    Usage();
+    gflags::ShutDownCommandLineFlags();
+    return (EXIT_SUCCESS);
+  }
+
+  sqlcheck::Configuration options;
+  options.pattern_engine = sqlcheck::StringToPatternEngine(FLAGS_engine);
+  if(options.pattern_engine == sqlcheck::PATTERN_ENGINE_INVALID){
+    printf("INVALID ENGINE :: %s\n", FLAGS_engine.c_str());
+    exit(EXIT_FAILURE);
+  }
+
+  // Files and directories, then the generated corpus
+  std::vector<std::pair<std::string, std::string>> inputs;
+  for(int i = 1; i < argc; i++){
+    std::string path = argv[i];
+    struct stat info;
+    if(stat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode)){
+      sqlcheck::WalkDirectory(path, [&inputs](const std::string& file){
+        inputs.push_back(std::make_pair(file, std::string()));
+      });
+    }
+    else {
+      inputs.push_back(std::make_pair(path, std::string()));
+    }
+  }
+  for(auto& input : inputs){
+    if(sqlcheck::ReadFile(input.first, input.second) == false){
+      printf("CANNOT READ :: %s\n", input.first.c_str());
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  if(FLAGS_corpus_bytes > 0){
+    sqlcheck::CorpusOptions corpus_options;
+    corpus_options.seed = FLAGS_seed;
+    std::ostringstream corpus;
+    sqlcheck::WriteCorpus(corpus_options, FLAGS_corpus_bytes, 0, corpus, nullptr);
+    inputs.push_back(std::make_pair("corpus (seed " + std::to_string(FLAGS_seed) + ")",
+                                    corpus.str()));
+  }
+
+  // Mutate the statements of all inputs
+  std::vector<std::string> statements;
+  for(auto& input : inputs){
+    auto split = SplitStatements(input.second);
+    statements.insert(statements.end(), split.begin(), split.end());
+  }
+  std::vector<std::string> literals = {";", "\n", "'", "(", ")", " "};
+  for(auto& rule : sqlcheck::GetRules()){
+    if(rule.pattern != nullptr){
+      auto rule_literals = sqlcheck::GetRequiredLiterals(rule.pattern);
+      literals.insert(literals.end(), rule_literals.begin(), rule_literals.end());
+    }
+  }
+  std::mt19937_64 random(FLAGS_seed);
+  for(std::uint64_t mutation = 0; mutation < FLAGS_mutations && statements.empty() == false;
+      mutation++){
+    auto& statement = statements[random() % statements.size()];
+    inputs.push_back(std::make_pair("mutation " + std::to_string(mutation),
+                                    Mutate(statement, statements, literals, random)));
+  }
+
+  // Rules that are not collected print their findings
+  std::cout.setstate(std::ios::badbit);
+
+  std::uint64_t disagreements = 0;
+  for(auto& input : inputs){
+    auto difference = sqlcheck::CompareEngines(options, input.second);
+    if(difference.empty()){
+      continue;
+    }
+
+    disagreements++;
+    auto reproducer = sqlcheck::MinimizeInput(input.second, [&options](const std::string& text){
+      return sqlcheck::CompareEngines(options, text).empty() == false;
+    });
+    printf("DISAGREEMENT :: %s\n%s\n", input.first.c_str(), difference.c_str());
+    printf("Reproducer (%zu bytes) :: \"%s\"\n%s\n\n", reproducer.length(),
+           reproducer.c_str(), sqlcheck::CompareEngines(options, reproducer).c_str());
+
+    if(disagreements >= FLAGS_max_reports){
+      break;
+    }
+  }
+
+  printf("Engine                       :: %s\n",
+         sqlcheck::PatternEngineToString(options.pattern_engine).c_str());
+  printf("Inputs                       :: %zu\n", inputs.size());
+  printf("Disagreements                :: %llu\n",
+         static_cast<unsigned long long>(disagreements));
+
+  gflags::ShutDownCommandLineFlags();
+  return (disagreements == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
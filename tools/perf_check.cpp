@@ -0,0 +1,357 @@
+// PERF CHECK SOURCE
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "checker.h"
+#include "generator.h"
+#include "run_stats.h"
+
+#include "gflags/gflags.h"
+
+DEFINE_bool(h, false, "Print help message");
+DEFINE_string(baseline, "perf_baseline.txt", "Baseline file");
+DEFINE_bool(update, false, "Write the measurements to the baseline file");
+DEFINE_uint64(repetitions, 3, "Runs of every corpus (the fastest one counts)");
+DEFINE_bool(check_throughput, true, "Compare the throughput with the baseline");
+DEFINE_double(throughput_tolerance, 0.5, "Allowed throughput loss (fraction)");
+DEFINE_double(allocation_tolerance, 0.05, "Allowed allocation growth (fraction)");
+DEFINE_double(memory_tolerance, 0.25, "Allowed peak heap growth (fraction)");
+
+void Usage() {
+  std::cout <<
+      "Command line options : perf_check <options>\n"
+      "   -baseline              :  Baseline file (perf_baseline.txt by default) \n"
+      "   -update                :  Write the measurements to the baseline file \n"
+      "   -repetitions           :  Runs of every corpus (3 by default) \n"
+      "   -check_throughput      :  Compare the throughput with the baseline \n"
+      "                          :  (only meaningful in release builds) \n"
+      "   -throughput_tolerance  :  Allowed throughput loss (0.5 by default) \n"
+      "   -allocation_tolerance  :  Allowed growth of allocations per statement \n"
+      "                          :  (0.05 by default) \n"
+      "   -memory_tolerance      :  Allowed growth of the peak heap (0.25 by default) \n"
+      "   -h -help               :  Print help message \n";
+}
+
+// COUNTING ALLOCATOR
+
+namespace {
+
+// Every block starts with its size, padded to keep the alignment of new
+const std::size_t kHeaderBytes = alignof(std::max_align_t);
+
+// The checker is single-threaded here, so plain counters suffice
+std::uint64_t allocations = 0;
+std::uint64_t live_bytes = 0;
+std::uint64_t peak_live_bytes = 0;
+
+void* CountedAllocate(std::size_t size){
+  auto block = static_cast<char*>(std::malloc(size + kHeaderBytes));
+  if(block == nullptr){
+    return nullptr;
+  }
+  *reinterpret_cast<std::size_t*>(block) = size;
+  allocations++;
+  live_bytes += size;
+  if(live_bytes > peak_live_bytes){
+    peak_live_bytes = live_bytes;
+  }
+  return block + kHeaderBytes;
+}
+
+void CountedFree(void* pointer){
+  if(pointer == nullptr){
+    return;
+  }
+  auto block = static_cast<char*>(pointer) - kHeaderBytes;
+  live_bytes -= *reinterpret_cast<std::size_t*>(block);
+  std::free(block);
+}
+
+}  // namespace
+
+void* operator new(std::size_t size){
+  auto pointer = CountedAllocate(size);
+  if(pointer == nullptr){
+    throw std::bad_alloc();
+  }
+  return pointer;
+}
+
+void* operator new[](std::size_t size){
+  return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  return CountedAllocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+  return CountedAllocate(size);
+}
+
+void operator delete(void* pointer) noexcept {
+  CountedFree(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+  CountedFree(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+  CountedFree(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+  CountedFree(pointer);
+}
+
+// CORPORA
+
+// Fixed-seed corpus
+struct PerfCorpus {
+
+  std::string name;
+
+  std::uint64_t seed;
+
+  // relative frequency of every statement kind
+  std::vector<std::uint32_t> weights;
+
+  sqlcheck::PatternEngine pattern_engine;
+
+};
+
+// Measurements of a corpus (and the baseline format)
+struct PerfResult {
+
+  PerfResult()
+   : statements_per_second(0),
+     allocations_per_statement(0),
+     peak_heap_bytes(0) {
+  }
+
+  double statements_per_second;
+
+  double allocations_per_statement;
+
+  std::uint64_t peak_heap_bytes;
+
+};
+
+const std::uint64_t kCorpusBytes = 256 * 1024;
+
+std::vector<PerfCorpus> GetCorpora(){
+  return {
+    {"mixed", 1, {10, 70, 10, 8, 2}, sqlcheck::PATTERN_ENGINE_REGEX},
+    {"mixed_prefilter", 1, {10, 70, 10, 8, 2}, sqlcheck::PATTERN_ENGINE_PREFILTER},
+    {"ddl", 2, {100, 0, 0, 0, 0}, sqlcheck::PATTERN_ENGINE_REGEX},
+    {"oltp", 3, {0, 100, 0, 0, 0}, sqlcheck::PATTERN_ENGINE_REGEX},
+    {"analytic", 4, {0, 0, 100, 0, 0}, sqlcheck::PATTERN_ENGINE_REGEX},
+    {"bulk_insert", 5, {0, 0, 0, 100, 0}, sqlcheck::PATTERN_ENGINE_REGEX}
+  };
+}
+
+// Stream buffer that drops the report (it is still formatted)
+class NullBuffer : public std::streambuf {
+
+ protected:
+  int overflow(int c) override {
+    return c;
+  }
+
+};
+
+// Check the corpus like the binary does
+std::uint64_t RunCorpus(const PerfCorpus& corpus, const std::string& sql_text){
+
+  sqlcheck::Configuration state;
+  state.testing_mode = true;
+  state.pattern_engine = corpus.pattern_engine;
+  state.test_stream.reset(new std::istringstream(sql_text));
+  sqlcheck::Check(state);
+  return state.run_stats.statements;
+}
+
+PerfResult Measure(const PerfCorpus& corpus){
+
+  sqlcheck::CorpusOptions options;
+  options.seed = corpus.seed;
+  for(int kind = 0; kind < sqlcheck::STATEMENT_KIND_COUNT; kind++){
+    options.weights[kind] = corpus.weights[kind];
+  }
+  std::ostringstream sql;
+  sqlcheck::WriteCorpus(options, kCorpusBytes, 0, sql, nullptr);
+  auto sql_text = sql.str();
+
+  // Warm up, so that rule patterns are compiled before the counted run
+  RunCorpus(corpus, sql_text);
+
+  PerfResult result;
+  for(std::uint64_t repetition = 0; repetition < FLAGS_repetitions; repetition++){
+    auto start_allocations = allocations;
+    auto start_live_bytes = live_bytes;
+    peak_live_bytes = live_bytes;
+
+    auto start = std::chrono::steady_clock::now();
+    auto statements = RunCorpus(corpus, sql_text);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    auto seconds = std::chrono::duration<double>(elapsed).count();
+    auto throughput = (seconds > 0) ? statements / seconds : 0;
+    if(throughput > result.statements_per_second){
+      result.statements_per_second = throughput;
+    }
+    if(statements > 0){
+      result.allocations_per_statement =
+          static_cast<double>(allocations - start_allocations) / statements;
+    }
+    result.peak_heap_bytes = peak_live_bytes - start_live_bytes;
+  }
+  return result;
+}
+
+// BASELINE
+
+bool ReadBaseline(const std::string& file_name,
+                  std::map<std::string, PerfResult>& baseline){
+
+  std::ifstream input(file_name.c_str());
+  if(input.good() == false){
+    return false;
+  }
+
+  std::string line;
+  while(std::getline(input, line)){
+    if(line.empty() || line[0] == '#'){
+      continue;
+    }
+    std::istringstream fields(line);
+    std::string name;
+    PerfResult result;
+    if(fields >> name >> result.statements_per_second
+       >> result.allocations_per_statement >> result.peak_heap_bytes){
+      baseline[name] = result;
+    }
+  }
+  return true;
+}
+
+bool WriteBaseline(const std::string& file_name,
+                   const std::vector<PerfCorpus>& corpora,
+                   const std::vector<PerfResult>& results){
+
+  std::ofstream output(file_name.c_str());
+  output << "# perf_check baseline (regenerate with perf_check -update "
+            "in a release build)\n";
+  output << "# corpus  statements_per_second  allocations_per_statement  "
+            "peak_heap_bytes\n";
+  for(std::size_t i = 0; i < corpora.size(); i++){
+    char line[256];
+    snprintf(line, sizeof(line), "%-16s %10.0f %10.2f %12llu\n",
+             corpora[i].name.c_str(), results[i].statements_per_second,
+             results[i].allocations_per_statement,
+             static_cast<unsigned long long>(results[i].peak_heap_bytes));
+    output << line;
+  }
+  return output.good();
+}
+
+// Compare a measurement with its baseline (higher -- worse)
+bool Compare(const char* metric, const double value, const double expected,
+             const double tolerance){
+
+  auto limit = expected * (1 + tolerance);
+  bool passed = (value <= limit);
+  printf("   %-26s :: %12.2f (baseline %12.2f, limit %12.2f) %s\n", metric,
+         value, expected, limit, passed ? "" : "REGRESSION");
+  return passed;
+}
+
+int main(int argc, char **argv) {
+
+  gflags::SetUsageMessage("");
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  if(FLAGS_h == true){
+    Usage();
+    gflags::ShutDownCommandLineFlags();
+    return (EXIT_SUCCESS);
+  }
+
+  std::map<std::string, PerfResult> baseline;
+  if(FLAGS_update == false && ReadBaseline(FLAGS_baseline, baseline) == false){
+    printf("CANNOT READ BASELINE :: %s\n", FLAGS_baseline.c_str());
+    exit(EXIT_FAILURE);
+  }
+
+  // Drop the reports, but keep formatting them
+  NullBuffer null_buffer;
+  auto stdout_buffer = std::cout.rdbuf(&null_buffer);
+
+  auto corpora = GetCorpora();
+  std::vector<PerfResult> results;
+  for(auto& corpus : corpora){
+    results.push_back(Measure(corpus));
+  }
+
+  std::cout.rdbuf(stdout_buffer);
+
+  if(FLAGS_update == true){
+    if(WriteBaseline(FLAGS_baseline, corpora, results) == false){
+      printf("CANNOT WRITE BASELINE :: %s\n", FLAGS_baseline.c_str());
+      exit(EXIT_FAILURE);
+    }
+    printf("Baseline written to %s\n", FLAGS_baseline.c_str());
+    gflags::ShutDownCommandLineFlags();
+    return (EXIT_SUCCESS);
+  }
+
+  std::uint64_t regressions = 0;
+  for(std::size_t i = 0; i < corpora.size(); i++){
+    auto& result = results[i];
+    printf("%s\n", corpora[i].name.c_str());
+
+    auto entry = baseline.find(corpora[i].name);
+    if(entry == baseline.end()){
+      printf("   NOT IN BASELINE\n");
+      regressions++;
+      continue;
+    }
+    auto& expected = entry->second;
+
+    // Time per statement, so that higher is worse for every metric
+    if(FLAGS_check_throughput == true && result.statements_per_second > 0 &&
+       expected.statements_per_second > 0){
+      regressions += !Compare("microseconds per statement",
+                              1e6 / result.statements_per_second,
+                              1e6 / expected.statements_per_second,
+                              1 / (1 - FLAGS_throughput_tolerance) - 1);
+    }
+    regressions += !Compare("allocations per statement",
+                            result.allocations_per_statement,
+                            expected.allocations_per_statement,
+                            FLAGS_allocation_tolerance);
+    regressions += !Compare("peak heap bytes",
+                            result.peak_heap_bytes,
+                            expected.peak_heap_bytes,
+                            FLAGS_memory_tolerance);
+  }
+
+  printf("Peak RSS                     :: %llu KB\n",
+         static_cast<unsigned long long>(sqlcheck::GetPeakRss() / 1024));
+  printf("Regressions                  :: %llu\n",
+         static_cast<unsigned long long>(regressions));
+
+  gflags::ShutDownCommandLineFlags();
+  return (regressions == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,92 @@
+// REGEX AUDIT SOURCE
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+#include "list.h"
+#include "regex_audit.h"
+
+#include "gflags/gflags.h"
+
+DEFINE_bool(h, false, "Print help message");
+DEFINE_uint64(max_input_bytes, 8192, "Largest generated input");
+DEFINE_uint64(time_threshold_ms, 100, "Fail a pattern if an input takes "
+              "longer than this");
+DEFINE_bool(v, false, "Print the warnings and the slowest input");
+DEFINE_bool(verbose, false, "Print the warnings and the slowest input");
+
+void Usage() {
+  std::cout <<
+      "Command line options : regex_audit <options>\n"
+      "   -max_input_bytes       :  Largest generated input (8192 by default) \n"
+      "   -time_threshold_ms     :  Fail a pattern if an input takes longer \n"
+      "                          :  than this (100 by default) \n"
+      "   -v -verbose            :  Print the warnings and the slowest input \n"
+      "   -h -help               :  Print help message \n";
+}
+
+int main(int argc, char **argv) {
+
+  gflags::SetUsageMessage("");
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  if(FLAGS_h == true){
+    Usage();
+    gflags::ShutDownCommandLineFlags();
+    return (EXIT_SUCCESS);
+  }
+
+  sqlcheck::RegexFuzzOptions options;
+  options.max_input_bytes = FLAGS_max_input_bytes;
+  options.time_threshold_ms = FLAGS_time_threshold_ms;
+
+  std::size_t patterns = 0;
+  std::size_t failed = 0;
+  std::size_t warned = 0;
+
+  std::cout << "==================== Regex Audit ===============\n";
+  for(auto& rule : sqlcheck::GetRules()){
+    if(rule.pattern == nullptr){
+      continue;
+    }
+    patterns++;
+
+    // Fuzz only patterns that pass the static analysis (an exponential
+    // pattern would not finish)
+    sqlcheck::RegexAudit audit;
+    sqlcheck::AnalyzePattern(rule.pattern, audit);
+    if(audit.Passed() == true){
+      sqlcheck::FuzzPattern(rule.pattern, options, audit);
+    }
+
+    char line[160];
+    snprintf(line, sizeof(line), "%-5s %-28s star %d  %8.1f ms  x%-4.1f  %s\n",
+             rule.id, rule.name, audit.star_height,
+             audit.worst_nanoseconds / 1e6, audit.growth,
+             audit.Passed() ? (audit.warnings.empty() ? "OK" : "WARN") : "FAIL");
+    std::cout << line;
+
+    for(auto& problem : audit.problems){
+      std::cout << "      problem :: " << problem << "\n";
+    }
+    if(FLAGS_v == true || FLAGS_verbose == true){
+      for(auto& warning : audit.warnings){
+        std::cout << "      warning :: " << warning << "\n";
+      }
+      if(audit.worst_input.empty() == false){
+        std::cout << "      slowest :: " << audit.worst_input << "\n";
+      }
+    }
+
+    failed += audit.Passed() ? 0 : 1;
+    warned += audit.warnings.empty() ? 0 : 1;
+  }
+
+  std::cout << "Patterns                     :: " << patterns << "\n";
+  std::cout << "With Warnings                :: " << warned << "\n";
+  std::cout << "Failed                       :: " << failed << "\n";
+
+  gflags::ShutDownCommandLineFlags();
+  return (failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}